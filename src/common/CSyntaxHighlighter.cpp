@@ -3,7 +3,12 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "CSyntaxHighlighter.h"
+#include "highlightformattable.h"
+#include "utils.h"
 #include <QDebug>
+#include <QTextLayout>
+
+#include <KSyntaxHighlighting/Format>
 
 CSyntaxHighlighter::CSyntaxHighlighter(QObject *parent):
     SyntaxHighlighter (parent),
@@ -23,11 +28,33 @@ void CSyntaxHighlighter::setEnableHighlight(bool isEnable)
     m_bHighlight = isEnable;
 }
 
+void CSyntaxHighlighter::setPreserveFormats(bool isPreserve)
+{
+    m_bPreserveFormats = isPreserve;
+}
+
 void CSyntaxHighlighter::highlightBlock(const QString &text)
 {
-    if (!m_bHighlight) {
+    // 超长行仅由后台高亮引擎在工作线程高亮，不在 GUI 线程同步高亮整行
+    if (!m_bHighlight || text.size() > LONG_LINE_THRESHOLD) {
+        // QSyntaxHighlighter 会使用本次设置的格式替换文本块的格式，重新设置已有格式避免编辑时高亮闪烁
+        if (m_bPreserveFormats && currentBlock().layout()) {
+            const auto ranges = currentBlock().layout()->formats();
+            for (const QTextLayout::FormatRange &range : ranges) {
+                setFormat(range.start, range.length, range.format);
+            }
+        }
         return;
     }
 
     KSyntaxHighlighting::SyntaxHighlighter::highlightBlock(text);
 }
+
+void CSyntaxHighlighter::applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format)
+{
+    if (length <= 0 || HighlightFormatTable::isPlainFormat(format, theme())) {
+        return;
+    }
+
+    setFormat(offset, length, HighlightFormatTable::charFormat(format, theme()));
+}
@@ -15,10 +15,15 @@ public:
     explicit CSyntaxHighlighter(QObject *parent = nullptr);
     explicit CSyntaxHighlighter(QTextDocument *pDocument);
     void setEnableHighlight(bool isEnable);
+    // 禁用高亮时是否保留文本块已有的格式(由后台高亮引擎设置)
+    void setPreserveFormats(bool isPreserve);
 
 protected:
     virtual void highlightBlock(const QString & text) override;
+    // 设置的格式记录格式标识，切换主题时按标识替换格式，无需重新高亮
+    virtual void applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format) override;
 
 private:
     bool m_bHighlight = false;
+    bool m_bPreserveFormats = false;
 };
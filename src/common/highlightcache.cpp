@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "highlightcache.h"
+#include "highlightformattable.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QFileInfo>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDebug>
+
+// 缓存文件标识及格式版本
+static const quint32 s_cacheMagic = 0x484c4331;
+static const quint32 s_cacheVersion = 1;
+
+static QString s_cacheDir;
+
+// 文本块内容校验值
+static QByteArray blockChecksum(const QString &text)
+{
+    return QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Md5);
+}
+
+QString HighlightCache::cacheDir()
+{
+    if (s_cacheDir.isEmpty()) {
+        s_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/highlight";
+    }
+    return s_cacheDir;
+}
+
+void HighlightCache::setCacheDir(const QString &dir)
+{
+    s_cacheDir = dir;
+}
+
+QString HighlightCache::cacheFilePath(const Key &key)
+{
+    // 同一文件及高亮设置仅保留一份缓存，文件大小及修改时间在缓存内容中校验
+    const QString identity = QFileInfo(key.filePath).absoluteFilePath() + '\n' + key.definitionName
+                             + '\n' + key.definitionVersion + '\n' + key.themeName;
+    const QByteArray hash = QCryptographicHash::hash(identity.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDir() + "/" + QString::fromLatin1(hash);
+}
+
+/**
+ * @brief 保存文档中文本块 \a centerBlock 附近的高亮格式，仅保存已高亮(\a endBlock 之前)的文本块
+ * @return 是否保存成功
+ */
+bool HighlightCache::save(const Key &key, QTextDocument *document, int centerBlock, int endBlock)
+{
+    QFileInfo fileInfo(key.filePath);
+    if (!document || !fileInfo.isFile() || key.definitionName.isEmpty()) {
+        return false;
+    }
+
+    const int firstBlock = qMax(0, centerBlock - s_cacheRadius);
+    const int lastBlock = qMin(qMin(centerBlock + s_cacheRadius, endBlock), document->blockCount()) - 1;
+    if (lastBlock < firstBlock) {
+        return false;
+    }
+
+    if (!QDir().mkpath(cacheDir())) {
+        return false;
+    }
+
+    QSaveFile file(cacheFilePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_11);
+    stream << s_cacheMagic << s_cacheVersion
+           << static_cast<qint64>(fileInfo.size())
+           << static_cast<qint64>(fileInfo.lastModified().toMSecsSinceEpoch())
+           << static_cast<qint32>(document->blockCount())
+           << static_cast<qint32>(firstBlock)
+           << static_cast<qint32>(lastBlock - firstBlock + 1);
+
+    QTextBlock block = document->findBlockByNumber(firstBlock);
+    for (int i = firstBlock; i <= lastBlock && block.isValid(); i++, block = block.next()) {
+        const QVector<QTextLayout::FormatRange> ranges = block.layout()->formats();
+        stream << blockChecksum(block.text()) << static_cast<qint32>(ranges.size());
+        for (const QTextLayout::FormatRange &range : ranges) {
+            // 格式标识在每次运行时分配，不保存到缓存
+            QTextFormat format = range.format;
+            format.clearProperty(HighlightFormatTable::s_formatIdProperty);
+            stream << static_cast<qint32>(range.start) << static_cast<qint32>(range.length) << format;
+        }
+    }
+
+    if (QDataStream::Ok != stream.status() || !file.commit()) {
+        return false;
+    }
+
+    trimCacheFiles();
+    return true;
+}
+
+/**
+ * @brief 读取缓存，文件大小、修改时间及文本块数量一致时，将格式应用到内容一致的文本块
+ * @return 应用的文本块数量
+ */
+int HighlightCache::restore(const Key &key, QTextDocument *document)
+{
+    QFileInfo fileInfo(key.filePath);
+    if (!document || !fileInfo.isFile() || key.definitionName.isEmpty()) {
+        return 0;
+    }
+
+    QFile file(cacheFilePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_11);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 fileSize = 0;
+    qint64 lastModified = 0;
+    qint32 blockCount = 0;
+    qint32 firstBlock = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> fileSize >> lastModified >> blockCount >> firstBlock >> count;
+    if (QDataStream::Ok != stream.status()
+            || s_cacheMagic != magic
+            || s_cacheVersion != version
+            || fileInfo.size() != fileSize
+            || fileInfo.lastModified().toMSecsSinceEpoch() != lastModified
+            || document->blockCount() != blockCount) {
+        return 0;
+    }
+
+    QTextBlock block = document->findBlockByNumber(firstBlock);
+    const int from = block.isValid() ? block.position() : 0;
+    int to = from;
+    int restored = 0;
+    for (int i = 0; i < count && block.isValid(); i++, block = block.next()) {
+        QByteArray checksum;
+        qint32 rangeCount = 0;
+        stream >> checksum >> rangeCount;
+        if (QDataStream::Ok != stream.status() || rangeCount < 0) {
+            break;
+        }
+
+        QVector<QTextLayout::FormatRange> ranges;
+        ranges.reserve(rangeCount);
+        for (int j = 0; j < rangeCount; j++) {
+            qint32 start = 0;
+            qint32 length = 0;
+            QTextFormat format;
+            stream >> start >> length >> format;
+
+            QTextLayout::FormatRange range;
+            range.start = start;
+            range.length = length;
+            range.format = format.toCharFormat();
+            ranges.append(range);
+        }
+        if (QDataStream::Ok != stream.status()) {
+            break;
+        }
+
+        // 内容不一致或已高亮的文本块保持不变
+        if (checksum != blockChecksum(block.text()) || !block.layout()->formats().isEmpty()) {
+            continue;
+        }
+
+        block.layout()->setFormats(ranges);
+        to = block.position() + block.length();
+        restored++;
+    }
+
+    if (to > from) {
+        document->markContentsDirty(from, to - from);
+    }
+
+    return restored;
+}
+
+void HighlightCache::remove(const Key &key)
+{
+    QFile::remove(cacheFilePath(key));
+}
+
+void HighlightCache::trimCacheFiles()
+{
+    QDir dir(cacheDir());
+    const QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time);
+    for (int i = s_maxCacheFiles; i < files.size(); i++) {
+        QFile::remove(files.at(i).absoluteFilePath());
+    }
+}
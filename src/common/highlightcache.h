@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HIGHLIGHTCACHE_H
+#define HIGHLIGHTCACHE_H
+
+#include <QString>
+
+class QTextDocument;
+
+/**
+ * @brief 语法高亮结果的磁盘缓存
+ *      关闭文件时保存光标附近文本块的高亮格式，按文件路径、大小、修改时间及高亮定义、主题区分，
+ *      重新打开时立即应用到恢复的光标位置，无需等待后台高亮从文档起始处理到此位置。
+ *      读取时校验每个文本块的内容，不一致的文本块不会应用缓存。
+ * @note KSyntaxHighlighting::State 未提供序列化接口，无法缓存高亮状态，因此缓存的是高亮格式
+ */
+class HighlightCache
+{
+public:
+    // 缓存标识
+    struct Key {
+        QString filePath;           ///< 文件路径
+        QString definitionName;     ///< 高亮定义名称
+        QString definitionVersion;  ///< 高亮定义版本
+        QString themeName;          ///< 高亮主题名称
+    };
+
+    // 保存文本块 [centerBlock - s_cacheRadius, min(centerBlock + s_cacheRadius, endBlock)) 的高亮格式
+    static bool save(const Key &key, QTextDocument *document, int centerBlock, int endBlock);
+    // 读取缓存并应用到文档，返回应用的文本块数量
+    static int restore(const Key &key, QTextDocument *document);
+    // 移除缓存
+    static void remove(const Key &key);
+
+    // 缓存目录
+    static QString cacheDir();
+    static void setCacheDir(const QString &dir);
+
+    // 光标前后缓存的文本块数量
+    static const int s_cacheRadius = 512;
+    // 最多保留的缓存文件数量
+    static const int s_maxCacheFiles = 64;
+
+private:
+    Q_DISABLE_COPY(HighlightCache)
+    HighlightCache() = delete;
+
+    static QString cacheFilePath(const Key &key);
+    // 移除最早的缓存文件，保留最多 s_maxCacheFiles 个文件
+    static void trimCacheFiles();
+};
+
+#endif  // HIGHLIGHTCACHE_H
@@ -0,0 +1,660 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "highlightengine.h"
+#include "highlightformattable.h"
+#include "utils.h"
+
+#include <KSyntaxHighlighting/AbstractHighlighter>
+#include <KSyntaxHighlighting/Format>
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTimer>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+
+// 单次任务快照的最大文本块数量，未结束时从快照末尾继续新的任务
+static const int s_snapshotBlocks = 4096;
+// 每批次返回的最大文本块数量及最长间隔(ms)
+static const int s_batchBlocks = 256;
+static const int s_batchInterval = 8;
+// 合并连续编辑的延迟(ms)
+static const int s_restartDelay = 10;
+// GUI 线程单次应用高亮结果的时间片(ms)，超出后让出事件循环处理输入及绘制
+static const int s_applyBudget = 4;
+// 超长行分段高亮时切分位置两侧比较格式的长度
+static const int s_segmentOverlap = 256;
+
+/**
+ * @brief 工作线程返回的高亮结果
+ */
+struct HighlightBatch {
+    quint64 generation = 0;
+    int firstBlock = 0;                                         ///< 首个文本块序号
+    QVector<QVector<QTextLayout::FormatRange>> formats;         ///< 每个文本块的格式
+    QVector<QPair<int, KSyntaxHighlighting::State>> checkpoints;///< 批次内的检查点
+    KSyntaxHighlighting::State endState;                        ///< 批次最后一个文本块结束时的状态
+    bool last = false;                                          ///< 是否为任务的最后一个批次
+    bool finished = false;                                      ///< 已到达文档末尾或提前结束
+};
+
+/**
+ * @brief 高亮任务，GUI 线程创建，工作线程执行
+ */
+struct HighlightJob {
+    HighlightEngine *engine = nullptr;
+    quint64 generation = 0;
+    QString text;                                   ///< 文本快照，文本块以 QChar::ParagraphSeparator 分隔
+    int startBlock = 0;                             ///< 快照首个文本块序号
+    int blockCount = 0;                             ///< 快照文本块数量
+    bool reachesEnd = false;                        ///< 快照是否包含文档末尾
+    KSyntaxHighlighting::State startState;
+    KSyntaxHighlighting::Definition definition;
+    KSyntaxHighlighting::Theme theme;
+    QMap<int, KSyntaxHighlighting::State> stopCheckpoints;  ///< 变更区域之后的检查点，状态一致时提前结束
+
+    std::atomic_bool canceled {false};
+    QMutex mutex;                                   ///< 保护 canceled 的设置及 batches
+    QVector<HighlightBatch> batches;                ///< 待 GUI 线程应用的结果
+};
+
+namespace {
+
+/**
+ * @brief 工作线程使用的高亮器，收集每行的格式
+ */
+class JobHighlighter : public KSyntaxHighlighting::AbstractHighlighter
+{
+public:
+    /**
+     * @brief 高亮一行文本。超过 LONG_LINE_THRESHOLD 的行按 LONG_LINE_SEGMENT 长度分段高亮，
+     *      高亮状态在分段之间传递，仅最后一段按行尾处理(行尾弹出的上下文、行尾续行等)，
+     *      分段之间可以检查取消。分段作为独立的行高亮时会提前执行行尾弹出，因此仅在切分位置
+     *      两侧的格式和不切分时一致的位置切分(例如不在单行注释、字符串内)；
+     *      LONG_LINE_HIGHLIGHT_LIMIT 长度内找不到可以切分的位置时，行的剩余部分不高亮
+     */
+    QVector<QTextLayout::FormatRange> highlight(const QString &text, KSyntaxHighlighting::State &state,
+                                                const std::atomic_bool &canceled)
+    {
+        Pass line;
+        if (text.size() <= LONG_LINE_THRESHOLD) {
+            state = highlightPass(text, state, line);
+            return line.ranges;
+        }
+
+        int begin = 0;
+        while (!canceled) {
+            if (text.size() - begin <= LONG_LINE_THRESHOLD) {
+                Pass last;
+                state = highlightPass(text.mid(begin), state, last);
+                appendPass(line, last, begin);
+                break;
+            }
+
+            int cut = -1;
+            for (int end = begin + LONG_LINE_SEGMENT;
+                    end - begin <= LONG_LINE_HIGHLIGHT_LIMIT && end + s_segmentOverlap <= text.size() && !canceled;
+                    end += LONG_LINE_SEGMENT) {
+                Pass head;
+                const KSyntaxHighlighting::State headState = highlightPass(text.mid(begin, end - begin), state, head);
+                if (isCleanCut(text, begin, end, state, head, headState)) {
+                    appendPass(line, head, begin);
+                    state = headState;
+                    cut = end;
+                    break;
+                }
+            }
+            if (-1 == cut) {
+                break;
+            }
+            begin = cut;
+        }
+
+        return line.ranges;
+    }
+
+protected:
+    void applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format) override
+    {
+        if (length <= 0 || HighlightFormatTable::isPlainFormat(format, theme())) {
+            return;
+        }
+
+        QTextLayout::FormatRange range;
+        range.start = offset;
+        range.length = length;
+        range.format = charFormat(format);
+        m_pass->ranges.append(range);
+        m_pass->ids.append(format.id());
+    }
+
+private:
+    // 单次 highlightLine() 的结果，ids 为每个格式范围对应的格式标识
+    struct Pass {
+        QVector<QTextLayout::FormatRange> ranges;
+        QVector<quint16> ids;
+    };
+
+    KSyntaxHighlighting::State highlightPass(const QString &text, const KSyntaxHighlighting::State &state, Pass &pass)
+    {
+        m_pass = &pass;
+        const KSyntaxHighlighting::State endState = highlightLine(text, state);
+        m_pass = nullptr;
+        return endState;
+    }
+
+    // 将 pass 的格式按偏移 offset 追加到 line
+    static void appendPass(Pass &line, const Pass &pass, int offset)
+    {
+        for (QTextLayout::FormatRange range : pass.ranges) {
+            range.start += offset;
+            line.ranges.append(range);
+        }
+        line.ids += pass.ids;
+    }
+
+    // 将 pass 中 [from, to) 范围内的格式标识(偏移 offset)写入 ids ，无格式的位置为 0
+    static void fillFormatIds(const Pass &pass, int offset, int from, int to, QVector<int> &ids)
+    {
+        for (int i = 0; i < pass.ranges.size(); i++) {
+            const QTextLayout::FormatRange &range = pass.ranges.at(i);
+            const int begin = qMax(from, range.start + offset);
+            const int end = qMin(to, range.start + offset + range.length);
+            for (int position = begin; position < end; position++) {
+                ids[position - from] = pass.ids.at(i) + 1;
+            }
+        }
+    }
+
+    /**
+     * @brief 在 \a end 处切分是否不影响高亮：不切分时 [begin, end + s_segmentOverlap) 的格式和切分后
+     *      两段的格式在切分位置两侧 s_segmentOverlap 范围内一致
+     */
+    bool isCleanCut(const QString &text, int begin, int end, const KSyntaxHighlighting::State &state,
+                    const Pass &head, const KSyntaxHighlighting::State &headState)
+    {
+        Pass whole;
+        highlightPass(text.mid(begin, end + s_segmentOverlap - begin), state, whole);
+        Pass next;
+        highlightPass(text.mid(end, s_segmentOverlap), headState, next);
+
+        const int from = end - begin - s_segmentOverlap;
+        const int to = end - begin + s_segmentOverlap;
+        QVector<int> expected(to - from, 0);
+        fillFormatIds(whole, 0, from, to, expected);
+        QVector<int> actual(to - from, 0);
+        fillFormatIds(head, 0, from, to, actual);
+        fillFormatIds(next, end - begin, from, to, actual);
+        return expected == actual;
+    }
+
+    // 按格式标识缓存转换后的格式，格式记录标识用于切换主题时替换
+    QTextCharFormat charFormat(const KSyntaxHighlighting::Format &format)
+    {
+        auto itr = m_formats.constFind(format.id());
+        if (itr != m_formats.constEnd()) {
+            return itr.value();
+        }
+
+        const QTextCharFormat charFormat = HighlightFormatTable::charFormat(format, theme());
+        m_formats.insert(format.id(), charFormat);
+        return charFormat;
+    }
+
+private:
+    Pass *m_pass = nullptr;     ///< 当前 highlightLine() 的结果
+    QHash<quint16, QTextCharFormat> m_formats;
+};
+
+}  // namespace
+
+HighlightEngine::HighlightEngine(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+    , m_blockCount(document->blockCount())
+{
+    m_restartTimer = new QTimer(this);
+    m_restartTimer->setSingleShot(true);
+    m_restartTimer->setInterval(s_restartDelay);
+    connect(m_restartTimer, &QTimer::timeout, this, &HighlightEngine::startJob);
+}
+
+HighlightEngine::~HighlightEngine()
+{
+    // 取消后工作线程在处理下一行前退出，等待其结束，避免高亮定义所属的 Repository 先于任务析构
+    cancelJob();
+    m_future.waitForFinished();
+
+    if (m_finishedInterface.isRunning()) {
+        m_finishedInterface.reportCanceled();
+        m_finishedInterface.reportFinished();
+    }
+}
+
+void HighlightEngine::setDefinition(const KSyntaxHighlighting::Definition &definition)
+{
+    cancelJob();
+    m_checkpoints.clear();
+    m_definition = definition;
+    m_blockCount = m_document->blockCount();
+
+    if (isActive()) {
+        // 在 GUI 线程预先加载高亮定义及其包含的定义，工作线程仅读取已加载的数据
+        (void)m_definition.includedDefinitions();
+        restart(0);
+    } else {
+        m_pendingFrom = -1;
+        m_dirtyEnd = -1;
+        reportFinished();
+    }
+}
+
+KSyntaxHighlighting::Definition HighlightEngine::definition() const
+{
+    return m_definition;
+}
+
+/**
+ * @brief 文本块已有的格式按格式标识直接替换为新主题的格式，不重新分析文本；
+ *      未完成的任务使用旧主题，取消后从待高亮位置重新开始
+ */
+void HighlightEngine::setTheme(const KSyntaxHighlighting::Theme &theme)
+{
+    const bool changed = m_theme.name() != theme.name();
+    m_theme = theme;
+    if (!isActive() || !changed) {
+        return;
+    }
+
+    HighlightFormatTable(m_definition, m_theme).apply(m_document);
+    emit formatsChanged(0, m_document->blockCount() - 1);
+    if (!isFinished()) {
+        cancelJob();
+        m_restartTimer->start();
+    }
+}
+
+bool HighlightEngine::isActive() const
+{
+    return m_definition.isValid();
+}
+
+bool HighlightEngine::isFinished() const
+{
+    return -1 == m_pendingFrom;
+}
+
+/**
+ * @brief 强制从 \a blockNumber 开始重新高亮至文档末尾，不会因检查点状态一致而提前结束
+ */
+void HighlightEngine::restart(int blockNumber)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    cancelJob();
+    blockNumber = qMax(0, blockNumber);
+    m_pendingFrom = (-1 == m_pendingFrom) ? blockNumber : qMin(m_pendingFrom, blockNumber);
+    m_dirtyEnd = m_document->blockCount();
+    m_restartTimer->start();
+}
+
+void HighlightEngine::waitForFinished()
+{
+    while (isActive() && -1 != m_pendingFrom) {
+        if (!m_job) {
+            startJob();
+        }
+        if (!m_job) {
+            break;
+        }
+
+        QSharedPointer<HighlightJob> job = m_job;
+        m_future.waitForFinished();
+        applyBatches(-1);
+        // 任务未返回最终结果(例如被取消)，避免重复等待
+        if (m_job == job) {
+            break;
+        }
+    }
+}
+
+int HighlightEngine::frontier() const
+{
+    return -1 == m_pendingFrom ? m_document->blockCount() : m_pendingFrom;
+}
+
+/**
+ * @brief 用于需要完整高亮的操作(例如打印)，高亮已完成或未启用高亮时返回已完成的 QFuture ，
+ *      文档在高亮完成前变更时将继续等待新的高亮结果
+ */
+QFuture<void> HighlightEngine::finishedFuture()
+{
+    if (!isActive() || isFinished()) {
+        QFutureInterface<void> finished;
+        finished.reportStarted();
+        finished.reportFinished();
+        return finished.future();
+    }
+
+    if (!m_finishedInterface.isRunning()) {
+        m_finishedInterface = QFutureInterface<void>();
+        m_finishedInterface.reportStarted();
+    }
+    return m_finishedInterface.future();
+}
+
+int HighlightEngine::checkpointCount() const
+{
+    return m_checkpoints.size();
+}
+
+/**
+ * @brief 文档变更时，变更区域内的检查点失效，之后的检查点按文本块数量的变化平移，
+ *      并从变更位置之上最近的检查点重新高亮
+ */
+void HighlightEngine::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+    const int newCount = m_document->blockCount();
+    const int delta = newCount - m_blockCount;
+    m_blockCount = newCount;
+    if (!isActive()) {
+        return;
+    }
+
+    QTextBlock firstBlock = m_document->findBlock(from);
+    QTextBlock lastBlock = m_document->findBlock(from + charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = m_document->lastBlock();
+    }
+
+    const int firstNumber = firstBlock.isValid() ? firstBlock.blockNumber() : 0;
+    const int lastNumber = qMax(firstNumber, lastBlock.blockNumber());
+    // 变更前变更区域的最后一个文本块
+    const int oldLastNumber = lastNumber - delta;
+
+    if (0 == delta) {
+        auto itr = m_checkpoints.upperBound(firstNumber);
+        while (itr != m_checkpoints.end() && itr.key() <= lastNumber) {
+            itr = m_checkpoints.erase(itr);
+        }
+    } else {
+        QMap<int, KSyntaxHighlighting::State> checkpoints;
+        for (auto itr = m_checkpoints.constBegin(); itr != m_checkpoints.constEnd(); ++itr) {
+            if (itr.key() <= firstNumber) {
+                checkpoints.insert(itr.key(), itr.value());
+            } else if (itr.key() > oldLastNumber) {
+                checkpoints.insert(itr.key() + delta, itr.value());
+            }
+        }
+        m_checkpoints = checkpoints;
+    }
+
+    if (m_dirtyEnd > oldLastNumber) {
+        m_dirtyEnd += delta;
+    }
+    m_dirtyEnd = qMax(m_dirtyEnd, lastNumber);
+    m_pendingFrom = (-1 == m_pendingFrom) ? firstNumber : qMin(m_pendingFrom, firstNumber);
+
+    cancelJob();
+    m_restartTimer->start();
+}
+
+void HighlightEngine::cancelJob()
+{
+    if (m_job) {
+        QMutexLocker locker(&m_job->mutex);
+        m_job->canceled = true;
+    }
+
+    m_job.reset();
+    m_generation++;
+}
+
+void HighlightEngine::startJob()
+{
+    m_restartTimer->stop();
+    if (!isActive() || -1 == m_pendingFrom) {
+        return;
+    }
+
+    cancelJob();
+
+    // 查找待高亮位置之上最近的检查点
+    int startBlock = 0;
+    KSyntaxHighlighting::State startState;
+    auto itr = m_checkpoints.upperBound(m_pendingFrom);
+    if (itr != m_checkpoints.begin()) {
+        --itr;
+        startBlock = itr.key();
+        startState = itr.value();
+    }
+
+    QTextBlock block = m_document->findBlockByNumber(startBlock);
+    if (!block.isValid()) {
+        m_checkpoints.clear();
+        startBlock = 0;
+        startState = KSyntaxHighlighting::State();
+        block = m_document->firstBlock();
+    }
+
+    QSharedPointer<HighlightJob> job(new HighlightJob);
+    job->engine = this;
+    job->generation = m_generation;
+    job->startBlock = startBlock;
+    job->startState = startState;
+    job->definition = m_definition;
+    job->theme = m_theme;
+
+    // 文本快照
+    int count = 0;
+    for (; block.isValid() && count < s_snapshotBlocks; block = block.next(), count++) {
+        if (count > 0) {
+            job->text += QChar(QChar::ParagraphSeparator);
+        }
+        job->text += block.text();
+    }
+    job->blockCount = count;
+    job->reachesEnd = !block.isValid();
+
+    for (auto stopItr = m_checkpoints.upperBound(m_dirtyEnd); stopItr != m_checkpoints.end(); ++stopItr) {
+        job->stopCheckpoints.insert(stopItr.key(), stopItr.value());
+    }
+
+    m_pendingFrom = startBlock;
+    m_job = job;
+    m_future = QtConcurrent::run([job]() {
+        HighlightEngine::runJob(job);
+    });
+}
+
+void HighlightEngine::drainBatches()
+{
+    applyBatches(s_applyBudget);
+}
+
+/**
+ * @brief 逐个取出并应用任务的结果。超出时间片时保留剩余结果并在事件循环中再次处理，
+ *      期间工作线程不会重复通知(队列非空)。
+ */
+void HighlightEngine::applyBatches(int budget)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (m_job) {
+        QSharedPointer<HighlightJob> job = m_job;
+        HighlightBatch batch;
+        {
+            QMutexLocker locker(&job->mutex);
+            if (job->batches.isEmpty()) {
+                return;
+            }
+            batch = job->batches.takeFirst();
+        }
+
+        applyBatch(batch);
+        if (batch.last || m_job != job) {
+            // 任务结束或已开始新的任务，新任务的结果由工作线程通知
+            return;
+        }
+
+        if (budget >= 0 && timer.elapsed() >= budget) {
+            QTimer::singleShot(0, this, &HighlightEngine::drainBatches);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 将一个批次的格式设置到文本块布局，整体标记一次重新布局，并更新检查点
+ */
+void HighlightEngine::applyBatch(const HighlightBatch &batch)
+{
+    if (!m_job || batch.generation != m_generation) {
+        return;
+    }
+
+    QTextBlock block = m_document->findBlockByNumber(batch.firstBlock);
+    const int from = block.isValid() ? block.position() : 0;
+    int to = from;
+    for (const QVector<QTextLayout::FormatRange> &ranges : batch.formats) {
+        if (!block.isValid()) {
+            break;
+        }
+
+        // 输入法预编辑区域的格式由编辑器设置，不进行覆盖
+        QTextLayout *layout = block.layout();
+        if (layout && layout->preeditAreaText().isEmpty()) {
+            layout->setFormats(ranges);
+        }
+
+        to = block.position() + block.length();
+        block = block.next();
+    }
+    if (to > from) {
+        m_document->markContentsDirty(from, to - from);
+    }
+
+    // 批次范围内的检查点使用新的高亮状态替换
+    const int lastBlock = batch.firstBlock + batch.formats.size() - 1;
+    if (to > from) {
+        emit formatsChanged(batch.firstBlock, lastBlock);
+    }
+    auto itr = m_checkpoints.lowerBound(batch.firstBlock);
+    while (itr != m_checkpoints.end() && itr.key() <= lastBlock) {
+        itr = m_checkpoints.erase(itr);
+    }
+    for (const auto &checkpoint : batch.checkpoints) {
+        m_checkpoints.insert(checkpoint.first, checkpoint.second);
+    }
+
+    if (!batch.formats.isEmpty()) {
+        m_pendingFrom = lastBlock + 1;
+    }
+
+    if (batch.finished) {
+        m_job.reset();
+        m_pendingFrom = -1;
+        m_dirtyEnd = -1;
+        reportFinished();
+        emit highlightFinished();
+    } else if (batch.last) {
+        // 快照已处理完成，从快照末尾继续高亮
+        m_checkpoints.insert(lastBlock + 1, batch.endState);
+        m_job.reset();
+        startJob();
+    }
+}
+
+void HighlightEngine::reportFinished()
+{
+    if (m_finishedInterface.isRunning()) {
+        m_finishedInterface.reportFinished();
+    }
+}
+
+void HighlightEngine::runJob(QSharedPointer<HighlightJob> job)
+{
+    // 投递结果，任务已取消时返回 false
+    auto postBatch = [job](const HighlightBatch &batch) {
+        QMutexLocker locker(&job->mutex);
+        if (job->canceled) {
+            return false;
+        }
+
+        const bool notify = job->batches.isEmpty();
+        job->batches.append(batch);
+        if (notify) {
+            HighlightEngine *engine = job->engine;
+            QMetaObject::invokeMethod(engine, [engine]() {
+                engine->drainBatches();
+            }, Qt::QueuedConnection);
+        }
+        return true;
+    };
+
+    JobHighlighter highlighter;
+    highlighter.setDefinition(job->definition);
+    highlighter.setTheme(job->theme);
+
+    KSyntaxHighlighting::State state = job->startState;
+    HighlightBatch batch;
+    batch.generation = job->generation;
+    batch.firstBlock = job->startBlock;
+
+    QElapsedTimer timer;
+    timer.start();
+    const QString &text = job->text;
+    int begin = 0;
+    for (int i = 0; i < job->blockCount; i++) {
+        if (job->canceled) {
+            return;
+        }
+
+        const int blockNumber = job->startBlock + i;
+        if (i > 0) {
+            // 和变更前记录的检查点状态一致，之后文本块的高亮结果不变
+            auto itr = job->stopCheckpoints.constFind(blockNumber);
+            if (itr != job->stopCheckpoints.constEnd() && itr.value() == state) {
+                batch.last = true;
+                batch.finished = true;
+                batch.endState = state;
+                postBatch(batch);
+                return;
+            }
+        }
+
+        if (0 == i % s_checkpointInterval) {
+            batch.checkpoints.append(qMakePair(blockNumber, state));
+        }
+
+        int end = text.indexOf(QChar::ParagraphSeparator, begin);
+        if (-1 == end) {
+            end = text.size();
+        }
+        batch.formats.append(highlighter.highlight(text.mid(begin, end - begin), state, job->canceled));
+        begin = end + 1;
+
+        const bool last = (i == job->blockCount - 1);
+        if (last || batch.formats.size() >= s_batchBlocks || timer.elapsed() >= s_batchInterval) {
+            batch.last = last;
+            batch.finished = last && job->reachesEnd;
+            batch.endState = state;
+            if (!postBatch(batch)) {
+                return;
+            }
+
+            batch = HighlightBatch();
+            batch.generation = job->generation;
+            batch.firstBlock = blockNumber + 1;
+            timer.restart();
+        }
+    }
+}
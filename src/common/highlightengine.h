@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HIGHLIGHTENGINE_H
+#define HIGHLIGHTENGINE_H
+
+#include <QObject>
+#include <QMap>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QSharedPointer>
+#include <QTextLayout>
+
+#include <KSyntaxHighlighting/Definition>
+#include <KSyntaxHighlighting/Theme>
+#include <KSyntaxHighlighting/State>
+
+class QTextDocument;
+class QTimer;
+struct HighlightJob;
+struct HighlightBatch;
+
+/**
+ * @brief 后台语法高亮引擎
+ *      在工作线程中使用 KSyntaxHighlighting::AbstractHighlighter 对文档快照逐行高亮，
+ *      每隔固定数量的文本块记录高亮状态(检查点)，高亮结果按批次返回 GUI 线程设置到文本块布局。
+ *      文档变更时仅从变更位置之上最近的检查点重新高亮，到达变更区域之后且高亮状态和已有检查点一致时提前结束。
+ */
+class HighlightEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HighlightEngine(QTextDocument *document, QObject *parent = nullptr);
+    ~HighlightEngine() override;
+
+    // 设置高亮定义并重新高亮，无效定义将停止高亮
+    void setDefinition(const KSyntaxHighlighting::Definition &definition);
+    KSyntaxHighlighting::Definition definition() const;
+    // 设置高亮主题，高亮状态不受主题影响，已高亮的格式按格式标识直接替换为新主题的格式
+    void setTheme(const KSyntaxHighlighting::Theme &theme);
+
+    // 是否启用后台高亮(高亮定义有效)
+    bool isActive() const;
+    // 全部文本块是否已高亮
+    bool isFinished() const;
+    // 已高亮的边界，此文本块之前的文本块均已高亮
+    int frontier() const;
+    // 取得全部文本块高亮完成的 QFuture ，不阻塞 GUI 线程，可通过 QFutureWatcher 等待
+    QFuture<void> finishedFuture();
+    // 从文本块 blockNumber 之上最近的检查点开始重新高亮
+    void restart(int blockNumber = 0);
+    // 等待高亮完成并应用所有结果
+    void waitForFinished();
+    // 当前记录的检查点数量
+    int checkpointCount() const;
+
+    // 检查点间隔(文本块数量)
+    static const int s_checkpointInterval = 256;
+
+signals:
+    // 全部文本块高亮完成
+    void highlightFinished();
+    // 文本块 [firstBlock, lastBlock] 的高亮格式已更新
+    void formatsChanged(int firstBlock, int lastBlock);
+
+public slots:
+    // 文档内容变更时失效变更区域之后的检查点并重新高亮
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+
+private:
+    // 取消当前任务，已投递的结果将被丢弃
+    void cancelJob();
+    // 从待高亮位置之上最近的检查点开始新的任务
+    void startJob();
+    // 在时间片内应用工作线程返回的结果，剩余结果在下次事件循环空闲时处理
+    void drainBatches();
+    // 应用工作线程返回的结果，budget 为单次处理的最长耗时(ms)，小于0时全部处理
+    void applyBatches(int budget);
+    void applyBatch(const HighlightBatch &batch);
+    // 通知等待全部高亮完成的调用者
+    void reportFinished();
+    // 工作线程执行的高亮任务
+    static void runJob(QSharedPointer<HighlightJob> job);
+
+private:
+    QTextDocument *m_document = nullptr;
+    KSyntaxHighlighting::Definition m_definition;
+    KSyntaxHighlighting::Theme m_theme;
+
+    QMap<int, KSyntaxHighlighting::State> m_checkpoints;    ///< 文本块序号 -> 文本块开始时的高亮状态
+    int m_pendingFrom = -1;         ///< 尚未高亮的首个文本块，-1 表示全部已高亮
+    int m_dirtyEnd = -1;            ///< 变更区域的最后一个文本块，之后才允许提前结束
+    int m_blockCount = 0;           ///< 上次变更后的文本块数量
+
+    QTimer *m_restartTimer = nullptr;           ///< 合并连续的编辑后再启动任务
+    QSharedPointer<HighlightJob> m_job;         ///< 当前任务
+    QFuture<void> m_future;
+    quint64 m_generation = 0;                   ///< 当前任务标识，用于丢弃已取消任务的结果
+    QFutureInterface<void> m_finishedInterface; ///< 等待全部高亮完成的 QFuture
+};
+
+#endif  // HIGHLIGHTENGINE_H
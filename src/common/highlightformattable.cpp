@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "highlightformattable.h"
+
+#include <KSyntaxHighlighting/Format>
+
+#include <QTextDocument>
+#include <QTextBlock>
+
+HighlightFormatTable::HighlightFormatTable(const KSyntaxHighlighting::Definition &definition,
+                                           const KSyntaxHighlighting::Theme &theme)
+{
+    if (!definition.isValid() || !theme.isValid()) {
+        return;
+    }
+
+    QVector<KSyntaxHighlighting::Definition> definitions = definition.includedDefinitions();
+    definitions.prepend(definition);
+    for (const KSyntaxHighlighting::Definition &def : definitions) {
+        const auto formats = def.formats();
+        for (const KSyntaxHighlighting::Format &format : formats) {
+            m_formats.insert(format.id(), charFormat(format, theme));
+        }
+    }
+}
+
+bool HighlightFormatTable::isEmpty() const
+{
+    return m_formats.isEmpty();
+}
+
+QVector<QTextLayout::FormatRange> HighlightFormatTable::remap(const QVector<QTextLayout::FormatRange> &ranges, bool *changed) const
+{
+    QVector<QTextLayout::FormatRange> result = ranges;
+    bool remapped = false;
+    for (QTextLayout::FormatRange &range : result) {
+        auto itr = m_formats.constFind(formatId(range.format));
+        if (itr != m_formats.constEnd() && itr.value() != range.format) {
+            range.format = itr.value();
+            remapped = true;
+        }
+    }
+
+    if (changed) {
+        *changed = remapped;
+    }
+    return result;
+}
+
+/**
+ * @brief 仅替换格式，文本块行数不变，替换范围整体标记一次重新布局
+ */
+int HighlightFormatTable::apply(QTextDocument *document, int fromBlock, int toBlock) const
+{
+    if (!document || m_formats.isEmpty()) {
+        return 0;
+    }
+
+    int count = 0;
+    int from = -1;
+    int to = -1;
+    QTextBlock block = document->findBlockByNumber(qMax(0, fromBlock));
+    for (; block.isValid() && (toBlock < 0 || block.blockNumber() < toBlock); block = block.next()) {
+        // 输入法预编辑区域的格式由编辑器设置，不进行覆盖
+        QTextLayout *layout = block.layout();
+        if (!layout || !layout->preeditAreaText().isEmpty()) {
+            continue;
+        }
+
+        bool changed = false;
+        const QVector<QTextLayout::FormatRange> ranges = remap(layout->formats(), &changed);
+        if (!changed) {
+            continue;
+        }
+
+        layout->setFormats(ranges);
+        if (-1 == from) {
+            from = block.position();
+        }
+        to = block.position() + block.length();
+        count++;
+    }
+
+    if (count > 0) {
+        document->markContentsDirty(from, to - from);
+    }
+    return count;
+}
+
+/**
+ * @brief 和 KSyntaxHighlighting::SyntaxHighlighter 的格式转换一致，未设置的属性使用编辑器默认格式
+ */
+QTextCharFormat HighlightFormatTable::charFormat(const KSyntaxHighlighting::Format &format,
+                                                 const KSyntaxHighlighting::Theme &theme)
+{
+    QTextCharFormat charFormat;
+    if (format.hasTextColor(theme)) {
+        charFormat.setForeground(format.textColor(theme));
+    }
+    if (format.hasBackgroundColor(theme)) {
+        charFormat.setBackground(format.backgroundColor(theme));
+    }
+    if (format.isBold(theme)) {
+        charFormat.setFontWeight(QFont::Bold);
+    }
+    if (format.isItalic(theme)) {
+        charFormat.setFontItalic(true);
+    }
+    if (format.isUnderline(theme)) {
+        charFormat.setFontUnderline(true);
+    }
+    if (format.isStrikeThrough(theme)) {
+        charFormat.setFontStrikeOut(true);
+    }
+
+    charFormat.setProperty(s_formatIdProperty, static_cast<int>(format.id()));
+    return charFormat;
+}
+
+/**
+ * @brief 其它样式的格式在部分主题下和默认文本样式相同(例如浅色主题的运算符)，仍需设置格式，
+ *      否则切换到其它主题时无法替换
+ */
+bool HighlightFormatTable::isPlainFormat(const KSyntaxHighlighting::Format &format, const KSyntaxHighlighting::Theme &theme)
+{
+    return KSyntaxHighlighting::Theme::Normal == format.textStyle() && format.isDefaultTextStyle(theme);
+}
+
+int HighlightFormatTable::formatId(const QTextFormat &format)
+{
+    return format.hasProperty(s_formatIdProperty) ? format.intProperty(s_formatIdProperty) : -1;
+}
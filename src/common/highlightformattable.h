@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HIGHLIGHTFORMATTABLE_H
+#define HIGHLIGHTFORMATTABLE_H
+
+#include <QHash>
+#include <QTextFormat>
+#include <QTextLayout>
+
+#include <KSyntaxHighlighting/Definition>
+#include <KSyntaxHighlighting/Theme>
+
+class QTextDocument;
+
+namespace KSyntaxHighlighting {
+class Format;
+}
+
+/**
+ * @brief 高亮格式映射表
+ *      高亮生成的格式记录 KSyntaxHighlighting::Format 标识，切换主题时按标识将文本块已有的格式
+ *      替换为新主题的格式，高亮状态及格式范围和主题无关，无需重新分析文本。
+ */
+class HighlightFormatTable
+{
+public:
+    // 根据高亮定义(含包含的定义)及主题构造映射表
+    HighlightFormatTable(const KSyntaxHighlighting::Definition &definition, const KSyntaxHighlighting::Theme &theme);
+
+    bool isEmpty() const;
+    // 替换格式范围 ranges 中记录标识的格式，changed 返回是否有替换
+    QVector<QTextLayout::FormatRange> remap(const QVector<QTextLayout::FormatRange> &ranges, bool *changed = nullptr) const;
+    // 替换文本块 [fromBlock, toBlock) 的格式，toBlock 小于0时至文档末尾，返回替换的文本块数量
+    int apply(QTextDocument *document, int fromBlock = 0, int toBlock = -1) const;
+
+    // 取得格式 format 在主题 theme 下的字符格式，并记录格式标识
+    static QTextCharFormat charFormat(const KSyntaxHighlighting::Format &format, const KSyntaxHighlighting::Theme &theme);
+    // 格式在任意主题下是否均为默认文本样式，此类格式无需设置
+    static bool isPlainFormat(const KSyntaxHighlighting::Format &format, const KSyntaxHighlighting::Theme &theme);
+    // 取得字符格式记录的格式标识，未记录时返回 -1
+    static int formatId(const QTextFormat &format);
+
+    // 记录格式标识的属性
+    static const int s_formatIdProperty = QTextFormat::UserProperty + 0x100;
+
+private:
+    QHash<int, QTextCharFormat> m_formats;      ///< 格式标识 -> 新主题的字符格式
+};
+
+#endif  // HIGHLIGHTFORMATTABLE_H
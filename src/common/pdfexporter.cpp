@@ -0,0 +1,367 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pdfexporter.h"
+#include "highlightengine.h"
+#include "printpaginator.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QPdfWriter>
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QFile>
+#include <QDebug>
+#include <QTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+// 单批拷贝的最大文本块数量
+static const int s_chunkBlocks = 4096;
+// 单批拷贝的最大字符数
+static const int s_chunkChars = 1024 * 1024;
+// 等待后台高亮的间隔(ms)
+static const int s_feedDelay = 20;
+// 导出分辨率
+static const int s_resolution = 300;
+// 页边距(mm)，和打印保持一致
+static const qreal s_pageMargin = 20;
+
+// 待写入的文本块
+struct PdfExportChunk {
+    QStringList texts;
+    QVector<QVector<QTextLayout::FormatRange>> formats;
+};
+
+// 导出任务，GUI 线程和工作线程共享
+struct PdfExportJob {
+    QMutex mutex;
+    QWaitCondition condition;
+    QQueue<PdfExportChunk> chunks;      ///< 待写入的批次
+    bool endOfDocument = false;         ///< 所有文本块均已拷贝
+    QAtomicInt canceled;
+    QAtomicInt exportedBlocks;          ///< 已写入的文本块数量
+
+    QString filePath;
+    QString title;
+    QFont font;
+    QTextOption option;
+    qreal tabStopSpaces = 4;            ///< 制表符宽度(空格数)，按导出字体重新计算
+};
+
+PdfExporter::PdfExporter(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+    m_feedTimer = new QTimer(this);
+    m_feedTimer->setSingleShot(true);
+    m_feedTimer->setInterval(s_feedDelay);
+    connect(m_feedTimer, &QTimer::timeout, this, &PdfExporter::feedChunks);
+
+    // 已导出的内容和文档不再一致，中止导出
+    connect(document, &QTextDocument::contentsChange, this, [this]() {
+        if (isRunning()) {
+            qWarning() << "Document changed, abort export pdf!";
+            cancel();
+        }
+    });
+}
+
+PdfExporter::~PdfExporter()
+{
+    // 工作线程等待 GUI 线程拷贝文本块，取消后等待退出
+    cancel();
+    if (m_watcher) {
+        m_watcher->disconnect(this);
+        m_watcher->waitForFinished();
+    }
+}
+
+void PdfExporter::setHighlightEngine(HighlightEngine *engine)
+{
+    m_engine = engine;
+}
+
+void PdfExporter::setBackground(const QColor &background)
+{
+    m_background = background;
+}
+
+void PdfExporter::setTitle(const QString &title)
+{
+    m_title = title;
+}
+
+bool PdfExporter::start(const QString &filePath)
+{
+    if (isRunning() || !m_document) {
+        return false;
+    }
+
+    m_job.reset(new PdfExportJob);
+    m_job->filePath = filePath;
+    m_job->title = m_title;
+    m_job->font = m_document->defaultFont();
+    m_job->option = m_document->defaultTextOption();
+    m_job->option.setTextDirection(Qt::LeftToRight);
+    m_job->option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    const qreal spaceWidth = QFontMetricsF(m_job->font).horizontalAdvance(QChar(' '));
+    if (spaceWidth > 0) {
+        m_job->tabStopSpaces = m_job->option.tabStopDistance() / spaceWidth;
+    }
+
+    m_nextBlock = 0;
+    m_blockCount = m_document->blockCount();
+    m_progress = -1;
+
+    QSharedPointer<PdfExportJob> job = m_job;
+    m_watcher = new QFutureWatcher<bool>(this);
+    connect(m_watcher, &QFutureWatcher<bool>::finished, this, &PdfExporter::onJobFinished);
+    m_watcher->setFuture(QtConcurrent::run([job, this]() {
+        return PdfExporter::runJob(job, this);
+    }));
+
+    feedChunks();
+    return true;
+}
+
+void PdfExporter::cancel()
+{
+    if (!m_job) {
+        return;
+    }
+
+    m_feedTimer->stop();
+    QMutexLocker locker(&m_job->mutex);
+    m_job->canceled.storeRelease(1);
+    m_job->condition.wakeAll();
+}
+
+bool PdfExporter::isRunning() const
+{
+    return m_watcher != nullptr;
+}
+
+/**
+ * @brief 在 GUI 线程等待导出完成，等待期间继续拷贝文本块
+ */
+bool PdfExporter::waitForFinished()
+{
+    if (!m_watcher) {
+        return false;
+    }
+
+    if (m_engine) {
+        m_engine->waitForFinished();
+    }
+
+    QSharedPointer<PdfExportJob> job = m_job;
+    while (!m_watcher->isFinished()) {
+        feedChunks();
+
+        QMutexLocker locker(&job->mutex);
+        if (!m_watcher->isFinished()) {
+            job->condition.wait(&job->mutex, s_feedDelay);
+        }
+    }
+
+    m_watcher->disconnect(this);
+    return finishJob();
+}
+
+/**
+ * @brief 按顺序拷贝文本块的文本及高亮格式，启用后台高亮时不超过已高亮的边界
+ */
+void PdfExporter::feedChunks()
+{
+    if (!m_job || !m_watcher || m_job->endOfDocument || m_job->canceled.loadAcquire()) {
+        return;
+    }
+
+    if (!m_document) {
+        cancel();
+        return;
+    }
+
+    int limit = m_blockCount;
+    if (m_engine && m_engine->isActive() && !m_engine->isFinished()) {
+        limit = qMin(limit, m_engine->frontier());
+    }
+
+    while (true) {
+        {
+            QMutexLocker locker(&m_job->mutex);
+            if (m_job->chunks.size() >= s_maxQueuedChunks) {
+                break;
+            }
+
+            if (m_nextBlock >= m_blockCount) {
+                m_job->endOfDocument = true;
+                m_job->condition.wakeAll();
+                break;
+            }
+        }
+
+        if (m_nextBlock >= limit) {
+            // 等待后台高亮
+            m_feedTimer->start();
+            break;
+        }
+
+        PdfExportChunk chunk;
+        int chars = 0;
+        QTextBlock block = m_document->findBlockByNumber(m_nextBlock);
+        for (; block.isValid() && m_nextBlock < limit && chunk.texts.size() < s_chunkBlocks && chars < s_chunkChars;
+                block = block.next(), m_nextBlock++) {
+            chunk.texts.append(block.text());
+            chunk.formats.append(PrintPaginator::printFormats(block.layout()->formats(), m_background));
+            chars += block.length();
+        }
+
+        QMutexLocker locker(&m_job->mutex);
+        m_job->chunks.enqueue(chunk);
+        m_job->condition.wakeAll();
+    }
+}
+
+void PdfExporter::onChunkExported()
+{
+    // 导出结束后丢弃排队的通知
+    if (!m_job || !m_watcher || m_blockCount <= 0) {
+        return;
+    }
+
+    const int progress = static_cast<int>(100LL * m_job->exportedBlocks.loadAcquire() / m_blockCount);
+    if (progress != m_progress) {
+        m_progress = progress;
+        emit progressChanged(progress);
+    }
+
+    feedChunks();
+}
+
+void PdfExporter::onJobFinished()
+{
+    if (m_watcher) {
+        finishJob();
+    }
+}
+
+bool PdfExporter::finishJob()
+{
+    QFutureWatcher<bool> *watcher = m_watcher;
+    m_watcher = nullptr;
+    watcher->deleteLater();
+    m_feedTimer->stop();
+
+    const bool success = watcher->result() && !m_job->canceled.loadAcquire();
+    if (success && m_progress != 100) {
+        m_progress = 100;
+        emit progressChanged(m_progress);
+    }
+
+    emit finished(success);
+    return success;
+}
+
+/**
+ * @brief 在工作线程按顺序排版文本块，页面写满后换页，取消或失败时删除未完成的文件
+ */
+bool PdfExporter::runJob(QSharedPointer<PdfExportJob> job, PdfExporter *exporter)
+{
+    bool success = false;
+    {
+        QPdfWriter writer(job->filePath);
+        writer.setCreator(QStringLiteral("deepin-editor"));
+        writer.setTitle(job->title);
+        writer.setResolution(s_resolution);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        writer.setPageMargins(QMarginsF(s_pageMargin, s_pageMargin, s_pageMargin, s_pageMargin), QPageLayout::Millimeter);
+
+        QPainter painter;
+        if (!painter.begin(&writer)) {
+            qWarning() << "Export pdf failed, can not open file:" << job->filePath;
+            return false;
+        }
+
+        const QFont font(job->font, &writer);
+        const QFontMetricsF metrics(font);
+        const qreal lineHeight = metrics.lineSpacing();
+        const qreal width = writer.width();
+        // 预留页码所在的行
+        const int linesPerPage = qMax(1, static_cast<int>(writer.height() / lineHeight) - 2);
+        QTextOption option = job->option;
+        option.setTabStopDistance(job->tabStopSpaces * metrics.horizontalAdvance(QChar(' ')));
+
+        int page = 1;
+        int lineInPage = 0;
+        auto drawPageNumber = [&]() {
+            painter.setFont(font);
+            painter.setPen(Qt::black);
+            painter.drawText(QRectF(0, writer.height() - lineHeight, width, lineHeight),
+                             Qt::AlignRight, QString::number(page));
+        };
+
+        painter.setPen(Qt::black);
+        while (!job->canceled.loadAcquire()) {
+            PdfExportChunk chunk;
+            {
+                QMutexLocker locker(&job->mutex);
+                while (job->chunks.isEmpty() && !job->endOfDocument && !job->canceled.loadAcquire()) {
+                    job->condition.wait(&job->mutex);
+                }
+
+                if (job->chunks.isEmpty()) {
+                    break;
+                }
+                chunk = job->chunks.dequeue();
+                // 队列已有空位，通知 GUI 线程继续拷贝
+                job->condition.wakeAll();
+            }
+
+            for (int index = 0; index < chunk.texts.size() && !job->canceled.loadAcquire(); index++) {
+                QTextLayout layout(chunk.texts.at(index), font);
+                layout.setTextOption(option);
+                layout.setFormats(chunk.formats.at(index));
+                layout.beginLayout();
+                QTextLine line;
+                while ((line = layout.createLine()).isValid()) {
+                    line.setLineWidth(width);
+                }
+                layout.endLayout();
+
+                for (int i = 0; i < layout.lineCount(); i++) {
+                    if (lineInPage >= linesPerPage) {
+                        drawPageNumber();
+                        writer.newPage();
+                        page++;
+                        lineInPage = 0;
+                    }
+
+                    layout.lineAt(i).draw(&painter, QPointF(0, lineInPage * lineHeight));
+                    lineInPage++;
+                }
+            }
+
+            job->exportedBlocks.fetchAndAddOrdered(chunk.texts.size());
+            QMetaObject::invokeMethod(exporter, [exporter]() {
+                exporter->onChunkExported();
+            }, Qt::QueuedConnection);
+        }
+
+        drawPageNumber();
+        success = painter.end() && !job->canceled.loadAcquire();
+    }
+
+    if (!success) {
+        QFile::remove(job->filePath);
+    }
+
+    return success;
+}
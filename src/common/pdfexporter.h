@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PDFEXPORTER_H
+#define PDFEXPORTER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QColor>
+
+class QTextDocument;
+class QTimer;
+class HighlightEngine;
+struct PdfExportJob;
+
+/**
+ * @brief 导出 PDF
+ *      不拷贝文档，GUI 线程分批拷贝文本块的文本及高亮格式(队列中的批次数量有上限)，工作线程按顺序排版并逐页写入
+ *      QPdfWriter ，已写入的页面不再保留，内存占用和文档大小无关。导出期间文档变更将中止导出。
+ */
+class PdfExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PdfExporter(QTextDocument *document, QObject *parent = nullptr);
+    ~PdfExporter() override;
+
+    // 设置后台高亮引擎，仅导出已高亮的文本块，保留语法高亮颜色
+    void setHighlightEngine(HighlightEngine *engine);
+    // 设置编辑器背景色，深色背景时调整高亮颜色
+    void setBackground(const QColor &background);
+    // 设置 PDF 文档标题
+    void setTitle(const QString &title);
+
+    // 开始导出到文件 filePath ，正在导出时返回 false
+    bool start(const QString &filePath);
+    // 取消导出，将删除未完成的文件
+    void cancel();
+    // 是否正在导出
+    bool isRunning() const;
+    // 等待导出完成，返回是否导出成功
+    bool waitForFinished();
+
+    // 等待写入的最大批次数量
+    static const int s_maxQueuedChunks = 4;
+
+signals:
+    // 导出进度(0~100)
+    void progressChanged(int progress);
+    // 导出完成，取消或失败时 success 为 false
+    void finished(bool success);
+
+private:
+    // 拷贝待导出的文本块，直到队列已满、到达高亮边界或文档末尾
+    void feedChunks();
+    // 工作线程已写入一个批次
+    void onChunkExported();
+    void onJobFinished();
+    // 释放工作线程的结果并通知导出完成，返回是否导出成功
+    bool finishJob();
+    // 工作线程执行的导出任务
+    static bool runJob(QSharedPointer<PdfExportJob> job, PdfExporter *exporter);
+
+private:
+    QPointer<QTextDocument> m_document;
+    QPointer<HighlightEngine> m_engine;
+    QColor m_background = Qt::white;
+    QString m_title;
+
+    QSharedPointer<PdfExportJob> m_job;     ///< 当前导出任务
+    QFutureWatcher<bool> *m_watcher = nullptr;
+    int m_nextBlock = 0;                    ///< 下一批待拷贝的首个文本块
+    int m_blockCount = 0;                   ///< 开始导出时的文本块数量
+    int m_progress = -1;
+    QTimer *m_feedTimer = nullptr;          ///< 等待后台高亮后继续拷贝
+};
+
+#endif  // PDFEXPORTER_H
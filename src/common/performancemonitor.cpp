@@ -4,6 +4,10 @@
 
 #include "performancemonitor.h"
 
+#include <QtAlgorithms>
+
+#include <algorithm>
+
 const QString LOG_FLAG = "[PerformanceMonitor]";
 
 const QString GRAB_POINT_INIT_APP_TIME  = "[GRABPOINT] POINT-01";
@@ -16,6 +20,31 @@ qint64 PerformanceMonitor::closeAppStartMs       = 0;
 qint64 PerformanceMonitor::closeAppFinishMs      = 0;
 qint64 PerformanceMonitor::openFileStartMs       = 0;
 qint64 PerformanceMonitor::openFileFinishMs      = 0;
+qint64 PerformanceMonitor::frameUpdateCount      = 0;
+qint64 PerformanceMonitor::frameUpdateEventCount = 0;
+int PerformanceMonitor::frameUpdateMaxEvents     = 0;
+qint64 PerformanceMonitor::createEditorStartMs   = 0;
+qint64 PerformanceMonitor::createEditorCount     = 0;
+qint64 PerformanceMonitor::createEditorTotalMs   = 0;
+qint64 PerformanceMonitor::latencyHistogram[LatencyMetricCount][s_latencyBucketCount] = {};
+qint64 PerformanceMonitor::latencyTotal[LatencyMetricCount] = {};
+int PerformanceMonitor::latencyOverlayState      = -1;
+
+// 每隔多少帧输出一次界面更新合并统计
+static const int s_frameUpdateLogInterval = 500;
+// 每隔多少次按键输出一次耗时统计
+static const int s_latencyLogInterval = 1000;
+
+PerformanceMonitor::LatencyScope::LatencyScope(LatencyMetric metric)
+    : m_metric(metric)
+{
+    m_timer.start();
+}
+
+PerformanceMonitor::LatencyScope::~LatencyScope()
+{
+    PerformanceMonitor::recordLatency(m_metric, m_timer.nsecsElapsed());
+}
 
 PerformanceMonitor::PerformanceMonitor()
 {
@@ -82,3 +111,164 @@ void PerformanceMonitor::openFileFinish(const QString &strFileName, qint64 iFile
     float fFilesize = iFileSize;
     qInfo() << qPrintable(QString("%1 filename=%2 filezise=%3M opentime=%4ms #(Open file time)").arg(GRAB_POINT_OPEN_FILE_TIME).arg(strFileName).arg(QString::number(fFilesize/(1024*1024), 'f', 6)).arg(time));
 }
+
+void PerformanceMonitor::frameUpdateFinish(int foldedEvents)
+{
+    frameUpdateCount++;
+    frameUpdateEventCount += foldedEvents;
+    frameUpdateMaxEvents = qMax(frameUpdateMaxEvents, foldedEvents);
+
+    if (0 == frameUpdateCount % s_frameUpdateLogInterval) {
+        qDebug() << qPrintable(LOG_FLAG)
+                 << "frame updates:" << frameUpdateCount
+                 << "raw events:" << frameUpdateEventCount
+                 << "average folded:" << QString::number(static_cast<double>(frameUpdateEventCount) / frameUpdateCount, 'f', 2)
+                 << "max folded:" << frameUpdateMaxEvents;
+    }
+}
+
+void PerformanceMonitor::resetFrameUpdateStatistics()
+{
+    frameUpdateCount = 0;
+    frameUpdateEventCount = 0;
+    frameUpdateMaxEvents = 0;
+}
+
+void PerformanceMonitor::createEditorStart()
+{
+    createEditorStartMs = QDateTime::currentMSecsSinceEpoch();
+}
+
+void PerformanceMonitor::createEditorFinish()
+{
+    qint64 time = QDateTime::currentMSecsSinceEpoch() - createEditorStartMs;
+    createEditorCount++;
+    createEditorTotalMs += time;
+    qInfo() << qPrintable(QString("%1 create editor duration=%2ms average=%3ms count=%4")
+                          .arg(LOG_FLAG).arg(time)
+                          .arg(QString::number(static_cast<double>(createEditorTotalMs) / createEditorCount, 'f', 2))
+                          .arg(createEditorCount));
+}
+
+/**
+ * @brief 记录一次耗时，直方图按对数划分区间，记录及统计的耗时和记录次数无关
+ */
+void PerformanceMonitor::recordLatency(LatencyMetric metric, qint64 nsecs)
+{
+    if (metric < 0 || metric >= LatencyMetricCount) {
+        return;
+    }
+
+    latencyHistogram[metric][latencyBucket(qMax<qint64>(0, nsecs) / 1000)]++;
+    latencyTotal[metric]++;
+
+    if (KeyToPaint == metric && 0 == latencyTotal[metric] % s_latencyLogInterval) {
+        for (int i = 0; i < LatencyMetricCount; i++) {
+            const LatencyMetric item = static_cast<LatencyMetric>(i);
+            if (0 == latencyTotal[i]) {
+                continue;
+            }
+
+            qDebug() << qPrintable(LOG_FLAG) << qPrintable(latencyName(item))
+                     << "count:" << latencyTotal[i]
+                     << "p50:" << latencyPercentile(item, 50) << "us"
+                     << "p99:" << latencyPercentile(item, 99) << "us";
+        }
+    }
+}
+
+qint64 PerformanceMonitor::latencyCount(LatencyMetric metric)
+{
+    if (metric < 0 || metric >= LatencyMetricCount) {
+        return 0;
+    }
+
+    return latencyTotal[metric];
+}
+
+qint64 PerformanceMonitor::latencyPercentile(LatencyMetric metric, int percentile)
+{
+    if (metric < 0 || metric >= LatencyMetricCount || 0 == latencyTotal[metric]) {
+        return 0;
+    }
+
+    const qint64 total = latencyTotal[metric];
+    const qint64 target = qMax<qint64>(1, (total * qBound(0, percentile, 100) + 99) / 100);
+    qint64 count = 0;
+    for (int bucket = 0; bucket < s_latencyBucketCount; bucket++) {
+        count += latencyHistogram[metric][bucket];
+        if (count >= target) {
+            return latencyBucketLowerBound(bucket + 1) - 1;
+        }
+    }
+
+    return latencyBucketLowerBound(s_latencyBucketCount) - 1;
+}
+
+QString PerformanceMonitor::latencyName(LatencyMetric metric)
+{
+    switch (metric) {
+    case KeyToPaint:
+        return QStringLiteral("key to paint");
+    case EditorPaint:
+        return QStringLiteral("editor paint");
+    case LineNumberPaint:
+        return QStringLiteral("line number paint");
+    case BookmarkPaint:
+        return QStringLiteral("bookmark paint");
+    case FoldPaint:
+        return QStringLiteral("fold paint");
+    case CursorPositionChanged:
+        return QStringLiteral("cursor changed");
+    case TextChanged:
+        return QStringLiteral("text changed");
+    default:
+        return QString();
+    }
+}
+
+void PerformanceMonitor::resetLatencyStatistics()
+{
+    for (int i = 0; i < LatencyMetricCount; i++) {
+        std::fill(latencyHistogram[i], latencyHistogram[i] + s_latencyBucketCount, 0);
+        latencyTotal[i] = 0;
+    }
+}
+
+bool PerformanceMonitor::latencyOverlayEnabled()
+{
+    if (latencyOverlayState < 0) {
+        latencyOverlayState = qEnvironmentVariableIntValue("DEEPIN_EDITOR_LATENCY_OVERLAY") > 0 ? 1 : 0;
+    }
+
+    return latencyOverlayState > 0;
+}
+
+void PerformanceMonitor::setLatencyOverlayEnabled(bool enabled)
+{
+    latencyOverlayState = enabled ? 1 : 0;
+}
+
+/**
+ * @brief 小于 4us 的耗时各占一个区间，之后每个 2 的幂次 [2^e, 2^(e+1)) 按最高的两位划分为 4 个区间
+ */
+int PerformanceMonitor::latencyBucket(qint64 usecs)
+{
+    if (usecs < 4) {
+        return static_cast<int>(qMax<qint64>(0, usecs));
+    }
+
+    const int exponent = 63 - static_cast<int>(qCountLeadingZeroBits(static_cast<quint64>(usecs)));
+    const int sub = static_cast<int>((usecs >> (exponent - 2)) & 3);
+    return qMin(s_latencyBucketCount - 1, 4 * (exponent - 1) + sub);
+}
+
+qint64 PerformanceMonitor::latencyBucketLowerBound(int bucket)
+{
+    if (bucket < 4) {
+        return qMax(0, bucket);
+    }
+
+    const int exponent = bucket / 4 + 1;
+    return static_cast<qint64>(4 + bucket % 4) << (exponent - 2);
+}
@@ -8,12 +8,38 @@
 
 #include <QTime>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QDebug>
 
 class PerformanceMonitor
 {
 
 public:
+    // 以直方图记录的耗时类型
+    enum LatencyMetric {
+        KeyToPaint = 0,             ///< 按键到界面绘制的延迟
+        EditorPaint,                ///< 编辑区绘制耗时
+        LineNumberPaint,            ///< 行号区域绘制耗时
+        BookmarkPaint,              ///< 书签区域绘制耗时
+        FoldPaint,                  ///< 折叠区域绘制耗时
+        CursorPositionChanged,      ///< 光标位置变更处理耗时
+        TextChanged,                ///< 文本变更处理耗时
+        LatencyMetricCount
+    };
+
+    // 作用域耗时记录，析构时记录到对应的直方图
+    class LatencyScope
+    {
+    public:
+        explicit LatencyScope(LatencyMetric metric);
+        ~LatencyScope();
+
+    private:
+        Q_DISABLE_COPY(LatencyScope)
+        LatencyMetric m_metric;
+        QElapsedTimer m_timer;
+    };
+
     explicit PerformanceMonitor();
 
     static void initializeAppStart();
@@ -22,8 +48,32 @@ public:
     static void closeAPPFinish();
     static void openFileStart();
     static void openFileFinish(const QString &strFileName, qint64 iFileSize);
+    // 记录一次合并的界面更新帧，foldedEvents 为合并到此帧的原始事件数
+    static void frameUpdateFinish(int foldedEvents);
+    static void resetFrameUpdateStatistics();
+    // 记录创建标签页编辑器的耗时
+    static void createEditorStart();
+    static void createEditorFinish();
+
+    // 记录一次耗时(纳秒)
+    static void recordLatency(LatencyMetric metric, qint64 nsecs);
+    static qint64 latencyCount(LatencyMetric metric);
+    // 耗时的百分位数(微秒)，取所在直方图区间的上界
+    static qint64 latencyPercentile(LatencyMetric metric, int percentile);
+    static QString latencyName(LatencyMetric metric);
+    static void resetLatencyStatistics();
+    // 是否在编辑区显示耗时统计，默认由环境变量 DEEPIN_EDITOR_LATENCY_OVERLAY 决定
+    static bool latencyOverlayEnabled();
+    static void setLatencyOverlayEnabled(bool enabled);
+
+    // 直方图区间数量，每个 2 的幂次划分为 4 个区间，相对误差不超过 25%
+    static const int s_latencyBucketCount = 120;
 
 private:
+    // 耗时(微秒)所在的直方图区间及区间下界
+    static int latencyBucket(qint64 usecs);
+    static qint64 latencyBucketLowerBound(int bucket);
+
     Q_DISABLE_COPY(PerformanceMonitor)
 
     static qint64 initializeAppStartMs;
@@ -32,6 +82,15 @@ private:
     static qint64 closeAppFinishMs;
     static qint64 openFileStartMs;
     static qint64 openFileFinishMs;
+    static qint64 frameUpdateCount;         // 界面更新帧数
+    static qint64 frameUpdateEventCount;    // 合并到界面更新帧的原始事件数
+    static int frameUpdateMaxEvents;        // 单帧合并的最大原始事件数
+    static qint64 createEditorStartMs;
+    static qint64 createEditorCount;        // 已创建的编辑器数量
+    static qint64 createEditorTotalMs;      // 创建编辑器的累计耗时
+    static qint64 latencyHistogram[LatencyMetricCount][s_latencyBucketCount];  // 耗时直方图
+    static qint64 latencyTotal[LatencyMetricCount];                           // 各类型的记录次数
+    static int latencyOverlayState;         // 耗时统计显示状态，-1 表示未读取环境变量
 };
 
 #endif // PERFORMANCEMONITOR_H
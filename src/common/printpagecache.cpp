@@ -0,0 +1,251 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "printpagecache.h"
+
+#include <QPainter>
+#include <QPaintDevice>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <climits>
+
+/**
+ * @brief 使用打印设备参数录制的页面，录制时的字体、坐标和直接绘制到打印设备一致
+ */
+class PrintPicture : public QPicture
+{
+public:
+    PrintPicture(int width, int height, int dpiX, int dpiY)
+        : m_width(width)
+        , m_height(height)
+        , m_dpiX(dpiX)
+        , m_dpiY(dpiY)
+    {
+    }
+
+protected:
+    int metric(PaintDeviceMetric metric) const override
+    {
+        switch (metric) {
+        case PdmWidth:
+            return m_width;
+        case PdmHeight:
+            return m_height;
+        case PdmWidthMM:
+            return qRound(m_width * 25.4 / m_dpiX);
+        case PdmHeightMM:
+            return qRound(m_height * 25.4 / m_dpiY);
+        case PdmDpiX:
+        case PdmPhysicalDpiX:
+            return m_dpiX;
+        case PdmDpiY:
+        case PdmPhysicalDpiY:
+            return m_dpiY;
+        default:
+            return QPicture::metric(metric);
+        }
+    }
+
+private:
+    int m_width;
+    int m_height;
+    int m_dpiX;
+    int m_dpiY;
+};
+
+PrintPageCache::PrintPageCache(QObject *parent)
+    : QObject(parent)
+{
+    setBudget(s_defaultBudget);
+}
+
+void PrintPageCache::setBudget(qint64 bytes)
+{
+    m_cache.setMaxCost(static_cast<int>(qBound<qint64>(1, bytes / 1024, INT_MAX)));
+}
+
+qint64 PrintPageCache::budget() const
+{
+    return static_cast<qint64>(m_cache.maxCost()) * 1024;
+}
+
+qint64 PrintPageCache::cost() const
+{
+    return static_cast<qint64>(m_cache.totalCost()) * 1024;
+}
+
+int PrintPageCache::count() const
+{
+    return static_cast<int>(m_cache.count());
+}
+
+bool PrintPageCache::contains(int page) const
+{
+    return m_cache.contains(keyForPage(page));
+}
+
+/**
+ * @brief 设置当前布局的页面来源，不同布局的页面通过缓存键区分，切换回之前的布局时可复用缓存
+ */
+void PrintPageCache::setSource(const QPageLayout &layout, QPaintDevice *device, const JobFactory &factory,
+                               int pageCount, bool threadSafe)
+{
+    ++m_sourceId;
+    m_prefetchPages.clear();
+    m_prefetching = false;
+
+    m_layout = layoutKey(layout);
+    m_metrics.width = device->width();
+    m_metrics.height = device->height();
+    m_metrics.dpiX = device->logicalDpiX();
+    m_metrics.dpiY = device->logicalDpiY();
+    m_factory = factory;
+    m_pageCount = pageCount;
+    m_threadSafe = threadSafe;
+}
+
+bool PrintPageCache::hasSource() const
+{
+    return static_cast<bool>(m_factory);
+}
+
+int PrintPageCache::pageCount() const
+{
+    return m_pageCount;
+}
+
+void PrintPageCache::drawPage(QPainter *painter, int page)
+{
+    if (!m_factory || page < 1 || page > m_pageCount) {
+        return;
+    }
+
+    const Key key = keyForPage(page);
+    QPicture *picture = m_cache.object(key);
+    if (!picture) {
+        insert(key, recordPage(m_metrics, m_factory(page)));
+        picture = m_cache.object(key);
+    }
+
+    if (picture) {
+        painter->drawPicture(0, 0, *picture);
+    }
+}
+
+/**
+ * @brief 按距离由近及远预先录制 [firstPage, lastPage] 前后的页面，新的请求将替换未完成的预先录制队列
+ */
+void PrintPageCache::prefetch(int firstPage, int lastPage)
+{
+    m_prefetchPages.clear();
+    for (int distance = 1; distance <= s_prefetchDistance; distance++) {
+        for (int page : {lastPage + distance, firstPage - distance}) {
+            if (page >= 1 && page <= m_pageCount && !contains(page)) {
+                m_prefetchPages.append(page);
+            }
+        }
+    }
+
+    startPrefetch();
+}
+
+void PrintPageCache::clear()
+{
+    ++m_sourceId;
+    m_prefetchPages.clear();
+    m_prefetching = false;
+    m_cache.clear();
+}
+
+QString PrintPageCache::layoutKey(const QPageLayout &layout)
+{
+    const QRectF rect = layout.fullRectPoints();
+    const QMarginsF margins = layout.margins(QPageLayout::Point);
+    return QString("%1:%2x%3:%4,%5,%6,%7:%8").arg(static_cast<int>(layout.orientation()))
+           .arg(rect.width()).arg(rect.height())
+           .arg(margins.left()).arg(margins.top()).arg(margins.right()).arg(margins.bottom())
+           .arg(static_cast<int>(layout.mode()));
+}
+
+PrintPageCache::Key PrintPageCache::keyForPage(int page) const
+{
+    Key key;
+    key.page = page;
+    key.layout = m_layout;
+    key.dpi = m_metrics.dpiY;
+    return key;
+}
+
+void PrintPageCache::insert(const Key &key, const QPicture &picture)
+{
+    // 开销按录制数据大小计算，超出上限时 QCache 淘汰最久未使用的页面
+    const int cost = qMax(1, static_cast<int>(picture.size() / 1024));
+    m_cache.insert(key, new QPicture(picture), cost);
+}
+
+void PrintPageCache::startPrefetch()
+{
+    if (m_prefetching || !m_factory) {
+        return;
+    }
+
+    int page = -1;
+    while (!m_prefetchPages.isEmpty() && page < 0) {
+        page = m_prefetchPages.takeFirst();
+        if (contains(page)) {
+            page = -1;
+        }
+    }
+
+    if (page < 0) {
+        return;
+    }
+
+    const Key key = keyForPage(page);
+    const PageJob job = m_factory(page);
+    const DeviceMetrics metrics = m_metrics;
+    const quint64 sourceId = m_sourceId;
+    m_prefetching = true;
+
+    auto onRecorded = [this, key, sourceId](const QPicture &picture) {
+        if (sourceId != m_sourceId) {
+            return;
+        }
+
+        m_prefetching = false;
+        insert(key, picture);
+        // 每次录制一个页面，录制完成后继续下一个
+        QTimer::singleShot(0, this, &PrintPageCache::startPrefetch);
+    };
+
+    if (m_threadSafe) {
+        auto *watcher = new QFutureWatcher<QPicture>(this);
+        connect(watcher, &QFutureWatcher<QPicture>::finished, this, [watcher, onRecorded]() {
+            onRecorded(watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([metrics, job]() {
+            return PrintPageCache::recordPage(metrics, job);
+        }));
+    } else {
+        // 绘制任务需访问 GUI 线程的文档，在事件循环空闲时录制
+        QTimer::singleShot(0, this, [metrics, job, onRecorded]() {
+            onRecorded(PrintPageCache::recordPage(metrics, job));
+        });
+    }
+}
+
+QPicture PrintPageCache::recordPage(const DeviceMetrics &metrics, const PageJob &job)
+{
+    PrintPicture picture(metrics.width, metrics.height, metrics.dpiX, metrics.dpiY);
+    if (job) {
+        QPainter painter(&picture);
+        job(&painter);
+        painter.end();
+    }
+
+    return picture;
+}
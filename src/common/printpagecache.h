@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PRINTPAGECACHE_H
+#define PRINTPAGECACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QPicture>
+#include <QPageLayout>
+#include <QVector>
+
+#include <functional>
+
+class QPainter;
+
+/**
+ * @brief 打印预览页面缓存
+ *      按页码、打印布局及分辨率缓存录制的页面(QPicture)，超出内存上限时淘汰最久未使用的页面。
+ *      预览请求页面时直接回放缓存，并预先录制相邻的页面，页面绘制任务可在工作线程执行时使用工作线程录制。
+ */
+class PrintPageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 缓存键
+    struct Key {
+        int page = 0;       ///< 页码，从1开始
+        QString layout;     ///< 打印布局标识
+        int dpi = 0;        ///< 打印设备分辨率
+    };
+
+    // 页面绘制任务
+    using PageJob = std::function<void(QPainter *)>;
+    // 在 GUI 线程准备页面 page 的绘制任务
+    using JobFactory = std::function<PageJob(int page)>;
+
+    explicit PrintPageCache(QObject *parent = nullptr);
+
+    // 设置缓存的内存上限(字节)
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+    // 已缓存页面占用的内存(字节)
+    qint64 cost() const;
+    // 已缓存页面数量
+    int count() const;
+    // 当前布局下页面 page 是否已缓存
+    bool contains(int page) const;
+
+    // 设置当前布局的页面来源，device 为打印设备，threadSafe 为 true 时页面绘制任务可在工作线程执行
+    void setSource(const QPageLayout &layout, QPaintDevice *device, const JobFactory &factory,
+                   int pageCount, bool threadSafe);
+    // 是否已设置页面来源
+    bool hasSource() const;
+    // 当前布局的页数
+    int pageCount() const;
+    // 绘制页面 page ，未缓存时录制并缓存
+    void drawPage(QPainter *painter, int page);
+    // 预先录制 [firstPage, lastPage] 相邻的页面
+    void prefetch(int firstPage, int lastPage);
+    // 清空缓存的页面
+    void clear();
+
+    // 取得打印布局标识
+    static QString layoutKey(const QPageLayout &layout);
+
+    // 预先录制的相邻页面数量
+    static const int s_prefetchDistance = 2;
+    // 默认内存上限(字节)
+    static const qint64 s_defaultBudget = 64 * 1024 * 1024;
+
+private:
+    // 录制页面使用的设备参数
+    struct DeviceMetrics {
+        int width = 0;
+        int height = 0;
+        int dpiX = 0;
+        int dpiY = 0;
+    };
+
+    Key keyForPage(int page) const;
+    void insert(const Key &key, const QPicture &picture);
+    // 录制下一个待预先录制的页面
+    void startPrefetch();
+    static QPicture recordPage(const DeviceMetrics &metrics, const PageJob &job);
+
+private:
+    QCache<Key, QPicture> m_cache;      ///< 页面缓存，开销单位为 KB
+    QString m_layout;
+    DeviceMetrics m_metrics;
+    JobFactory m_factory;
+    int m_pageCount = 0;
+    bool m_threadSafe = false;
+
+    QVector<int> m_prefetchPages;       ///< 待预先录制的页面
+    bool m_prefetching = false;         ///< 是否正在预先录制
+    quint64 m_sourceId = 0;             ///< 页面来源标识，来源变更后丢弃预先录制的结果
+};
+
+inline bool operator==(const PrintPageCache::Key &left, const PrintPageCache::Key &right)
+{
+    return left.page == right.page && left.dpi == right.dpi && left.layout == right.layout;
+}
+
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+inline uint qHash(const PrintPageCache::Key &key, uint seed = 0)
+#else
+inline size_t qHash(const PrintPageCache::Key &key, size_t seed = 0)
+#endif
+{
+    return qHash(key.page, seed) ^ qHash(key.layout, seed) ^ qHash(key.dpi, seed);
+}
+
+#endif  // PRINTPAGECACHE_H
@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "printpaginator.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QtConcurrent/QtConcurrentRun>
+
+// 单批计算的最大文本块数量
+static const int s_chunkBlocks = 4096;
+// 单批计算的最大字符数，限制文本快照占用的内存
+static const int s_chunkChars = 1024 * 1024;
+
+PrintPaginator::PrintPaginator(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+    // 分页期间文档变更(例如重新加载文件)时重新分页
+    connect(document, &QTextDocument::contentsChange, this, [this]() {
+        if (!m_pageSize.isEmpty()) {
+            paginate();
+        }
+    });
+}
+
+PrintPaginator::~PrintPaginator()
+{
+    if (m_watcher) {
+        m_watcher->disconnect(this);
+    }
+}
+
+void PrintPaginator::setPageGeometry(const QFont &font, const QTextOption &option, const QSizeF &pageSize)
+{
+    m_font = font;
+    m_option = option;
+    m_pageSize = pageSize;
+    // 行高和 QTextLayout 布局结果一致，所有行使用相同的行高，以便在后台仅统计行数
+    m_lineHeight = QFontMetricsF(m_font).lineSpacing();
+    m_linesPerPage = m_lineHeight > 0 ? qMax(1, static_cast<int>(pageSize.height() / m_lineHeight)) : 1;
+}
+
+void PrintPaginator::setBackground(const QColor &background)
+{
+    m_background = background;
+}
+
+QFont PrintPaginator::font() const
+{
+    return m_font;
+}
+
+/**
+ * @brief 丢弃已有的页索引，从首个文本块开始分批在后台线程计算行数
+ */
+void PrintPaginator::paginate()
+{
+    if (m_watcher) {
+        m_watcher->disconnect(this);
+        m_watcher->deleteLater();
+        m_watcher = nullptr;
+    }
+
+    ++m_buildId;
+    m_pages.clear();
+    m_pages.append(PageStart());
+    m_nextBlock = 0;
+    m_lineInPage = 0;
+    m_finished = false;
+
+    startChunk();
+}
+
+void PrintPaginator::waitForFinished()
+{
+    while (!m_finished && m_watcher) {
+        m_watcher->waitForFinished();
+        onChunkFinished(m_buildId);
+    }
+}
+
+bool PrintPaginator::isFinished() const
+{
+    return m_finished;
+}
+
+int PrintPaginator::pageCount() const
+{
+    return m_pages.size();
+}
+
+int PrintPaginator::linesPerPage() const
+{
+    return m_linesPerPage;
+}
+
+PrintPaginator::PageStart PrintPaginator::pageStart(int pageIndex) const
+{
+    if (pageIndex < 1 || pageIndex > m_pages.size()) {
+        return PageStart();
+    }
+
+    return m_pages.at(pageIndex - 1);
+}
+
+/**
+ * @brief 拷贝页面内文本块的文本，高亮格式直接取自源文本块的布局，无需重新高亮
+ */
+PrintPaginator::PageSnapshot PrintPaginator::pageSnapshot(int pageIndex) const
+{
+    PageSnapshot snapshot;
+    snapshot.font = m_font;
+    snapshot.option = m_option;
+    snapshot.width = m_pageSize.width();
+    snapshot.lineHeight = m_lineHeight;
+    snapshot.linesPerPage = m_linesPerPage;
+
+    if (!m_document || pageIndex < 1 || pageIndex > m_pages.size()) {
+        return snapshot;
+    }
+
+    const PageStart start = m_pages.at(pageIndex - 1);
+    snapshot.firstLine = start.line;
+
+    // 页面结束于下一页的起始文本块，下一页从文本块中间开始时包含此文本块
+    int endBlock = m_document->blockCount() - 1;
+    if (pageIndex < m_pages.size()) {
+        const PageStart next = m_pages.at(pageIndex);
+        endBlock = next.line > 0 ? next.block : next.block - 1;
+    }
+
+    QTextBlock block = m_document->findBlockByNumber(start.block);
+    for (int i = start.block; i <= endBlock && block.isValid(); i++, block = block.next()) {
+        snapshot.texts.append(block.text());
+        snapshot.formats.append(printFormats(block.layout()->formats(), m_background));
+    }
+
+    return snapshot;
+}
+
+void PrintPaginator::drawPage(QPainter *painter, int pageIndex) const
+{
+    drawSnapshot(painter, pageSnapshot(pageIndex));
+}
+
+/**
+ * @brief 从页面起始位置开始逐个文本块构造布局，仅绘制本页内的行
+ */
+void PrintPaginator::drawSnapshot(QPainter *painter, const PageSnapshot &snapshot)
+{
+    int skipLines = snapshot.firstLine;
+    int drawnLines = 0;
+
+    painter->save();
+    painter->setPen(Qt::black);
+
+    for (int index = 0; index < snapshot.texts.size() && drawnLines < snapshot.linesPerPage; index++) {
+        QTextLayout layout(snapshot.texts.at(index), snapshot.font);
+        layout.setTextOption(snapshot.option);
+        layout.setFormats(snapshot.formats.at(index));
+
+        layout.beginLayout();
+        QTextLine line;
+        int lineNumber = 0;
+        while ((line = layout.createLine()).isValid()) {
+            line.setLineWidth(snapshot.width);
+            line.setPosition(QPointF(0, (drawnLines + lineNumber - skipLines) * snapshot.lineHeight));
+            lineNumber++;
+            if (drawnLines + lineNumber - skipLines >= snapshot.linesPerPage) {
+                break;
+            }
+        }
+        layout.endLayout();
+
+        for (int i = skipLines; i < layout.lineCount(); i++) {
+            layout.lineAt(i).draw(painter, QPointF(0, 0));
+        }
+
+        drawnLines += qMax(0, layout.lineCount() - skipLines);
+        skipLines = 0;
+    }
+
+    painter->restore();
+}
+
+int PrintPaginator::lineCount(const QString &text, const QFont &font, const QTextOption &option, qreal width)
+{
+    QTextLayout layout(text, font);
+    layout.setTextOption(option);
+
+    int count = 0;
+    layout.beginLayout();
+    QTextLine line;
+    while ((line = layout.createLine()).isValid()) {
+        line.setLineWidth(width);
+        count++;
+    }
+    layout.endLayout();
+
+    return qMax(1, count);
+}
+
+/**
+ * @brief 打印使用白色背景，编辑器为深色背景时，降低和背景色相同的高亮格式的前景色亮度以提高对比度
+ */
+QVector<QTextLayout::FormatRange> PrintPaginator::printFormats(const QVector<QTextLayout::FormatRange> &formats,
+                                                               const QColor &background)
+{
+    if (background.value() >= 128) {
+        return formats;
+    }
+
+    QVector<QTextLayout::FormatRange> formatList = formats;
+    // adjust syntax highlighting colors for better contrast
+    for (int i = formatList.count() - 1; i >= 0; --i) {
+        QTextCharFormat &format = formatList[i].format;
+        if (format.background().color() == background) {
+            QBrush brush = format.foreground();
+            QColor color = brush.color();
+            int h, s, v, a;
+            color.getHsv(&h, &s, &v, &a);
+            color.setHsv(h, s, qMin(128, v), a);
+            brush.setColor(color);
+            format.setForeground(brush);
+        }
+        format.setBackground(Qt::white);
+    }
+
+    return formatList;
+}
+
+void PrintPaginator::startChunk()
+{
+    if (!m_document || m_nextBlock >= m_document->blockCount()) {
+        m_finished = true;
+        emit paginationFinished(m_pages.size());
+        return;
+    }
+
+    // 仅拷贝本批文本块的文本，后台线程不访问文档
+    QStringList texts;
+    int chars = 0;
+    for (QTextBlock block = m_document->findBlockByNumber(m_nextBlock);
+            block.isValid() && texts.size() < s_chunkBlocks && chars < s_chunkChars;
+            block = block.next()) {
+        texts.append(block.text());
+        chars += block.length();
+    }
+
+    const quint64 buildId = m_buildId;
+    const QFont font = m_font;
+    const QTextOption option = m_option;
+    const qreal width = m_pageSize.width();
+
+    m_watcher = new QFutureWatcher<QVector<int>>(this);
+    connect(m_watcher, &QFutureWatcher<QVector<int>>::finished, this, [this, buildId]() {
+        onChunkFinished(buildId);
+    });
+    m_watcher->setFuture(QtConcurrent::run([texts, font, option, width]() {
+        QVector<int> lineCounts;
+        lineCounts.reserve(texts.size());
+        for (const QString &text : texts) {
+            lineCounts.append(PrintPaginator::lineCount(text, font, option, width));
+        }
+        return lineCounts;
+    }));
+}
+
+void PrintPaginator::onChunkFinished(quint64 buildId)
+{
+    if (!m_watcher || buildId != m_buildId) {
+        return;
+    }
+
+    QFutureWatcher<QVector<int>> *watcher = m_watcher;
+    m_watcher = nullptr;
+    watcher->disconnect(this);
+    watcher->deleteLater();
+
+    const QVector<int> lineCounts = watcher->result();
+    appendLineCounts(lineCounts);
+    m_nextBlock += lineCounts.size();
+
+    startChunk();
+}
+
+void PrintPaginator::appendLineCounts(const QVector<int> &lineCounts)
+{
+    int block = m_nextBlock;
+    for (int count : lineCounts) {
+        int line = 0;
+        while (line < count) {
+            if (m_lineInPage >= m_linesPerPage) {
+                PageStart page;
+                page.block = block;
+                page.line = line;
+                m_pages.append(page);
+                m_lineInPage = 0;
+            }
+
+            const int take = qMin(count - line, m_linesPerPage - m_lineInPage);
+            m_lineInPage += take;
+            line += take;
+        }
+        block++;
+    }
+}
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PRINTPAGINATOR_H
+#define PRINTPAGINATOR_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <QStringList>
+#include <QFont>
+#include <QColor>
+#include <QTextOption>
+#include <QTextLayout>
+#include <QFutureWatcher>
+
+class QTextDocument;
+class QPainter;
+
+/**
+ * @brief 打印分页引擎，用于大文本打印
+ *      不拷贝文档，在后台线程按打印文本宽度分批计算源文档各文本块换行后的行数，仅记录每页起始的
+ *      文本块及行号(页索引)。绘制页面时根据页索引直接从源文档的文本块及已有的高亮格式构造布局。
+ */
+class PrintPaginator : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 页面起始位置
+    struct PageStart {
+        int block = 0;      ///< 文本块序号
+        int line = 0;       ///< 文本块内的行号
+    };
+
+    // 页面快照，仅持有页面内文本块的文本及格式，可在工作线程绘制
+    struct PageSnapshot {
+        QFont font;
+        QTextOption option;
+        qreal width = 0;                ///< 文本区域宽度
+        qreal lineHeight = 0;
+        int linesPerPage = 0;
+        int firstLine = 0;              ///< 首个文本块内的起始行号
+        QStringList texts;
+        QVector<QVector<QTextLayout::FormatRange>> formats;
+    };
+
+    explicit PrintPaginator(QTextDocument *document, QObject *parent = nullptr);
+    ~PrintPaginator() override;
+
+    // 设置打印字体(已适配打印设备)、文本选项及每页文本区域大小，变更后需重新分页
+    void setPageGeometry(const QFont &font, const QTextOption &option, const QSizeF &pageSize);
+    // 设置编辑器背景色，深色背景时调整高亮颜色
+    void setBackground(const QColor &background);
+    // 打印字体
+    QFont font() const;
+
+    // 在后台线程重新分页
+    void paginate();
+    // 等待分页完成
+    void waitForFinished();
+    // 分页是否完成
+    bool isFinished() const;
+    // 已分页的页数，分页完成前为已计算的页数
+    int pageCount() const;
+    // 每页行数
+    int linesPerPage() const;
+    // 取得页面 pageIndex (从1开始) 的起始位置
+    PageStart pageStart(int pageIndex) const;
+
+    // 取得页面 pageIndex (从1开始) 的快照
+    PageSnapshot pageSnapshot(int pageIndex) const;
+    // 绘制页面 pageIndex (从1开始)，painter 原点为文本区域左上角
+    void drawPage(QPainter *painter, int pageIndex) const;
+    // 绘制页面快照，不访问文档，可在工作线程调用
+    static void drawSnapshot(QPainter *painter, const PageSnapshot &snapshot);
+
+    // 计算文本 text 按宽度 width 换行后的行数
+    static int lineCount(const QString &text, const QFont &font, const QTextOption &option, qreal width);
+    // 调整高亮格式用于白色背景打印，深色背景下降低前景色亮度
+    static QVector<QTextLayout::FormatRange> printFormats(const QVector<QTextLayout::FormatRange> &formats,
+                                                          const QColor &background);
+
+signals:
+    // 分页完成
+    void paginationFinished(int pageCount);
+
+private:
+    // 提交下一批文本块到后台线程计算
+    void startChunk();
+    void onChunkFinished(quint64 buildId);
+    // 根据文本块行数追加页索引
+    void appendLineCounts(const QVector<int> &lineCounts);
+
+private:
+    QPointer<QTextDocument> m_document;
+    QFont m_font;
+    QTextOption m_option;
+    QSizeF m_pageSize;
+    qreal m_lineHeight = 0;
+    int m_linesPerPage = 1;
+    QColor m_background = Qt::white;
+
+    QVector<PageStart> m_pages;         ///< 页索引
+    int m_nextBlock = 0;                ///< 下一批待计算的首个文本块
+    int m_lineInPage = 0;               ///< 最后一页已使用的行数
+    bool m_finished = false;
+
+    QFutureWatcher<QVector<int>> *m_watcher = nullptr;
+    quint64 m_buildId = 0;              ///< 当前分页标识，用于丢弃重新分页前的结果
+};
+
+#endif  // PRINTPAGINATOR_H
@@ -98,6 +98,9 @@ Settings::Settings(QWidget *parent)
     auto blankCharacter = settings->option("base.font.showblankcharacter");
     connect(blankCharacter, &Dtk::Core::DSettingsOption::valueChanged, this, &Settings::slotsigShowBlankCharacter);
 
+    auto showMinimap = settings->option("base.font.showminimap");
+    connect(showMinimap, &Dtk::Core::DSettingsOption::valueChanged, this, &Settings::slotsigShowMinimap);
+
     //hightlightcurrentline
     auto hightlightCurrentLine = settings->option("base.font.hightlightcurrentline");
     connect(hightlightCurrentLine, &Dtk::Core::DSettingsOption::valueChanged, this, &Settings::slotsigHightLightCurrentLine);
@@ -679,18 +682,27 @@ void Settings::slotCustomshortcut(const QString &key, const QVariant &value)
 }
 
 
+quint64 Settings::displaySettingsGeneration() const
+{
+    return m_displaySettingsGeneration;
+}
+
 void Settings::slotsigAdjustFont(QVariant value)
 {
+    // 在通知各窗口前递增显示设置版本
+    ++m_displaySettingsGeneration;
     emit sigAdjustFont(value.toString());
 }
 
 void Settings::slotsigAdjustFontSize(QVariant value)
 {
+    ++m_displaySettingsGeneration;
     emit sigAdjustFontSize(value.toReal());
 }
 
 void Settings::slotsigAdjustWordWrap(QVariant value)
 {
+    ++m_displaySettingsGeneration;
     emit sigAdjustWordWrap(value.toBool());
 }
 
@@ -711,9 +723,15 @@ void Settings::slotsigShowCodeFlodFlag(QVariant value)
 
 void Settings::slotsigShowBlankCharacter(QVariant value)
 {
+    ++m_displaySettingsGeneration;
     emit sigShowBlankCharacter(value.toBool());
 }
 
+void Settings::slotsigShowMinimap(QVariant value)
+{
+    emit sigShowMinimap(value.toBool());
+}
+
 void Settings::slotsigHightLightCurrentLine(QVariant value)
 {
     emit sigHightLightCurrentLine(value.toBool());
@@ -721,6 +739,7 @@ void Settings::slotsigHightLightCurrentLine(QVariant value)
 
 void Settings::slotsigAdjustTabSpaceNumber(QVariant value)
 {
+    ++m_displaySettingsGeneration;
     emit sigAdjustTabSpaceNumber(value.toInt());
 }
 
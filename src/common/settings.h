@@ -66,6 +66,8 @@ public:
     QString getSavePath(int id);
     void setSavePathId(int id);
     int getSavePathId();
+    // 显示设置(字体、字号、换行、Tab宽度、空白符)的版本，每次变更仅递增一次，各窗口据此同步标签页
+    quint64 displaySettingsGeneration() const;
 
 signals:
     void sigAdjustFont(QString name);
@@ -75,6 +77,7 @@ signals:
     void sigAdjustBookmark(bool enable);
     void sigShowCodeFlodFlag(bool enable);
     void sigShowBlankCharacter(bool enable);
+    void sigShowMinimap(bool enable);
     void sigHightLightCurrentLine(bool enable);
     void sigThemeChanged(const QString &theme);
     void sigSetLineNumberShow(bool bIsShow);
@@ -92,6 +95,7 @@ public slots:
     void slotsigAdjustBookmark(QVariant value);
     void slotsigShowCodeFlodFlag(QVariant value);
     void slotsigShowBlankCharacter(QVariant value);
+    void slotsigShowMinimap(QVariant value);
     void slotsigHightLightCurrentLine(QVariant value);
     void slotsigAdjustTabSpaceNumber(QVariant value);
     void slotupdateAllKeysWithKeymap(QVariant value);
@@ -108,6 +112,7 @@ private:
     Dtk::Core::QSettingBackend *m_backend {nullptr};
 
     bool m_bUserChangeKey = false;
+    quint64 m_displaySettingsGeneration = 0;
     DSettingsDialog *m_pSettingsDialog;
     static Settings* s_pSetting;
     DDialog *m_pDialog;
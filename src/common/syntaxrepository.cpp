@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "syntaxrepository.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+#include <type_traits>
+
+static std::atomic_bool s_loaded {false};
+
+// 新版本的 Repository 继承 QObject，在后台线程构造后需移动到 GUI 线程
+template<typename T>
+static void moveToApplicationThread(T *repository)
+{
+    if constexpr (std::is_base_of<QObject, T>::value) {
+        if (QCoreApplication::instance() && repository->thread() != QCoreApplication::instance()->thread()) {
+            repository->moveToThread(QCoreApplication::instance()->thread());
+        }
+    } else {
+        Q_UNUSED(repository)
+    }
+}
+
+static KSyntaxHighlighting::Repository *createRepository()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto repository = new KSyntaxHighlighting::Repository;
+    // 更新单独添加的高亮格式文件
+    repository->addCustomSearchPath(KF5_HIGHLIGHT_PATH);
+    moveToApplicationThread(repository);
+
+    s_loaded = true;
+    qInfo() << qPrintable(QString("Load syntax repository, definitions: %1, duration=%2ms")
+                          .arg(repository->definitions().size()).arg(timer.elapsed()));
+    return repository;
+}
+
+/**
+ * @return 共享的高亮定义仓库，进程退出前不会释放，保证各标签页持有的高亮定义始终有效
+ */
+KSyntaxHighlighting::Repository *SyntaxRepository::instance()
+{
+    // 静态局部变量的初始化是线程安全的，后台预加载和 GUI 线程同时访问时将等待加载完成
+    static KSyntaxHighlighting::Repository *s_repository = createRepository();
+    return s_repository;
+}
+
+void SyntaxRepository::warmUp()
+{
+    if (isLoaded()) {
+        return;
+    }
+
+    QtConcurrent::run([]() {
+        SyntaxRepository::instance();
+    });
+}
+
+bool SyntaxRepository::isLoaded()
+{
+    return s_loaded;
+}
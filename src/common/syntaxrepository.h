@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYNTAXREPOSITORY_H
+#define SYNTAXREPOSITORY_H
+
+#include <KSyntaxHighlighting/Repository>
+
+/**
+ * @brief 进程共享的语法高亮定义仓库
+ *      KSyntaxHighlighting::Repository 构造时会扫描并索引所有高亮定义文件，开销较大，
+ *      所有标签页共用同一实例，首次使用时加载，也可在程序启动时于后台线程预先加载。
+ *      加载完成后仅在 GUI 线程访问。
+ */
+class SyntaxRepository
+{
+public:
+    // 取得共享的高亮定义仓库，未加载时在当前线程加载(多线程同时调用时仅加载一次)
+    static KSyntaxHighlighting::Repository *instance();
+    // 在后台线程预先加载高亮定义仓库
+    static void warmUp();
+    // 高亮定义仓库是否已加载
+    static bool isLoaded();
+
+private:
+    Q_DISABLE_COPY(SyntaxRepository)
+    SyntaxRepository() = delete;
+};
+
+#endif  // SYNTAXREPOSITORY_H
@@ -27,6 +27,9 @@
 #include <QTextCodec>
 #include <QImageReader>
 #include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
 #include "qprocess.h"
 
 #include <QLibraryInfo>
@@ -512,6 +515,19 @@ qreal Utils::easeOutQuint(qreal x)
 
 QVariantMap Utils::getThemeMapFromPath(const QString &filepath)
 {
+    // 切换主题时每个标签页均会读取主题文件，缓存解析结果避免重复解析
+    struct ThemeCacheItem {
+        QDateTime modified;
+        QVariantMap map;
+    };
+    static QHash<QString, ThemeCacheItem> s_themeCache;
+
+    const QDateTime modified = QFileInfo(filepath).lastModified();
+    auto itr = s_themeCache.constFind(filepath);
+    if (itr != s_themeCache.constEnd() && itr.value().modified == modified) {
+        return itr.value().map;
+    }
+
     QFile file(filepath);
     if (!file.open(QIODevice::ReadOnly)) {
         qDebug() << "Failed to open " << filepath;
@@ -526,7 +542,9 @@ QVariantMap Utils::getThemeMapFromPath(const QString &filepath)
     QJsonDocument document = QJsonDocument::fromJson(jsonBytes);
     QJsonObject object = document.object();
 
-    return object.toVariantMap();
+    const QVariantMap map = object.toVariantMap();
+    s_themeCache.insert(filepath, {modified, map});
+    return map;
 }
 
 bool Utils::isMimeTypeSupport(const QString &filepath)
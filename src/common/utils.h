@@ -30,6 +30,9 @@
 #define PROC_MEMINFO_PATH "/proc/meminfo"
 #define COPY_CONSUME_MEMORY_MULTIPLE 9   // 复制文本时内存占用系数
 #define PASTE_CONSUME_MEMORY_MULTIPLE 7  // 粘贴文本时内存占用系数
+#define LONG_LINE_THRESHOLD (10 * 1024)  // 超长行的长度阈值(字符数)，文档包含超长行时启用超长行模式
+#define LONG_LINE_SEGMENT 4096           // 超长行括号匹配的扫描窗口及分段高亮的分段长度(字符数)
+#define LONG_LINE_HIGHLIGHT_LIMIT (100 * 1024)  // 超长行分段高亮的最大分段长度(字符数)，找不到切分位置时剩余部分不高亮
 
 class Utils
 {
@@ -61,6 +64,7 @@ public:
         IdUnknown = 256,    // sa: QTextUndoCommand::Command::Custom
         IdInsert,
         IdDelete,
+        IdLineBlock,        // line block move, duplicate and join command
 
         IdColumnEdit = 0x1000,  // column edit mark
         IdColumnEditInsert = IdColumnEdit | IdInsert,
@@ -87,6 +91,7 @@ public:
     static qreal easeInQuint(qreal x);
     static qreal easeOutQuad(qreal x);
     static qreal easeOutQuint(qreal x);
+    // 读取主题文件，按路径及修改时间缓存解析结果(仅在 GUI 线程调用)
     static QVariantMap getThemeMapFromPath(const QString &filepath);
     static bool isMimeTypeSupport(const QString &filepath);
     static bool isDraftFile(const QString &filepath);
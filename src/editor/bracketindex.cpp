@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "bracketindex.h"
+#include "../common/utils.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+
+#include <limits>
+
+// 单次查找默认的耗时上限(ms)
+static const int s_defaultTimeBudget = 30;
+// 每扫描多少个文本块或字符检查一次耗时
+static const int s_blockCheckInterval = 256;
+static const int s_charCheckInterval = 64 * 1024;
+
+BracketIndex::BracketIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+    , m_timeBudget(s_defaultTimeBudget)
+{
+}
+
+/**
+ * @brief 从 \a position 开始查找匹配的括号，和逐字符扫描的结果一致：
+ *      起始文本块及匹配括号所在的文本块逐字符扫描，中间的文本块根据摘要整块跳过。
+ * @return 匹配括号的位置，未找到或超出耗时上限时返回 -1
+ */
+int BracketIndex::findMatchingBracket(int position, const QChar &openChar, const QChar &closeChar, bool forward)
+{
+    if (position < 0) {
+        return -1;
+    }
+
+    QTextBlock block = m_document->findBlock(position);
+    if (!block.isValid()) {
+        return -1;
+    }
+
+    m_timer.start();
+    const int type = bracketType(openChar, closeChar);
+    const QChar begin = forward ? openChar : closeChar;
+    const QChar end = forward ? closeChar : openChar;
+    ScanState state {1, false};
+
+    // 起始文本块从 position 开始扫描，position 可能指向文本块末尾的段落分隔符
+    int offset = position - block.position();
+    int windowStart = 0;
+    const bool longLine = block.length() - 1 > LONG_LINE_THRESHOLD;
+    QString text;
+    if (longLine) {
+        // 超长行仅读取查找方向上固定长度的分段，避免拷贝整行文本
+        const int blockLength = block.length() - 1;
+        windowStart = forward ? offset : qMax(0, offset - LONG_LINE_SEGMENT);
+        const int windowEnd = forward ? qMin(blockLength, offset + LONG_LINE_SEGMENT) : qMin(blockLength, offset + 1);
+        QTextCursor cursor(m_document);
+        cursor.setPosition(block.position() + windowStart);
+        cursor.setPosition(block.position() + windowEnd, QTextCursor::KeepAnchor);
+        text = cursor.selectedText();
+        offset -= windowStart;
+    } else {
+        text = block.text();
+    }
+
+    const int from = forward ? offset : qMin(offset, text.size() - 1);
+    if (from >= 0 && from < text.size()) {
+        const int index = scanText(text, from, forward, begin, end, state);
+        if (index >= 0) {
+            return block.position() + windowStart + index;
+        }
+        if (isTimeout()) {
+            return -1;
+        }
+    }
+
+    // 匹配括号不在分段内时不再查找
+    if (longLine) {
+        return -1;
+    }
+
+    int visited = 0;
+    block = forward ? block.next() : block.previous();
+    while (block.isValid()) {
+        if (0 == (++visited % s_blockCheckInterval) && isTimeout()) {
+            return -1;
+        }
+
+        // 不跨越超长行查找
+        if (block.length() - 1 > LONG_LINE_THRESHOLD) {
+            return -1;
+        }
+
+        if (-1 != type) {
+            const BlockEntry &entry = blockEntry(block);
+            if (!entry.overflow) {
+                const Summary &summary = entry.summary[forward][state.inString];
+                // 扫描过程中深度不会降为 0，匹配括号不在此文本块中
+                if (state.depth + summary.min[type] > 0) {
+                    state.depth += summary.net[type];
+                    state.inString = summary.endInString;
+                    block = forward ? block.next() : block.previous();
+                    continue;
+                }
+            }
+        }
+
+        text = block.text();
+        const int index = scanText(text, forward ? 0 : text.size() - 1, forward, begin, end, state);
+        if (index >= 0) {
+            return block.position() + index;
+        }
+        if (isTimeout()) {
+            return -1;
+        }
+
+        block = forward ? block.next() : block.previous();
+    }
+
+    return -1;
+}
+
+void BracketIndex::setTimeBudget(int ms)
+{
+    m_timeBudget = ms;
+}
+
+void BracketIndex::clear()
+{
+    m_entries.clear();
+}
+
+int BracketIndex::bracketType(const QChar &openChar, const QChar &closeChar)
+{
+    if ('(' == openChar && ')' == closeChar) {
+        return RoundBracket;
+    } else if ('{' == openChar && '}' == closeChar) {
+        return CurlyBracket;
+    } else if ('[' == openChar && ']' == closeChar) {
+        return SquareBracket;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 文档变更后，变更区间 [ \a from , \a from + \a charsAdded ] 覆盖的文本块摘要失效，
+ *      并根据文本块数量的变化平移后续文本块的摘要
+ */
+void BracketIndex::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+    if (m_entries.isEmpty()) {
+        return;
+    }
+
+    const int oldCount = m_entries.size();
+    const int newCount = m_document->blockCount();
+    QTextBlock firstBlock = m_document->findBlock(from);
+    QTextBlock lastBlock = m_document->findBlock(from + charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = m_document->lastBlock();
+    }
+    if (!firstBlock.isValid() || lastBlock.blockNumber() < firstBlock.blockNumber()) {
+        clear();
+        return;
+    }
+
+    const int firstNumber = firstBlock.blockNumber();
+    const int newAffected = lastBlock.blockNumber() - firstNumber + 1;
+    const int oldAffected = newAffected - (newCount - oldCount);
+    if (oldAffected < 1 || firstNumber + oldAffected > oldCount) {
+        clear();
+        return;
+    }
+
+    if (newAffected > oldAffected) {
+        m_entries.insert(firstNumber + oldAffected, newAffected - oldAffected, BlockEntry());
+    } else if (newAffected < oldAffected) {
+        m_entries.remove(firstNumber + newAffected, oldAffected - newAffected);
+    }
+
+    for (int i = firstNumber; i < firstNumber + newAffected; i++) {
+        m_entries[i].revision = -1;
+    }
+}
+
+const BracketIndex::BlockEntry &BracketIndex::blockEntry(const QTextBlock &block)
+{
+    // 首次使用或文本块数量不一致时重新分配
+    if (m_entries.size() != m_document->blockCount()) {
+        m_entries.clear();
+        m_entries.resize(m_document->blockCount());
+    }
+
+    BlockEntry &entry = m_entries[block.blockNumber()];
+    if (entry.revision != block.revision() || entry.length != block.length()) {
+        computeEntry(block.text(), entry);
+        entry.revision = block.revision();
+        entry.length = block.length();
+    }
+
+    return entry;
+}
+
+void BracketIndex::computeEntry(const QString &text, BlockEntry &entry)
+{
+    entry.overflow = false;
+    for (int forward = 0; forward < 2; forward++) {
+        for (int startInString = 0; startInString < 2; startInString++) {
+            if (!computeSummary(text, forward, startInString, entry.summary[forward][startInString])) {
+                entry.overflow = true;
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 按扫描方向 \a forward 计算文本块 \a text 的括号深度摘要，字符串的判断规则和逐字符扫描一致
+ * @return 深度是否在记录范围内
+ */
+bool BracketIndex::computeSummary(const QString &text, bool forward, bool startInString, Summary &summary)
+{
+    static const QChar s_openChars[BracketTypeCount] = {'(', '{', '['};
+    static const QChar s_closeChars[BracketTypeCount] = {')', '}', ']'};
+    static const int s_maxDepth = std::numeric_limits<qint16>::max();
+
+    int net[BracketTypeCount] = {0, 0, 0};
+    int min[BracketTypeCount] = {0, 0, 0};
+    bool inString = startInString;
+
+    const int size = text.size();
+    for (int step = 0; step < size; step++) {
+        const int i = forward ? step : size - 1 - step;
+        const QChar c = text.at(i);
+        if (inString) {
+            if ('"' == c && !(i > 0 && '\\' == text.at(i - 1))) {
+                inString = false;
+            }
+            continue;
+        }
+
+        if ('"' == c) {
+            inString = true;
+            continue;
+        }
+
+        for (int type = 0; type < BracketTypeCount; type++) {
+            // 向前扫描时以闭括号为起始括号
+            const QChar &begin = forward ? s_openChars[type] : s_closeChars[type];
+            const QChar &end = forward ? s_closeChars[type] : s_openChars[type];
+            if (c == begin) {
+                net[type]++;
+            } else if (c == end) {
+                net[type]--;
+                min[type] = qMin(min[type], net[type]);
+            } else {
+                continue;
+            }
+
+            if (qAbs(net[type]) >= s_maxDepth) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    for (int type = 0; type < BracketTypeCount; type++) {
+        summary.net[type] = static_cast<qint16>(net[type]);
+        summary.min[type] = static_cast<qint16>(min[type]);
+    }
+    summary.endInString = inString;
+
+    return true;
+}
+
+int BracketIndex::scanText(const QString &text, int from, bool forward, const QChar &begin, const QChar &end, ScanState &state) const
+{
+    int scanned = 0;
+    for (int i = from; i >= 0 && i < text.size(); forward ? i++ : i--) {
+        if (0 == (++scanned % s_charCheckInterval) && isTimeout()) {
+            return -1;
+        }
+
+        const QChar c = text.at(i);
+        if (state.inString) {
+            // 判断 " 是否存在转义字符，若不存在，则退出字符串模式
+            if ('"' == c && !(i > 0 && '\\' == text.at(i - 1))) {
+                state.inString = false;
+            }
+        } else {
+            if (c == begin) {
+                state.depth++;
+            } else if (c == end) {
+                state.depth--;
+                if (0 == state.depth) {
+                    return i;
+                }
+            } else if ('"' == c) {
+                state.inString = true;
+            }
+        }
+    }
+
+    return -1;
+}
+
+bool BracketIndex::isTimeout() const
+{
+    return m_timer.isValid() && m_timer.elapsed() > m_timeBudget;
+}
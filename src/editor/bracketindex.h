@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BRACKETINDEX_H
+#define BRACKETINDEX_H
+
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+
+class QTextDocument;
+class QTextBlock;
+
+/**
+ * @brief 括号匹配索引
+ *      为每个文本块记录 ()、{}、[] 三类括号的深度摘要(净深度及最小深度)，字符串内的括号不计入统计。
+ *      查找匹配括号时整块跳过不包含匹配位置的文本块，耗时和两个括号之间的文本块数量相关；
+ *      文本块内容变更时仅失效对应的摘要，在下次查找时重新计算。超长行内仅在起始括号之后(之前)的固定长度分段内查找。
+ */
+class BracketIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 支持摘要的括号类型
+    enum BracketType {
+        RoundBracket = 0,   ///< ()
+        CurlyBracket,       ///< {}
+        SquareBracket,      ///< []
+        BracketTypeCount
+    };
+
+    explicit BracketIndex(QTextDocument *document, QObject *parent = nullptr);
+
+    // 从 position 开始查找匹配的括号(起始括号需已跳过)，forward 为 true 时向后查找 closeChar，
+    // 否则向前查找 openChar，未找到或超出耗时上限时返回 -1
+    int findMatchingBracket(int position, const QChar &openChar, const QChar &closeChar, bool forward);
+    // 设置单次查找的耗时上限(ms)
+    void setTimeBudget(int ms);
+    // 清空所有文本块摘要
+    void clear();
+
+    // 取得括号类型，不支持的括号返回 -1
+    static int bracketType(const QChar &openChar, const QChar &closeChar);
+
+public slots:
+    // 文档内容变更时失效对应文本块的摘要
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+
+private:
+    // 单向扫描文本块得到的括号深度摘要，深度以查找方向的起始括号为正
+    struct Summary {
+        qint16 net[BracketTypeCount];   ///< 扫描完成后的深度变化
+        qint16 min[BracketTypeCount];   ///< 扫描过程中的最小深度变化
+        bool endInString;               ///< 扫描结束时是否处于字符串内
+    };
+
+    struct BlockEntry {
+        int revision = -1;              ///< 计算摘要时的文本块版本
+        int length = -1;                ///< 计算摘要时的文本块长度
+        bool overflow = false;          ///< 深度超出记录范围，需逐字符扫描
+        Summary summary[2][2];          ///< [是否向后扫描][扫描开始时是否处于字符串内]
+    };
+
+    // 逐字符扫描的状态
+    struct ScanState {
+        int depth;
+        bool inString;
+    };
+
+    // 取得文本块摘要，摘要失效时重新计算
+    const BlockEntry &blockEntry(const QTextBlock &block);
+    static void computeEntry(const QString &text, BlockEntry &entry);
+    static bool computeSummary(const QString &text, bool forward, bool startInString, Summary &summary);
+    // 从 text 的 from 位置开始逐字符扫描，找到匹配括号时返回其在 text 中的位置，否则返回 -1 并更新扫描状态
+    int scanText(const QString &text, int from, bool forward, const QChar &begin, const QChar &end, ScanState &state) const;
+    bool isTimeout() const;
+
+private:
+    QTextDocument *m_document = nullptr;
+    QVector<BlockEntry> m_entries;      ///< 按文本块序号记录的摘要
+    int m_timeBudget;                   ///< 单次查找耗时上限(ms)
+    QElapsedTimer m_timer;              ///< 单次查找计时
+};
+
+#endif  // BRACKETINDEX_H
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "digitglyphatlas.h"
+
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QtMath>
+
+// 最多缓存的图集数量，超出时清空重建(字体、颜色及缩放变化时才会生成新的图集)
+static const int s_maxAtlasCount = 32;
+
+DigitGlyphAtlas::DigitGlyphAtlas()
+{
+}
+
+/**
+ * @brief 按数字位数计算总宽度后居中，逐位从图集中拷贝字形绘制到 \a rect 内
+ */
+void DigitGlyphAtlas::drawNumber(QPainter *painter, const QRect &rect, int number, const QFont &font, const QColor &color)
+{
+    if (number < 0) {
+        return;
+    }
+
+    const Atlas &glyphs = atlas(font, color, painter->device() ? painter->device()->devicePixelRatioF() : 1.0);
+
+    int digits[16];
+    int count = 0;
+    do {
+        digits[count++] = number % 10;
+        number /= 10;
+    } while (number > 0 && count < 16);
+
+    qreal width = 0;
+    for (int i = 0; i < count; i++) {
+        width += glyphs.advances[digits[i]];
+    }
+
+    // 对齐到设备像素，避免拷贝时插值导致字形模糊
+    qreal x = rect.x() + (rect.width() - width) / 2;
+    qreal y = rect.y() + (rect.height() - glyphs.height) / 2.0;
+    x = qRound(x * glyphs.dpr) / glyphs.dpr;
+    y = qRound(y * glyphs.dpr) / glyphs.dpr;
+
+    for (int i = count - 1; i >= 0; i--) {
+        const int digit = digits[i];
+        const qreal advance = glyphs.advances[digit];
+        const QRectF source(digit * glyphs.cellWidth * glyphs.dpr, 0, advance * glyphs.dpr, glyphs.height * glyphs.dpr);
+        painter->drawPixmap(QRectF(x, y, advance, glyphs.height), glyphs.pixmap, source);
+        x += advance;
+    }
+}
+
+void DigitGlyphAtlas::clear()
+{
+    m_atlases.clear();
+}
+
+int DigitGlyphAtlas::atlasCount() const
+{
+    return m_atlases.size();
+}
+
+const DigitGlyphAtlas::Atlas &DigitGlyphAtlas::atlas(const QFont &font, const QColor &color, qreal dpr)
+{
+    const QString key = QString("%1|%2|%3").arg(font.key()).arg(color.rgba()).arg(dpr);
+    auto itr = m_atlases.constFind(key);
+    if (itr != m_atlases.constEnd()) {
+        return itr.value();
+    }
+
+    if (m_atlases.size() >= s_maxAtlasCount) {
+        m_atlases.clear();
+    }
+
+    return m_atlases.insert(key, createAtlas(font, color, dpr)).value();
+}
+
+DigitGlyphAtlas::Atlas DigitGlyphAtlas::createAtlas(const QFont &font, const QColor &color, qreal dpr)
+{
+    Atlas glyphs;
+    glyphs.dpr = dpr;
+
+    QFontMetricsF metrics(font);
+    for (int digit = 0; digit < 10; digit++) {
+        glyphs.advances[digit] = metrics.horizontalAdvance(QChar('0' + digit));
+        glyphs.cellWidth = qMax(glyphs.cellWidth, glyphs.advances[digit]);
+    }
+    // 预留字形越过步进宽度的部分
+    glyphs.cellWidth = qCeil(glyphs.cellWidth) + 1;
+    glyphs.height = qCeil(metrics.height());
+
+    glyphs.pixmap = QPixmap(qCeil(glyphs.cellWidth * 10 * dpr), qCeil(glyphs.height * dpr));
+    glyphs.pixmap.setDevicePixelRatio(dpr);
+    glyphs.pixmap.fill(Qt::transparent);
+
+    QPainter painter(&glyphs.pixmap);
+    painter.setRenderHint(QPainter::TextAntialiasing, true);
+    painter.setFont(font);
+    painter.setPen(color);
+    for (int digit = 0; digit < 10; digit++) {
+        painter.drawText(QPointF(digit * glyphs.cellWidth, metrics.ascent()), QString(QChar('0' + digit)));
+    }
+
+    return glyphs;
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIGITGLYPHATLAS_H
+#define DIGITGLYPHATLAS_H
+
+#include <QHash>
+#include <QPixmap>
+#include <QFont>
+#include <QColor>
+
+class QPainter;
+
+/**
+ * @brief 数字字形图集
+ *      按字体、颜色及设备像素比预先将 0~9 绘制到同一张图片中，绘制行号时逐位拷贝图集中的字形，
+ *      避免每行构造字符串并进行文本排版。
+ */
+class DigitGlyphAtlas
+{
+public:
+    DigitGlyphAtlas();
+
+    // 在 rect 内水平、垂直居中绘制非负整数 number，效果和 drawText(AlignCenter) 一致
+    void drawNumber(QPainter *painter, const QRect &rect, int number, const QFont &font, const QColor &color);
+    // 清空所有图集
+    void clear();
+    // 当前缓存的图集数量
+    int atlasCount() const;
+
+private:
+    struct Atlas {
+        QPixmap pixmap;         ///< 0~9 字形，每个字形占用 cellWidth 宽度
+        qreal advances[10];     ///< 每个数字的宽度
+        qreal cellWidth = 0;    ///< 图集中单个字形的宽度
+        int height = 0;         ///< 字形高度
+        qreal dpr = 1.0;        ///< 设备像素比
+    };
+
+    const Atlas &atlas(const QFont &font, const QColor &color, qreal dpr);
+    static Atlas createAtlas(const QFont &font, const QColor &color, qreal dpr);
+
+private:
+    QHash<QString, Atlas> m_atlases;    ///< 按字体、颜色及设备像素比缓存的图集
+};
+
+#endif  // DIGITGLYPHATLAS_H
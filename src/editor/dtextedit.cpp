@@ -4,6 +4,8 @@
 
 
 #include "../common/utils.h"
+#include "../common/performancemonitor.h"
+#include "../common/syntaxrepository.h"
 #include "../widgets/window.h"
 #include "../widgets/bottombar.h"
 #include "dtextedit.h"
@@ -14,9 +16,16 @@
 #include "replaceallcommond.h"
 #include "insertblockbytextcommond.h"
 #include "indenttextcommond.h"
+#include "lineblockcommand.h"
 #include "undolist.h"
 #include "changemarkcommand.h"
 #include "endlineformatcommond.h"
+#include "matchintervalindex.h"
+#include "selectionoverlay.h"
+#include "bracketindex.h"
+#include "foldregionindex.h"
+#include "digitglyphatlas.h"
+#include "latencyoverlay.h"
 
 #include <KSyntaxHighlighting/definition.h>
 #include <KSyntaxHighlighting/syntaxhighlighter.h>
@@ -40,6 +49,7 @@
 #include <QTextBlock>
 #include <QMimeData>
 #include <QTimer>
+#include <QSet>
 #include <QGesture>
 #include <QStyleHints>
 #include <DSysInfo>
@@ -54,9 +64,6 @@ TextEdit::TextEdit(QWidget *parent)
     : DPlainTextEdit(parent),
       m_wrapper(nullptr)
 {
-    // 更新单独添加的高亮格式文件
-    m_repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
-
     setUndoRedoEnabled(false);
     //撤销重做栈
     m_pUndoStack = new QUndoStack();
@@ -100,18 +107,57 @@ TextEdit::TextEdit(QWidget *parent)
     // Init widgets.
     //左边栏控件　滑动条滚动跟新行号 折叠标记
     connect(this->verticalScrollBar(), &QScrollBar::valueChanged, this, &TextEdit::slotValueChanged);
-    connect(this, &QPlainTextEdit::textChanged, this, &TextEdit::updateLeftAreaWidget);
     connect(this, &QPlainTextEdit::textChanged, this, [this]() {
+        // 文本变更处理耗时，字体、缩放等其它途径调用的 updateLeftAreaWidget 不计入
+        PerformanceMonitor::LatencyScope latency(PerformanceMonitor::TextChanged);
+        this->updateLeftAreaWidget();
         this->m_wrapper->UpdateBottomBarWordCnt(this->characterCount());
     });
 
     connect(this, &QPlainTextEdit::cursorPositionChanged, this, &TextEdit::cursorPositionChanged);
+    // 光标移动引起的界面更新按帧合并执行
+    m_frameUpdateTimer = new QTimer(this);
+    m_frameUpdateTimer->setSingleShot(true);
+    m_frameUpdateTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameUpdateTimer, &QTimer::timeout, this, &TextEdit::flushFrameUpdate);
+    // 字体变更后剩余文本块的行数在事件循环空闲时计算
+    m_relayoutTimer = new QTimer(this);
+    m_relayoutTimer->setSingleShot(true);
+    m_relayoutTimer->setInterval(0);
+    connect(m_relayoutTimer, &QTimer::timeout, this, &TextEdit::continueProgressiveRelayout);
     connect(this, &QPlainTextEdit::selectionChanged, this, &TextEdit::onSelectionArea);
 
     connect(document(), &QTextDocument::contentsChange, this, &TextEdit::updateMark);
     connect(document(), &QTextDocument::contentsChange, this, &TextEdit::checkBookmarkLineMove);
     connect(document(), &QTextDocument::contentsChange, this, &TextEdit::onTextContentChanged);
 
+    // 全文标记及查找关键字的匹配区间索引，根据文档变更增量修正
+    m_pMatchIndex = new MatchIntervalIndex(document(), this);
+    connect(document(), &QTextDocument::contentsChange, m_pMatchIndex, &MatchIntervalIndex::onContentsChange);
+    // 滚动条标注，在匹配区间索引修正后计算，文档变更时仅重新计算变更行所在的区间
+    m_pScrollBarAnnotation = new ScrollBarAnnotation(this, [this]() {
+        return scrollBarAnnotationSources();
+    });
+    connect(m_pMatchIndex, &MatchIntervalIndex::indexReady, m_pScrollBarAnnotation, &ScrollBarAnnotation::invalidate);
+    // 后台构建完成后通过索引刷新可视区域内的标记及查找高亮
+    connect(m_pMatchIndex, &MatchIntervalIndex::indexReady, this, &TextEdit::onMatchIndexReady);
+    m_pSelectionOverlay.reset(new SelectionOverlay);
+    // 耗时统计浮层，通过隐藏快捷键或环境变量开启
+    m_pLatencyOverlay = new LatencyOverlay(viewport());
+    m_pLatencyOverlay->setVisible(PerformanceMonitor::latencyOverlayEnabled());
+    m_pLineNumberAtlas.reset(new DigitGlyphAtlas);
+    // 括号匹配索引，文本块内容变更时失效对应的摘要
+    m_pBracketIndex = new BracketIndex(document(), this);
+    connect(document(), &QTextDocument::contentsChange, m_pBracketIndex, &BracketIndex::onContentsChange);
+    // 代码折叠区域索引，文档变更时仅重新计算变更的行
+    m_pFoldRegionIndex = new FoldRegionIndex(document(), this);
+    connect(document(), &QTextDocument::contentsChange, m_pFoldRegionIndex, &FoldRegionIndex::onContentsChange);
+    // 后台构建完成前折叠区域查询不阻塞界面，完成后刷新折叠区域相关的绘制
+    connect(m_pFoldRegionIndex, &FoldRegionIndex::regionsReady, this, [this]() {
+        m_pLeftAreaWidget->m_pFlodArea->update();
+        viewport()->update();
+    });
+
     connect(m_pUndoStack, &QUndoStack::canRedoChanged, this, &TextEdit::slotCanRedoChanged);
     connect(m_pUndoStack, &QUndoStack::canUndoChanged, this, &TextEdit::slotCanUndoChanged);
 
@@ -478,7 +524,7 @@ void TextEdit::popRightMenu(QPoint pos)
     }
 
     // intelligent judge whether to support comments.
-    const auto def = m_repository.definitionForFileName(QFileInfo(m_sFilePath).fileName());
+    const auto def = SyntaxRepository::instance()->definitionForFileName(QFileInfo(m_sFilePath).fileName());
     if (characterCount() &&
             (textCursor().hasSelection() || !isBlankLine) &&
             !def.filePath().isEmpty()) {
@@ -958,69 +1004,14 @@ void TextEdit::openNewlineBelow()
     this->setTextCursor(cursor);
 }
 
-/*
- * swap tow lines.
- * firstly,combine the contents of the current line with the contents of the previous or next line.
- * then,insert the combined content.
- * */
-void TextEdit::moveLineDownUp(bool up)
-{
-    if (up) {
-        QTextCursor cursor = this->textCursor();
-        //current line isn't the first line of this document
-        if (0 != cursor.blockNumber()) {
-            int startpos = 0;
-            int endpos = 0;
-            cursor.movePosition(QTextCursor::StartOfLine);
-            cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-            endpos = cursor.position();
-            QString curtext = cursor.selectedText();
-
-            cursor.movePosition(QTextCursor::PreviousBlock);
-            startpos = cursor.position();
-            cursor.movePosition(QTextCursor::StartOfLine);
-            cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-            QString uptext = cursor.selectedText();
-
-            cursor.setPosition(startpos);
-            cursor.setPosition(endpos, QTextCursor::KeepAnchor);
-            InsertTextUndoCommand *com = new InsertTextUndoCommand(cursor, curtext + "\n" + uptext, this);
-            m_pUndoStack->push(com);
-
-            //ensure that this operation can be performed multiple times in succession.
-            //and make the vertical scroll bar change together at the same time.
-            cursor.setPosition(startpos);
-            this->setTextCursor(cursor);
-        }
-    } else {
-        QTextCursor cursor = this->textCursor();
-        //current line isn't the last line of this document
-        if (cursor.blockNumber() + 1 != this->document()->blockCount()) {
-            int startpos = 0;
-            int endpos = 0;
-            cursor.movePosition(QTextCursor::StartOfLine);
-            startpos = cursor.position();
-            cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-            QString curtext = cursor.selectedText();
-
-            cursor.movePosition(QTextCursor::NextBlock);
-            cursor.movePosition(QTextCursor::StartOfLine);
-            cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-            endpos = cursor.position();
-            QString downtext = cursor.selectedText();
-
-            cursor.setPosition(startpos);
-            cursor.setPosition(endpos, QTextCursor::KeepAnchor);
-            InsertTextUndoCommand *com = new InsertTextUndoCommand(cursor, downtext + "\n" + curtext, this);
-            m_pUndoStack->push(com);
-
-            //make the vertical scroll bar change together.
-            cursor.setPosition(endpos);
-            this->setTextCursor(cursor);
-        }
+/**
+ * @brief 选中的行整体上移或下移一行，仅移动相邻的一行文本，在同一编辑块内执行
+ */
+void TextEdit::moveLineDownUp(bool up, bool merge)
+{
+    if (LineBlockCommand *command = LineBlockCommand::moveLines(this, up, merge)) {
+        m_pUndoStack->push(command);
     }
-
-
 }
 
 void TextEdit::scrollLineUp()
@@ -1111,25 +1102,14 @@ void TextEdit::scrollDown()
     }
 }
 
-/*
- * copy the current line
- * firstly,get the text of current line.
- * then,insert the text with '\n' at the end of current line.
- * */
-void TextEdit::duplicateLine()
+/**
+ * @brief 在选中的行之后插入选中行的副本，光标随之移至副本
+ */
+void TextEdit::duplicateLine(bool merge)
 {
-    auto cursor = textCursor();
-    cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::MoveAnchor);
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    auto text = cursor.selectedText();
-
-    text = "\n" + text;
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::MoveAnchor);
-    auto com = new InsertTextUndoCommand(cursor, text, this);
-    m_pUndoStack->push(com);
-
-    //make the vertical scroll bar change together.
-    this->setTextCursor(cursor);
+    if (LineBlockCommand *command = LineBlockCommand::duplicateLines(this, merge)) {
+        m_pUndoStack->push(command);
+    }
 }
 
 void TextEdit::copyLines()
@@ -1211,27 +1191,10 @@ void TextEdit::cutlines()
     }
 }
 
-void TextEdit::joinLines()
+void TextEdit::joinLines(bool merge)
 {
-    QTextCursor cursor = this->textCursor();
-    //the current line isn't the last line of text.
-    if (cursor.blockNumber() + 1 != this->document()->blockCount()) {
-        int startpos = 0;
-        int endpos = 0;
-        cursor.movePosition(QTextCursor::EndOfBlock);
-        startpos = cursor.position();
-        cursor.movePosition(QTextCursor::NextBlock);
-        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-        endpos = cursor.position();
-        QString t = cursor.selectedText();
-
-        cursor.setPosition(startpos);
-        cursor.setPosition(endpos, QTextCursor::KeepAnchor);
-        auto com = new InsertTextUndoCommand(cursor, t, this);
-        m_pUndoStack->push(com);
-
-        cursor.setPosition(startpos);
-        this->setTextCursor(cursor);
+    if (LineBlockCommand *command = LineBlockCommand::joinLines(this, merge)) {
+        m_pUndoStack->push(command);
     }
 }
 
@@ -1327,56 +1290,41 @@ void TextEdit::indentText()
 {
     auto cursor = this->textCursor();
     if (cursor.hasSelection()) {
-        //calculate the start postion and the end postion of current selection.
-        int pos1 = cursor.position();
-        int pos2 = cursor.anchor();
-        if (pos1 > pos2)
-            std::swap(pos1, pos2);
-
         //calculate the start line and end line of current selection.
-        cursor.setPosition(pos1);
-        int line1 = cursor.blockNumber();
-        cursor.setPosition(pos2);
-        int line2 = cursor.blockNumber();
+        const int line1 = document()->findBlock(cursor.selectionStart()).blockNumber();
+        const int line2 = document()->findBlock(cursor.selectionEnd()).blockNumber();
 
         //do the indent operation
-        auto com = new IndentTextCommand(this, pos1, pos2, line1, line2);
+        auto com = new IndentTextCommand(this, line1, line2);
         m_pUndoStack->push(com);
     }
 }
 
+/**
+ * @brief 取消选中的行(无选中时为当前行)的缩进，每行删除一个制表符或最多 m_tabSpaceNumber 个空格，
+ *      所有行作为一次编辑执行
+ */
 void TextEdit::unindentText()
 {
     QTextCursor cursor = this->textCursor();
-    cursor.movePosition(QTextCursor::StartOfBlock);
-    int pos = cursor.position();
-    cursor.setPosition(cursor.position() + 1, QTextCursor::KeepAnchor);
+    const int line1 = document()->findBlock(cursor.selectionStart()).blockNumber();
+    const int line2 = document()->findBlock(cursor.selectionEnd()).blockNumber();
 
-    //the text in front of current line is '\t'.
-    if ("\t" == cursor.selectedText()) {
-        DeleteBackCommand *com = new DeleteBackCommand(cursor, this);
-        m_pUndoStack->push(com);
-    }
-    //the text in front of current line is ' '.
-    else if (" " == cursor.selectedText()) {
-        int startpos = pos;
-        int cnt = 0;
-        // calculate the number of ' '.
-        while (document()->characterAt(pos) == ' ' && cnt < m_tabSpaceNumber) {
-            pos++;
-            cnt++;
-        }
-        cursor.setPosition(startpos);
-        cursor.setPosition(pos, QTextCursor::KeepAnchor);
-        DeleteBackCommand *com = new DeleteBackCommand(cursor, this);
+    auto com = new IndentTextCommand(this, line1, line2, true, m_tabSpaceNumber);
+    if (com->hasChange()) {
         m_pUndoStack->push(com);
-
+    } else {
+        delete com;
     }
-
 }
 
 void TextEdit::setTabSpaceNumber(int number)
 {
+    // 未变化时不重新布局
+    if (m_tabSpaceNumber == number) {
+        return;
+    }
+
     m_tabSpaceNumber = number;
     updateFont();
     //updateLineNumber();
@@ -1441,6 +1389,8 @@ void TextEdit::slotValueChanged(int iValue)
     }
 
     this->updateLeftAreaWidget();
+    // 滚动后更新裁剪的扩展选区
+    updateVisibleSelections();
 }
 
 void TextEdit::convertWordCase(ConvertCase convertCase)
@@ -1578,16 +1528,64 @@ void TextEdit::scrollToLine(int scrollOffset, int row, int column)
 
 void TextEdit::setLineWrapMode(bool enable)
 {
+    // 超长行模式下保持自动换行
+    enable = enable || m_longLineMode;
+    this->setWordWrapMode(QTextOption::WrapAnywhere);
+    // 换行模式未变化时不重新布局，也不跳转光标
+    const QPlainTextEdit::LineWrapMode mode = enable ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap;
+    if (lineWrapMode() == mode) {
+        return;
+    }
+
     QTextCursor cursor = textCursor();
     int nJumpLine = textCursor().blockNumber() + 1;
-    this->setWordWrapMode(QTextOption::WrapAnywhere);
-    QPlainTextEdit::setLineWrapMode(enable ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+    QPlainTextEdit::setLineWrapMode(mode);
     m_pLeftAreaWidget->m_pLineNumberArea->update();
     m_pLeftAreaWidget->m_pFlodArea->update();
     m_pLeftAreaWidget->m_pBookMarkArea->update();
 
     jumpToLine(nJumpLine, false);
     setTextCursor(cursor);
+    // 切换为自动换行后文本块的行数均重置为1，按时间片重新计算
+    startProgressiveRelayout();
+}
+
+/**
+ * @brief 超长行不换行时需要水平滚动到数百万像素之外，强制自动换行，超长行按窗口宽度分为多个可视行。
+ *      文本块不拆分，保存、查找及行号仍按逻辑行处理；文本块的布局仍覆盖整行，布局耗时和行长度相关。
+ *      超长行模式仅在文件加载完成时检测(detectLongLines())，编辑后不会自动退出
+ */
+void TextEdit::setLongLineMode(bool enable)
+{
+    if (m_longLineMode == enable) {
+        return;
+    }
+
+    m_longLineMode = enable;
+    bool wrap = enable;
+    if (!enable && m_settings) {
+        wrap = m_settings->settings->option("base.font.wordwrap")->value().toBool();
+    }
+    setLineWrapMode(wrap);
+}
+
+bool TextEdit::isLongLineMode() const
+{
+    return m_longLineMode;
+}
+
+bool TextEdit::detectLongLines()
+{
+    bool found = false;
+    for (QTextBlock block = document()->firstBlock(); block.isValid() && !found; block = block.next()) {
+        found = block.length() - 1 > LONG_LINE_THRESHOLD;
+    }
+
+    if (found && !m_longLineMode) {
+        qInfo() << "Long line detected, enable long line mode.";
+    }
+    setLongLineMode(found);
+    return found;
 }
 
 void TextEdit::setFontFamily(QString name)
@@ -1608,6 +1606,86 @@ void TextEdit::setFontSize(qreal size)
     updateLeftAreaWidget();
 }
 
+/**
+ * @brief 字体及字号仅设置一次，可视区域在绘制时立即布局，其余文本块按时间片布局
+ */
+void TextEdit::applyFont(const QString &fontName, qreal fontSize)
+{
+    if (m_fontName == fontName && qFuzzyCompare(m_fontSize, fontSize)) {
+        return;
+    }
+
+    m_fontName = fontName;
+    m_fontSize = fontSize;
+    updateFont();
+    updateLeftAreaWidget();
+    startProgressiveRelayout();
+}
+
+/**
+ * @brief 字体变更后 QPlainTextDocumentLayout::documentChanged() 清除各文本块的布局并将行数重置为 1，
+ *      自动换行时滚动条范围偏小，直到各文本块重新布局。可视区域的文本块在绘制时布局，
+ *      从可视区域开始向后、再从文档开头至可视区域按时间片计算其余文本块的行数
+ */
+void TextEdit::startProgressiveRelayout()
+{
+    if (QPlainTextEdit::NoWrap == lineWrapMode()) {
+        m_relayoutNext = -1;
+        m_relayoutTimer->stop();
+        return;
+    }
+
+    m_relayoutStart = firstVisibleBlock().blockNumber();
+    m_relayoutNext = qMax(0, m_relayoutStart);
+    m_relayoutWrapped = false;
+    m_relayoutTimer->start();
+}
+
+void TextEdit::continueProgressiveRelayout()
+{
+    // 单次计算的时间片(ms)，超出后让出事件循环处理输入及绘制
+    static const int s_relayoutBudget = 4;
+
+    if (m_relayoutNext < 0 || QPlainTextEdit::NoWrap == lineWrapMode()) {
+        m_relayoutNext = -1;
+        return;
+    }
+
+    QAbstractTextDocumentLayout *layout = document()->documentLayout();
+    QElapsedTimer timer;
+    timer.start();
+    QTextBlock block = document()->findBlockByNumber(m_relayoutNext);
+    while (timer.elapsed() < s_relayoutBudget) {
+        if (!block.isValid()) {
+            if (m_relayoutWrapped) {
+                break;
+            }
+            m_relayoutWrapped = true;
+            block = document()->firstBlock();
+        }
+        if (m_relayoutWrapped && block.blockNumber() >= m_relayoutStart) {
+            block = QTextBlock();
+            break;
+        }
+
+        // 未布局的文本块将重新布局并更新行数
+        if (block.isVisible()) {
+            layout->blockBoundingRect(block);
+        }
+        block = block.next();
+    }
+
+    // 通知编辑器按新的行数更新滚动条，编辑器保持首个可视文本块不变
+    emit layout->documentSizeChanged(layout->documentSize());
+
+    if (block.isValid() || !m_relayoutWrapped) {
+        m_relayoutNext = block.isValid() ? block.blockNumber() : document()->blockCount();
+        m_relayoutTimer->start();
+    } else {
+        m_relayoutNext = -1;
+    }
+}
+
 void TextEdit::updateFont()
 {
     QFont font = document()->defaultFont();
@@ -1852,6 +1930,7 @@ void TextEdit::removeKeywords()
     m_findHighlightSelection.cursor.clearSelection();
 
     m_findMatchSelections.clear();
+    setFindIndexKeyword(QString(), Qt::CaseInsensitive);
 
     updateHighlightLineSelection();
 
@@ -1864,6 +1943,7 @@ bool TextEdit::highlightKeyword(const QString &keyword, int position, Qt::CaseSe
 {
     Q_UNUSED(position)
     m_findMatchSelections.clear();
+    setFindIndexKeyword(keyword, caseFlag);
     updateHighlightLineSelection();
     updateCursorKeywordSelection(keyword, true);
     bool bRet = updateKeywordSelectionsInView(keyword, m_findMatchFormat, &m_findMatchSelections, caseFlag);
@@ -1875,6 +1955,7 @@ bool TextEdit::highlightKeyword(const QString &keyword, int position, Qt::CaseSe
 bool TextEdit::highlightKeywordInView(const QString &keyword, Qt::CaseSensitivity caseFlag)
 {
     m_findMatchSelections.clear();
+    setFindIndexKeyword(keyword, caseFlag);
     bool bRet = updateKeywordSelectionsInView(keyword, m_findMatchFormat, &m_findMatchSelections, caseFlag);
     // 直接设置 setExtraSelections 会导致无法显示颜色标记，调用 renderAllSelections 进行显示更新
     // setExtraSelections(m_findMatchSelections);
@@ -1963,19 +2044,14 @@ bool TextEdit::updateKeywordSelectionsInView(QString keyword, QTextCharFormat ch
         QTextEdit::ExtraSelection extra;
         extra.format = charFormat;
 
-        QScrollBar *pScrollBar = verticalScrollBar();
-        QPoint startPoint = QPointF(0, 0).toPoint();
-        QTextBlock beginBlock = cursorForPosition(startPoint).block();
-        int beginPos = beginBlock.position();
-        QTextBlock endBlock;
+        int beginPos = 0;
+        int endPos = 0;
+        getVisibleDocumentRange(beginPos, endPos);
 
-        if (pScrollBar->maximum() > 0) {
-            QPoint endPoint = QPointF(0, 1.5 * height()).toPoint();
-            endBlock = cursorForPosition(endPoint).block();
-        } else {
-            endBlock = document()->lastBlock();
+        // 索引已构建完成时，直接查询可视区域内的匹配项
+        if (m_pMatchIndex->isReady(keyword, caseFlag)) {
+            return updateKeywordSelectionsFromIndex(keyword, charFormat, listSelection, beginPos, endPos, caseFlag);
         }
-        int endPos = endBlock.position() + endBlock.length() - 1;
 
         // 内部计算时，均视为 \n 结尾
         QLatin1Char endLine('\n');
@@ -2029,6 +2105,200 @@ bool TextEdit::updateKeywordSelectionsInView(QString keyword, QTextCharFormat ch
     return false;
 }
 
+void TextEdit::getVisibleDocumentRange(int &beginPos, int &endPos)
+{
+    QTextBlock beginBlock = cursorForPosition(QPoint(0, 0)).block();
+    QTextBlock endBlock;
+
+    if (verticalScrollBar()->maximum() > 0) {
+        QPoint endPoint = QPointF(0, 1.5 * height()).toPoint();
+        endBlock = cursorForPosition(endPoint).block();
+    } else {
+        endBlock = document()->lastBlock();
+    }
+
+    beginPos = beginBlock.position();
+    endPos = endBlock.position() + endBlock.length() - 1;
+}
+
+/**
+ * @brief 通过匹配区间索引计算 [ \a beginPos , \a endPos ] 范围内的关键字高亮，
+ *      耗时仅和范围内的匹配数量相关，和文档大小无关
+ * @return 和直接查找一致，从 \a beginPos 开始是否查找到匹配的关键字
+ */
+bool TextEdit::updateKeywordSelectionsFromIndex(const QString &keyword, const QTextCharFormat &charFormat,
+                                                QList<QTextEdit::ExtraSelection> *listSelection,
+                                                int beginPos, int endPos, Qt::CaseSensitivity caseFlag)
+{
+    listSelection->clear();
+
+    const QVector<int> starts = m_pMatchIndex->matchesInRange(keyword, beginPos, endPos + 1, caseFlag);
+    QTextEdit::ExtraSelection extra;
+    extra.format = charFormat;
+    for (int start : starts) {
+        extra.cursor = QTextCursor(document());
+        extra.cursor.setPosition(start);
+        extra.cursor.setPosition(start + keyword.size(), QTextCursor::KeepAnchor);
+        listSelection->append(extra);
+    }
+
+    return m_pMatchIndex->hasMatchInRange(keyword, beginPos, document()->characterCount(), caseFlag);
+}
+
+/**
+ * @brief 关键字 \a keyword 的索引构建完成，此前可视区域内的标记及查找高亮通过直接查找计算，
+ *      改为从索引刷新
+ */
+void TextEdit::onMatchIndexReady(const QString &keyword)
+{
+    for (const auto &markOperation : m_markOperations) {
+        if (MarkAllMatch == markOperation.first.type
+                && MatchIntervalIndex::normalizeText(markOperation.first.matchText) == keyword) {
+            markAllKeywordInView();
+            break;
+        }
+    }
+
+    if (!m_findMatchSelections.isEmpty() && MatchIntervalIndex::normalizeText(m_findIndexKeyword) == keyword) {
+        updateKeywordSelectionsInView(m_findIndexKeyword, m_findMatchFormat, &m_findMatchSelections, m_findIndexCaseFlag);
+        renderAllSelections();
+    }
+}
+
+/**
+ * @brief 同步匹配区间索引中的关键字，仅保留全文标记(MarkAllMatch)及当前查找使用的关键字
+ */
+void TextEdit::syncMatchIndexKeywords()
+{
+    QSet<MatchIntervalIndex::IndexKey> usedKeys;
+    for (auto &markOperation : m_markOperations) {
+        if (MarkAllMatch == markOperation.first.type && !markOperation.first.matchText.isEmpty()) {
+            usedKeys.insert(MatchIntervalIndex::makeKey(markOperation.first.matchText, Qt::CaseInsensitive));
+        }
+    }
+    if (!m_findIndexKeyword.isEmpty()) {
+        usedKeys.insert(MatchIntervalIndex::makeKey(m_findIndexKeyword, m_findIndexCaseFlag));
+    }
+
+    for (auto &key : m_pMatchIndex->keys()) {
+        if (!usedKeys.contains(key)) {
+            m_pMatchIndex->removeKeyword(key.first, static_cast<Qt::CaseSensitivity>(key.second));
+            m_keywordViewCache.remove(key.first);
+        }
+    }
+    for (auto &key : usedKeys) {
+        m_pMatchIndex->addKeyword(key.first, static_cast<Qt::CaseSensitivity>(key.second));
+    }
+}
+
+void TextEdit::setFindIndexKeyword(const QString &keyword, Qt::CaseSensitivity caseFlag)
+{
+    if (keyword == m_findIndexKeyword && caseFlag == m_findIndexCaseFlag) {
+        return;
+    }
+
+    m_findIndexKeyword = keyword;
+    m_findIndexCaseFlag = caseFlag;
+    syncMatchIndexKeywords();
+}
+
+/**
+ * @brief 取得滚动条标注的数据来源，全文标记及查找关键字通过匹配区间索引查询，
+ *      选中文本及整行的颜色标记使用标记光标的当前位置
+ */
+ScrollBarAnnotation::Sources TextEdit::scrollBarAnnotationSources() const
+{
+    ScrollBarAnnotation::Sources sources;
+    sources.matchIndex = m_pMatchIndex;
+    if (!m_findIndexKeyword.isEmpty()) {
+        ScrollBarAnnotation::KeywordSource source;
+        source.keyword = m_findIndexKeyword;
+        source.caseFlag = m_findIndexCaseFlag;
+        source.kind = ScrollBarAnnotation::FindMatch;
+        sources.keywords.append(source);
+    }
+
+    // 按时间戳顺序添加，后添加的标记颜色覆盖先添加的标记
+    for (const auto &markOperation : m_markOperations) {
+        const MarkOperation &operation = markOperation.first;
+        switch (operation.type) {
+        case MarkAll:
+            sources.markAllColor = QColor(operation.color);
+            break;
+        case MarkAllMatch:
+            if (!operation.matchText.isEmpty()) {
+                ScrollBarAnnotation::KeywordSource source;
+                source.keyword = operation.matchText;
+                source.kind = ScrollBarAnnotation::ColorMark;
+                source.color = QColor(operation.color);
+                sources.keywords.append(source);
+            }
+            break;
+        default: {
+            ScrollBarAnnotation::RangeSource range;
+            range.start = operation.cursor.selectionStart();
+            range.end = qMax(range.start + 1, operation.cursor.selectionEnd());
+            range.color = QColor(operation.color);
+            sources.ranges.append(range);
+            break;
+        }
+        }
+    }
+
+    // 书签记录的行号从1开始
+    sources.bookmarks.reserve(m_listBookmark.size());
+    for (int line : m_listBookmark) {
+        sources.bookmarks.append(line - 1);
+    }
+
+    return sources;
+}
+
+/**
+ * @brief 比较标注数据来源的特征值(不包含标记位置，位置随文档变更由变更区间更新)，变更时重新计算全部区间
+ */
+void TextEdit::syncScrollBarAnnotation()
+{
+    if (!m_pScrollBarAnnotation) {
+        return;
+    }
+
+    // 标记操作及书签列表未修改时(隐式共享数据相同)无需重新计算特征值
+    if (m_annotationSourcesSynced
+            && m_annotationMarkOperations.isSharedWith(m_markOperations)
+            && m_annotationBookmarks.isSharedWith(m_listBookmark)
+            && m_annotationFindKeyword == m_findIndexKeyword
+            && m_annotationFindCaseFlag == m_findIndexCaseFlag) {
+        return;
+    }
+    m_annotationMarkOperations = m_markOperations;
+    m_annotationBookmarks = m_listBookmark;
+    m_annotationFindKeyword = m_findIndexKeyword;
+    m_annotationFindCaseFlag = m_findIndexCaseFlag;
+    m_annotationSourcesSynced = true;
+
+    quint64 signature = qHash(m_findIndexKeyword) ^ static_cast<quint64>(m_findIndexCaseFlag);
+    auto mix = [&signature](quint64 value) {
+        signature = signature * 1099511628211ULL + value;
+    };
+    for (const auto &markOperation : m_markOperations) {
+        mix(static_cast<quint64>(markOperation.first.type));
+        mix(static_cast<quint64>(markOperation.second));
+        mix(qHash(markOperation.first.color));
+        mix(qHash(markOperation.first.matchText));
+    }
+    mix(static_cast<quint64>(m_markOperations.size()));
+    for (int line : m_listBookmark) {
+        mix(static_cast<quint64>(line));
+    }
+    mix(static_cast<quint64>(m_listBookmark.size()));
+
+    if (signature != m_annotationSourcesSignature) {
+        m_annotationSourcesSignature = signature;
+        m_pScrollBarAnnotation->invalidate();
+    }
+}
+
 bool TextEdit::searchKeywordSeletion(QString keyword, QTextCursor cursor, bool findNext)
 {
     if (keyword.isEmpty()) {
@@ -2077,81 +2347,106 @@ bool TextEdit::searchKeywordSeletion(QString keyword, QTextCursor cursor, bool f
     return ret;
 }
 
+/**
+ * @brief 更新各图层的扩展选区并刷新显示，图层内容未变化时不重新排序，
+ *      仅将和可视区域相交的选区设置到编辑器，避免全文标记时每次光标移动都重新排序及布局全文选区。
+ *      标记、查找结果等列表未修改时通过隐式共享判断，光标移动的耗时和标记数量无关
+ */
 void TextEdit::renderAllSelections()
 {
-    QList<QTextEdit::ExtraSelection> finalSelections;
-    QList<QPair<QTextEdit::ExtraSelection, qint64>> selectionsSortList;
-
     // 标记当前行的浅灰色
+    QList<QTextEdit::ExtraSelection> currentLineSelections;
     if (m_HightlightYes) {
-        finalSelections.append(m_currentLineSelection);
+        currentLineSelections.append(m_currentLineSelection);
     }
-    // 此处代码无作用，去除
-    // else {
-    //     selections.clear();
-    // }
+    m_pSelectionOverlay->setLayer(SelectionOverlay::CurrentLineLayer, currentLineSelections);
 
-    // 按代码逻辑，推测m_markAllSelection 用于还原所有文本的背景颜色, 实际不需要
-    // 考虑到各平台运行之间可能存在运行差异，暂不清除
-    // finalSelections.append(m_markAllSelection);
+    // 选中区域的颜色标记及标记所有，通过时间戳升序绘制，标记列表未修改时无需重新合并
+    if (!m_colorMarksRendered
+            || !m_renderedWordMarks.isSharedWith(m_wordMarkSelections)
+            || !m_renderedKeywordMarks.isSharedWith(m_mapKeywordMarkSelections)) {
+        m_renderedWordMarks = m_wordMarkSelections;
+        m_renderedKeywordMarks = m_mapKeywordMarkSelections;
+        m_colorMarksRendered = true;
 
-    // 选中区域的颜色标记，先加入 selectionsSortList
-    // 通过时间戳升序排序后，加入到 finalSelections 中
-    selectionsSortList.append(m_wordMarkSelections);
-
-    // Find 和 Replace 高亮选中，移动到最后放入到 finalSelections 中
-    // 保证此高亮状态，若存在，一定可以被用户看到
-    // selections.append(m_findMatchSelections);
-    // selections.append(m_findHighlightSelection);
-
-    // 不再使用，注释掉
-    // selections.append(m_wordUnderCursorSelection);
-
-    // 标记括号移动到处理完颜色标记后，插入到 finalSelections 中
-    // selections.append(m_beginBracketSelection);
-    // selections.append(m_endBracketSelection);
+        QList<QPair<QTextEdit::ExtraSelection, qint64>> colorMarkSelections = m_wordMarkSelections;
+        for (auto it = m_mapKeywordMarkSelections.constBegin(); it != m_mapKeywordMarkSelections.constEnd(); ++it) {
+            colorMarkSelections.append(it.value());
+        }
+        m_pSelectionOverlay->setLayer(SelectionOverlay::ColorMarkLayer, colorMarkSelections);
+    }
 
+    // 标记括号，处理完颜色标记后绘制
+    m_pSelectionOverlay->setLayer(SelectionOverlay::BracketLayer,
+                                  QList<QTextEdit::ExtraSelection>() << m_beginBracketSelection << m_endBracketSelection);
     // 仅对代码文件有效，标记代码中的代码段，例如函数内{}所有内容
-    // 移动到处理完颜色标记后，插入到 finalSelections 中，插入晚于括号
-    // selections.append(m_markFoldHighLightSelections);
+    m_pSelectionOverlay->setLayer(SelectionOverlay::FoldHighlightLayer, m_markFoldHighLightSelections);
+    // Alt选中区域的高亮
+    m_pSelectionOverlay->setLayer(SelectionOverlay::AltColumnLayer, m_altModSelections);
 
-    // Alt选中区域的高亮, 移动到排序后面加入
-    // selections.append(m_altModSelections);
+    // 查找替换的高亮需要放在最后，保证此高亮状态若存在，一定可以被用户看到
+    m_pSelectionOverlay->setLayer(SelectionOverlay::FindMatchLayer, m_findMatchSelections);
+    m_pSelectionOverlay->setLayer(SelectionOverlay::FindHighlightLayer,
+                                  QList<QTextEdit::ExtraSelection>() << m_findHighlightSelection);
 
-    // 将颜色标记，标记所有的 selections 加入到 selectionsSortList 中， 后边将进行排序
-    QMap<QString, QList<QPair<QTextEdit::ExtraSelection, qint64>>>::Iterator it;
-    for (it = m_mapKeywordMarkSelections.begin(); it != m_mapKeywordMarkSelections.end(); ++it) {
-        selectionsSortList.append(it.value());
-    }
+    updateVisibleSelections();
+    syncScrollBarAnnotation();
+}
 
-    // 通过时间戳重新排序颜色标记功能的 selections
-    std::sort(selectionsSortList.begin(), selectionsSortList.end(), [](const QPair<QTextEdit::ExtraSelection, qint64> &A, const QPair<QTextEdit::ExtraSelection, qint64> &B) {
-        return (A.second < B.second);
-    });
+/**
+ * @brief 取得扩展选区的裁剪范围，在可视区域前后各预留一定行数，
+ *      少量滚动或编辑时无需重新设置扩展选区
+ */
+void TextEdit::getSelectionCullingRange(int &beginPos, int &endPos)
+{
+    // 裁剪范围最少预留的行数
+    static const int s_minReserveLines = 100;
+    const int pageLines = qMax(s_minReserveLines, viewport()->height() / qMax(1, fontMetrics().height()));
 
-    // 将排序后的颜色标记 selections 加入到 finalSelections 中
-    for (int i = 0; i < selectionsSortList.size(); i++) {
-        finalSelections.append(selectionsSortList.at(i).first);
+    QTextBlock beginBlock = QPlainTextEdit::firstVisibleBlock();
+    if (!beginBlock.isValid()) {
+        beginBlock = document()->firstBlock();
     }
+    QTextBlock endBlock = beginBlock;
 
-    // 标记括号
-    finalSelections.append(m_beginBracketSelection);
-    finalSelections.append(m_endBracketSelection);
+    // 折叠隐藏的文本块不计入预留行数
+    for (int i = 0; i < pageLines && beginBlock.previous().isValid();) {
+        beginBlock = beginBlock.previous();
+        if (beginBlock.isVisible()) {
+            i++;
+        }
+    }
+    for (int i = 0; i < 2 * pageLines && endBlock.next().isValid();) {
+        endBlock = endBlock.next();
+        if (endBlock.isVisible()) {
+            i++;
+        }
+    }
 
-    // 标记代码段
-    finalSelections.append(m_markFoldHighLightSelections);
+    beginPos = beginBlock.position();
+    endPos = endBlock.position() + endBlock.length() - 1;
+}
 
-    // Alt选中区域的高亮
-    finalSelections.append(m_altModSelections);
+/**
+ * @brief 将和裁剪范围相交的扩展选区设置到编辑器，选区内容未变化时跳过。
+ *      在选区变更、滚动及尺寸变化时调用，不在绘制时调用(设置扩展选区会触发再次绘制)，
+ *      耗时仅和可视区域内的选区数量相关
+ */
+void TextEdit::updateVisibleSelections(bool force)
+{
+    int beginPos = 0;
+    int endPos = 0;
+    getSelectionCullingRange(beginPos, endPos);
 
-    // 查找替换的高亮需要放在最后
-    // Find 高亮
-    finalSelections.append(m_findMatchSelections);
-    // Replace 高亮
-    finalSelections.append(m_findHighlightSelection);
+    const QList<QTextEdit::ExtraSelection> selections = m_pSelectionOverlay->selectionsInRange(beginPos, endPos);
+    const quint64 signature = SelectionOverlay::signature(selections);
+    if (!force && signature == m_visibleSelectionsSignature) {
+        return;
+    }
 
+    m_visibleSelectionsSignature = signature;
     // 设置到 QPlainText 中进行渲染
-    setExtraSelections(finalSelections);
+    setExtraSelections(selections);
 }
 
 void TextEdit::updateMarkAllSelectColor()
@@ -2167,6 +2462,7 @@ DMenu *TextEdit::getHighlightMenu()
 
 void TextEdit::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
+    PerformanceMonitor::LatencyScope latency(PerformanceMonitor::LineNumberPaint);
     QPainter painter(m_pLeftAreaWidget->m_pLineNumberArea);
     QColor lineNumberAreaBackgroundColor;
 
@@ -2182,66 +2478,38 @@ void TextEdit::lineNumberAreaPaintEvent(QPaintEvent *event)
     }
     //painter.fillRect(event->rect(), lineNumberAreaBackgroundColor);
 
-    int blockNumber = getFirstVisibleBlockId();
-    QTextBlock block = document()->findBlockByNumber(blockNumber);
-
-    int top = this->viewport()->geometry().top() + verticalScrollBar()->value();
-    int bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
-
     Utils::setFontSize(painter, document()->defaultFont().pointSize() - 2);
-    QPoint endPoint;
-
-    if (verticalScrollBar()->maximum() > 0) {
-        endPoint = QPointF(0, height() + height() / verticalScrollBar()->maximum() * verticalScrollBar()->value()).toPoint();
-    }
+    m_fontLineNumberArea.setPointSize(font().pointSize() - 1);
+    painter.setFont(m_fontLineNumberArea);
 
-    QTextCursor cur = cursorForPosition(endPoint);
-    QTextBlock endBlock = cur.block();
-    int nPageLine = endBlock.blockNumber();
-    int nStartLine = block.blockNumber();
-
-    if (verticalScrollBar()->maximum() == 0) {
-        nPageLine = blockCount() - 1;
-    }
-
-    auto currentCursor = this->textCursor();
-    cur = textCursor();
-    for (int i = nStartLine; i <= nPageLine; i++) {
-        if (i + 1 == m_markStartLine) {
-            painter.setPen(m_regionMarkerColor);
-        } else {
-            painter.setPen(m_lineNumbersColor);
+    //the language currently set by the system is Tibetan.
+    const int offset = ("bo_CN" == Utils::getSystemLan()) ? 2 : 0;
+
+    // 可视区域文本块的位置由左侧区域每帧计算一次，不再逐行查询光标区域
+    const int currentBlockNumber = textCursor().blockNumber();
+    const int areaWidth = m_pLeftAreaWidget->m_pLineNumberArea->width();
+    const QColor highlightColor = qApp->palette().highlight().color();
+    for (const VisibleBlockGeometry &geometry : m_pLeftAreaWidget->visibleBlockGeometry()) {
+        if (!geometry.visible) {
+            continue;
         }
 
-        m_fontLineNumberArea.setPointSize(font().pointSize() - 1);
-        painter.setFont(m_fontLineNumberArea);
-
-        cur.setPosition(block.position(), QTextCursor::MoveAnchor);
-
-        if (block.isVisible()) {
-            int w = this->m_fontSize <= 15 ? 15 : m_fontSize;
-            updateLeftWidgetWidth(w);
-            int offset = 0;
-            //the language currently set by the system is Tibetan.
-            if ("bo_CN" == Utils::getSystemLan()) {
-                offset = 2;
-            }
-            if (cur.blockNumber() == currentCursor.blockNumber()) {
-                painter.setPen(qApp->palette().highlight().color());
-            }
-            painter.drawText(0, cursorRect(cur).y() + offset,
-                             m_pLeftAreaWidget->m_pLineNumberArea->width(), cursorRect(cur).height(),
-                             Qt::AlignVCenter | Qt::AlignHCenter, QString::number(block.blockNumber() + 1));
+        QColor color = m_lineNumbersColor;
+        if (geometry.blockNumber == currentBlockNumber) {
+            color = highlightColor;
+        } else if (geometry.blockNumber + 1 == m_markStartLine) {
+            color = m_regionMarkerColor;
         }
 
-        block = block.next();
-        top = bottom/* + document()->documentMargin()*/;
-        bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+        // 行号从预先绘制的数字图集中拷贝，无需每行构造字符串及排版
+        m_pLineNumberAtlas->drawNumber(&painter, QRect(0, geometry.y + offset, areaWidth, geometry.height),
+                                       geometry.blockNumber + 1, m_fontLineNumberArea, color);
     }
 }
 
 void TextEdit::codeFLodAreaPaintEvent(QPaintEvent *event)
 {
+    PerformanceMonitor::LatencyScope latency(PerformanceMonitor::FoldPaint);
     m_listFlodIconPos.clear();
     QPainter painter(m_pLeftAreaWidget->m_pFlodArea);
 
@@ -2257,99 +2525,75 @@ void TextEdit::codeFLodAreaPaintEvent(QPaintEvent *event)
         m_lineNumbersColor.setAlphaF(0.3);
     }
 
-    int blockNumber = getFirstVisibleBlockId();
-    QTextBlock block = document()->findBlockByNumber(blockNumber);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHints(QPainter::SmoothPixmapTransform);
 
-    DGuiApplicationHelper *guiAppHelp = DGuiApplicationHelper::instance();
-    QString theme  = "";
+    const int w = this->m_fontSize <= 15 ? 15 : m_fontSize;
+    //the language currently set by the system is Tibetan.
+    const bool isTibetan = ("bo_CN" == Utils::getSystemLan());
+    for (const VisibleBlockGeometry &geometry : m_pLeftAreaWidget->visibleBlockGeometry()) {
+        //判定是否包含注释代码左括号、是否整行是注释、是否包含成对的括号，行标识由折叠区域索引缓存，无需每次绘制重新计算
+        if (!geometry.visible || !m_pFoldRegionIndex->isFoldIconLine(geometry.blockNumber)) {
+            continue;
+        }
 
-    if (guiAppHelp->themeType() == DGuiApplicationHelper::ColorType::DarkType) {  //暗色主题
-        theme = "d";
-    } else {  //浅色主题
-        theme = "l";
+        const int h = geometry.height;
+        // 绘制行纵向居中
+        int offset = qMax(0, (h - w) / 2);
+        if (isTibetan)
+            offset = h <= 20 ? 0 : h / 10;
+
+        QRect rect(0, geometry.y + offset, w, w);
+        paintCodeFlod(&painter, rect, !geometry.nextVisible);
+        m_listFlodIconPos.append(geometry.blockNumber);
     }
+}
 
-    // QString flodImagePath = QString(":/images/d-%1.svg").arg(theme);
-    //QString unflodImagePath = QString(":/images/u-%1.svg").arg(theme);
+/**
+ * @brief 计算可视区域文本块的几何信息(文本块序号、首行位置及高度、是否可见)，
+ *      行号、书签及折叠区域绘制时共享，每帧仅计算一次。
+ */
+void TextEdit::updateVisibleBlockGeometry(QVector<VisibleBlockGeometry> &geometry)
+{
+    geometry.clear();
 
-    QPoint endPoint;
+    int blockNumber = getFirstVisibleBlockId();
+    QTextBlock block = document()->findBlockByNumber(blockNumber);
 
+    QPoint endPoint;
     if (verticalScrollBar()->maximum() > 0) {
         endPoint = QPointF(0, height() + height() / verticalScrollBar()->maximum() * verticalScrollBar()->value()).toPoint();
     }
 
-    QTextCursor cur = cursorForPosition(endPoint);
-    QTextBlock endBlock = cur.block();
-    int nPageLine = endBlock.blockNumber();
-
+    int nPageLine = cursorForPosition(endPoint).blockNumber();
     if (verticalScrollBar()->maximum() == 0) {
         nPageLine = blockCount() - 1;
     }
 
-    cur = textCursor();
-
-    for (int iBlockCount = blockNumber ; iBlockCount <= nPageLine; ++iBlockCount) {
-        if (block.isVisible()) {
-            //判定是否包含注释代码左括号、是否整行是注释，isNeedShowFoldIcon该函数是为了做判定当前行是否包含成对的括号，如果包括，则不显示折叠标志
-
-            //获取行数文本块 出去字符串判断　梁卫东２０２０年０９月０１日１７：１６：１７
-            QString text = block.text();
-            //若存在字符串行，多个字符串中间的 '{' '}' 同样被忽略
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-            QRegExp regExp("\".*\"");
-#else
-            QRegularExpression regExp("\".*\"");
-#endif
-            QString curText = text.remove(regExp);
-
-            //不同类型文件注释符号不同 梁卫东　２０２０－０９－０３　１７：２８：４５
-            bool bHasCommnent = false;
-            QString multiLineCommentMark;
-            QString singleLineCommentMark;
-
-            if (m_commentDefinition.isValid()) {
-                multiLineCommentMark = m_commentDefinition.multiLineStart.trimmed();
-                singleLineCommentMark = m_commentDefinition.singleLine.trimmed();
-                //判断是否包含单行或多行注释
-                if (!multiLineCommentMark.isEmpty()) bHasCommnent = block.text().trimmed().startsWith(multiLineCommentMark);
-                if (!singleLineCommentMark.isEmpty()) bHasCommnent = block.text().trimmed().startsWith(singleLineCommentMark);
-            } else {
-                bHasCommnent = false;
-            }
-
-            //添加注释判断 存在不显示折叠标志　不存在显示折叠标准　梁卫东　２０２０年０９月０３日１７：２８：５０
-            if (curText.contains("{") && isNeedShowFoldIcon(block) && !bHasCommnent) {
-
-                cur.setPosition(block.position(), QTextCursor::MoveAnchor);
-
-                painter.setRenderHint(QPainter::Antialiasing, true);
-                painter.setRenderHints(QPainter::SmoothPixmapTransform);
-
-                int w = this->m_fontSize <= 15 ? 15 : m_fontSize;
-                updateLeftWidgetWidth(w);
-                int h = cursorRect(cur).height();
-                // 绘制行纵向居中
-                int offset = qMax(0, (h - w) / 2);
-                //the language currently set by the system is Tibetan.
-                if ("bo_CN" == Utils::getSystemLan())
-                    offset = h <= 20 ? 0 : h / 10;
-
-                QRect rect(0, cursorRect(cur).y() + offset, w, w);
-                if (block.next().isVisible()) {
-                    if (block.isVisible()) {
-                        paintCodeFlod(&painter, rect);
-                    }
-                } else {
-                    if (block.isVisible()) {
-                        paintCodeFlod(&painter, rect, true);
-                    }
-                }
-                m_listFlodIconPos.append(block.blockNumber());
-            }
+    QTextCursor cur(document());
+    bool hasVisibleBlock = false;
+    for (int line = blockNumber; line <= nPageLine && block.isValid(); ++line) {
+        VisibleBlockGeometry item;
+        item.blockNumber = line;
+        item.visible = block.isVisible();
+        item.nextVisible = block.next().isVisible();
+        if (item.visible) {
+            cur.setPosition(block.position(), QTextCursor::MoveAnchor);
+            const QRect rect = cursorRect(cur);
+            item.y = rect.y();
+            item.height = rect.height();
+            hasVisibleBlock = true;
         }
 
+        geometry.append(item);
         block = block.next();
     }
+
+    // 左侧区域宽度仅需每帧调整一次
+    if (hasVisibleBlock) {
+        int w = this->m_fontSize <= 15 ? 15 : m_fontSize;
+        updateLeftWidgetWidth(w);
+    }
 }
 
 void TextEdit::setBookmarkFlagVisable(bool isVisable, bool bIsFirstOpen)
@@ -2416,6 +2660,11 @@ void TextEdit::handleScrollFinish()
 void TextEdit::setSyntaxDefinition(KSyntaxHighlighting::Definition def)
 {
     m_commentDefinition.setComments(def.singleLineCommentMarker(), def.multiLineCommentMarker().first,  def.multiLineCommentMarker().second);
+    if (m_commentDefinition.isValid()) {
+        m_pFoldRegionIndex->setCommentMarks(m_commentDefinition.singleLine.trimmed(), m_commentDefinition.multiLineStart.trimmed());
+    } else {
+        m_pFoldRegionIndex->setCommentMarks(QString(), QString());
+    }
 }
 
 bool TextEdit::setCursorKeywordSeletoin(int position, bool findNext)
@@ -2460,26 +2709,95 @@ bool TextEdit::setCursorKeywordSeletoin(int position, bool findNext)
 
 void TextEdit::cursorPositionChanged()
 {
-    // 以赋值形式，清空 Bracket 括号的selection
-    // m_beginBracketSelection 和 m_endBracketSelection 将在 updateHighlightBrackets 重新设置
-    m_beginBracketSelection = QTextEdit::ExtraSelection();
-    m_endBracketSelection = QTextEdit::ExtraSelection();
+    // 长按方向键等连续的光标移动合并到下一帧统一更新
+    scheduleFrameUpdate(FrameUpdateAll);
+}
 
-    updateHighlightLineSelection();
-    updateHighlightBrackets('(', ')');
-    updateHighlightBrackets('{', '}');
-    updateHighlightBrackets('[', ']');
-    renderAllSelections();
+/**
+ * @brief 标记界面待更新内容 \a flags ，距离上一帧更新不足一帧间隔时延迟到下一帧执行，
+ *      期间的多次标记合并为一次更新
+ */
+void TextEdit::scheduleFrameUpdate(int flags)
+{
+    // 界面更新帧间隔(ms)
+    static const int s_frameInterval = 16;
 
-    QTextCursor cursor = textCursor();
-    if (m_wrapper) {
+    m_frameUpdateFlags |= flags;
+    m_frameFoldedEvents++;
+    if (m_frameUpdateTimer->isActive()) {
+        return;
+    }
+
+    int delay = 0;
+    if (m_frameUpdateClock.isValid()) {
+        delay = static_cast<int>(qMax<qint64>(0, s_frameInterval - m_frameUpdateClock.elapsed()));
+    }
+    m_frameUpdateTimer->start(delay);
+}
+
+void TextEdit::flushFrameUpdate()
+{
+    // 合并后的光标变更界面更新计入光标位置变更处理耗时
+    PerformanceMonitor::LatencyScope latency(PerformanceMonitor::CursorPositionChanged);
+    const int flags = m_frameUpdateFlags;
+    const int foldedEvents = m_frameFoldedEvents;
+    m_frameUpdateFlags = FrameUpdateNone;
+    m_frameFoldedEvents = 0;
+    m_frameUpdateClock.restart();
+
+    if (flags & FrameUpdateCurrentLine) {
+        updateHighlightLineSelection();
+    }
+
+    if (flags & FrameUpdateBrackets) {
+        // 以赋值形式，清空 Bracket 括号的selection
+        // m_beginBracketSelection 和 m_endBracketSelection 将在 updateHighlightBrackets 重新设置
+        m_beginBracketSelection = QTextEdit::ExtraSelection();
+        m_endBracketSelection = QTextEdit::ExtraSelection();
+
+        updateHighlightBrackets('(', ')');
+        updateHighlightBrackets('{', '}');
+        updateHighlightBrackets('[', ']');
+    }
+
+    if (flags & (FrameUpdateCurrentLine | FrameUpdateBrackets | FrameUpdateSelections)) {
+        renderAllSelections();
+    }
+
+    if ((flags & FrameUpdateBottomBar) && m_wrapper) {
+        QTextCursor cursor = textCursor();
         m_wrapper->bottomBar()->updatePosition(cursor.blockNumber() + 1,
                                                cursor.positionInBlock() + 1);
     }
 
-    m_pLeftAreaWidget->m_pLineNumberArea->update();
-    m_pLeftAreaWidget->m_pBookMarkArea->update();
-    m_pLeftAreaWidget->m_pFlodArea->update();
+    if (flags & FrameUpdateGutter) {
+        m_pLeftAreaWidget->m_pLineNumberArea->update();
+        m_pLeftAreaWidget->m_pBookMarkArea->update();
+        m_pLeftAreaWidget->m_pFlodArea->update();
+    }
+
+    PerformanceMonitor::frameUpdateFinish(foldedEvents);
+}
+
+/**
+ * @brief 光标闪烁等和按键无关的绘制不计入，连续按键时从首个尚未绘制的按键开始计时
+ */
+void TextEdit::recordKeyToPaintLatency()
+{
+    if (!m_keyPressClock.isValid()) {
+        return;
+    }
+
+    const bool changed = document()->revision() != m_keyPressRevision
+                         || textCursor().position() != m_keyPressCursor
+                         || verticalScrollBar()->value() != m_keyPressScroll;
+    if (changed) {
+        PerformanceMonitor::recordLatency(PerformanceMonitor::KeyToPaint, m_keyPressClock.nsecsElapsed());
+        m_keyPressClock.invalidate();
+    } else if (m_keyPressClock.elapsed() > 1000) {
+        // 未引起界面变化的按键
+        m_keyPressClock.invalidate();
+    }
 }
 
 /**
@@ -2842,6 +3160,7 @@ void TextEdit::slotClearBookMarkAction(bool checked)
     m_listBookmark.clear();
     qDebug() << "ClearBookMark:" << m_listBookmark;
     m_pLeftAreaWidget->m_pBookMarkArea->update();
+    syncScrollBarAnnotation();
 }
 
 void TextEdit::slotFlodAllLevel(bool checked)
@@ -2910,6 +3229,7 @@ void TextEdit::redo_()
         this->m_wrapper->window()->updateModifyStatus(m_sFilePath, false);
         this->m_wrapper->setTemFile(false);
         this->document()->setModified(false);
+        m_pScrollBarAnnotation->clearModifiedBlocks();
     }
 
 }
@@ -2935,6 +3255,7 @@ void TextEdit::undo_()
         this->m_wrapper->window()->updateModifyStatus(m_sFilePath, false);
         this->m_wrapper->setTemFile(false);
         this->document()->setModified(false);
+        m_pScrollBarAnnotation->clearModifiedBlocks();
     }
 }
 
@@ -3192,36 +3513,12 @@ void TextEdit::updateHighlightBrackets(const QChar &openChar, const QChar &close
         bracketBeginCursor.movePosition(forward ? QTextCursor::NextCharacter : QTextCursor::PreviousCharacter,
                                         QTextCursor::KeepAnchor);
 
-        int braceDepth = 1;
-        // 判断当前是否处于字符串内，字符串内的 openChar closeChar  {} () [] 等不进行统计
-        bool inCodeString = false;
-        QChar c;
-        while (!(c = doc->characterAt(position)).isNull()) {
-            if (inCodeString) {
-                // 判断 " 是否存在转义字符，若不存在，则退出字符串模式
-                // 注意回退(!forward)模式下，position = 0，characterAt(position - 1) 将返回空字符，同样符合判断，不会触发越界访问
-                if ('"' == c
-                        && '\\' != doc->characterAt(position - 1)) {
-                    inCodeString = false;
-                }
-            } else {
-                if (c == begin) {
-                    braceDepth++;
-                } else if (c == end) {
-                    braceDepth--;
-
-                    if (!braceDepth) {
-                        bracketEndCursor = QTextCursor(doc);
-                        bracketEndCursor.setPosition(position);
-                        bracketEndCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-                        break;
-                    }
-                } else if ('"' == c) {
-                    inCodeString = true;
-                }
-            }
-
-            forward ? position++ : position--;
+        // 通过括号匹配索引查找，字符串内的 {} () [] 等不进行统计，中间不包含匹配括号的文本块整块跳过
+        const int matchPosition = m_pBracketIndex->findMatchingBracket(position, openChar, closeChar, forward);
+        if (matchPosition >= 0) {
+            bracketEndCursor = QTextCursor(doc);
+            bracketEndCursor.setPosition(matchPosition);
+            bracketEndCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
         }
 
         // cannot find the end bracket to not need to highlight.
@@ -3271,6 +3568,8 @@ void TextEdit::setLeftAreaUpdateState(TextEdit::UpdateOperationType statevalue)
 
         // 当文件读取完成时，手动触发更新界面
         if (TextEdit::FileOpenEnd == m_LeftAreaUpdateState) {
+            // 文件读取完成后在后台构建折叠区域索引
+            m_pFoldRegionIndex->rebuild();
             m_pLeftAreaWidget->updateAll();
         }
     }
@@ -3291,32 +3590,70 @@ bool TextEdit::getNeedControlLine(int line, bool isVisable)
     if (!bFoundBrace) {
         //遍历最后右括弧文本块 设置块隐藏或显示
         while (beginBlock.isValid()) {
-            beginBlock.setVisible(isVisable);
-            viewport()->adjustSize();
+            setFoldBlockVisible(beginBlock, isVisable);
             beginBlock = beginBlock.next();
         }
-        return true;
         //没有找到匹配左右括弧 //如果左右"{" "}"在同一行不折叠
-    } else if (!bFoundBrace || endBlock == curBlock) {
+    } else if (endBlock == curBlock) {
         return false;
     } else {
         //遍历最后右括弧文本块 设置块隐藏或显示
         while (beginBlock != endBlock && beginBlock.isValid()) {
-            if (beginBlock.isValid()) {
-                beginBlock.setVisible(isVisable);
-            }
-            viewport()->adjustSize();
+            setFoldBlockVisible(beginBlock, isVisable);
             beginBlock = beginBlock.next();
         }
 
         //最后一行显示或隐藏,或者下行就包含"}"
         if (beginBlock.isValid() && beginBlock == endBlock && endBlock.text().simplified() == "}") {
-            endBlock.setVisible(isVisable);
-            viewport()->adjustSize();
+            setFoldBlockVisible(endBlock, isVisable);
         }
+    }
 
-        return true;
+    // 批量折叠时由调用者统一重新布局
+    if (!m_foldBatch) {
+        flushFoldRelayout();
+    }
+    return true;
+}
+
+void TextEdit::setFoldBlockVisible(QTextBlock block, bool visible)
+{
+    if (block.isVisible() == visible) {
+        return;
+    }
+
+    block.setVisible(visible);
+    const int end = block.position() + block.length();
+    if (m_foldDirtyFrom < 0) {
+        m_foldDirtyFrom = block.position();
+        m_foldDirtyTo = end;
+    } else {
+        m_foldDirtyFrom = qMin(m_foldDirtyFrom, block.position());
+        m_foldDirtyTo = qMax(m_foldDirtyTo, end);
+    }
+}
+
+/**
+ * @brief 文本块显示状态变更后需通知文档布局更新行数，之前通过切换换行模式触发，将重新布局整个文档。
+ *      标记变更范围后，文档布局仅清除范围内文本块的布局并更新行数，发送 documentSizeChanged 更新滚动条范围
+ */
+void TextEdit::flushFoldRelayout()
+{
+    if (m_foldDirtyFrom < 0) {
+        return;
     }
+
+    QTextBlock first = document()->findBlock(m_foldDirtyFrom);
+    // 变更范围仅包含单个文本块时文档布局不更新行数，范围向前扩展一个文本块(折叠区域的起始行)
+    if (first.previous().isValid()) {
+        first = first.previous();
+    }
+    const int from = first.position();
+    const int to = qMin(m_foldDirtyTo, document()->characterCount());
+    m_foldDirtyFrom = -1;
+    m_foldDirtyTo = -1;
+
+    document()->markContentsDirty(from, to - from);
 }
 
 bool TextEdit::event(QEvent *event)
@@ -3534,6 +3871,7 @@ void TextEdit::setTheme(const QString &path)
     QString findMatchFgColor = jsonMap["editor-colors"].toMap()["find-match-foreground"].toString();
     m_findMatchFormat = currentCharFormat();
     m_findMatchFormat.setBackground(QColor(findMatchBgColor));
+    m_pScrollBarAnnotation->setColor(ScrollBarAnnotation::FindMatch, QColor(findMatchBgColor));
     m_findMatchFormat.setForeground(QColor(findMatchFgColor));
 
     QString findHighlightBgColor = jsonMap["editor-colors"].toMap()["find-highlight-background"].toString();
@@ -3814,7 +4152,7 @@ void TextEdit::toggleReadOnlyMode(bool notNotify)
 
 void TextEdit::toggleComment(bool bValue)
 {
-    const auto def = m_repository.definitionForFileName(QFileInfo(m_sFilePath).fileName());
+    const auto def = SyntaxRepository::instance()->definitionForFileName(QFileInfo(m_sFilePath).fileName());
     QTextCursor selectionCursor = textCursor();
     selectionCursor.movePosition(QTextCursor::StartOfBlock);
     selectionCursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
@@ -4096,6 +4434,7 @@ void TextEdit::hideRightMenu()
 
 void TextEdit::bookMarkAreaPaintEvent(QPaintEvent *event)
 {
+    PerformanceMonitor::LatencyScope latency(PerformanceMonitor::BookmarkPaint);
     BookMarkWidget *bookMarkArea = m_pLeftAreaWidget->m_pBookMarkArea;
     QPainter painter(bookMarkArea);
     QColor lineNumberAreaBackgroundColor;
@@ -4110,7 +4449,6 @@ void TextEdit::bookMarkAreaPaintEvent(QPaintEvent *event)
         m_lineNumbersColor.setAlphaF(0.3);
     }
 
-    QTextBlock lineBlock;//第几行文本块
     QImage image;
     QString pixmapPath;
     QList<int> list = m_listBookmark;
@@ -4122,10 +4460,15 @@ void TextEdit::bookMarkAreaPaintEvent(QPaintEvent *event)
         bIsContains = true;
     }
 
+    //the language currently set by the system is Tibetan.
+    const bool isTibetan = ("bo_CN" == Utils::getSystemLan());
     foreach (auto line, list) {
-        lineBlock = document()->findBlockByNumber(line - 1);
-        QTextCursor cur = textCursor();
-        cur.setPosition(lineBlock.position(), QTextCursor::MoveAnchor);
+        // 不在可视区域或已折叠的书签无需绘制
+        const VisibleBlockGeometry *geometry = m_pLeftAreaWidget->blockGeometry(line - 1);
+        if (line <= 0 || !geometry || !geometry->visible) {
+            continue;
+        }
+
         if (line == m_nBookMarkHoverLine && !bIsContains) {
             if (DGuiApplicationHelper::instance()->themeType() == DGuiApplicationHelper::ColorType::DarkType) {
                 pixmapPath = ":/images/like_hover_dark.svg";
@@ -4139,26 +4482,17 @@ void TextEdit::bookMarkAreaPaintEvent(QPaintEvent *event)
             pixmapPath = ":/images/bookmark.svg";
         }
 
-        if (line > 0) {
-            lineBlock = document()->findBlockByNumber(line - 1);
-            if (!lineBlock.isVisible()) {
-                continue;
-            }
-
-            int w = this->m_fontSize <= 15 ? 15 : m_fontSize;
-            updateLeftWidgetWidth(w);
-            int h = cursorRect(cur).height();
-            // 绘制行纵向居中
-            int offset = qMax(0, (h - w) / 2);
-            //the language currently set by the system is Tibetan.
-            if ("bo_CN" == Utils::getSystemLan())
-                offset = h <= 20 ? 0 : h / 10;
+        int w = this->m_fontSize <= 15 ? 15 : m_fontSize;
+        int h = geometry->height;
+        // 绘制行纵向居中
+        int offset = qMax(0, (h - w) / 2);
+        if (isTibetan)
+            offset = h <= 20 ? 0 : h / 10;
 
-            QRect rect(0, cursorRect(cur).y() + offset, w, w);
-            QSvgRenderer render;
-            render.load(pixmapPath);
-            render.render(&painter, rect);
-        }
+        QRect rect(0, geometry->y + offset, w, w);
+        QSvgRenderer render;
+        render.load(pixmapPath);
+        render.render(&painter, rect);
     }
 }
 
@@ -4194,6 +4528,7 @@ void TextEdit::addOrDeleteBookMark()
     }
 
     m_pLeftAreaWidget->m_pBookMarkArea->update();
+    syncScrollBarAnnotation();
 }
 
 void TextEdit::moveToPreviousBookMark()
@@ -4274,12 +4609,16 @@ void TextEdit::checkBookmarkLineMove(int from, int charsRemoved, int charsAdded)
 void TextEdit::flodOrUnflodAllLevel(bool isFlod)
 {
     m_listMainFlodAllPos.clear();
+    // 所有折叠区域设置完成后统一重新布局
+    m_foldBatch = true;
     //折叠
+    // 通过折叠区域索引的行标识过滤，仅对包含左括号的行查询折叠区域
+    const int braceFlags = FoldRegionIndex::HasBraceFlag | FoldRegionIndex::SlashCommentFlag;
+    QTextBlock block = document()->firstBlock();
     if (isFlod) {
-        for (int line = 0; line < document()->blockCount(); line++) {
-            if (blockContainStrBrackets(line)
-                    && document()->findBlockByNumber(line).isVisible()
-                    && !document()->findBlockByNumber(line).text().trimmed().startsWith("//")) {
+        for (int line = 0; block.isValid(); line++, block = block.next()) {
+            if (FoldRegionIndex::HasBraceFlag == (m_pFoldRegionIndex->lineFlags(line) & braceFlags)
+                    && block.isVisible()) {
                 if (getNeedControlLine(line, false)) {
                     m_listMainFlodAllPos.append(line);
                 }
@@ -4287,10 +4626,9 @@ void TextEdit::flodOrUnflodAllLevel(bool isFlod)
         }
         //展开
     } else {
-        for (int line = 0; line < document()->blockCount(); line++) {
-            if (blockContainStrBrackets(line)
-                    && !document()->findBlockByNumber(line + 1).isVisible()
-                    && !document()->findBlockByNumber(line).text().trimmed().startsWith("//")) {
+        for (int line = 0; block.isValid(); line++, block = block.next()) {
+            if (FoldRegionIndex::HasBraceFlag == (m_pFoldRegionIndex->lineFlags(line) & braceFlags)
+                    && !block.next().isVisible()) {
                 if (getNeedControlLine(line, true)) {
                     m_listMainFlodAllPos.append(line);
                 }
@@ -4298,20 +4636,12 @@ void TextEdit::flodOrUnflodAllLevel(bool isFlod)
         }
     }
 
-    //折叠时出现点击光标选择行变短
-    QPlainTextEdit::LineWrapMode curMode = this->lineWrapMode();
-    QPlainTextEdit::LineWrapMode WrapMode = curMode ==  QPlainTextEdit::NoWrap ?  QPlainTextEdit::WidgetWidth :  QPlainTextEdit::NoWrap;
-    this->setWordWrapMode(QTextOption::WrapAnywhere);
-    this->setLineWrapMode(WrapMode);
+    m_foldBatch = false;
+    flushFoldRelayout();
 
     m_pLeftAreaWidget->m_pFlodArea->update();
     m_pLeftAreaWidget->m_pLineNumberArea->update();
     m_pLeftAreaWidget->m_pBookMarkArea->update();
-
-    viewport()->update();
-    document()->adjustSize();
-
-    this->setLineWrapMode(curMode);
     viewport()->update();
 }
 
@@ -4323,8 +4653,6 @@ void TextEdit::flodOrUnflodCurrentLevel(bool isFlod)
     m_pLeftAreaWidget->m_pLineNumberArea->update();
     m_pLeftAreaWidget->m_pBookMarkArea->update();
     viewport()->update();
-    document()->adjustSize();
-
 }
 
 void TextEdit::getHideRowContent(int iLine)
@@ -4338,21 +4666,14 @@ void TextEdit::getHideRowContent(int iLine)
     QTextBlock beginBlock, endBlock, curBlock;
     bool bFoundBrace = findFoldBlock(iLine, beginBlock, endBlock, curBlock);
 
-    if (QColor(m_backgroundColor).lightness() < 128) {
-        m_foldCodeShow->initHighLight(m_sFilePath, false);
-    } else {
-        m_foldCodeShow->initHighLight(m_sFilePath, true);
-    }
-
-    m_foldCodeShow->appendText("{", width());
+    // 预览内容和折叠隐藏的文本块一致，直接使用文本块已设置的高亮格式绘制
+    QVector<QTextBlock> blocks;
     //左右括弧没有匹配到
     if (!bFoundBrace) {
-        // 读取文本块索引
-        int curIndex = 0;
-        //遍历最后右括弧文本块 设置块隐藏或显示,显示文本块不超过1000
+        //遍历最后右括弧文本块，显示文本块不超过1000
         while (beginBlock.isValid()
-                && (curIndex++ < s_MaxDisplayBlockCount)) {
-            m_foldCodeShow->appendText(beginBlock.text(), width());
+                && (blocks.size() < s_MaxDisplayBlockCount)) {
+            blocks.append(beginBlock);
             beginBlock = beginBlock.next();
         }
 
@@ -4360,47 +4681,27 @@ void TextEdit::getHideRowContent(int iLine)
     } else if (endBlock == curBlock) {
         return;
     } else {
-        // 读取文本块索引
-        int curIndex = 0;
-        //遍历最后右括弧文本块 设置块隐藏或显示,显示文本块不超过1000
+        //遍历最后右括弧文本块，显示文本块不超过1000
         while (beginBlock != endBlock
                 && beginBlock.isValid()
-                && (curIndex++ < s_MaxDisplayBlockCount)) {
-            if (beginBlock.isValid()) {
-                m_foldCodeShow->appendText(beginBlock.text(), width());
-            }
-
+                && (blocks.size() < s_MaxDisplayBlockCount)) {
+            blocks.append(beginBlock);
             beginBlock = beginBlock.next();
         }
 
-        if (endBlock.text().simplified() == "}") {
-            m_foldCodeShow->appendText("}", width());
+        if (beginBlock == endBlock && endBlock.text().simplified() == "}") {
+            blocks.append(endBlock);
         }
-
-        m_foldCodeShow->appendText("}", width());
     }
+
+    m_foldCodeShow->setTextStyle(document()->defaultFont(), document()->defaultTextOption(),
+                                 palette().color(QPalette::Text));
+    m_foldCodeShow->setBlocks(blocks, width(), height());
 }
 
 bool TextEdit::isNeedShowFoldIcon(QTextBlock block)
 {
-    QString blockText = block.text();
-    bool hasFindLeft = false; // 是否已经找到当前行第一个左括号
-    int rightNum = 0, leftNum = 0;//右括号数目、左括号数目
-    for (int i = 0 ; i < blockText.size(); ++i) {
-        if (blockText.at(i) == "}" && hasFindLeft) {
-            rightNum++;
-        } else if (blockText.at(i) == "{") {
-            if (!hasFindLeft)
-                hasFindLeft = true;
-            leftNum++;
-        }
-    }
-
-    if (rightNum == leftNum) {
-        return  false;
-    } else {
-        return  true;
-    }
+    return FoldRegionIndex::needFoldIcon(block.text());
 }
 
 int TextEdit::getHighLightRowContentLineNum(int iLine)
@@ -4409,25 +4710,14 @@ int TextEdit::getHighLightRowContentLineNum(int iLine)
     QTextBlock beginBlock, endBlock, curBlock;
     bool bFoundBrace = findFoldBlock(iLine, beginBlock, endBlock, curBlock);
 
-    //左右括弧没有匹配到
+    //左右括弧没有匹配到，高亮至最后一行
     if (!bFoundBrace) {
-        //遍历最后右括弧文本块 设置块隐藏或显示
-        while (beginBlock.isValid()) {
-            iLine++;
-            beginBlock = beginBlock.next();
-        }
-        return iLine;
+        return blockCount() - 1;
         //如果左右"{" "}"在同一行不折叠
-    } else if (!bFoundBrace || endBlock == curBlock) {
+    } else if (endBlock == curBlock) {
         return iLine;
     } else {
-        while (beginBlock != endBlock && beginBlock.isValid()) {
-            iLine++;
-            beginBlock = beginBlock.next();
-        }
-
-        iLine++;
-        return iLine;
+        return endBlock.blockNumber();
     }
 }
 
@@ -4521,6 +4811,8 @@ void TextEdit::setTextFinished()
 {
     m_bIsFileOpen = false;
     m_nLines = blockCount();
+    // 加载的内容不视为修改
+    m_pScrollBarAnnotation->clearModifiedBlocks();
 
     if (!m_listBookmark.isEmpty()) {
         return;
@@ -4697,11 +4989,13 @@ QList<int> TextEdit::getBookmarkInfo()
 void TextEdit::setBookMarkList(QList<int> bookMarkList)
 {
     m_listBookmark = bookMarkList;
+    syncScrollBarAnnotation();
 }
 
 void TextEdit::updateSaveIndex()
 {
     m_lastSaveIndex = m_pUndoStack->index();
+    m_pScrollBarAnnotation->clearModifiedBlocks();
 }
 
 void TextEdit::isMarkCurrentLine(bool isMark, QString strColor,  qint64 timeStamp)
@@ -4786,7 +5080,28 @@ bool TextEdit::markKeywordInView(QString keyword, QString color, qint64 timeStam
     bool ret = false;
 
     format.setBackground(QColor(color));
-    ret = updateKeywordSelectionsInView(keyword, format, &listExtraSelection);
+    if (m_pMatchIndex->isReady(keyword)) {
+        int beginPos = 0;
+        int endPos = 0;
+        getVisibleDocumentRange(beginPos, endPos);
+
+        // 可视范围、索引及标记操作均未变更时，沿用上次计算的标记，滚动时不再重复计算
+        const int revision = m_pMatchIndex->revision(keyword);
+        auto cacheItr = m_keywordViewCache.constFind(keyword);
+        if (cacheItr != m_keywordViewCache.constEnd()
+                && m_mapKeywordMarkSelections.contains(keyword)
+                && cacheItr->beginPos == beginPos
+                && cacheItr->endPos == endPos
+                && cacheItr->revision == revision
+                && cacheItr->timeStamp == operationTimeStamp) {
+            return true;
+        }
+
+        ret = updateKeywordSelectionsFromIndex(keyword, format, &listExtraSelection, beginPos, endPos, Qt::CaseInsensitive);
+        m_keywordViewCache.insert(keyword, KeywordViewCache {beginPos, endPos, revision, operationTimeStamp});
+    } else {
+        ret = updateKeywordSelectionsInView(keyword, format, &listExtraSelection);
+    }
 
     // 构建带有时间戳的 listExtraSelectionWithTimeStamp
     QList<QPair<QTextEdit::ExtraSelection, qint64>> listExtraSelectionWithTimeStamp;
@@ -4869,6 +5184,8 @@ void TextEdit::isMarkAllLine(bool isMark, QString strColor)
             markOperation.color = strColor;
             markOperation.matchText = selectionText;
             m_markOperations.append(QPair<TextEdit::MarkOperation, qint64>(markOperation, timeStamp));
+            // 后台构建全文匹配索引，后续滚动及编辑时仅查询可视区域
+            syncMatchIndexKeywords();
 
             if (updateKeywordSelectionsInView(selectionText, format, &listExtraSelection)) {
 
@@ -4903,6 +5220,8 @@ void TextEdit::isMarkAllLine(bool isMark, QString strColor)
         m_markOperations.clear();
         m_wordMarkSelections.clear();
         m_mapKeywordMarkSelections.clear();
+        m_keywordViewCache.clear();
+        syncMatchIndexKeywords();
 
         QTextEdit::ExtraSelection selection;
         selection.format.setBackground(QColor(strColor));
@@ -4957,6 +5276,7 @@ void TextEdit::cancelLastMark()
         if (m_mapKeywordMarkSelections.contains(keyword)) {
             m_mapKeywordMarkSelections.remove(keyword);
         }
+        m_keywordViewCache.remove(keyword);
         break;
     }
 
@@ -4970,6 +5290,7 @@ void TextEdit::cancelLastMark()
     }
 
     m_markOperations.removeLast();
+    syncMatchIndexKeywords();
 
     // 如果在标记颜色操作后，更改文本内容，如果存在残留，补充一个清除处理
     if (m_markOperations.isEmpty() &&
@@ -5174,6 +5495,7 @@ void TextEdit::manualUpdateAllMark(const QList<QPair<MarkOperation, qint64> > &m
     });
 
     // 计算全文标记部分并刷新界面颜色标记
+    syncMatchIndexKeywords();
     markAllKeywordInView();
 }
 
@@ -5707,33 +6029,18 @@ bool TextEdit::eventFilter(QObject *object, QEvent *event)
 
                 // 当前行line-1 判断下行line是否隐藏
                 if (document()->findBlockByNumber(line).isVisible() && document()->findBlockByNumber(line - 1).text().contains("{") && !bHasCommnent) {
+                    // 仅重新布局折叠区域的文本块
                     getNeedControlLine(line - 1, false);
-                    document()->adjustSize();
-
-                    //折叠时出现点击光标选择行变短
-                    QPlainTextEdit::LineWrapMode curMode = this->lineWrapMode();
-                    QPlainTextEdit::LineWrapMode WrapMode = curMode ==  QPlainTextEdit::NoWrap ?  QPlainTextEdit::WidgetWidth :  QPlainTextEdit::NoWrap;          this->setWordWrapMode(QTextOption::WrapAnywhere);
-                    this->setLineWrapMode(WrapMode);
-                    viewport()->update();
                     m_pLeftAreaWidget->updateBookMark();
                     m_pLeftAreaWidget->updateCodeFlod();
                     m_pLeftAreaWidget->updateLineNumber();
-                    this->setLineWrapMode(curMode);
                     viewport()->update();
 
                 } else if (!document()->findBlockByNumber(line).isVisible() && document()->findBlockByNumber(line - 1).text().contains("{") && !bHasCommnent) {
                     getNeedControlLine(line - 1, true);
-                    document()->adjustSize();
-
-                    //折叠时出现点击光标选择行变短
-                    QPlainTextEdit::LineWrapMode curMode = this->lineWrapMode();
-                    QPlainTextEdit::LineWrapMode WrapMode = curMode ==  QPlainTextEdit::NoWrap ?  QPlainTextEdit::WidgetWidth :  QPlainTextEdit::NoWrap;          this->setWordWrapMode(QTextOption::WrapAnywhere);
-                    this->setLineWrapMode(WrapMode);
-                    viewport()->update();
                     m_pLeftAreaWidget->updateBookMark();
                     m_pLeftAreaWidget->updateCodeFlod();
                     m_pLeftAreaWidget->updateLineNumber();
-                    this->setLineWrapMode(curMode);
                     viewport()->update();
                 } else {
                     //其他不做处理
@@ -5814,7 +6121,6 @@ bool TextEdit::eventFilter(QObject *object, QEvent *event)
                     m_foldCodeShow->setStyle(lineWrapMode());//enum LineWrapMode {NoWrap,WidgetWidth};
                     getHideRowContent(line - 1);
                     m_foldCodeShow->show();
-                    m_foldCodeShow->hideFirstBlock();
                     m_foldCodeShow->move(5, getLinePosYByLineNum(line));
                 } else {
                     QTextCursor previousCursor = textCursor();
@@ -6864,8 +7170,22 @@ void TextEdit::mouseReleaseEvent(QMouseEvent *e)
 
 void TextEdit::keyPressEvent(QKeyEvent *e)
 {
+    // 超过 1s 仍未绘制的按键视为未引起界面变化，重新计时
+    if (!m_keyPressClock.isValid() || m_keyPressClock.elapsed() > 1000) {
+        m_keyPressClock.start();
+        m_keyPressRevision = document()->revision();
+        m_keyPressCursor = textCursor().position();
+        m_keyPressScroll = verticalScrollBar()->value();
+    }
+
     Qt::KeyboardModifiers modifiers = e->modifiers();
     QString key = Utils::getKeyshortcut(e);
+    // 隐藏快捷键，切换耗时统计的显示
+    if (modifiers == (Qt::ControlModifier | Qt::AltModifier | Qt::ShiftModifier) && e->key() == Qt::Key_F12) {
+        PerformanceMonitor::setLatencyOverlayEnabled(!PerformanceMonitor::latencyOverlayEnabled());
+        m_pLatencyOverlay->setVisible(PerformanceMonitor::latencyOverlayEnabled());
+        return;
+    }
     //没有修改键　插入文件
     //按下esc的时候,光标退出编辑区，切换至标题栏
     if (modifiers == Qt::NoModifier && e->key() == Qt::Key_Escape) {
@@ -7249,7 +7569,7 @@ void TextEdit::keyPressEvent(QKeyEvent *e)
             openNewlineBelow();
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "duplicateline")) {
-            duplicateLine();
+            duplicateLine(e->isAutoRepeat());
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "killline")) {
             killLine();
@@ -7258,10 +7578,10 @@ void TextEdit::keyPressEvent(QKeyEvent *e)
             killCurrentLine();
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "swaplineup")) {
-            moveLineDownUp(true);
+            moveLineDownUp(true, e->isAutoRepeat());
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "swaplinedown")) {
-            moveLineDownUp(false);
+            moveLineDownUp(false, e->isAutoRepeat());
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "scrolllineup")) {
             scrollLineUp();
@@ -7320,7 +7640,7 @@ void TextEdit::keyPressEvent(QKeyEvent *e)
             exchangeMark();
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "joinlines")) {
-            joinLines();
+            joinLines(e->isAutoRepeat());
             return;
         } else if (key == Utils::getKeyshortcutFromKeymap(m_settings, "editor", "togglereadonlymode")/*|| key=="Alt+Meta+L"*/) {
             //setReadOnly(false);
@@ -7416,7 +7736,11 @@ void TextEdit::contextMenuEvent(QContextMenuEvent *event)
 
 void TextEdit::paintEvent(QPaintEvent *e)
 {
-    DPlainTextEdit::paintEvent(e);
+    {
+        PerformanceMonitor::LatencyScope latency(PerformanceMonitor::EditorPaint);
+        DPlainTextEdit::paintEvent(e);
+    }
+    recordKeyToPaintLatency();
 
     if (m_altModSelections.length() > 0) {
         for (auto sel : m_altModSelections) {
@@ -7468,6 +7792,8 @@ void TextEdit::resizeEvent(QResizeEvent *e)
     }
 
     QPlainTextEdit::resizeEvent(e);
+    // 可视行数变化后更新裁剪的扩展选区
+    updateVisibleSelections();
 }
 
 bool TextEdit::isComment(const QString &text, int index, const QString &commentType)
@@ -8007,21 +8333,8 @@ void TextEdit::removeComment()
 
 bool TextEdit::blockContainStrBrackets(int line)
 {
-    //获取行数文本块
-    QTextBlock curBlock = document()->findBlockByNumber(line);
-    QString text = curBlock.text();
     //若存在字符串行，多个字符串中间的 '{' '}' 同样被忽略
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-    QRegExp regExp("\".*\"");
-#else
-    QRegularExpression regExp("\".*\"");
-#endif
-    if (text.contains(regExp)) {
-        QString curText = text.remove(regExp);
-        return curText.contains("{");
-    } else {
-        return text.contains("{");
-    }
+    return m_pFoldRegionIndex->lineFlags(line) & FoldRegionIndex::HasBraceFlag;
 }
 
 /**
@@ -8035,7 +8348,6 @@ bool TextEdit::blockContainStrBrackets(int line)
  */
 bool TextEdit::findFoldBlock(int line, QTextBlock &beginBlock, QTextBlock &endBlock, QTextBlock &curBlock)
 {
-    //使用统一 折叠判断算法 根据左右"{""}"高亮算法
     QTextDocument *doc = document();
     //获取行号对应文本块
     curBlock = doc->findBlockByNumber(line);
@@ -8047,59 +8359,21 @@ bool TextEdit::findFoldBlock(int line, QTextBlock &beginBlock, QTextBlock &endBl
     //如果是第一行不包括左括弧"{"
     if (line == 0 && !curBlock.text().contains("{")) {
         curBlock = curBlock.next();
+        line++;
     }
 
-    //获取当前块文本左括弧所在光标
-    int position = curBlock.position();
-    int offset = curBlock.text().lastIndexOf('{');
-    position += offset;
-
-    //获取当前文本块第一个字符光标
-    QChar begin = '{', end = '}';
-    QTextCursor cursor = textCursor();
-    cursor.setPosition(position, QTextCursor::MoveAnchor);
-    cursor.clearSelection();
-
-    //左括弧光标 右括弧光标
-    QTextCursor bracketBeginCursor = cursor;
-    QTextCursor bracketEndCursor = cursor;
-    bracketBeginCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-
-    //获取最后右括弧光标
-    int braceDepth = 0;
-    // 判断当前是否处于字符串内，字符串内的 { } 不进行统计
-    bool inCodeString = false;
-    QChar c;
-    while (!(c = doc->characterAt(position)).isNull()) {
-        // 判断是否处于字符串内，已在字符串内将不处理其它字符，只判断结束处理
-        if (inCodeString) {
-            // 判断 " 前是否存在转义字符，若不存在，则退出字符串
-            if ('"' == c
-                    && '\\' != doc->characterAt(position - 1)) {
-                inCodeString = false;
-            }
-        } else {
-            if (c == begin) {
-                braceDepth++;
-            } else if (c == end) {
-                braceDepth--;
-
-                if (0 == braceDepth) {
-                    bracketEndCursor = QTextCursor(doc);
-                    bracketEndCursor.setPosition(position);
-                    bracketEndCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-                    endBlock = bracketEndCursor.block();
-                    break;
-                }
-            } else if ('"' == c) {
-                inCodeString = true;
-            }
-        }
-
-        position++;
+    //从折叠区域索引查询当前文本块最后一个左括弧匹配的右括弧所在行
+    const int foldEnd = m_pFoldRegionIndex->foldEndLine(line);
+    if (FoldRegionIndex::UnmatchedFoldRegion == foldEnd) {
+        return false;
+    } else if (FoldRegionIndex::NoFoldRegion == foldEnd || foldEnd == line) {
+        //不包含左括弧或左右括弧在同一行
+        endBlock = curBlock;
+    } else {
+        endBlock = doc->findBlockByNumber(foldEnd);
     }
 
-    return 0 == braceDepth;
+    return true;
 }
 
 /**
@@ -12,11 +12,15 @@
 #include "../common/utils.h"
 #include "../widgets/ColorSelectWdg.h"
 #include "uncommentselection.h"
+#include "scrollbarannotation.h"
 //添加自定义撤销重做栈
 #include "inserttextundocommand.h"
 #include "deletetextundocommand.h"
 #include "../widgets/bottombar.h"
 #include <QUndoStack>
+#include <QHash>
+#include <QScopedPointer>
+#include <QElapsedTimer>
 
 #include <KSyntaxHighlighting/Definition>
 #include <KSyntaxHighlighting/SyntaxHighlighter>
@@ -37,7 +41,14 @@ enum ConvertCase { UPPER, LOWER, CAPITALIZE };
 
 class ShowFlodCodeWidget;
 class LeftAreaTextEdit;
+struct VisibleBlockGeometry;
 class EditWrapper;
+class MatchIntervalIndex;
+class SelectionOverlay;
+class BracketIndex;
+class FoldRegionIndex;
+class DigitGlyphAtlas;
+class LatencyOverlay;
 
 class TextEdit : public DPlainTextEdit
 {
@@ -65,6 +76,16 @@ public:
         CopyOperation,
         PasteOperation
     };
+    // 界面更新标识，标记后在下一帧统一执行
+    enum FrameUpdateFlag {
+        FrameUpdateNone = 0x0,
+        FrameUpdateCurrentLine = 0x1,   ///< 当前行高亮
+        FrameUpdateBrackets = 0x2,      ///< 括号匹配高亮
+        FrameUpdateSelections = 0x4,    ///< 扩展选区渲染
+        FrameUpdateBottomBar = 0x8,     ///< 底部栏光标位置
+        FrameUpdateGutter = 0x10,       ///< 左侧行号、书签、折叠区域
+        FrameUpdateAll = 0x1F
+    };
 
     struct MarkOperation {
         MarkOperationType   type;           // 标记操作类型
@@ -163,20 +184,21 @@ public:
     void newline();
     void openNewlineAbove();
     void openNewlineBelow();
-    void moveLineDownUp(bool up);
+    // 选中的行(无选中时为当前行)上移或下移一行，merge 为 true 时和之前的移动合并为一个撤销项
+    void moveLineDownUp(bool up, bool merge = false);
     void scrollLineUp();
     void scrollLineDown();
     void scrollUp();
     void scrollDown();
-    //copy current line and paste in the next line
-    void duplicateLine();
+    //copy selected lines or current line and paste in the next line
+    void duplicateLine(bool merge = false);
     void copyLines();
 
     //剪切选中行或当前行至剪贴板中
     void cutlines();
 
-    // joinLines 合并行
-    void joinLines();
+    // joinLines 合并选中的行，未选中多行时和下一行合并
+    void joinLines(bool merge = false);
 
     void killLine();
     void killCurrentLine();
@@ -193,9 +215,16 @@ public:
     void scrollToLine(int scrollOffset, int row, int column);
 
     void setLineWrapMode(bool enable);
+    // 超长行模式，文档包含超长行时强制自动换行，超长行按窗口宽度分段布局
+    void setLongLineMode(bool enable);
+    bool isLongLineMode() const;
+    // 检测文档是否包含超长行并设置超长行模式，返回是否包含超长行
+    bool detectLongLines();
     void setFontFamily(QString fontName);
     void setFontSize(qreal fontSize);
     void updateFont();
+    // 同时设置字体及字号，未变化时不重新布局
+    void applyFont(const QString &fontName, qreal fontSize);
 
     void replaceAll(const QString &replaceText, const QString &withText, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive);
     void replaceNext(const QString &replaceText, const QString &withText, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive);
@@ -215,6 +244,8 @@ public:
                                        Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive);
     bool searchKeywordSeletion(QString keyword, QTextCursor cursor, bool findNext);
     void renderAllSelections();
+    // 取得关键字匹配区间索引
+    inline MatchIntervalIndex *matchIndex() const { return m_pMatchIndex; }
 
     bool clearMarkOperationForCursor(QTextCursor cursor);
     bool clearMarksForTextCursor();
@@ -234,6 +265,8 @@ public:
 
     void lineNumberAreaPaintEvent(QPaintEvent *event);
     void codeFLodAreaPaintEvent(QPaintEvent *event);
+    // 计算可视区域文本块的几何信息，由左侧区域每帧缓存
+    void updateVisibleBlockGeometry(QVector<VisibleBlockGeometry> &geometry);
     void setBookmarkFlagVisable(bool isVisable, bool bIsFirstOpen = false);
     void setCodeFlodFlagVisable(bool isVisable, bool bIsFirstOpen = false);
     void setTheme(const QString &path);
@@ -611,6 +644,40 @@ private:
                              Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
     // 查找行号line起始的折叠区域
     bool findFoldBlock(int line, QTextBlock &beginBlock, QTextBlock &endBlock, QTextBlock &curBlock);
+    // 设置折叠区域文本块的显示状态，记录显示状态变更的文档范围
+    void setFoldBlockVisible(QTextBlock block, bool visible);
+    // 仅重新布局显示状态变更的文档范围，并按新的行数更新滚动条范围
+    void flushFoldRelayout();
+
+    // 取得当前可视区域(包含向下预取的半屏)的文档位置范围
+    void getVisibleDocumentRange(int &beginPos, int &endPos);
+    // 通过匹配区间索引计算 [beginPos, endPos] 范围内的关键字高亮
+    bool updateKeywordSelectionsFromIndex(const QString &keyword, const QTextCharFormat &charFormat,
+                                          QList<QTextEdit::ExtraSelection> *listSelection,
+                                          int beginPos, int endPos, Qt::CaseSensitivity caseFlag);
+    // 关键字索引构建完成后刷新可视区域内的标记及查找高亮
+    void onMatchIndexReady(const QString &keyword);
+    // 同步匹配区间索引的关键字(全文标记关键字和查找关键字)
+    void syncMatchIndexKeywords();
+    // 设置查找使用的关键字索引
+    void setFindIndexKeyword(const QString &keyword, Qt::CaseSensitivity caseFlag);
+    // 取得滚动条标注的数据来源(查找关键字、颜色标记及书签)
+    ScrollBarAnnotation::Sources scrollBarAnnotationSources() const;
+    // 标注数据来源变更时重新计算滚动条标注
+    void syncScrollBarAnnotation();
+    // 取得扩展选区的裁剪范围(可视区域及前后预留区域)的文档位置
+    void getSelectionCullingRange(int &beginPos, int &endPos);
+    // 仅将和裁剪范围相交的选区设置到编辑器，内容未变化时跳过
+    void updateVisibleSelections(bool force = false);
+    // 标记界面待更新内容，多次标记合并到下一帧执行
+    void scheduleFrameUpdate(int flags);
+    // 执行已标记的界面更新
+    void flushFrameUpdate();
+    // 按键后首次反映编辑或光标变化的绘制时记录按键到绘制的延迟
+    void recordKeyToPaintLatency();
+    // 自动换行时从可视区域开始按时间片重新计算文本块的行数
+    void startProgressiveRelayout();
+    void continueProgressiveRelayout();
 
     bool refreshUndoRedoColumnStatus();
 
@@ -647,6 +714,35 @@ private:
     QTextEdit::ExtraSelection m_markAllSelection;///< “标记所有”的字符格式
     QList<QTextEdit::ExtraSelection> m_markFoldHighLightSelections;
 
+    // 可视区域关键字标记的计算缓存，可视范围和索引均未变更时跳过重新计算
+    struct KeywordViewCache {
+        int beginPos;
+        int endPos;
+        int revision;
+        qint64 timeStamp;
+    };
+    MatchIntervalIndex *m_pMatchIndex {nullptr};        ///< 全文标记及查找关键字的匹配区间索引
+    QHash<QString, KeywordViewCache> m_keywordViewCache; ///< 关键字对应的可视区域标记缓存
+    QString m_findIndexKeyword;                         ///< 查找使用的索引关键字
+    Qt::CaseSensitivity m_findIndexCaseFlag {Qt::CaseInsensitive};
+    QScopedPointer<SelectionOverlay> m_pSelectionOverlay;   ///< 分层管理的扩展选区
+    BracketIndex *m_pBracketIndex {nullptr};            ///< 括号匹配索引
+    FoldRegionIndex *m_pFoldRegionIndex {nullptr};      ///< 代码折叠区域索引
+    QScopedPointer<DigitGlyphAtlas> m_pLineNumberAtlas; ///< 行号数字字形图集
+    ScrollBarAnnotation *m_pScrollBarAnnotation {nullptr};  ///< 垂直滚动条标注
+    quint64 m_annotationSourcesSignature {0};           ///< 滚动条标注数据来源的特征值
+    // 上次计算滚动条标注特征值时的数据来源，列表未修改时和当前列表共享数据
+    QList<QPair<TextEdit::MarkOperation, qint64>> m_annotationMarkOperations;
+    QList<int> m_annotationBookmarks;
+    QString m_annotationFindKeyword;
+    Qt::CaseSensitivity m_annotationFindCaseFlag {Qt::CaseInsensitive};
+    bool m_annotationSourcesSynced {false};
+    quint64 m_visibleSelectionsSignature {0};           ///< 已设置到编辑器的扩展选区特征值
+    // 上次合并到颜色标记图层的标记列表，列表未修改时和当前列表共享数据
+    QList<QPair<QTextEdit::ExtraSelection, qint64>> m_renderedWordMarks;
+    QMap<QString, QList<QPair<QTextEdit::ExtraSelection, qint64>>> m_renderedKeywordMarks;
+    bool m_colorMarksRendered {false};
+
     QTextCursor m_highlightWordCacheCursor;
     QTextCursor m_wordUnderPointerCursor;
 
@@ -657,7 +753,6 @@ private:
 
     int m_tabSpaceNumber = 4;
 
-    KSyntaxHighlighting::Repository m_repository;
     KSyntaxHighlighting::SyntaxHighlighter *m_highlighter = nullptr;
 
     DMenu *m_rightMenu;
@@ -735,6 +830,10 @@ private:
     Settings *m_settings {nullptr};
 
     bool m_readOnlyMode = false;
+    bool m_longLineMode = false;                ///< 是否为超长行模式
+    int m_foldDirtyFrom = -1;                   ///< 折叠显示状态变更的起始位置，-1 表示无变更
+    int m_foldDirtyTo = -1;                     ///< 折叠显示状态变更的结束位置
+    bool m_foldBatch = false;                   ///< 是否正在批量折叠，结束后统一重新布局
     bool m_cursorMarkStatus = false;
     int m_cursorMarkPosition = 0;
     int m_cursorWidthChangeDelay = 2000;
@@ -775,6 +874,19 @@ private:
 
     QPoint m_lastTouchBeginPos;
     QPointer<QTimer> m_updateEnableSelectionByMouseTimer;
+    QTimer *m_frameUpdateTimer {nullptr};   ///< 界面更新帧定时器
+    QElapsedTimer m_frameUpdateClock;       ///< 距离上一帧界面更新的计时
+    int m_frameUpdateFlags {FrameUpdateNone};   ///< 待执行的界面更新标识
+    int m_frameFoldedEvents {0};            ///< 合并到当前帧的原始事件数
+    QElapsedTimer m_keyPressClock;          ///< 首个尚未绘制的按键的计时
+    int m_keyPressRevision {-1};            ///< 按键时的文档版本
+    int m_keyPressCursor {-1};              ///< 按键时的光标位置
+    int m_keyPressScroll {-1};              ///< 按键时的滚动条位置
+    LatencyOverlay *m_pLatencyOverlay {nullptr};    ///< 耗时统计浮层
+    QTimer *m_relayoutTimer {nullptr};      ///< 按时间片重新计算行数的定时器
+    int m_relayoutStart {-1};               ///< 开始重新计算时的首个可视文本块
+    int m_relayoutNext {-1};                ///< 下一个待计算的文本块，-1 表示无需计算
+    bool m_relayoutWrapped {false};         ///< 是否已计算至文档末尾并从文档开头继续
     int m_touchTapDistance = -1;
 
     QFont m_fontLineNumberArea;///< 绘制行号的字体
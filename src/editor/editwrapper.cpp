@@ -11,6 +11,10 @@
 #include "leftareaoftextedit.h"
 #include "drecentmanager.h"
 #include "../common/settings.h"
+#include "../common/syntaxrepository.h"
+#include "../common/pdfexporter.h"
+#include "../common/highlightformattable.h"
+#include "minimap.h"
 #include <DSettingsOption>
 #include <DSettings>
 #include <unistd.h>
@@ -86,8 +90,8 @@ EditWrapper::EditWrapper(Window *window, QWidget *parent)
       m_pWaringNotices(new WarningNotices(WarningNotices::ResidentType, this))
 
 {
-    // 更新单独添加的高亮格式文件
-    m_Repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
+    m_pHighlightEngine = new HighlightEngine(m_pTextEdit->document(), this);
+    connect(m_pTextEdit->document(), &QTextDocument::contentsChange, m_pHighlightEngine, &HighlightEngine::onContentsChange);
 
     m_bQuit = false;
     m_pWaringNotices->hide();
@@ -100,6 +104,17 @@ EditWrapper::EditWrapper(Window *window, QWidget *parent)
     m_layout->addWidget(m_pTextEdit);
     m_pTextEdit->setWrapper(this);
 
+    // 缩略图仅在高亮格式变更时失效对应的图块
+    m_pMinimap = new Minimap(m_pTextEdit, this);
+    m_layout->addWidget(m_pMinimap);
+    connect(m_pHighlightEngine, &HighlightEngine::formatsChanged, m_pMinimap, &Minimap::invalidateBlocks);
+    auto showMinimap = Settings::instance()->settings->option("base.font.showminimap");
+    setShowMinimap(showMinimap && showMinimap->value().toBool());
+    auto minimapCacheSize = Settings::instance()->settings->option("advance.editor.minimap_cache_size");
+    if (minimapCacheSize && minimapCacheSize->value().toInt() > 0) {
+        m_pMinimap->setBudget(static_cast<qint64>(minimapCacheSize->value().toInt()) * 1024 * 1024);
+    }
+
     QVBoxLayout *mainLayout = new QVBoxLayout;
     mainLayout->addLayout(m_layout);
     mainLayout->addWidget(m_pBottomBar);
@@ -124,6 +139,15 @@ EditWrapper::EditWrapper(Window *window, QWidget *parent)
 
 EditWrapper::~EditWrapper()
 {
+    // 导出及高亮引擎引用编辑器文档，需在编辑器析构前释放
+    if (m_pPdfExporter != nullptr) {
+        delete m_pPdfExporter;
+        m_pPdfExporter = nullptr;
+    }
+    if (m_pHighlightEngine != nullptr) {
+        delete m_pHighlightEngine;
+        m_pHighlightEngine = nullptr;
+    }
     if (m_pTextEdit != nullptr) {
         disconnect(m_pTextEdit);
         delete m_pTextEdit;
@@ -145,6 +169,9 @@ EditWrapper::~EditWrapper()
 void EditWrapper::setQuitFlag()
 {
     m_bQuit = true;
+    if (m_pPdfExporter) {
+        m_pPdfExporter->cancel();
+    }
 }
 
 bool EditWrapper::isQuit()
@@ -430,17 +457,18 @@ bool EditWrapper::reloadFileEncode(QByteArray encode)
  */
 void EditWrapper::reloadFileHighlight(QString definitionName)
 {
-    m_Definition = m_Repository.definitionForName(definitionName);
+    m_Definition = SyntaxRepository::instance()->definitionForName(definitionName);
     if (m_Definition.isValid() && !m_Definition.filePath().isEmpty()) {
         if (!m_pSyntaxHighlighter) m_pSyntaxHighlighter = new CSyntaxHighlighter(m_pTextEdit->document());
         QString m_themePath = Settings::instance()->settings->option("advance.editor.theme")->value().toString();
         if (m_themePath.contains("dark")) {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
+            m_pSyntaxHighlighter->setTheme(SyntaxRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
         } else {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+            m_pSyntaxHighlighter->setTheme(SyntaxRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
         }
         if (m_pSyntaxHighlighter) m_pSyntaxHighlighter->setDefinition(m_Definition);;
         m_pTextEdit->setSyntaxDefinition(m_Definition);
+        syncHighlightEngine();
 
         // 获取当前展示区域文本块
         QPoint startPoint = QPoint(0, 0);
@@ -465,20 +493,18 @@ void EditWrapper::reloadFileHighlight(QString definitionName)
             }
         }
         cursor.endEditBlock();
-        // 复位标识位
-        m_bHighlighterAll = false;
 
         // 重新高亮当前界面
         OnUpdateHighlighter();
     } else {
         // 不允许的高亮格式或无对应的高亮格式文件，例如“None”，移除高亮效果
-        m_bHighlighterAll = false;
         m_Definition = KSyntaxHighlighting::Definition();
         if (m_pSyntaxHighlighter) {
             m_pSyntaxHighlighter->deleteLater();
             m_pSyntaxHighlighter = nullptr;
         }
         m_pTextEdit->setSyntaxDefinition(m_Definition);
+        syncHighlightEngine();
     }
 }
 
@@ -982,6 +1008,8 @@ void EditWrapper::handleFileLoadFinished(const QByteArray &encode, const QByteAr
         if (checkPtr.isNull()) {
             return;
         }
+        // 包含超长行时启用超长行模式
+        m_pTextEdit->detectLongLines();
 
         m_bFileLoading = false;
         if (flag == true) {
@@ -997,6 +1025,8 @@ void EditWrapper::handleFileLoadFinished(const QByteArray &encode, const QByteAr
     }
 
     m_pTextEdit->setTextFinished();
+    // 恢复上次关闭时光标附近的高亮，后台高亮完成前即可显示
+    restoreHighlightCache();
 
     QStringList temFileList = Settings::instance()->settings->option("advance.editor.browsing_history_temfile")->value().toStringList();
 
@@ -1059,8 +1089,12 @@ void EditWrapper::handleFileLoadFinished(const QByteArray &encode, const QByteAr
 }
 
 
+/**
+ * @brief 应用主题，已有的高亮格式按格式标识替换为新主题的格式，无需重新高亮
+ */
 void EditWrapper::OnThemeChangeSlot(QString theme)
 {
+    m_pendingTheme.clear();
     QVariantMap jsonMap = Utils::getThemeMapFromPath(theme);
     QString backgroundColor = jsonMap["editor-colors"].toMap()["background-color"].toString();
     QString textColor = jsonMap["Normal"].toMap()["text-color"].toString();
@@ -1073,15 +1107,64 @@ void EditWrapper::OnThemeChangeSlot(QString theme)
 
     //设置编辑器
     if (m_pSyntaxHighlighter) {
-        if (QColor(backgroundColor).lightness() < 128) {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
-        } else {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+        const KSyntaxHighlighting::Theme syntaxTheme = SyntaxRepository::instance()->defaultTheme(
+                    QColor(backgroundColor).lightness() < 128 ? KSyntaxHighlighting::Repository::DarkTheme
+                                                              : KSyntaxHighlighting::Repository::LightTheme);
+
+        if (syntaxTheme.name() != m_pSyntaxHighlighter->theme().name()) {
+            m_pSyntaxHighlighter->setTheme(syntaxTheme);
+            if (m_pHighlightEngine && m_pHighlightEngine->isActive()) {
+                // 由后台高亮引擎替换格式，未完成的部分使用新主题继续高亮
+                m_pHighlightEngine->setTheme(syntaxTheme);
+            } else {
+                HighlightFormatTable(m_Definition, syntaxTheme).apply(m_pTextEdit->document());
+            }
         }
-        m_pSyntaxHighlighter->rehighlight();
     }
 
     m_pTextEdit->setTheme(theme);
+    m_pMinimap->setColors(QColor(backgroundColor),
+                          QColor(jsonMap["text-styles"].toMap()["Normal"].toMap()["text-color"].toString()));
+}
+
+/**
+ * @brief 标记待应用的主题，未显示的标签页在显示时再应用，避免切换主题时处理所有标签页
+ */
+void EditWrapper::setPendingTheme(const QString &theme)
+{
+    if (isVisible()) {
+        OnThemeChangeSlot(theme);
+    } else {
+        m_pendingTheme = theme;
+    }
+}
+
+bool EditWrapper::hasPendingTheme() const
+{
+    return !m_pendingTheme.isEmpty();
+}
+
+quint64 EditWrapper::displaySettingsGeneration() const
+{
+    return m_displaySettingsGeneration;
+}
+
+void EditWrapper::setDisplaySettingsGeneration(quint64 generation)
+{
+    m_displaySettingsGeneration = generation;
+}
+
+void EditWrapper::showEvent(QShowEvent *e)
+{
+    if (!m_pendingTheme.isEmpty()) {
+        OnThemeChangeSlot(m_pendingTheme);
+    }
+    // 隐藏期间变更的显示设置在显示前应用，只重新布局一次
+    if (m_pWindow) {
+        m_pWindow->syncDisplaySettings(this);
+    }
+
+    QWidget::showEvent(e);
 }
 
 void EditWrapper::UpdateBottomBarWordCnt(int cnt)
@@ -1095,7 +1178,13 @@ void EditWrapper::UpdateBottomBarWordCnt(int cnt)
  */
 void EditWrapper::OnUpdateHighlighter()
 {
-    if (m_pSyntaxHighlighter  && !m_bQuit && !m_bHighlighterAll) {
+    // 后台高亮引擎处理全部文本块的高亮，编辑器高亮仅保留已有格式
+    if (m_pSyntaxHighlighter && m_pHighlightEngine && m_pHighlightEngine->isActive()) {
+        m_pSyntaxHighlighter->setEnableHighlight(false);
+        return;
+    }
+
+    if (m_pSyntaxHighlighter  && !m_bQuit) {
         QScrollBar *pScrollBar = m_pTextEdit->verticalScrollBar();
         QPoint startPoint = QPoint(0, 0);
         QTextBlock beginBlock = m_pTextEdit->cursorForPosition(startPoint).block();
@@ -1185,33 +1274,125 @@ void EditWrapper::OnUpdateHighlighter()
     }
 }
 
+/**
+ * @brief 同步后台高亮引擎的高亮定义及主题，编辑器高亮器禁用时保留引擎设置的格式。
+ *      无有效高亮定义时停止后台高亮。
+ */
+void EditWrapper::syncHighlightEngine()
+{
+    if (!m_pHighlightEngine) {
+        return;
+    }
+
+    if (m_pSyntaxHighlighter && m_Definition.isValid()) {
+        m_pSyntaxHighlighter->setPreserveFormats(true);
+        m_pHighlightEngine->setTheme(m_pSyntaxHighlighter->theme());
+        m_pHighlightEngine->setDefinition(m_Definition);
+    } else {
+        m_pHighlightEngine->setDefinition(KSyntaxHighlighting::Definition());
+    }
+}
+
+bool EditWrapper::highlightCacheKey(HighlightCache::Key &key)
+{
+    if (!m_pSyntaxHighlighter || !m_pHighlightEngine || !m_pHighlightEngine->isActive()
+            || m_bIsTemFile || Utils::isDraftFile(m_pTextEdit->getFilePath())) {
+        return false;
+    }
+
+    key.filePath = m_pTextEdit->getFilePath();
+    key.definitionName = m_Definition.name();
+    key.definitionVersion = QString::number(m_Definition.version());
+    key.themeName = m_pSyntaxHighlighter->theme().name();
+    return true;
+}
+
+void EditWrapper::saveHighlightCache()
+{
+    HighlightCache::Key key;
+    if (m_bQuit || m_bFileLoading || isModified() || !highlightCacheKey(key)) {
+        return;
+    }
+
+    const int centerBlock = m_pTextEdit->textCursor().blockNumber();
+    if (!HighlightCache::save(key, m_pTextEdit->document(), centerBlock, m_pHighlightEngine->frontier())) {
+        HighlightCache::remove(key);
+    }
+}
+
+int EditWrapper::restoreHighlightCache()
+{
+    HighlightCache::Key key;
+    if (!highlightCacheKey(key)) {
+        return 0;
+    }
+
+    return HighlightCache::restore(key, m_pTextEdit->document());
+}
+
 void EditWrapper::setTemFile(bool value)
 {
     m_bIsTemFile = value;
 }
 
-void EditWrapper::updateHighlighterAll()
+/**
+ * @brief 取得全部文本块高亮完成的 QFuture ，用于需要完整高亮的操作(例如打印)。
+ *      高亮由后台高亮引擎按检查点分段处理，调用者通过 QFutureWatcher 等待，不阻塞 GUI 线程；
+ *      未启用后台高亮或已高亮完成时返回已完成的 QFuture
+ */
+QFuture<void> EditWrapper::highlighterAllFuture()
 {
-    if (m_pSyntaxHighlighter  && !m_bQuit && !m_bHighlighterAll) {
-        QTextBlock beginBlock = m_pTextEdit->document()->firstBlock();
-        QTextBlock endBlock = m_pTextEdit->document()->lastBlock();
+    if (m_pHighlightEngine && !m_bQuit) {
+        return m_pHighlightEngine->finishedFuture();
+    }
 
-        if (!beginBlock.isValid() || !endBlock.isValid()) {
-            return;
-        }
+    QFutureInterface<void> finished;
+    finished.reportStarted();
+    finished.reportFinished();
+    return finished.future();
+}
 
-        for (QTextBlock var = beginBlock; var != endBlock; var = var.next()) {
-            m_pSyntaxHighlighter->setEnableHighlight(true);
-            m_pSyntaxHighlighter->rehighlightBlock(var);
-            m_pSyntaxHighlighter->setEnableHighlight(false);
-        }
+/**
+ * @brief 导出当前文档到 PDF 文件，不拷贝文档，导出期间可继续浏览，修改文档将中止导出
+ */
+bool EditWrapper::exportPdf(const QString &filePath)
+{
+    if (m_bQuit || m_bFileLoading || isExportingPdf()) {
+        return false;
+    }
 
-        m_pSyntaxHighlighter->setEnableHighlight(true);
-        m_pSyntaxHighlighter->rehighlightBlock(endBlock);
-        m_pSyntaxHighlighter->setEnableHighlight(false);
+    if (!m_pPdfExporter) {
+        m_pPdfExporter = new PdfExporter(m_pTextEdit->document(), this);
+        m_pPdfExporter->setHighlightEngine(m_pHighlightEngine);
+        connect(m_pPdfExporter, &PdfExporter::progressChanged, m_pBottomBar, &BottomBar::setExportProgress);
+        connect(m_pBottomBar, &BottomBar::exportCancelRequested, m_pPdfExporter, &PdfExporter::cancel);
+        connect(m_pPdfExporter, &PdfExporter::finished, this, [this](bool success) {
+            m_pBottomBar->setExportProgress(-1);
+            if (m_bQuit) {
+                return;
+            }
 
-        m_bHighlighterAll = true;
+            if (success) {
+                showNotify(tr("Exported successfully"));
+            } else {
+                showNotify(tr("Export canceled or failed"), true);
+            }
+        });
+    }
+
+    m_pPdfExporter->setBackground(m_pTextEdit->palette().color(QPalette::Base));
+    m_pPdfExporter->setTitle(QFileInfo(m_pTextEdit->getTruePath()).fileName());
+    if (!m_pPdfExporter->start(filePath)) {
+        return false;
     }
+
+    m_pBottomBar->setExportProgress(0);
+    return true;
+}
+
+bool EditWrapper::isExportingPdf() const
+{
+    return m_pPdfExporter && m_pPdfExporter->isRunning();
 }
 
 QDateTime EditWrapper::getLastModifiedTime() const
@@ -1260,6 +1441,11 @@ void EditWrapper::setLineNumberShow(bool bIsShow, bool bIsFirstShow)
 //显示空白符
 void EditWrapper::setShowBlankCharacter(bool ok)
 {
+    // 设置文本选项将重新布局整个文档，未变化时直接返回
+    if (m_pTextEdit->document()->defaultTextOption().flags().testFlag(QTextOption::ShowTabsAndSpaces) == ok) {
+        return;
+    }
+
     if (ok) {
         QTextOption opts = m_pTextEdit->document()->defaultTextOption();
         QTextOption::Flags flag = opts.flags();
@@ -1277,6 +1463,17 @@ void EditWrapper::setShowBlankCharacter(bool ok)
     }
 }
 
+/**
+ * @brief 隐藏时释放已缓存的图块，缩略图不绘制时不会请求新的图块
+ */
+void EditWrapper::setShowMinimap(bool bIsShow)
+{
+    m_pMinimap->setVisible(bIsShow);
+    if (!bIsShow) {
+        m_pMinimap->clear();
+    }
+}
+
 BottomBar *EditWrapper::bottomBar()
 {
     return m_pBottomBar;
@@ -1486,19 +1683,20 @@ void EditWrapper::loadContent(const QByteArray &strContent)
  */
 void EditWrapper::reinitOnFileLoad(const QByteArray &encode)
 {
-    m_Definition = m_Repository.definitionForFileName(m_pTextEdit->getFilePath());
+    m_Definition = SyntaxRepository::instance()->definitionForFileName(m_pTextEdit->getFilePath());
     if (m_Definition.isValid() && !m_Definition.filePath().isEmpty()) {
         if (!m_pSyntaxHighlighter) m_pSyntaxHighlighter = new CSyntaxHighlighter(m_pTextEdit->document());
         QString m_themePath = Settings::instance()->settings->option("advance.editor.theme")->value().toString();
         if (m_themePath.contains("dark")) {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
+            m_pSyntaxHighlighter->setTheme(SyntaxRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
         } else {
-            m_pSyntaxHighlighter->setTheme(m_Repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+            m_pSyntaxHighlighter->setTheme(SyntaxRepository::instance()->defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
         }
 
         if (m_pSyntaxHighlighter) m_pSyntaxHighlighter->setDefinition(m_Definition);
         m_pTextEdit->setSyntaxDefinition(m_Definition);
         m_pBottomBar->getHighlightMenu()->setCurrentTextOnly(m_Definition.translatedName());
+        syncHighlightEngine();
     }
 
     if (!Utils::isDraftFile(m_pTextEdit->getFilePath())) {
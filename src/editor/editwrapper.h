@@ -10,6 +10,8 @@
 #include "../controls/warningnotices.h"
 #include "../editor/leftareaoftextedit.h"
 #include "../common/CSyntaxHighlighter.h"
+#include "../common/highlightengine.h"
+#include "../common/highlightcache.h"
 #include "../common/utils.h"
 #include <QVBoxLayout>
 #include <QWidget>
@@ -26,6 +28,8 @@
 #include <KSyntaxHighlighting/Theme>
 
 class Window;
+class PdfExporter;
+class Minimap;
 class EditWrapper : public QWidget
 {
     Q_OBJECT
@@ -99,6 +103,8 @@ public:
     void setTextChangeFlag(bool bFlag);
     void setLineNumberShow(bool bIsShow, bool bIsFirstShow = false);
     void setShowBlankCharacter(bool ok);
+    // 显示或隐藏编辑器右侧的缩略图
+    void setShowMinimap(bool bIsShow);
     void handleCursorModeChanged(TextEdit::CursorMode mode);
     void clearDoubleCharaterEncode();
     //
@@ -106,7 +112,7 @@ public:
     QString filePath();
     TextEdit *textEditor();
     Window *window();
-    void updateHighlighterAll();
+    QFuture<void> highlighterAllFuture();
 
     //get and set m_tModifiedDateTime
     QDateTime getLastModifiedTime() const;
@@ -118,6 +124,22 @@ public:
     // 取得当前编辑器使用的高亮处理(用于打印高亮)
     inline CSyntaxHighlighter *getSyntaxHighlighter() const
     { return m_pSyntaxHighlighter; }
+    // 取得后台高亮引擎
+    inline HighlightEngine *getHighlightEngine() const
+    { return m_pHighlightEngine; }
+    // 保存光标附近的高亮格式到磁盘缓存，用于重新打开文件时立即恢复高亮
+    void saveHighlightCache();
+    // 在后台导出当前文档到 PDF 文件，进度显示在底部栏，正在导出时返回 false
+    bool exportPdf(const QString &filePath);
+    // 是否正在导出 PDF
+    bool isExportingPdf() const;
+    // 设置主题，未显示时延迟到显示时应用
+    void setPendingTheme(const QString &theme);
+    // 是否有待应用的主题
+    bool hasPendingTheme() const;
+    // 已同步的显示设置版本，和窗口的版本不一致时在显示时同步
+    quint64 displaySettingsGeneration() const;
+    void setDisplaySettingsGeneration(quint64 generation);
 
 signals:
     void sigClearDoubleCharaterEncode();
@@ -125,6 +147,8 @@ signals:
 protected:
     // 处理文件加载事件
     virtual void customEvent(QEvent *e) override;
+    // 显示时应用待应用的主题
+    virtual void showEvent(QShowEvent *e) override;
 
 private:
     // 类似setPlainText(QString) 接口支持大文本加载 不卡顿 秒退出 梁卫东 2020年11月11日16:56:27
@@ -133,6 +157,12 @@ private:
     int GetCorrectUnicode1(const QByteArray &ba);
     // 文件加载时重新初始化部分设置
     void reinitOnFileLoad(const QByteArray &encode);
+    // 同步后台高亮引擎的高亮定义及主题
+    void syncHighlightEngine();
+    // 读取高亮缓存并应用到文档，返回应用的文本块数量
+    int restoreHighlightCache();
+    // 取得当前文件及高亮设置的缓存标识，不支持缓存时返回 false
+    bool highlightCacheKey(HighlightCache::Key &key);
 
 public slots:
     // 处理文档预加载数据
@@ -170,11 +200,14 @@ private:
     //撤销重做栈操作任务文件修改
     bool m_bUndoRedoOption = false;
     //语法高亮
-    KSyntaxHighlighting::Repository m_Repository;
     KSyntaxHighlighting::Definition m_Definition;
     //KSyntaxHighlighting::SyntaxHighlighter *m_pSyntaxHighlighter = nullptr;
     CSyntaxHighlighter *m_pSyntaxHighlighter = nullptr;
-    bool m_bHighlighterAll = false;
+    HighlightEngine *m_pHighlightEngine = nullptr;      ///< 后台高亮引擎，启用时替代可视区域的同步高亮
+    PdfExporter *m_pPdfExporter = nullptr;              ///< PDF 导出，首次导出时创建
+    Minimap *m_pMinimap = nullptr;                      ///< 编辑器右侧的缩略图
+    QString m_pendingTheme;                             ///< 未显示时待应用的主题路径
+    quint64 m_displaySettingsGeneration = 0;            ///< 已同步的显示设置版本
 
     bool m_bAsyncReadFileFinished = false;
     bool m_bHasPreProcess = false;               // 预处理标识
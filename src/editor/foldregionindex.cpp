@@ -0,0 +1,470 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "foldregionindex.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+// 单次变更超过此字符数时(例如加载文件、全部替换)延迟在后台重新构建
+static const int s_maxPatchChars = 512 * 1024;
+// 大量变更后延迟重新构建的时间(ms)
+static const int s_rebuildDelay = 300;
+
+FoldRegionIndex::FoldRegionIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+    m_rebuildTimer = new QTimer(this);
+    m_rebuildTimer->setSingleShot(true);
+    m_rebuildTimer->setInterval(s_rebuildDelay);
+    connect(m_rebuildTimer, &QTimer::timeout, this, &FoldRegionIndex::rebuild);
+}
+
+FoldRegionIndex::~FoldRegionIndex()
+{
+    if (m_watcher) {
+        m_watcher->disconnect(this);
+    }
+}
+
+void FoldRegionIndex::setCommentMarks(const QString &singleLine, const QString &multiLineStart)
+{
+    if (singleLine == m_singleLineMark && multiLineStart == m_multiLineStartMark) {
+        return;
+    }
+
+    m_singleLineMark = singleLine;
+    m_multiLineStartMark = multiLineStart;
+    // 注释标记影响所有行的标识
+    invalidate(0, m_document->blockCount() - 1);
+    m_rebuildTimer->start();
+}
+
+/**
+ * @brief 在后台线程根据文本快照构建所有行的索引，构建期间文档发生变更时丢弃结果并延迟重新构建。
+ *      构建完成前 foldEndLine() 从查询行开始按文本块逐行计算
+ */
+void FoldRegionIndex::rebuild()
+{
+    m_rebuildTimer->stop();
+    if (m_watcher) {
+        m_watcher->disconnect(this);
+        m_watcher->deleteLater();
+        m_watcher = nullptr;
+    }
+
+    const quint64 buildId = ++m_buildId;
+    const QString rawText = m_document->toRawText();
+    const QString singleLine = m_singleLineMark;
+    const QString multiLineStart = m_multiLineStartMark;
+    m_buildRevision = m_document->revision();
+
+    m_watcher = new QFutureWatcher<QVector<LineInfo>>(this);
+    connect(m_watcher, &QFutureWatcher<QVector<LineInfo>>::finished, this, [this, buildId]() {
+        onBuildFinished(buildId);
+    });
+    m_watcher->setFuture(QtConcurrent::run([rawText, singleLine, multiLineStart]() {
+        return FoldRegionIndex::computeLines(rawText, singleLine, multiLineStart);
+    }));
+}
+
+void FoldRegionIndex::waitForFinished()
+{
+    if (m_rebuildTimer->isActive()) {
+        rebuild();
+    }
+    if (m_watcher) {
+        m_watcher->waitForFinished();
+        onBuildFinished(m_buildId);
+    }
+}
+
+bool FoldRegionIndex::isBuilding() const
+{
+    return m_watcher || m_rebuildTimer->isActive();
+}
+
+bool FoldRegionIndex::isReady() const
+{
+    return !m_watcher
+           && m_lines.size() == m_document->blockCount()
+           && m_invalidFrom > m_invalidTo;
+}
+
+int FoldRegionIndex::lineFlags(int line)
+{
+    if (line < 0 || line >= m_document->blockCount()) {
+        return 0;
+    }
+
+    return lineInfo(line).flags;
+}
+
+bool FoldRegionIndex::isFoldIconLine(int line)
+{
+    const int flags = lineFlags(line);
+    return (flags & HasBraceFlag) && (flags & NeedFoldIconFlag) && !(flags & CommentFlag);
+}
+
+/**
+ * @brief 取得行 \a line 最后一个左括号对应的折叠区域结束行，
+ *      索引变更后首次查询时通过括号摘要线性计算所有行的折叠区域，之后均为直接查询。
+ *      后台构建未完成时不等待结果，仅计算查询的折叠区域，耗时和折叠区域的行数相关
+ */
+int FoldRegionIndex::foldEndLine(int line)
+{
+    if (line < 0 || line >= m_document->blockCount()) {
+        return NoFoldRegion;
+    }
+
+    if (isBuilding()) {
+        return scanFoldEnd(line);
+    }
+    ensureRegions();
+
+    return m_foldEnds.value(line, NoFoldRegion);
+}
+
+int FoldRegionIndex::computeFlags(const QString &text, const QString &singleLine, const QString &multiLineStart)
+{
+    int flags = 0;
+
+    // 若存在字符串，首尾引号之间的 '{' 同样被忽略，和正则 "\".*\"" 的处理一致
+    const int quoteBegin = text.indexOf('"');
+    const int quoteEnd = text.lastIndexOf('"');
+    if (-1 != quoteBegin && quoteEnd > quoteBegin) {
+        const int brace = text.indexOf('{');
+        if ((-1 != brace && brace < quoteBegin) || -1 != text.indexOf('{', quoteEnd + 1)) {
+            flags |= HasBraceFlag;
+        }
+    } else if (text.contains('{')) {
+        flags |= HasBraceFlag;
+    }
+
+    if (needFoldIcon(text)) {
+        flags |= NeedFoldIconFlag;
+    }
+
+    // 判断是否包含单行或多行注释，单行注释标记优先
+    const QString trimmed = text.trimmed();
+    bool hasComment = false;
+    if (!multiLineStart.isEmpty()) {
+        hasComment = trimmed.startsWith(multiLineStart);
+    }
+    if (!singleLine.isEmpty()) {
+        hasComment = trimmed.startsWith(singleLine);
+    }
+    if (hasComment) {
+        flags |= CommentFlag;
+    }
+    if (trimmed.startsWith("//")) {
+        flags |= SlashCommentFlag;
+    }
+
+    return flags;
+}
+
+bool FoldRegionIndex::needFoldIcon(const QString &text)
+{
+    bool hasFindLeft = false; // 是否已经找到当前行第一个左括号
+    int rightNum = 0, leftNum = 0;//右括号数目、左括号数目
+    for (const QChar &ch : text) {
+        if ('}' == ch && hasFindLeft) {
+            rightNum++;
+        } else if ('{' == ch) {
+            hasFindLeft = true;
+            leftNum++;
+        }
+    }
+
+    return rightNum != leftNum;
+}
+
+/**
+ * @brief 文档变更后失效变更区间 [ \a from , \a from + \a charsAdded ] 覆盖的行，
+ *      并根据行数的变化平移后续行的索引
+ */
+void FoldRegionIndex::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    m_regionsDirty = true;
+    if (m_watcher) {
+        // 构建期间文档变更，结果已失效
+        m_rebuildTimer->start();
+    }
+
+    const int newCount = m_document->blockCount();
+    if (qMax(charsRemoved, charsAdded) > s_maxPatchChars) {
+        m_lines.resize(newCount);
+        invalidate(0, newCount - 1);
+        m_rebuildTimer->start();
+        return;
+    }
+
+    const int oldCount = m_lines.size();
+    QTextBlock firstBlock = m_document->findBlock(from);
+    QTextBlock lastBlock = m_document->findBlock(from + charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = m_document->lastBlock();
+    }
+
+    const int firstNumber = firstBlock.isValid() ? firstBlock.blockNumber() : 0;
+    const int newAffected = lastBlock.blockNumber() - firstNumber + 1;
+    const int oldAffected = newAffected - (newCount - oldCount);
+    if (newAffected < 1 || oldAffected < 1 || firstNumber + oldAffected > oldCount) {
+        m_lines.resize(newCount);
+        invalidate(0, newCount - 1);
+        return;
+    }
+
+    if (newAffected > oldAffected) {
+        m_lines.insert(firstNumber + oldAffected, newAffected - oldAffected, LineInfo());
+    } else if (newAffected < oldAffected) {
+        m_lines.remove(firstNumber + newAffected, oldAffected - newAffected);
+    }
+
+    // 平移失效行范围，允许范围大于实际失效的行
+    if (m_invalidFrom <= m_invalidTo) {
+        m_invalidFrom = qMin(m_invalidFrom, firstNumber);
+        if (m_invalidTo >= firstNumber + oldAffected) {
+            m_invalidTo += newAffected - oldAffected;
+        }
+    }
+    invalidate(firstNumber, firstNumber + newAffected - 1);
+}
+
+FoldRegionIndex::LineInfo FoldRegionIndex::computeLine(const QString &text, const QString &singleLine, const QString &multiLineStart)
+{
+    LineInfo info;
+    info.valid = true;
+    info.flags = computeFlags(text, singleLine, multiLineStart);
+    info.summary = computeSummary(text);
+
+    return info;
+}
+
+/**
+ * @brief 计算单行 '{' '}' 的括号摘要，字符串的判断规则和括号匹配一致
+ */
+FoldRegionIndex::BraceSummary FoldRegionIndex::computeSummary(const QString &text)
+{
+    BraceSummary summary;
+    int depth = 0;
+    int minDepth = 0;
+    bool inString = false;
+
+    for (int i = 0; i < text.size(); i++) {
+        const QChar c = text.at(i);
+        if (inString) {
+            // 判断 " 前是否存在转义字符，若不存在，则退出字符串
+            if ('"' == c && !(i > 0 && '\\' == text.at(i - 1))) {
+                inString = false;
+            }
+        } else if ('{' == c) {
+            depth++;
+            summary.hasOpen = true;
+            summary.lastOpenMatched = false;
+        } else if ('}' == c) {
+            // 最后一个左括号之后的首个右括号和其匹配
+            if (summary.hasOpen) {
+                summary.lastOpenMatched = true;
+            }
+            depth--;
+            minDepth = qMin(minDepth, depth);
+        } else if ('"' == c) {
+            inString = true;
+        }
+    }
+
+    summary.closes = -minDepth;
+    summary.opens = depth - minDepth;
+
+    return summary;
+}
+
+QVector<FoldRegionIndex::LineInfo> FoldRegionIndex::computeLines(const QString &rawText, const QString &singleLine, const QString &multiLineStart)
+{
+    QVector<LineInfo> lines;
+    int begin = 0;
+    while (true) {
+        int end = rawText.indexOf(QChar::ParagraphSeparator, begin);
+        if (-1 == end) {
+            end = rawText.size();
+        }
+
+        lines.append(computeLine(rawText.mid(begin, end - begin), singleLine, multiLineStart));
+        if (end >= rawText.size()) {
+            break;
+        }
+        begin = end + 1;
+    }
+
+    return lines;
+}
+
+const FoldRegionIndex::LineInfo &FoldRegionIndex::lineInfo(int line)
+{
+    if (m_lines.size() != m_document->blockCount()) {
+        m_lines.resize(m_document->blockCount());
+        invalidate(0, m_lines.size() - 1);
+        m_regionsDirty = true;
+    }
+
+    LineInfo &info = m_lines[line];
+    if (!info.valid) {
+        info = computeLine(m_document->findBlockByNumber(line).text(), m_singleLineMark, m_multiLineStartMark);
+        m_regionsDirty = true;
+    }
+
+    return info;
+}
+
+void FoldRegionIndex::ensureLines()
+{
+    if (m_lines.size() != m_document->blockCount()) {
+        m_lines.resize(m_document->blockCount());
+        invalidate(0, m_lines.size() - 1);
+    }
+    if (m_invalidFrom > m_invalidTo) {
+        return;
+    }
+
+    const int to = qMin(m_invalidTo, m_lines.size() - 1);
+    QTextBlock block = m_document->findBlockByNumber(m_invalidFrom);
+    for (int line = m_invalidFrom; line <= to && block.isValid(); line++, block = block.next()) {
+        if (!m_lines.at(line).valid) {
+            m_lines[line] = computeLine(block.text(), m_singleLineMark, m_multiLineStartMark);
+        }
+    }
+
+    m_invalidFrom = 0;
+    m_invalidTo = -1;
+    m_regionsDirty = true;
+}
+
+/**
+ * @brief 按行顺序遍历括号摘要，使用左括号栈(按行合并计数)计算每行最后一个左括号匹配的右括号所在行，
+ *      耗时和行数线性相关
+ */
+void FoldRegionIndex::ensureRegions()
+{
+    ensureLines();
+    if (!m_regionsDirty && m_foldEnds.size() == m_lines.size()) {
+        return;
+    }
+
+    // 同一行未匹配的左括号，tracked 标识栈顶(最后一个)左括号是否为该行需要折叠的左括号
+    struct OpenRun {
+        int line;
+        int count;
+        bool tracked;
+    };
+
+    const int count = m_lines.size();
+    m_foldEnds.fill(NoFoldRegion, count);
+    QVector<OpenRun> runs;
+
+    for (int line = 0; line < count; line++) {
+        const BraceSummary &summary = m_lines.at(line).summary;
+
+        int closes = summary.closes;
+        while (closes > 0 && !runs.isEmpty()) {
+            OpenRun &run = runs.last();
+            if (run.tracked) {
+                m_foldEnds[run.line] = line;
+                run.tracked = false;
+            }
+
+            const int matched = qMin(closes, run.count);
+            run.count -= matched;
+            closes -= matched;
+            if (0 == run.count) {
+                runs.removeLast();
+            }
+        }
+
+        if (summary.hasOpen) {
+            m_foldEnds[line] = summary.lastOpenMatched ? line : UnmatchedFoldRegion;
+        }
+        if (summary.opens > 0) {
+            runs.append({line, summary.opens, summary.hasOpen && !summary.lastOpenMatched});
+        }
+    }
+
+    m_regionsDirty = false;
+}
+
+/**
+ * @brief 最后一个左括号未在行内匹配时，向后累加每行的括号摘要，
+ *      首个使未匹配的左括号全部闭合的行即为折叠区域结束行，和 ensureRegions() 的结果一致
+ */
+int FoldRegionIndex::scanFoldEnd(int line)
+{
+    const BraceSummary summary = lineInfo(line).summary;
+    if (!summary.hasOpen) {
+        return NoFoldRegion;
+    } else if (summary.lastOpenMatched) {
+        return line;
+    }
+
+    // 最后一个左括号及之后各行未匹配的左括号数量
+    int depth = 1;
+    const int count = m_document->blockCount();
+    for (int next = line + 1; next < count; next++) {
+        const BraceSummary &nextSummary = lineInfo(next).summary;
+        if (nextSummary.closes >= depth) {
+            return next;
+        }
+        depth += nextSummary.opens - nextSummary.closes;
+    }
+
+    return UnmatchedFoldRegion;
+}
+
+void FoldRegionIndex::invalidate(int from, int to)
+{
+    to = qMin(to, m_lines.size() - 1);
+    for (int line = qMax(0, from); line <= to; line++) {
+        m_lines[line].valid = false;
+    }
+
+    if (m_invalidFrom > m_invalidTo) {
+        m_invalidFrom = from;
+        m_invalidTo = to;
+    } else {
+        m_invalidFrom = qMin(m_invalidFrom, from);
+        m_invalidTo = qMax(m_invalidTo, to);
+    }
+    m_regionsDirty = true;
+}
+
+void FoldRegionIndex::onBuildFinished(quint64 buildId)
+{
+    if (!m_watcher || buildId != m_buildId) {
+        return;
+    }
+
+    QFutureWatcher<QVector<LineInfo>> *watcher = m_watcher;
+    m_watcher = nullptr;
+    watcher->disconnect(this);
+    watcher->deleteLater();
+
+    // 构建期间文档已变更，丢弃结果
+    if (m_document->revision() != m_buildRevision) {
+        return;
+    }
+
+    const QVector<LineInfo> lines = watcher->result();
+    if (lines.size() != m_document->blockCount()) {
+        return;
+    }
+
+    m_lines = lines;
+    m_invalidFrom = 0;
+    m_invalidTo = -1;
+    m_regionsDirty = true;
+    emit regionsReady();
+}
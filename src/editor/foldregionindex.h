@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FOLDREGIONINDEX_H
+#define FOLDREGIONINDEX_H
+
+#include <QObject>
+#include <QVector>
+#include <QFutureWatcher>
+
+class QTextDocument;
+class QTimer;
+
+/**
+ * @brief 代码折叠区域索引
+ *      按行记录折叠相关的标识及 '{' '}' 的括号摘要，首次在后台线程构建，之后根据文档 contentsChange
+ *      仅重新计算变更的行。折叠区域(每行最后一个 '{' 到匹配的 '}' 所在行)通过括号摘要一次线性遍历得到，
+ *      折叠/展开、折叠图标绘制及折叠内容预览均直接查询索引，无需重新扫描文本。
+ */
+class FoldRegionIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 折叠区域查询结果
+    enum FoldRegion {
+        NoFoldRegion = -2,          ///< 行内没有左括号
+        UnmatchedFoldRegion = -1    ///< 没有匹配的右括号，折叠到文档末尾
+    };
+
+    // 行标识
+    enum LineFlag {
+        HasBraceFlag = 0x1,         ///< 去除字符串后包含 '{'
+        NeedFoldIconFlag = 0x2,     ///< 首个 '{' 之后左右括号数量不一致
+        CommentFlag = 0x4,          ///< 以当前语法的注释标记开始
+        SlashCommentFlag = 0x8      ///< 以 "//" 开始
+    };
+
+    explicit FoldRegionIndex(QTextDocument *document, QObject *parent = nullptr);
+    ~FoldRegionIndex() override;
+
+    // 设置注释标记，标记变更时重新计算所有行
+    void setCommentMarks(const QString &singleLine, const QString &multiLineStart);
+    // 在后台线程重新构建所有行的索引
+    void rebuild();
+    // 立即开始待执行的构建，等待后台构建完成并应用结果
+    void waitForFinished();
+    // 是否存在未完成或待执行的后台构建
+    bool isBuilding() const;
+    // 所有行的索引是否均已计算
+    bool isReady() const;
+
+    // 取得行标识
+    int lineFlags(int line);
+    // 是否需要绘制折叠图标
+    bool isFoldIconLine(int line);
+    // 取得行 line 的折叠区域结束行，可能为 NoFoldRegion 或 UnmatchedFoldRegion，
+    // 后台构建完成前不等待结果，从行 line 开始向后逐行计算
+    int foldEndLine(int line);
+
+    // 计算行文本的标识
+    static int computeFlags(const QString &text, const QString &singleLine, const QString &multiLineStart);
+    // 首个 '{' 之后左右括号数量是否不一致
+    static bool needFoldIcon(const QString &text);
+
+signals:
+    // 后台构建的结果已应用，折叠区域可以查询
+    void regionsReady();
+
+public slots:
+    // 文档内容变更时失效变更的行
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+
+private:
+    // 单行 '{' '}' 的括号摘要，不统计字符串内的括号。字符串状态在每行开始时重置，
+    // 避免单个未配对的引号(字符常量、注释等)影响之后所有行
+    struct BraceSummary {
+        int closes = 0;                 ///< 和之前行的左括号匹配的右括号数量
+        int opens = 0;                  ///< 未在行内匹配的左括号数量
+        bool hasOpen = false;           ///< 是否包含左括号
+        bool lastOpenMatched = false;   ///< 最后一个左括号是否在行内匹配
+    };
+
+    struct LineInfo {
+        bool valid = false;
+        int flags = 0;
+        BraceSummary summary;
+    };
+
+    static LineInfo computeLine(const QString &text, const QString &singleLine, const QString &multiLineStart);
+    static BraceSummary computeSummary(const QString &text);
+    static QVector<LineInfo> computeLines(const QString &rawText, const QString &singleLine, const QString &multiLineStart);
+
+    // 取得行索引，未计算时根据文本块重新计算
+    const LineInfo &lineInfo(int line);
+    // 计算所有失效的行
+    void ensureLines();
+    // 根据括号摘要重新计算所有行的折叠区域
+    void ensureRegions();
+    // 从行 line 开始向后逐行累加括号摘要，查找单个折叠区域的结束行
+    int scanFoldEnd(int line);
+    void invalidate(int from, int to);
+    void onBuildFinished(quint64 buildId);
+
+private:
+    QTextDocument *m_document = nullptr;
+    QString m_singleLineMark;           ///< 单行注释标记
+    QString m_multiLineStartMark;       ///< 多行注释起始标记
+
+    QVector<LineInfo> m_lines;          ///< 按行记录的索引
+    QVector<int> m_foldEnds;            ///< 按行记录的折叠区域结束行
+    bool m_regionsDirty = true;         ///< 折叠区域是否需要重新计算
+    int m_invalidFrom = 0;              ///< 失效行范围
+    int m_invalidTo = -1;
+
+    QTimer *m_rebuildTimer = nullptr;   ///< 大量变更后延迟重新构建
+    QFutureWatcher<QVector<LineInfo>> *m_watcher = nullptr;
+    quint64 m_buildId = 0;              ///< 当前后台构建标识
+    int m_buildRevision = -1;           ///< 后台构建时的文档版本
+};
+
+#endif  // FOLDREGIONINDEX_H
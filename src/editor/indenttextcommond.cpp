@@ -3,71 +3,135 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "indenttextcommond.h"
-#include "dtextedit.h"
 
-IndentTextCommand::IndentTextCommand(TextEdit* edit,int startpos,int endpos,int startline,int endline):
+#include <QTextBlock>
+
+// 取消缩进时删除的是制表符
+static const quint8 s_removedTab = 0xFF;
+
+IndentTextCommand::IndentTextCommand(QPlainTextEdit *edit, int startline, int endline, bool unindent, int tabSpaceNumber):
     m_edit(edit),
-    m_startpos(startpos),
-    m_endpos(endpos),
-    m_startline(startline),
-    m_endline(endline)
+    m_startline(qMin(startline, endline)),
+    m_endline(qMax(startline, endline)),
+    m_unindent(unindent)
 {
-    m_hasselected = m_edit->textCursor().hasSelection();
+    const QTextCursor cursor = m_edit->textCursor();
+    m_anchorBefore = cursor.anchor();
+    m_positionBefore = cursor.position();
+
+    if (m_unindent) {
+        //calculate the indent of every line, '\t' or at most tabSpaceNumber ' '.
+        QTextDocument *document = m_edit->document();
+        const int maxSpaces = qBound(1, tabSpaceNumber, 0xFE);
+        m_removed.reserve(m_endline - m_startline + 1);
+        QTextBlock block = document->findBlockByNumber(m_startline);
+        for (int line = m_startline; line <= m_endline && block.isValid(); line++, block = block.next()) {
+            const int pos = block.position();
+            const int end = pos + block.length() - 1;
+            quint8 width = 0;
+            if (pos < end && QChar('\t') == document->characterAt(pos)) {
+                width = s_removedTab;
+            } else {
+                while (pos + width < end && width < maxSpaces && QChar(' ') == document->characterAt(pos + width)) {
+                    width++;
+                }
+            }
+            m_removed.append(width);
+        }
+    }
 }
+
 IndentTextCommand::~IndentTextCommand()
 {
 
 }
 
-void IndentTextCommand::redo()
+bool IndentTextCommand::hasChange() const
 {
-    auto cursor = m_edit->textCursor();
-
-    //insert "\t" in front of multiple lines.
-    cursor.setPosition(m_startpos);
-    for(int i=m_startline;i<=m_endline;i++){
-        cursor.movePosition(QTextCursor::StartOfBlock);
-        cursor.insertText("\t");
-
-        cursor.movePosition(QTextCursor::NextBlock);
+    if (!m_unindent) {
+        return true;
     }
 
-    //reset selection.
-    if(m_hasselected){
-        if(m_startline == m_endline){
-            cursor.setPosition(m_startpos);
-            cursor.movePosition(QTextCursor::StartOfBlock);
-            cursor.movePosition(QTextCursor::EndOfBlock,QTextCursor::KeepAnchor);
-            m_edit->setTextCursor(cursor);
-        }
-        else{
-            cursor.setPosition(m_startpos+1);
-            cursor.setPosition(m_endpos + m_endline - m_startline +1,QTextCursor::KeepAnchor);
-            m_edit->setTextCursor(cursor);
+    for (quint8 width : m_removed) {
+        if (width > 0) {
+            return true;
         }
-
     }
+
+    return false;
 }
 
+void IndentTextCommand::redo()
+{
+    applyIndent(!m_unindent);
 
+    //the selection moves with the text at first time, reset it when redo.
+    if (m_hasSelectionAfter) {
+        setSelection(m_anchorAfter, m_positionAfter);
+    } else {
+        const QTextCursor cursor = m_edit->textCursor();
+        m_anchorAfter = cursor.anchor();
+        m_positionAfter = cursor.position();
+        m_hasSelectionAfter = true;
+    }
+}
 
 void IndentTextCommand::undo()
 {
-    auto cursor = m_edit->textCursor();
+    applyIndent(m_unindent);
 
-    //delete "\t" in front of multiple lines.
-    cursor.setPosition(m_startpos);
-    for(int i=m_startline;i<=m_endline;i++){
-        cursor.movePosition(QTextCursor::StartOfBlock);
-        cursor.deleteChar();
+    //reset selection
+    setSelection(m_anchorBefore, m_positionBefore);
+}
 
-        cursor.movePosition(QTextCursor::NextBlock);
-    }
+/**
+ * @brief 在同一编辑块内逐行插入或删除行首缩进，文本块不会重建，仅发送一次 contentsChange
+ */
+void IndentTextCommand::applyIndent(bool insert)
+{
+    QTextDocument *document = m_edit->document();
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
 
-    //reset selection
-    if(m_hasselected){
-        cursor.setPosition(m_startpos);
-        cursor.setPosition(m_endpos,QTextCursor::KeepAnchor);
-        m_edit->setTextCursor(cursor);
+    QTextBlock block = document->findBlockByNumber(m_startline);
+    for (int line = m_startline; line <= m_endline && block.isValid(); line++, block = block.next()) {
+        const int pos = block.position();
+        if (!m_unindent) {
+            cursor.setPosition(pos);
+            if (insert) {
+                //insert "\t" in front of the line.
+                cursor.insertText("\t");
+            } else {
+                cursor.setPosition(pos + 1, QTextCursor::KeepAnchor);
+                cursor.removeSelectedText();
+            }
+            continue;
+        }
+
+        const int index = line - m_startline;
+        const quint8 width = index < m_removed.size() ? m_removed.at(index) : 0;
+        if (0 == width) {
+            continue;
+        }
+
+        const QString indent = (s_removedTab == width) ? QString("\t") : QString(width, ' ');
+        cursor.setPosition(pos);
+        if (insert) {
+            cursor.insertText(indent);
+        } else {
+            cursor.setPosition(pos + indent.size(), QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+        }
     }
+
+    cursor.endEditBlock();
+}
+
+void IndentTextCommand::setSelection(int anchor, int position)
+{
+    const int maxPosition = qMax(0, m_edit->document()->characterCount() - 1);
+    QTextCursor cursor = m_edit->textCursor();
+    cursor.setPosition(qBound(0, anchor, maxPosition));
+    cursor.setPosition(qBound(0, position, maxPosition), QTextCursor::KeepAnchor);
+    m_edit->setTextCursor(cursor);
 }
@@ -9,30 +9,46 @@
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QPlainTextEdit>
-class TextEdit;
-//indent text in front of multiple lines
-class IndentTextCommand:public QUndoCommand
+#include <QVector>
+
+/**
+ * @brief indent or unindent text in front of multiple lines.
+ *      所有行在同一编辑块内修改，文档只发送一次变更通知。缩进无需记录额外数据，
+ *      取消缩进仅记录每行删除的缩进宽度(1 字节)。
+ */
+class IndentTextCommand : public QUndoCommand
 {
 public:
-    IndentTextCommand(TextEdit* edit,int startpos,int endpos,int startline,int endline);
+    // 缩进或取消缩进文本块 [startline, endline]，取消缩进时每行删除一个制表符或最多 tabSpaceNumber 个空格
+    IndentTextCommand(QPlainTextEdit *edit, int startline, int endline, bool unindent = false, int tabSpaceNumber = 4);
     virtual ~IndentTextCommand();
 
+    // 是否存在需要修改的行，取消缩进时所有行均无缩进则不存在
+    bool hasChange() const;
+
     virtual void redo();
     virtual void undo();
 
 private:
+    // 按行修改缩进，insert 为 true 时插入缩进，否则删除缩进
+    void applyIndent(bool insert);
+    void setSelection(int anchor, int position);
 
-    TextEdit* m_edit=nullptr;
-    //the start postion of selected text.
-    int m_startpos=0;
-    //the end postion of selected text.
-    int m_endpos=0;
+    QPlainTextEdit *m_edit = nullptr;
     //the start line of selected text.
-    int m_startline=0;
+    int m_startline = 0;
     //the end line of selected text.
-    int m_endline=0;
-    bool m_hasselected=false;
+    int m_endline = 0;
+    bool m_unindent = false;
+    //取消缩进时每行删除的缩进，0 表示无缩进
+    QVector<quint8> m_removed;
 
+    //the selection before and after indent.
+    int m_anchorBefore = 0;
+    int m_positionBefore = 0;
+    int m_anchorAfter = 0;
+    int m_positionAfter = 0;
+    bool m_hasSelectionAfter = false;
 };
 
 #endif // IndentTextCommand_H
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "latencyoverlay.h"
+#include "../common/performancemonitor.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QEvent>
+#include <QTimer>
+
+namespace {
+// 浮层边距
+const int s_margin = 6;
+}  // namespace
+
+LatencyOverlay::LatencyOverlay(QWidget *parent)
+    : QWidget(parent)
+{
+    // 仅显示统计，鼠标操作仍由编辑区处理
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+
+    QFont overlayFont(QStringLiteral("monospace"));
+    overlayFont.setStyleHint(QFont::Monospace);
+    overlayFont.setPointSize(qMax(6, parent->font().pointSize() - 2));
+    setFont(overlayFont);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(s_refreshInterval);
+    connect(m_refreshTimer, &QTimer::timeout, this, &LatencyOverlay::refresh);
+
+    parent->installEventFilter(this);
+    hide();
+}
+
+QStringList LatencyOverlay::statisticsLines()
+{
+    QStringList lines;
+    for (int i = 0; i < PerformanceMonitor::LatencyMetricCount; i++) {
+        const auto metric = static_cast<PerformanceMonitor::LatencyMetric>(i);
+        if (0 == PerformanceMonitor::latencyCount(metric)) {
+            continue;
+        }
+
+        lines.append(QString("%1  p50 %2ms  p99 %3ms")
+                     .arg(PerformanceMonitor::latencyName(metric), -18)
+                     .arg(QString::number(PerformanceMonitor::latencyPercentile(metric, 50) / 1000.0, 'f', 2))
+                     .arg(QString::number(PerformanceMonitor::latencyPercentile(metric, 99) / 1000.0, 'f', 2)));
+    }
+
+    return lines;
+}
+
+/**
+ * @brief 统计文本变化时调整大小并重绘浮层区域，父控件尺寸变化时重新放置到右上角
+ */
+void LatencyOverlay::refresh()
+{
+    const QStringList lines = statisticsLines();
+    const QFontMetrics metrics(font());
+    int textWidth = 0;
+    for (const QString &line : lines) {
+        textWidth = qMax(textWidth, metrics.horizontalAdvance(line));
+    }
+
+    QRect rect;
+    if (!lines.isEmpty()) {
+        rect = QRect(0, 0, textWidth + 2 * s_margin, metrics.height() * lines.size() + 2 * s_margin);
+        rect.moveTopRight(parentWidget()->rect().topRight() + QPoint(-s_margin, s_margin));
+    }
+    setGeometry(rect);
+
+    if (lines != m_lines) {
+        m_lines = lines;
+        update();
+    }
+}
+
+void LatencyOverlay::paintEvent(QPaintEvent *e)
+{
+    Q_UNUSED(e);
+    if (m_lines.isEmpty()) {
+        return;
+    }
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    painter.drawText(rect().adjusted(s_margin, s_margin, -s_margin, -s_margin),
+                     Qt::AlignLeft | Qt::AlignTop, m_lines.join('\n'));
+}
+
+void LatencyOverlay::showEvent(QShowEvent *e)
+{
+    refresh();
+    m_refreshTimer->start();
+    QWidget::showEvent(e);
+}
+
+void LatencyOverlay::hideEvent(QHideEvent *e)
+{
+    m_refreshTimer->stop();
+    QWidget::hideEvent(e);
+}
+
+bool LatencyOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == parentWidget() && QEvent::Resize == event->type() && !isHidden()) {
+        refresh();
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LATENCYOVERLAY_H
+#define LATENCYOVERLAY_H
+
+#include <QWidget>
+#include <QStringList>
+
+class QTimer;
+
+/**
+ * @brief 耗时统计浮层
+ *      作为编辑区视口的子控件显示在右上角，定时刷新各耗时指标的 p50/p99 。
+ *      独立绘制，不受编辑区局部刷新的裁剪区域影响，刷新时也只重绘浮层所在区域。
+ */
+class LatencyOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyOverlay(QWidget *parent);
+
+    // 各耗时指标的统计文本，无统计数据的指标不显示
+    static QStringList statisticsLines();
+    // 重新统计并按内容调整大小，放置在父控件右上角
+    void refresh();
+
+    // 刷新间隔(ms)
+    static const int s_refreshInterval = 500;
+
+protected:
+    void paintEvent(QPaintEvent *e) override;
+    void showEvent(QShowEvent *e) override;
+    void hideEvent(QHideEvent *e) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    QTimer *m_refreshTimer = nullptr;
+    QStringList m_lines;            ///< 当前显示的统计文本
+};
+
+#endif  // LATENCYOVERLAY_H
@@ -9,6 +9,8 @@
 #include "dtextedit.h"
 
 #include <QHBoxLayout>
+#include <QScrollBar>
+#include <QTextDocument>
 #include <QDebug>
 
 
@@ -86,6 +88,7 @@ void LeftAreaTextEdit::updateCodeFlod()
 
 void LeftAreaTextEdit::updateAll()
 {
+    invalidateBlockGeometry();
     if (m_pLineNumberArea) m_pLineNumberArea->update();
     if (m_pBookMarkArea) m_pBookMarkArea->update();
     if (m_pFlodArea) m_pFlodArea->update();
@@ -111,4 +114,56 @@ TextEdit* LeftAreaTextEdit::getEdit()
     return m_pTextEdit;
 }
 
+/**
+ * @brief 三个子控件在同一帧内绘制，首次绘制时计算可视区域文本块的几何信息，
+ *      并在事件循环返回后失效，同一帧内的后续绘制直接读取缓存。
+ */
+const QVector<VisibleBlockGeometry> &LeftAreaTextEdit::visibleBlockGeometry()
+{
+    const GeometryKey key = currentGeometryKey();
+    if (!m_geometryValid || !(key == m_geometryKey)) {
+        m_pTextEdit->updateVisibleBlockGeometry(m_blockGeometry);
+        // 几何信息更新时可能调整控件宽度，重新读取状态
+        m_geometryKey = currentGeometryKey();
+        if (!m_geometryValid) {
+            m_geometryValid = true;
+            QMetaObject::invokeMethod(this, &LeftAreaTextEdit::invalidateBlockGeometry, Qt::QueuedConnection);
+        }
+    }
+
+    return m_blockGeometry;
+}
+
+const VisibleBlockGeometry *LeftAreaTextEdit::blockGeometry(int blockNumber)
+{
+    const QVector<VisibleBlockGeometry> &geometry = visibleBlockGeometry();
+    if (geometry.isEmpty()) {
+        return nullptr;
+    }
+
+    // 可视区域文本块序号连续
+    const int index = blockNumber - geometry.first().blockNumber;
+    if (index < 0 || index >= geometry.size()) {
+        return nullptr;
+    }
+
+    return &geometry.at(index);
+}
+
+void LeftAreaTextEdit::invalidateBlockGeometry()
+{
+    m_geometryValid = false;
+}
+
+LeftAreaTextEdit::GeometryKey LeftAreaTextEdit::currentGeometryKey() const
+{
+    GeometryKey key;
+    key.scrollValue = m_pTextEdit->verticalScrollBar()->value();
+    key.revision = m_pTextEdit->document()->revision();
+    key.blockCount = m_pTextEdit->document()->blockCount();
+    key.viewportHeight = m_pTextEdit->viewport()->height();
+
+    return key;
+}
+
 
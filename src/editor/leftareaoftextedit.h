@@ -6,12 +6,24 @@
 #define LEFTAREAOFTEXTEDIT_H
 
 #include <QWidget>
+#include <QVector>
 
 class CodeFlodArea;
 class BookMarkWidget;
 class LineNumberArea;
 class TextEdit;
 
+/**
+ * @brief 可视区域文本块的几何信息，每帧由 TextEdit 计算一次，行号、书签及折叠区域绘制时共享
+ */
+struct VisibleBlockGeometry {
+    int blockNumber = 0;        ///< 文本块序号
+    int y = 0;                  ///< 文本块首行相对视口的纵坐标
+    int height = 0;             ///< 文本块首行高度
+    bool visible = true;        ///< 文本块是否可见(未被折叠)
+    bool nextVisible = true;    ///< 下一文本块是否可见，用于判断折叠状态
+};
+
 class LeftAreaTextEdit : public QWidget
 {
     Q_OBJECT
@@ -27,6 +39,12 @@ public:
     void updateCodeFlod();
     void updateAll();
     TextEdit* getEdit();
+    // 取得当前帧可视区域文本块的几何信息，每帧仅计算一次
+    const QVector<VisibleBlockGeometry> &visibleBlockGeometry();
+    // 取得文本块 blockNumber 的几何信息，不在可视区域时返回 nullptr
+    const VisibleBlockGeometry *blockGeometry(int blockNumber);
+    // 失效缓存的几何信息，下次绘制时重新计算
+    void invalidateBlockGeometry();
 protected:
     void paintEvent(QPaintEvent *event);
 public:
@@ -34,8 +52,27 @@ public:
     BookMarkWidget *m_pBookMarkArea = nullptr;
     CodeFlodArea *m_pFlodArea = nullptr;
 
+private:
+    // 缓存几何信息时的编辑器状态，任一变更时需重新计算
+    struct GeometryKey {
+        int scrollValue = -1;
+        int revision = -1;
+        int blockCount = -1;
+        int viewportHeight = -1;
+
+        bool operator==(const GeometryKey &other) const
+        {
+            return scrollValue == other.scrollValue && revision == other.revision
+                   && blockCount == other.blockCount && viewportHeight == other.viewportHeight;
+        }
+    };
+    GeometryKey currentGeometryKey() const;
+
 private:
     TextEdit *m_pTextEdit = nullptr;
+    QVector<VisibleBlockGeometry> m_blockGeometry;  ///< 当前帧可视区域文本块的几何信息
+    GeometryKey m_geometryKey;                      ///< 计算几何信息时的编辑器状态
+    bool m_geometryValid = false;                   ///< 几何信息是否有效
 };
 
 #endif // LEFTAREAOFTEXTEDIT_H
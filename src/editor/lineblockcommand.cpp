@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "lineblockcommand.h"
+#include "../common/utils.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+
+LineBlockCommand::LineBlockCommand(QPlainTextEdit *edit, Operation operation, bool merge)
+    : m_edit(edit)
+    , m_operation(operation)
+    , m_merge(merge)
+{
+    const QTextCursor cursor = edit->textCursor();
+    m_anchorBefore = cursor.anchor();
+    m_positionBefore = cursor.position();
+    m_anchorAfter = m_anchorBefore;
+    m_positionAfter = m_positionBefore;
+}
+
+/**
+ * @brief 上移时移除选中行的上一行并插入到选中行之后，下移时移除下一行并插入到选中行之前，
+ *      仅移动相邻的一行文本，选中行的内容不变
+ */
+LineBlockCommand *LineBlockCommand::moveLines(QPlainTextEdit *edit, bool up, bool merge)
+{
+    if (!edit) {
+        return nullptr;
+    }
+
+    int first = 0;
+    int last = 0;
+    selectedBlockRange(edit, first, last);
+    QTextDocument *document = edit->document();
+
+    if (up) {
+        if (first <= 0) {
+            return nullptr;
+        }
+
+        const QTextBlock previous = document->findBlockByNumber(first - 1);
+        const QTextBlock lastBlock = document->findBlockByNumber(last);
+        const QString line = previous.text();
+        const int lineLength = line.size() + 1;
+
+        auto command = new LineBlockCommand(edit, MoveLines, merge);
+        command->m_edits.append({previous.position(), line + '\n', QString()});
+        command->m_edits.append({lastBlock.position() + lastBlock.length() - 1 - lineLength, QString(), '\n' + line});
+        command->shiftSelection(-lineLength);
+        return command;
+    }
+
+    if (last + 1 >= document->blockCount()) {
+        return nullptr;
+    }
+
+    const QTextBlock next = document->findBlockByNumber(last + 1);
+    const QTextBlock firstBlock = document->findBlockByNumber(first);
+    const QString line = next.text();
+    const int lineLength = line.size() + 1;
+
+    auto command = new LineBlockCommand(edit, MoveLines, merge);
+    command->m_edits.append({next.position() - 1, '\n' + line, QString()});
+    command->m_edits.append({firstBlock.position(), QString(), line + '\n'});
+    command->shiftSelection(lineLength);
+    return command;
+}
+
+LineBlockCommand *LineBlockCommand::duplicateLines(QPlainTextEdit *edit, bool merge)
+{
+    if (!edit) {
+        return nullptr;
+    }
+
+    int first = 0;
+    int last = 0;
+    selectedBlockRange(edit, first, last);
+    QTextDocument *document = edit->document();
+    const QTextBlock firstBlock = document->findBlockByNumber(first);
+    const QTextBlock lastBlock = document->findBlockByNumber(last);
+    const int end = lastBlock.position() + lastBlock.length() - 1;
+    const QString text = documentText(edit, firstBlock.position(), end);
+
+    auto command = new LineBlockCommand(edit, DuplicateLines, merge);
+    command->m_edits.append({end, QString(), '\n' + text});
+    command->shiftSelection(text.size() + 1);
+    return command;
+}
+
+LineBlockCommand *LineBlockCommand::joinLines(QPlainTextEdit *edit, bool merge)
+{
+    if (!edit) {
+        return nullptr;
+    }
+
+    int first = 0;
+    int last = 0;
+    selectedBlockRange(edit, first, last);
+    QTextDocument *document = edit->document();
+    if (first == last) {
+        if (last + 1 >= document->blockCount()) {
+            return nullptr;
+        }
+        last++;
+    }
+
+    const QTextBlock firstBlock = document->findBlockByNumber(first);
+    const QTextBlock lastBlock = document->findBlockByNumber(last);
+    const int from = firstBlock.position();
+    const QString text = documentText(edit, from, lastBlock.position() + lastBlock.length() - 1);
+    QString joined = text;
+    joined.remove('\n');
+
+    auto command = new LineBlockCommand(edit, JoinLines, merge);
+    command->m_edits.append({from, text, joined});
+    // 光标置于首行原有内容之后
+    command->m_anchorAfter = from + firstBlock.length() - 1;
+    command->m_positionAfter = command->m_anchorAfter;
+    return command;
+}
+
+void LineBlockCommand::undo()
+{
+    QTextCursor cursor(m_edit->document());
+    cursor.beginEditBlock();
+    for (int i = m_edits.size() - 1; i >= 0; i--) {
+        const Edit &edit = m_edits.at(i);
+        cursor.setPosition(edit.position);
+        cursor.setPosition(edit.position + edit.added.size(), QTextCursor::KeepAnchor);
+        if (edit.removed.isEmpty()) {
+            cursor.removeSelectedText();
+        } else {
+            cursor.insertText(edit.removed);
+        }
+    }
+    cursor.endEditBlock();
+
+    setSelection(m_anchorBefore, m_positionBefore);
+}
+
+void LineBlockCommand::redo()
+{
+    QTextCursor cursor(m_edit->document());
+    cursor.beginEditBlock();
+    for (const Edit &edit : m_edits) {
+        cursor.setPosition(edit.position);
+        cursor.setPosition(edit.position + edit.removed.size(), QTextCursor::KeepAnchor);
+        if (edit.added.isEmpty()) {
+            cursor.removeSelectedText();
+        } else {
+            cursor.insertText(edit.added);
+        }
+    }
+    cursor.endEditBlock();
+
+    setSelection(m_anchorAfter, m_positionAfter);
+}
+
+int LineBlockCommand::id() const
+{
+    return Utils::IdLineBlock;
+}
+
+/**
+ * @brief 合并长按快捷键时的连续操作，要求操作类型相同且两次操作之间选区未变化，
+ *      合并仅追加文本替换记录，撤销时按相反顺序还原
+ */
+bool LineBlockCommand::mergeWith(const QUndoCommand *other)
+{
+    if (other->id() != id()) {
+        return false;
+    }
+
+    auto command = static_cast<const LineBlockCommand *>(other);
+    if (!command->m_merge || command->m_edit != m_edit || command->m_operation != m_operation
+            || command->m_anchorBefore != m_anchorAfter || command->m_positionBefore != m_positionAfter) {
+        return false;
+    }
+
+    m_edits += command->m_edits;
+    m_anchorAfter = command->m_anchorAfter;
+    m_positionAfter = command->m_positionAfter;
+    return true;
+}
+
+void LineBlockCommand::selectedBlockRange(QPlainTextEdit *edit, int &firstBlock, int &lastBlock)
+{
+    const QTextCursor cursor = edit->textCursor();
+    QTextDocument *document = edit->document();
+    const QTextBlock first = document->findBlock(cursor.selectionStart());
+    QTextBlock last = document->findBlock(cursor.selectionEnd());
+    if (last.blockNumber() > first.blockNumber() && cursor.selectionEnd() == last.position()) {
+        last = last.previous();
+    }
+
+    firstBlock = qMax(0, first.blockNumber());
+    lastBlock = qMax(firstBlock, last.blockNumber());
+}
+
+QString LineBlockCommand::documentText(QPlainTextEdit *edit, int from, int to)
+{
+    QTextCursor cursor(edit->document());
+    cursor.setPosition(from);
+    cursor.setPosition(to, QTextCursor::KeepAnchor);
+    QString text = cursor.selectedText();
+    text.replace(QChar::ParagraphSeparator, '\n');
+    return text;
+}
+
+void LineBlockCommand::shiftSelection(int offset)
+{
+    m_anchorAfter = m_anchorBefore + offset;
+    m_positionAfter = m_positionBefore + offset;
+}
+
+void LineBlockCommand::setSelection(int anchor, int position)
+{
+    QTextCursor cursor = m_edit->textCursor();
+    cursor.setPosition(anchor);
+    cursor.setPosition(position, QTextCursor::KeepAnchor);
+    m_edit->setTextCursor(cursor);
+}
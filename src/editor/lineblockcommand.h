@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LINEBLOCKCOMMAND_H
+#define LINEBLOCKCOMMAND_H
+
+#include <QUndoCommand>
+#include <QVector>
+#include <QString>
+
+class QPlainTextEdit;
+
+/**
+ * @brief 以行为单位的移动、复制及合并操作的撤销项
+ *      操作选中的全部行，仅记录实际变更的文本片段，在同一编辑块内执行，文档只发送一次变更通知，
+ *      耗时和移动的文本长度相关，和文档大小无关。长按快捷键时连续的操作合并为一个撤销项。
+ */
+class LineBlockCommand : public QUndoCommand
+{
+public:
+    // 操作类型，相同类型的连续操作可以合并
+    enum Operation {
+        MoveLines,
+        DuplicateLines,
+        JoinLines
+    };
+
+    // 将选中的行上移或下移一行，无法移动时返回 nullptr
+    static LineBlockCommand *moveLines(QPlainTextEdit *edit, bool up, bool merge = false);
+    // 在选中的行之后插入选中行的副本，光标及选区随之移至副本
+    static LineBlockCommand *duplicateLines(QPlainTextEdit *edit, bool merge = false);
+    // 合并选中的行，仅选中一行时和下一行合并，无法合并时返回 nullptr
+    static LineBlockCommand *joinLines(QPlainTextEdit *edit, bool merge = false);
+
+    void undo() override;
+    void redo() override;
+    int id() const override;
+    bool mergeWith(const QUndoCommand *other) override;
+
+private:
+    // 文本片段替换，position 处的 removed 替换为 added
+    struct Edit {
+        int position = 0;
+        QString removed;
+        QString added;
+    };
+
+    LineBlockCommand(QPlainTextEdit *edit, Operation operation, bool merge);
+
+    // 选中的首个及最后一个文本块，选区结束于文本块开头时不包含该文本块
+    static void selectedBlockRange(QPlainTextEdit *edit, int &firstBlock, int &lastBlock);
+    // 文档位置 [from, to) 的文本
+    static QString documentText(QPlainTextEdit *edit, int from, int to);
+    // 按偏移量平移操作前的选区，作为操作后的选区
+    void shiftSelection(int offset);
+    void setSelection(int anchor, int position);
+
+    QPlainTextEdit *m_edit = nullptr;
+    Operation m_operation = MoveLines;
+    bool m_merge = false;           ///< 是否可以合并到之前的撤销项(长按快捷键时)
+    QVector<Edit> m_edits;          ///< 按执行顺序排列的文本替换
+    int m_anchorBefore = 0;         ///< 操作前的选区
+    int m_positionBefore = 0;
+    int m_anchorAfter = 0;          ///< 操作后的选区
+    int m_positionAfter = 0;
+};
+
+#endif  // LINEBLOCKCOMMAND_H
@@ -0,0 +1,364 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "matchintervalindex.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <algorithm>
+
+// 单次变更超过此字符数时(例如加载文件、全部替换)直接重新构建，不进行增量修正
+static const int s_maxPatchChars = 512 * 1024;
+
+MatchIntervalIndex::MatchIntervalIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent)
+    , m_document(document)
+{
+}
+
+MatchIntervalIndex::~MatchIntervalIndex()
+{
+    // 不等待后台任务，仅丢弃其结果
+    for (auto watcher : m_watchers) {
+        watcher->disconnect(this);
+    }
+}
+
+void MatchIntervalIndex::addKeyword(const QString &keyword, Qt::CaseSensitivity caseFlag)
+{
+    if (keyword.isEmpty() || contains(keyword, caseFlag)) {
+        return;
+    }
+
+    KeywordIndex &index = m_indexes[makeKey(keyword, caseFlag)];
+    index.keyword = normalizeText(keyword);
+    index.caseFlag = caseFlag;
+    rebuild(index);
+}
+
+void MatchIntervalIndex::removeKeyword(const QString &keyword, Qt::CaseSensitivity caseFlag)
+{
+    m_indexes.remove(makeKey(keyword, caseFlag));
+}
+
+void MatchIntervalIndex::clear()
+{
+    m_indexes.clear();
+}
+
+bool MatchIntervalIndex::contains(const QString &keyword, Qt::CaseSensitivity caseFlag) const
+{
+    return m_indexes.contains(makeKey(keyword, caseFlag));
+}
+
+QList<MatchIntervalIndex::IndexKey> MatchIntervalIndex::keys() const
+{
+    return m_indexes.keys();
+}
+
+bool MatchIntervalIndex::isReady(const QString &keyword, Qt::CaseSensitivity caseFlag) const
+{
+    auto itr = m_indexes.constFind(makeKey(keyword, caseFlag));
+    return itr != m_indexes.constEnd() && itr->ready;
+}
+
+int MatchIntervalIndex::revision(const QString &keyword, Qt::CaseSensitivity caseFlag) const
+{
+    auto itr = m_indexes.constFind(makeKey(keyword, caseFlag));
+    if (itr == m_indexes.constEnd() || !itr->ready) {
+        return -1;
+    }
+
+    return itr->revision;
+}
+
+int MatchIntervalIndex::matchCount(const QString &keyword, Qt::CaseSensitivity caseFlag) const
+{
+    auto itr = m_indexes.constFind(makeKey(keyword, caseFlag));
+    if (itr == m_indexes.constEnd() || !itr->ready) {
+        return 0;
+    }
+
+    return itr->starts.size();
+}
+
+/**
+ * @brief 查询和区间 [ \a from , \a to ) 相交的匹配项起始位置，使用二分查找，
+ *      耗时仅和区间内的匹配数量相关
+ */
+QVector<int> MatchIntervalIndex::matchesInRange(const QString &keyword, int from, int to, Qt::CaseSensitivity caseFlag) const
+{
+    QVector<int> result;
+    auto itr = m_indexes.constFind(makeKey(keyword, caseFlag));
+    if (itr == m_indexes.constEnd() || !itr->ready || from >= to) {
+        return result;
+    }
+
+    const QVector<int> &starts = itr->starts;
+    const int length = itr->keyword.size();
+    auto lower = std::lower_bound(starts.constBegin(), starts.constEnd(), from - length + 1);
+    auto upper = std::lower_bound(lower, starts.constEnd(), to);
+    result.reserve(static_cast<int>(std::distance(lower, upper)));
+    std::copy(lower, upper, std::back_inserter(result));
+
+    return result;
+}
+
+/**
+ * @brief 查询是否存在起始位置位于区间 [ \a from , \a to ) 的匹配项，仅进行一次二分查找，
+ *      耗时和匹配数量无关，用于按区间统计匹配分布
+ */
+bool MatchIntervalIndex::hasMatchInRange(const QString &keyword, int from, int to, Qt::CaseSensitivity caseFlag) const
+{
+    auto itr = m_indexes.constFind(makeKey(keyword, caseFlag));
+    if (itr == m_indexes.constEnd() || !itr->ready || from >= to) {
+        return false;
+    }
+
+    const QVector<int> &starts = itr->starts;
+    auto lower = std::lower_bound(starts.constBegin(), starts.constEnd(), from);
+    return lower != starts.constEnd() && *lower < to;
+}
+
+void MatchIntervalIndex::waitForFinished()
+{
+    for (auto watcher : m_watchers) {
+        watcher->waitForFinished();
+    }
+    // 处理构建完成的队列通知
+    QCoreApplication::processEvents();
+}
+
+QString MatchIntervalIndex::normalizeText(const QString &text)
+{
+    QString result = text;
+    for (QChar &ch : result) {
+        if (QChar::ParagraphSeparator == ch || QChar::LineSeparator == ch) {
+            ch = QLatin1Char('\n');
+        } else if (QChar::Nbsp == ch) {
+            ch = QLatin1Char(' ');
+        }
+    }
+
+    return result;
+}
+
+QVector<int> MatchIntervalIndex::findAll(const QString &text, const QString &keyword, Qt::CaseSensitivity caseFlag, int offset)
+{
+    QVector<int> result;
+    if (keyword.isEmpty()) {
+        return result;
+    }
+
+    // 匹配项互不重叠，和查找、替换的逐个查找结果一致
+    int pos = text.indexOf(keyword, 0, caseFlag);
+    while (-1 != pos) {
+        result.append(pos + offset);
+        pos = text.indexOf(keyword, pos + keyword.size(), caseFlag);
+    }
+
+    return result;
+}
+
+void MatchIntervalIndex::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    if (m_indexes.isEmpty()) {
+        return;
+    }
+
+    const bool bigChange = qMax(charsRemoved, charsAdded) > s_maxPatchChars;
+    const ContentsDelta delta {from, charsRemoved, charsAdded};
+
+    for (auto itr = m_indexes.begin(); itr != m_indexes.end(); ++itr) {
+        KeywordIndex &index = itr.value();
+        if (bigChange) {
+            rebuild(index);
+            continue;
+        }
+
+        if (!index.ready) {
+            // 构建期间的变更暂存，构建完成后按顺序修正
+            index.pendingDeltas.append(delta);
+            continue;
+        }
+
+        const int length = index.keyword.size();
+        shiftMatches(index.starts, length, delta);
+        rescanWindow(index, from - length + 1, from + charsAdded + length - 1);
+        index.revision++;
+    }
+}
+
+MatchIntervalIndex::IndexKey MatchIntervalIndex::makeKey(const QString &keyword, Qt::CaseSensitivity caseFlag)
+{
+    return qMakePair(normalizeText(keyword), static_cast<int>(caseFlag));
+}
+
+void MatchIntervalIndex::rebuild(KeywordIndex &index)
+{
+    index.ready = false;
+    index.starts.clear();
+    index.pendingDeltas.clear();
+    index.buildId = ++m_nextBuildId;
+
+    const IndexKey key = makeKey(index.keyword, index.caseFlag);
+    const quint64 buildId = index.buildId;
+    const QString text = m_document->toPlainText();
+    const QString keyword = index.keyword;
+    const Qt::CaseSensitivity caseFlag = index.caseFlag;
+
+    auto watcher = new QFutureWatcher<QVector<int>>(this);
+    m_watchers.append(watcher);
+    connect(watcher, &QFutureWatcher<QVector<int>>::finished, this, [this, key, buildId, watcher]() {
+        onBuildFinished(key, buildId, watcher);
+    });
+    watcher->setFuture(QtConcurrent::run([text, keyword, caseFlag]() {
+        return MatchIntervalIndex::findAll(text, keyword, caseFlag);
+    }));
+}
+
+void MatchIntervalIndex::onBuildFinished(const IndexKey &key, quint64 buildId, QFutureWatcher<QVector<int>> *watcher)
+{
+    m_watchers.removeOne(watcher);
+    watcher->deleteLater();
+
+    auto itr = m_indexes.find(key);
+    // 关键字已移除或已重新构建，丢弃此结果
+    if (itr == m_indexes.end() || itr->buildId != buildId) {
+        return;
+    }
+
+    KeywordIndex &index = itr.value();
+    index.starts = watcher->result();
+
+    // 依次应用构建期间的变更，同时记录需要重新扫描的区间(当前文档坐标)
+    const int length = index.keyword.size();
+    int dirtyFrom = -1;
+    int dirtyTo = -1;
+    for (const ContentsDelta &delta : index.pendingDeltas) {
+        shiftMatches(index.starts, length, delta);
+
+        auto mapPos = [&delta](int pos) {
+            if (pos >= delta.from + delta.charsRemoved) {
+                return pos + delta.charsAdded - delta.charsRemoved;
+            }
+            return qMin(pos, delta.from);
+        };
+
+        const int windowFrom = delta.from - length + 1;
+        const int windowTo = delta.from + delta.charsAdded + length - 1;
+        if (-1 == dirtyFrom) {
+            dirtyFrom = windowFrom;
+            dirtyTo = windowTo;
+        } else {
+            dirtyFrom = qMin(mapPos(dirtyFrom), windowFrom);
+            dirtyTo = qMax(mapPos(dirtyTo), windowTo);
+        }
+    }
+    index.pendingDeltas.clear();
+
+    if (-1 != dirtyFrom) {
+        rescanWindow(index, dirtyFrom, dirtyTo);
+    }
+
+    index.ready = true;
+    index.revision++;
+    emit indexReady(index.keyword);
+}
+
+void MatchIntervalIndex::shiftMatches(QVector<int> &starts, int length, const ContentsDelta &delta)
+{
+    // 起始位置在 [from - length + 1, from + charsRemoved) 的匹配项和变更区间相交，已失效
+    const int invalidFrom = delta.from - length + 1;
+    const int invalidTo = delta.from + delta.charsRemoved;
+    const int offset = delta.charsAdded - delta.charsRemoved;
+
+    auto lower = std::lower_bound(starts.begin(), starts.end(), invalidFrom);
+    auto upper = std::lower_bound(lower, starts.end(), invalidTo);
+    if (0 != offset) {
+        for (auto itr = upper; itr != starts.end(); ++itr) {
+            *itr += offset;
+        }
+    }
+    starts.erase(lower, upper);
+}
+
+/**
+ * @brief 重新扫描区间 [from, to) 内的匹配项，匹配项互不重叠，和全文从前向后查找的结果一致。
+ *      区间前的匹配项延伸到区间内时从其结尾开始扫描；区间后和新结果重叠的旧匹配项失效，
+ *      继续向后逐个查找，直到找到的匹配项和旧匹配项一致，之后的查找结果和旧结果相同
+ */
+void MatchIntervalIndex::rescanWindow(KeywordIndex &index, int from, int to)
+{
+    QVector<int> &starts = index.starts;
+    const int length = index.keyword.size();
+    const int docLength = documentLength();
+    from = qMax(0, from);
+    to = qMin(docLength, to);
+
+    auto lower = std::lower_bound(starts.begin(), starts.end(), from);
+    if (lower != starts.begin() && *(lower - 1) + length > from) {
+        from = *(lower - 1) + length;
+    }
+    if (from >= to) {
+        return;
+    }
+
+    // 移除起始位置落在区间内的旧匹配项，由重新扫描的结果替换
+    auto upper = std::lower_bound(lower, starts.end(), to - length + 1);
+    lower = starts.erase(lower, upper);
+
+    // 下一次查找的起始位置
+    int pos = from;
+    if (to - from >= length) {
+        const QVector<int> found = findAll(documentText(from, to), index.keyword, index.caseFlag, from);
+        if (!found.isEmpty()) {
+            const int insertIndex = static_cast<int>(std::distance(starts.begin(), lower));
+            starts.insert(insertIndex, found.size(), 0);
+            std::copy(found.constBegin(), found.constEnd(), starts.begin() + insertIndex);
+            lower = starts.begin() + insertIndex + found.size();
+            pos = found.last() + length;
+        }
+    }
+
+    // 跨越区间结尾或位于失效旧匹配项覆盖范围内的新匹配项需要查找到此位置
+    int searchEnd = qMin(docLength, to + length - 1);
+    while (true) {
+        const bool hasNext = lower != starts.end();
+        if (hasNext && *lower < pos) {
+            // 和新结果重叠的旧匹配项失效，其覆盖的位置可能存在新的匹配项
+            searchEnd = qMin(docLength, qMax(searchEnd, *lower + 2 * length - 1));
+            lower = starts.erase(lower);
+            continue;
+        }
+
+        const int end = (hasNext && *lower + length <= searchEnd) ? *lower + length : searchEnd;
+        const int offset = end - pos >= length ? documentText(pos, end).indexOf(index.keyword, 0, index.caseFlag) : -1;
+        if (-1 == offset || (hasNext && pos + offset == *lower)) {
+            // 之后仅存在旧匹配项，结果和旧结果相同
+            break;
+        }
+
+        lower = starts.insert(lower, pos + offset) + 1;
+        pos += offset + length;
+    }
+}
+
+QString MatchIntervalIndex::documentText(int from, int to) const
+{
+    QTextCursor cursor(m_document);
+    cursor.setPosition(from);
+    cursor.setPosition(to, QTextCursor::KeepAnchor);
+    return normalizeText(cursor.selectedText());
+}
+
+int MatchIntervalIndex::documentLength() const
+{
+    // 不包括文档末尾的段落分隔符
+    return qMax(0, m_document->characterCount() - 1);
+}
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MATCHINTERVALINDEX_H
+#define MATCHINTERVALINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QFutureWatcher>
+
+class QTextDocument;
+
+/**
+ * @brief 关键字匹配区间索引
+ *      为每个关键字记录全文的匹配起始位置(升序)，首次在后台线程构建，
+ *      之后根据文档 contentsChange 的变更量增量修正，界面绘制时仅查询可视区域范围。
+ */
+class MatchIntervalIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 索引键值：归一化的关键字及大小写敏感标识
+    using IndexKey = QPair<QString, int>;
+
+    explicit MatchIntervalIndex(QTextDocument *document, QObject *parent = nullptr);
+    ~MatchIntervalIndex() override;
+
+    // 添加关键字索引，将在后台线程构建全文匹配信息
+    void addKeyword(const QString &keyword, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive);
+    // 移除关键字索引
+    void removeKeyword(const QString &keyword, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive);
+    // 清空所有关键字索引
+    void clear();
+
+    bool contains(const QString &keyword, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
+    // 当前已索引的关键字
+    QList<IndexKey> keys() const;
+    // 索引是否已构建完成，未完成时调用方需回退到直接查找
+    bool isReady(const QString &keyword, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
+    // 索引版本号，每次构建或修正后递增，未就绪时返回 -1
+    int revision(const QString &keyword, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
+    // 全文匹配数量
+    int matchCount(const QString &keyword, Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
+    // 查询和区间 [from, to) 相交的匹配项起始位置
+    QVector<int> matchesInRange(const QString &keyword, int from, int to,
+                                Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
+    // 是否存在起始位置位于区间 [from, to) 的匹配项
+    bool hasMatchInRange(const QString &keyword, int from, int to,
+                         Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive) const;
+
+    // 等待后台构建完成并处理结果
+    void waitForFinished();
+
+    // 生成索引键值
+    static IndexKey makeKey(const QString &keyword, Qt::CaseSensitivity caseFlag);
+    // 统一换行及空白字符，和 QTextDocument::toPlainText() 保持一致
+    static QString normalizeText(const QString &text);
+    // 查找 text 中所有的 keyword 匹配位置(允许重叠)，返回值附加 offset 偏移
+    static QVector<int> findAll(const QString &text, const QString &keyword,
+                                Qt::CaseSensitivity caseFlag, int offset = 0);
+
+signals:
+    // 关键字索引构建完成
+    void indexReady(const QString &keyword);
+
+public slots:
+    // 文档内容变更时修正索引
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+
+private:
+    // 文档变更量
+    struct ContentsDelta {
+        int from;
+        int charsRemoved;
+        int charsAdded;
+    };
+
+    struct KeywordIndex {
+        QString keyword;                        // 归一化后的关键字
+        Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive;
+        QVector<int> starts;                    // 升序排列的匹配起始位置
+        bool ready = false;                     // 是否构建完成
+        int revision = 0;                       // 索引版本号
+        quint64 buildId = 0;                    // 当前后台构建标识
+        QVector<ContentsDelta> pendingDeltas;   // 后台构建期间产生的文档变更
+    };
+
+    // 启动后台构建
+    void rebuild(KeywordIndex &index);
+    void onBuildFinished(const IndexKey &key, quint64 buildId, QFutureWatcher<QVector<int>> *watcher);
+    // 移除和变更区间相交的匹配项，并平移后续匹配项
+    static void shiftMatches(QVector<int> &starts, int length, const ContentsDelta &delta);
+    // 重新扫描文档区间 [from, to)，更新完全落在区间内的匹配项
+    void rescanWindow(KeywordIndex &index, int from, int to);
+    // 取得文档区间 [from, to) 的文本
+    QString documentText(int from, int to) const;
+    int documentLength() const;
+
+private:
+    QTextDocument *m_document = nullptr;
+    QHash<IndexKey, KeywordIndex> m_indexes;
+    QList<QFutureWatcher<QVector<int>> *> m_watchers;
+    quint64 m_nextBuildId = 0;
+};
+
+#endif  // MATCHINTERVALINDEX_H
@@ -0,0 +1,429 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "minimap.h"
+#include "../common/utils.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextLayout>
+#include <QScrollBar>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QFontMetricsF>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <climits>
+
+// 文本颜色的不透明度，和背景混合以区分缩略图与正文
+static const int s_textAlpha = 160;
+// 可视区域指示框的不透明度
+static const int s_indicatorAlpha = 40;
+
+Minimap::Minimap(QPlainTextEdit *edit, QWidget *parent)
+    : QWidget(parent)
+    , m_edit(edit)
+{
+    setFixedWidth(s_maxColumns + 2 * s_margin);
+    setCursor(Qt::ArrowCursor);
+    setBudget(s_defaultBudget);
+
+    if (edit) {
+        m_background = edit->palette().color(QPalette::Base);
+        m_foreground = edit->palette().color(QPalette::Text);
+        m_blockCount = edit->document()->blockCount();
+
+        connect(edit->document(), &QTextDocument::contentsChange, this, &Minimap::onContentsChange);
+        // 滚动时仅重新拼接已缓存的图块
+        connect(edit->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+            update();
+        });
+        connect(edit->verticalScrollBar(), &QScrollBar::rangeChanged, this, [this]() {
+            update();
+        });
+    }
+}
+
+void Minimap::setColors(const QColor &background, const QColor &foreground)
+{
+    if (background == m_background && foreground == m_foreground) {
+        return;
+    }
+
+    m_background = background;
+    m_foreground = foreground;
+    clear();
+    update();
+}
+
+void Minimap::setBudget(qint64 bytes)
+{
+    m_cache.setMaxCost(static_cast<int>(qBound<qint64>(1, bytes / 1024, INT_MAX)));
+}
+
+qint64 Minimap::budget() const
+{
+    return static_cast<qint64>(m_cache.maxCost()) * 1024;
+}
+
+qint64 Minimap::cost() const
+{
+    return static_cast<qint64>(m_cache.totalCost()) * 1024;
+}
+
+int Minimap::count() const
+{
+    return static_cast<int>(m_cache.count());
+}
+
+bool Minimap::contains(int tile) const
+{
+    return m_cache.contains(tile);
+}
+
+bool Minimap::isRendering() const
+{
+    return m_renderingTile >= 0;
+}
+
+/**
+ * @brief 按顺序排列 [firstTile, lastTile] 内未缓存的图块，已在绘制的图块不重复请求
+ */
+void Minimap::requestTiles(int firstTile, int lastTile)
+{
+    m_pendingTiles.clear();
+    if (!m_edit) {
+        return;
+    }
+
+    lastTile = qMin(lastTile, tileForBlock(m_edit->document()->blockCount() - 1));
+    for (int tile = qMax(0, firstTile); tile <= lastTile; tile++) {
+        if (!contains(tile) && tile != m_renderingTile) {
+            m_pendingTiles.append(tile);
+        }
+    }
+
+    startRender();
+}
+
+void Minimap::invalidateBlocks(int firstBlock, int lastBlock)
+{
+    invalidateTiles(tileForBlock(firstBlock), tileForBlock(qMax(firstBlock, lastBlock)));
+}
+
+void Minimap::invalidateFrom(int firstBlock)
+{
+    invalidateTiles(tileForBlock(firstBlock), -1);
+}
+
+void Minimap::clear()
+{
+    ++m_sourceId;
+    m_pendingTiles.clear();
+    m_renderingTile = -1;
+    m_renderingStale = false;
+    m_cache.clear();
+}
+
+int Minimap::tileForBlock(int block)
+{
+    return qMax(0, block) / s_tileBlocks;
+}
+
+/**
+ * @brief 文本块数量不变时仅失效变更的文本块所在的图块，否则之后的文本块整体偏移，失效之后的全部图块
+ */
+void Minimap::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+    if (!m_edit) {
+        return;
+    }
+
+    QTextDocument *document = m_edit->document();
+    const int firstBlock = document->findBlock(from).blockNumber();
+    const int blockCount = document->blockCount();
+    if (blockCount != m_blockCount) {
+        m_blockCount = blockCount;
+        invalidateFrom(firstBlock);
+    } else {
+        invalidateBlocks(firstBlock, document->findBlock(from + charsAdded).blockNumber());
+    }
+
+    update();
+}
+
+void Minimap::paintEvent(QPaintEvent *e)
+{
+    Q_UNUSED(e)
+    QPainter painter(this);
+    painter.fillRect(rect(), m_background);
+    if (!m_edit) {
+        return;
+    }
+
+    const int offset = scrollOffset();
+    const int tileHeight = s_tileBlocks * s_lineHeight;
+    const int lastBlock = m_edit->document()->blockCount() - 1;
+    const int firstTile = offset / tileHeight;
+    const int lastTile = qMin(tileForBlock(lastBlock), (offset + height()) / tileHeight);
+
+    for (int tile = firstTile; tile <= lastTile; tile++) {
+        if (const QImage *image = m_cache.object(tile)) {
+            painter.drawImage(0, tile * tileHeight - offset, *image);
+        }
+    }
+
+    // 未缓存的图块在绘制完成后刷新，同时预先绘制相邻的图块
+    requestTiles(firstTile - 1, lastTile + 1);
+
+    int firstVisible = 0;
+    int lastVisible = 0;
+    visibleBlocks(firstVisible, lastVisible);
+    QColor indicator = m_foreground;
+    indicator.setAlpha(s_indicatorAlpha);
+    painter.fillRect(QRect(0, firstVisible * s_lineHeight - offset,
+                           width(), (lastVisible - firstVisible + 1) * s_lineHeight), indicator);
+}
+
+void Minimap::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button() == Qt::LeftButton) {
+        scrollToPosition(e->pos().y());
+    }
+
+    QWidget::mousePressEvent(e);
+}
+
+void Minimap::mouseMoveEvent(QMouseEvent *e)
+{
+    if (e->buttons() & Qt::LeftButton) {
+        scrollToPosition(e->pos().y());
+    }
+
+    QWidget::mouseMoveEvent(e);
+}
+
+/**
+ * @brief 缩略图总高度超出控件高度时滚动缩略图。图块按文本块排列，滚动条按可视行计数，
+ *      自动换行或折叠时两者不成比例，因此按文本块计算，可视区域指示框始终和图块内容对齐
+ */
+int Minimap::scrollOffset() const
+{
+    const int blockCount = m_edit->document()->blockCount();
+    const qint64 totalHeight = static_cast<qint64>(blockCount) * s_lineHeight;
+    if (totalHeight <= height()) {
+        return 0;
+    }
+
+    int firstVisible = 0;
+    int lastVisible = 0;
+    visibleBlocks(firstVisible, lastVisible);
+    const int scrollableBlocks = blockCount - (lastVisible - firstVisible + 1);
+    if (scrollableBlocks <= 0) {
+        return 0;
+    }
+
+    const qreal ratio = static_cast<qreal>(firstVisible) / scrollableBlocks;
+    return static_cast<int>((totalHeight - height()) * qBound<qreal>(0, ratio, 1));
+}
+
+void Minimap::visibleBlocks(int &firstBlock, int &lastBlock) const
+{
+    firstBlock = m_edit->cursorForPosition(QPoint(0, 0)).blockNumber();
+    lastBlock = qMax(firstBlock, m_edit->cursorForPosition(QPoint(0, m_edit->viewport()->height() - 1)).blockNumber());
+}
+
+void Minimap::scrollToPosition(int y)
+{
+    if (!m_edit) {
+        return;
+    }
+
+    const QTextBlock block = m_edit->document()->findBlockByNumber(
+                                 qMax(0, (y + scrollOffset()) / s_lineHeight));
+    if (!block.isValid()) {
+        return;
+    }
+
+    // 滚动条按行计数，文本块的首行号已包含换行及隐藏的文本块
+    QScrollBar *bar = m_edit->verticalScrollBar();
+    bar->setValue(block.firstLineNumber() - bar->pageStep() / 2);
+}
+
+/**
+ * @brief 拷贝图块内文本块的前 s_maxColumns 个字符及高亮颜色，超长文本块不拷贝整行文本
+ */
+Minimap::TileSnapshot Minimap::snapshotTile(int tile) const
+{
+    TileSnapshot snapshot;
+    snapshot.background = m_background.rgba();
+    snapshot.foreground = m_foreground.rgba();
+
+    const qreal spaceWidth = QFontMetricsF(m_edit->document()->defaultFont()).horizontalAdvance(QChar(' '));
+    if (spaceWidth > 0) {
+        snapshot.tabSize = qMax(1, qRound(m_edit->tabStopDistance() / spaceWidth));
+    }
+
+    QTextBlock block = m_edit->document()->findBlockByNumber(tile * s_tileBlocks);
+    for (int i = 0; i < s_tileBlocks && block.isValid(); i++, block = block.next()) {
+        QString text;
+        if (block.length() > LONG_LINE_THRESHOLD) {
+            QTextCursor cursor(block);
+            cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, s_maxColumns);
+            text = cursor.selectedText();
+        } else {
+            text = block.text().left(s_maxColumns);
+        }
+
+        QVector<ColorRun> runs;
+        if (QTextLayout *layout = block.layout()) {
+            for (const QTextLayout::FormatRange &range : layout->formats()) {
+                if (range.start < text.size() && range.length > 0
+                        && range.format.hasProperty(QTextFormat::ForegroundBrush)) {
+                    runs.append({range.start, range.length, range.format.foreground().color().rgba()});
+                }
+            }
+            std::sort(runs.begin(), runs.end(), [](const ColorRun &left, const ColorRun &right) {
+                return left.start < right.start;
+            });
+        }
+
+        snapshot.texts.append(text);
+        snapshot.runs.append(runs);
+    }
+
+    return snapshot;
+}
+
+/**
+ * @brief 在工作线程绘制下一个图块，每次绘制一个图块，完成后继续下一个
+ */
+void Minimap::startRender()
+{
+    if (isRendering() || !m_edit) {
+        return;
+    }
+
+    int tile = -1;
+    while (!m_pendingTiles.isEmpty() && tile < 0) {
+        tile = m_pendingTiles.takeFirst();
+        if (contains(tile)) {
+            tile = -1;
+        }
+    }
+
+    if (tile < 0) {
+        return;
+    }
+
+    const TileSnapshot snapshot = snapshotTile(tile);
+    const quint64 sourceId = m_sourceId;
+    m_renderingTile = tile;
+    m_renderingStale = false;
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, tile, sourceId]() {
+        watcher->deleteLater();
+        if (sourceId != m_sourceId) {
+            return;
+        }
+
+        m_renderingTile = -1;
+        if (!m_renderingStale) {
+            insert(tile, watcher->result());
+            update();
+        } else if (!m_pendingTiles.contains(tile)) {
+            // 绘制期间图块已失效，重新绘制
+            m_pendingTiles.prepend(tile);
+        }
+        QTimer::singleShot(0, this, &Minimap::startRender);
+    });
+    watcher->setFuture(QtConcurrent::run([snapshot]() {
+        return Minimap::renderTile(snapshot);
+    }));
+}
+
+void Minimap::insert(int tile, const QImage &image)
+{
+    // 开销按图像数据大小计算，超出上限时 QCache 淘汰最久未使用的图块
+    const int cost = qMax(1, image.bytesPerLine() * image.height() / 1024);
+    m_cache.insert(tile, new QImage(image), cost);
+}
+
+void Minimap::invalidateTiles(int firstTile, int lastTile)
+{
+    const auto tiles = m_cache.keys();
+    for (int tile : tiles) {
+        if (tile >= firstTile && (lastTile < 0 || tile <= lastTile)) {
+            m_cache.remove(tile);
+        }
+    }
+
+    if (m_renderingTile >= firstTile && (lastTile < 0 || m_renderingTile <= lastTile)) {
+        m_renderingStale = true;
+    }
+}
+
+/**
+ * @brief 每个字符绘制为1像素宽的色块，相邻同色字符合并绘制，空白字符不绘制，制表符按制表符宽度展开
+ */
+QImage Minimap::renderTile(const TileSnapshot &snapshot)
+{
+    QImage image(s_maxColumns + 2 * s_margin, s_tileBlocks * s_lineHeight, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor::fromRgba(snapshot.background));
+
+    QPainter painter(&image);
+    for (int index = 0; index < snapshot.texts.size(); index++) {
+        const QString &text = snapshot.texts.at(index);
+        const QVector<ColorRun> &runs = snapshot.runs.at(index);
+        const int y = index * s_lineHeight;
+
+        int column = 0;
+        int run = 0;
+        int spanStart = -1;
+        QRgb spanColor = 0;
+        auto flush = [&]() {
+            if (spanStart >= 0) {
+                QColor color = QColor::fromRgba(spanColor);
+                color.setAlpha(s_textAlpha);
+                painter.fillRect(QRect(s_margin + spanStart, y, qMin(column, s_maxColumns) - spanStart, s_lineHeight), color);
+                spanStart = -1;
+            }
+        };
+
+        for (int pos = 0; pos < text.size() && column < s_maxColumns; pos++) {
+            const QChar ch = text.at(pos);
+            if (ch.isSpace()) {
+                flush();
+                column += ch == QLatin1Char('\t') ? snapshot.tabSize - column % snapshot.tabSize : 1;
+                continue;
+            }
+
+            while (run < runs.size() && runs.at(run).start + runs.at(run).length <= pos) {
+                run++;
+            }
+            const QRgb color = (run < runs.size() && runs.at(run).start <= pos) ? runs.at(run).color
+                                                                                 : snapshot.foreground;
+            if (spanStart >= 0 && color != spanColor) {
+                flush();
+            }
+            if (spanStart < 0) {
+                spanStart = column;
+                spanColor = color;
+            }
+            column++;
+        }
+        flush();
+    }
+    painter.end();
+
+    return image;
+}
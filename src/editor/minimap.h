@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <QWidget>
+#include <QPointer>
+#include <QCache>
+#include <QImage>
+#include <QVector>
+#include <QStringList>
+#include <QColor>
+
+class QPlainTextEdit;
+
+/**
+ * @brief 编辑器缩略图
+ *      按固定数量的文本块将文档缩小绘制为图块，GUI 线程仅拷贝图块内文本块的前若干个字符及已有的高亮颜色，
+ *      由工作线程绘制。图块缓存超出内存上限时淘汰最久未使用的图块，绘制时仅请求可视区域及相邻的图块。
+ *      文档变更或高亮变更时只失效覆盖变更文本块的图块，文本块数量变化时失效变更位置之后的图块。
+ */
+class Minimap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit Minimap(QPlainTextEdit *edit, QWidget *parent = nullptr);
+
+    // 设置背景色及默认文本颜色，清空已缓存的图块
+    void setColors(const QColor &background, const QColor &foreground);
+    // 设置图块缓存的内存上限(字节)
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+    // 已缓存图块占用的内存(字节)
+    qint64 cost() const;
+    // 已缓存图块数量
+    int count() const;
+    // 图块 tile 是否已缓存
+    bool contains(int tile) const;
+    // 是否正在绘制图块
+    bool isRendering() const;
+
+    // 请求绘制 [firstTile, lastTile] 内未缓存的图块，新的请求将替换未完成的请求队列
+    void requestTiles(int firstTile, int lastTile);
+    // 失效覆盖文本块 [firstBlock, lastBlock] 的图块
+    void invalidateBlocks(int firstBlock, int lastBlock);
+    // 失效文本块 firstBlock 及之后的图块
+    void invalidateFrom(int firstBlock);
+    // 清空缓存的图块
+    void clear();
+
+    // 文本块所在的图块
+    static int tileForBlock(int block);
+
+    // 每个图块包含的文本块数量
+    static const int s_tileBlocks = 256;
+    // 每个文本块的绘制高度(像素)
+    static const int s_lineHeight = 2;
+    // 每个文本块绘制的最大列数，每列1像素
+    static const int s_maxColumns = 100;
+    // 左右边距(像素)
+    static const int s_margin = 5;
+    // 默认内存上限(字节)
+    static const qint64 s_defaultBudget = 16 * 1024 * 1024;
+
+public slots:
+    // 文档内容变更时失效变更的图块
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+
+protected:
+    void paintEvent(QPaintEvent *e) override;
+    void mousePressEvent(QMouseEvent *e) override;
+    void mouseMoveEvent(QMouseEvent *e) override;
+
+private:
+    // 图块快照，仅持有文本块截断后的文本及高亮颜色，可在工作线程绘制
+    struct ColorRun {
+        int start = 0;
+        int length = 0;
+        QRgb color = 0;
+    };
+    struct TileSnapshot {
+        QStringList texts;
+        QVector<QVector<ColorRun>> runs;
+        QRgb background = 0;
+        QRgb foreground = 0;
+        int tabSize = 4;
+    };
+
+    // 缩略图内容相对控件顶部的偏移，按首个可见文本块在可滚动文本块中的比例计算
+    int scrollOffset() const;
+    // 编辑器可视区域的首个及最后一个文本块
+    void visibleBlocks(int &firstBlock, int &lastBlock) const;
+    // 滚动编辑器使控件坐标 y 对应的文本块居中
+    void scrollToPosition(int y);
+    // 拷贝图块 tile 内文本块的文本及高亮颜色
+    TileSnapshot snapshotTile(int tile) const;
+    // 绘制下一个待绘制的图块
+    void startRender();
+    void insert(int tile, const QImage &image);
+    // 失效 [firstTile, lastTile] 内的图块，lastTile 小于0时失效之后的全部图块
+    void invalidateTiles(int firstTile, int lastTile);
+    static QImage renderTile(const TileSnapshot &snapshot);
+
+private:
+    QPointer<QPlainTextEdit> m_edit;
+    QColor m_background = Qt::white;
+    QColor m_foreground = Qt::black;
+
+    QCache<int, QImage> m_cache;        ///< 图块缓存，开销单位为 KB
+    QVector<int> m_pendingTiles;        ///< 待绘制的图块
+    int m_renderingTile = -1;           ///< 正在绘制的图块，-1 表示空闲
+    bool m_renderingStale = false;      ///< 正在绘制的图块已失效，完成后丢弃
+    quint64 m_sourceId = 0;             ///< 缓存标识，清空缓存后丢弃未完成的结果
+    int m_blockCount = 0;               ///< 上次变更后的文本块数量
+};
+
+#endif  // MINIMAP_H
@@ -0,0 +1,414 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "scrollbarannotation.h"
+#include "matchintervalindex.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QAbstractTextDocumentLayout>
+#include <QScrollBar>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QEvent>
+#include <QTimer>
+#include <QtMath>
+
+#include <algorithm>
+
+// 标注的不透明度，避免完全遮挡滑块
+static const int s_annotationAlpha = 200;
+
+ScrollBarAnnotation::ScrollBarAnnotation(QPlainTextEdit *edit, const SourceProvider &provider)
+    : QWidget(edit->verticalScrollBar())
+    , m_edit(edit)
+    , m_provider(provider)
+{
+    // 仅绘制标注，鼠标操作仍由滚动条处理
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+
+    m_colors[FindMatch] = QColor("#FF8A00");
+    m_colors[ColorMark] = QColor("#FFD600");
+    m_colors[Bookmark] = QColor("#0081FF");
+    m_colors[Modified] = QColor("#4CAF50");
+
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(s_updateDelay);
+    connect(m_updateTimer, &QTimer::timeout, this, &ScrollBarAnnotation::updateBuckets);
+
+    m_modifiedBlockCount = edit->document()->blockCount();
+    connect(edit->document(), &QTextDocument::contentsChange, this, &ScrollBarAnnotation::onContentsChange);
+    // 行数变化(换行、折叠)后区间对应的行随之变化，重新计算全部区间
+    connect(edit->verticalScrollBar(), &QScrollBar::rangeChanged, this, &ScrollBarAnnotation::scheduleUpdate);
+
+    edit->verticalScrollBar()->installEventFilter(this);
+    updateGeometryFromScrollBar();
+    show();
+}
+
+ScrollBarAnnotation::~ScrollBarAnnotation()
+{
+}
+
+void ScrollBarAnnotation::setColor(Kind kind, const QColor &color)
+{
+    if (kind < 0 || kind >= KindCount || m_colors[kind] == color) {
+        return;
+    }
+
+    m_colors[kind] = color;
+    update();
+}
+
+void ScrollBarAnnotation::invalidate()
+{
+    m_fullUpdate = true;
+    scheduleUpdate();
+}
+
+void ScrollBarAnnotation::invalidateBlocks(int firstBlock, int lastBlock)
+{
+    if (firstBlock > lastBlock) {
+        qSwap(firstBlock, lastBlock);
+    }
+
+    m_dirtyFrom = m_dirtyFrom < 0 ? firstBlock : qMin(m_dirtyFrom, firstBlock);
+    m_dirtyTo = qMax(m_dirtyTo, lastBlock);
+    scheduleUpdate();
+}
+
+/**
+ * @brief 计算待更新的区间，滑槽高度、文档行数或文本块数量变化时重新计算全部区间，
+ *      否则仅计算变更的文本块所在的区间。每个区间仅进行固定次数的二分查找。
+ */
+void ScrollBarAnnotation::updateBuckets()
+{
+    m_updateTimer->stop();
+    if (!m_edit) {
+        return;
+    }
+
+    const int count = qMax(0, height() / s_bucketHeight);
+    const int lineCount = documentLineCount();
+    const int blockCount = m_edit->document()->blockCount();
+    if (count != m_buckets.size() || lineCount != m_lineCount || blockCount != m_blockCount) {
+        m_fullUpdate = true;
+    }
+    if (!m_fullUpdate && m_dirtyFrom < 0) {
+        return;
+    }
+
+    m_lineCount = lineCount;
+    m_blockCount = blockCount;
+    int firstBucket = 0;
+    int lastBucket = count - 1;
+    if (m_fullUpdate) {
+        m_buckets = QVector<Bucket>(count);
+    } else {
+        firstBucket = bucketForBlock(m_dirtyFrom);
+        lastBucket = bucketForBlock(m_dirtyTo);
+    }
+    m_fullUpdate = false;
+    m_dirtyFrom = -1;
+    m_dirtyTo = -1;
+
+    if (count > 0) {
+        Sources sources = m_provider ? m_provider() : Sources();
+        std::sort(sources.bookmarks.begin(), sources.bookmarks.end());
+        std::sort(sources.ranges.begin(), sources.ranges.end(), [](const RangeSource &left, const RangeSource &right) {
+            return left.start < right.start;
+        });
+
+        // 前缀中结束位置最大的标记区间，用于二分查询和区间相交的标记
+        QVector<int> rangeStarts;
+        QVector<int> maxEndIndex;
+        rangeStarts.reserve(sources.ranges.size());
+        maxEndIndex.reserve(sources.ranges.size());
+        for (int i = 0; i < sources.ranges.size(); i++) {
+            rangeStarts.append(sources.ranges.at(i).start);
+            const bool larger = (0 == i) || sources.ranges.at(i).end > sources.ranges.at(maxEndIndex.last()).end;
+            maxEndIndex.append(larger ? i : maxEndIndex.last());
+        }
+
+        for (int bucket = firstBucket; bucket <= lastBucket; bucket++) {
+            m_buckets[bucket] = computeBucket(bucket, sources, rangeStarts, maxEndIndex);
+        }
+    }
+
+    update();
+}
+
+void ScrollBarAnnotation::clearModifiedBlocks()
+{
+    if (m_modifiedBlocks.isEmpty()) {
+        return;
+    }
+
+    m_modifiedBlocks.clear();
+    invalidate();
+}
+
+int ScrollBarAnnotation::bucketCount() const
+{
+    return m_buckets.size();
+}
+
+bool ScrollBarAnnotation::hasAnnotation(int bucket, Kind kind) const
+{
+    if (bucket < 0 || bucket >= m_buckets.size()) {
+        return false;
+    }
+
+    return m_buckets.at(bucket).kinds & (1 << kind);
+}
+
+int ScrollBarAnnotation::bucketForBlock(int block) const
+{
+    if (!m_edit || m_buckets.isEmpty() || m_lineCount <= 0) {
+        return 0;
+    }
+
+    QTextBlock textBlock = m_edit->document()->findBlockByNumber(block);
+    if (!textBlock.isValid()) {
+        textBlock = m_edit->document()->lastBlock();
+    }
+
+    const qint64 bucket = static_cast<qint64>(textBlock.firstLineNumber()) * m_buckets.size() / m_lineCount;
+    return static_cast<int>(qBound<qint64>(0, bucket, m_buckets.size() - 1));
+}
+
+/**
+ * @brief 已修改区间中和被替换区域相交的部分与新的文本块区域合并，之后的区间按文本块数量的变化平移，
+ *      耗时仅和已修改区间的数量相关
+ */
+void ScrollBarAnnotation::updateModifiedRanges(QVector<QPair<int, int>> &ranges, int firstBlock, int removedLast, int addedLast)
+{
+    const int delta = addedLast - removedLast;
+    QPair<int, int> changed(firstBlock, addedLast);
+    QVector<QPair<int, int>> before;
+    QVector<QPair<int, int>> after;
+    for (const auto &range : ranges) {
+        if (range.second < firstBlock) {
+            before.append(range);
+        } else if (range.first > removedLast) {
+            after.append(qMakePair(range.first + delta, range.second + delta));
+        } else {
+            changed.first = qMin(changed.first, range.first);
+            if (range.second > removedLast) {
+                changed.second = qMax(changed.second, range.second + delta);
+            }
+        }
+    }
+
+    ranges.clear();
+    ranges.reserve(before.size() + after.size() + 1);
+    auto append = [&ranges](const QPair<int, int> &range) {
+        // 合并相邻的区间
+        if (!ranges.isEmpty() && range.first <= ranges.last().second + 1) {
+            ranges.last().second = qMax(ranges.last().second, range.second);
+        } else {
+            ranges.append(range);
+        }
+    };
+    for (const auto &range : before) {
+        append(range);
+    }
+    append(changed);
+    for (const auto &range : after) {
+        append(range);
+    }
+}
+
+void ScrollBarAnnotation::onContentsChange(int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+    if (!m_edit) {
+        return;
+    }
+
+    QTextDocument *document = m_edit->document();
+    const int blockCount = document->blockCount();
+    const int firstBlock = qMax(0, document->findBlock(from).blockNumber());
+    QTextBlock lastBlock = document->findBlock(from + charsAdded);
+    const int addedLast = qMax(firstBlock, lastBlock.isValid() ? lastBlock.blockNumber() : blockCount - 1);
+    const int removedLast = qMax(firstBlock, addedLast - (blockCount - m_modifiedBlockCount));
+    m_modifiedBlockCount = blockCount;
+
+    updateModifiedRanges(m_modifiedBlocks, firstBlock, removedLast, addedLast);
+    invalidateBlocks(firstBlock, addedLast);
+}
+
+void ScrollBarAnnotation::paintEvent(QPaintEvent *e)
+{
+    if (m_buckets.isEmpty()) {
+        return;
+    }
+
+    QPainter painter(this);
+    const int laneWidth = qMax(1, width() / 3);
+    const int tickHeight = qMax(1, s_bucketHeight - 1);
+    const int first = qMax(0, e->rect().top() / s_bucketHeight);
+    const int last = qMin(m_buckets.size() - 1, e->rect().bottom() / s_bucketHeight);
+
+    auto tickColor = [](QColor color) {
+        color.setAlpha(s_annotationAlpha);
+        return color;
+    };
+    const QColor findColor = tickColor(m_colors[FindMatch]);
+    const QColor bookmarkColor = tickColor(m_colors[Bookmark]);
+    const QColor modifiedColor = tickColor(m_colors[Modified]);
+
+    // 左侧为查找匹配项，中间为颜色标记，右侧为已修改行，书签覆盖已修改行
+    for (int bucket = first; bucket <= last; bucket++) {
+        const Bucket &item = m_buckets.at(bucket);
+        if (0 == item.kinds) {
+            continue;
+        }
+
+        const int y = bucket * s_bucketHeight;
+        if (item.kinds & (1 << FindMatch)) {
+            painter.fillRect(QRect(0, y, laneWidth, tickHeight), findColor);
+        }
+        if (item.kinds & (1 << ColorMark)) {
+            painter.fillRect(QRect(laneWidth, y, laneWidth, tickHeight), tickColor(QColor::fromRgba(item.markColor)));
+        }
+        if (item.kinds & (1 << Modified)) {
+            painter.fillRect(QRect(2 * laneWidth, y, width() - 2 * laneWidth, tickHeight), modifiedColor);
+        }
+        if (item.kinds & (1 << Bookmark)) {
+            painter.fillRect(QRect(2 * laneWidth, y, width() - 2 * laneWidth, tickHeight), bookmarkColor);
+        }
+    }
+}
+
+bool ScrollBarAnnotation::eventFilter(QObject *watched, QEvent *e)
+{
+    if (watched == parentWidget()) {
+        switch (e->type()) {
+        case QEvent::Resize:
+        case QEvent::Show:
+        case QEvent::StyleChange:
+            updateGeometryFromScrollBar();
+            break;
+        default:
+            break;
+        }
+    }
+
+    return QWidget::eventFilter(watched, e);
+}
+
+void ScrollBarAnnotation::updateGeometryFromScrollBar()
+{
+    QScrollBar *bar = qobject_cast<QScrollBar *>(parentWidget());
+    if (!bar) {
+        return;
+    }
+
+    QStyleOptionSlider option;
+    option.initFrom(bar);
+    option.orientation = bar->orientation();
+    option.minimum = bar->minimum();
+    option.maximum = bar->maximum();
+    option.sliderPosition = bar->sliderPosition();
+    option.sliderValue = bar->value();
+    option.singleStep = bar->singleStep();
+    option.pageStep = bar->pageStep();
+    option.upsideDown = bar->invertedAppearance();
+    if (Qt::Horizontal == bar->orientation()) {
+        option.state |= QStyle::State_Horizontal;
+    }
+
+    const QRect groove = bar->style()->subControlRect(QStyle::CC_ScrollBar, &option, QStyle::SC_ScrollBarGroove, bar);
+    setGeometry(groove.isValid() ? groove : bar->rect());
+    raise();
+    scheduleUpdate();
+}
+
+void ScrollBarAnnotation::scheduleUpdate()
+{
+    if (!m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
+}
+
+ScrollBarAnnotation::Bucket ScrollBarAnnotation::computeBucket(int bucket, const Sources &sources,
+                                                               const QVector<int> &rangeStarts,
+                                                               const QVector<int> &maxEndIndex) const
+{
+    Bucket item;
+    QTextDocument *document = m_edit->document();
+    const int count = m_buckets.size();
+    const int lineFrom = static_cast<int>(static_cast<qint64>(bucket) * m_lineCount / count);
+    const int lineTo = qMax(lineFrom, static_cast<int>(static_cast<qint64>(bucket + 1) * m_lineCount / count) - 1);
+    QTextBlock firstBlock = document->findBlockByLineNumber(lineFrom);
+    QTextBlock lastBlock = document->findBlockByLineNumber(lineTo);
+    if (!firstBlock.isValid()) {
+        firstBlock = document->lastBlock();
+    }
+    if (!lastBlock.isValid()) {
+        lastBlock = document->lastBlock();
+    }
+
+    const int from = firstBlock.position();
+    const int to = lastBlock.position() + lastBlock.length();
+    const int firstNumber = firstBlock.blockNumber();
+    const int lastNumber = lastBlock.blockNumber();
+
+    // 颜色取最后匹配的标记
+    auto setMark = [&item](const QColor &color) {
+        item.kinds |= 1 << ColorMark;
+        item.markColor = color.rgba();
+    };
+
+    if (sources.markAllColor.isValid()) {
+        setMark(sources.markAllColor);
+    }
+
+    // 起始位置小于区间结束位置的标记中，结束位置最大的标记是否和区间相交
+    auto rangeItr = std::lower_bound(rangeStarts.constBegin(), rangeStarts.constEnd(), to);
+    if (rangeItr != rangeStarts.constBegin()) {
+        const RangeSource &range = sources.ranges.at(maxEndIndex.at(static_cast<int>(rangeItr - rangeStarts.constBegin()) - 1));
+        if (range.end > from) {
+            setMark(range.color);
+        }
+    }
+
+    if (sources.matchIndex) {
+        for (const KeywordSource &source : sources.keywords) {
+            if (sources.matchIndex->hasMatchInRange(source.keyword, from, to, source.caseFlag)) {
+                if (ColorMark == source.kind) {
+                    setMark(source.color);
+                } else {
+                    item.kinds |= 1 << source.kind;
+                }
+            }
+        }
+    }
+
+    auto bookmarkItr = std::lower_bound(sources.bookmarks.constBegin(), sources.bookmarks.constEnd(), firstNumber);
+    if (bookmarkItr != sources.bookmarks.constEnd() && *bookmarkItr <= lastNumber) {
+        item.kinds |= 1 << Bookmark;
+    }
+
+    auto modifiedItr = std::lower_bound(m_modifiedBlocks.constBegin(), m_modifiedBlocks.constEnd(), firstNumber,
+    [](const QPair<int, int> &range, int value) {
+        return range.second < value;
+    });
+    if (modifiedItr != m_modifiedBlocks.constEnd() && modifiedItr->first <= lastNumber) {
+        item.kinds |= 1 << Modified;
+    }
+
+    return item;
+}
+
+int ScrollBarAnnotation::documentLineCount() const
+{
+    // QPlainTextDocumentLayout 的文档高度以行为单位
+    return qMax(1, qCeil(m_edit->document()->documentLayout()->documentSize().height()));
+}
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SCROLLBARANNOTATION_H
+#define SCROLLBARANNOTATION_H
+
+#include <QWidget>
+#include <QPointer>
+#include <QVector>
+#include <QPair>
+#include <QColor>
+
+#include <functional>
+
+class QPlainTextEdit;
+class QTimer;
+class MatchIntervalIndex;
+
+/**
+ * @brief 垂直滚动条标注
+ *      在滚动条滑槽上绘制查找匹配项、颜色标记、书签及已修改行的位置。滑槽按固定像素高度划分为区间，
+ *      每个区间对应一段连续的行，通过匹配区间索引、排序后的标记及行号二分查询区间内是否存在标注，
+ *      计算耗时只和滑槽高度相关，和匹配数量无关。文档变更时仅重新计算变更行所在的区间。
+ */
+class ScrollBarAnnotation : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // 标注类型
+    enum Kind {
+        FindMatch = 0,      ///< 查找匹配项
+        ColorMark,          ///< 颜色标记
+        Bookmark,           ///< 书签
+        Modified,           ///< 已修改行
+        KindCount
+    };
+
+    // 通过匹配区间索引查询的关键字
+    struct KeywordSource {
+        QString keyword;
+        Qt::CaseSensitivity caseFlag = Qt::CaseInsensitive;
+        Kind kind = FindMatch;
+        QColor color;       ///< 颜色标记使用的颜色
+    };
+
+    // 文档位置区间 [start, end) 的颜色标记
+    struct RangeSource {
+        int start = 0;
+        int end = 0;
+        QColor color;
+    };
+
+    // 标注数据来源，计算时由编辑器提供
+    struct Sources {
+        MatchIntervalIndex *matchIndex = nullptr;
+        QVector<KeywordSource> keywords;
+        QVector<RangeSource> ranges;
+        QColor markAllColor;        ///< 全文标记颜色，无效时未标记全文
+        QVector<int> bookmarks;     ///< 书签所在的文本块序号(从0开始)
+    };
+    using SourceProvider = std::function<Sources()>;
+
+    // 标注区间
+    struct Bucket {
+        quint8 kinds = 0;           ///< 区间内存在的标注类型(按位)
+        QRgb markColor = 0;         ///< 颜色标记使用的颜色
+    };
+
+    explicit ScrollBarAnnotation(QPlainTextEdit *edit, const SourceProvider &provider);
+    ~ScrollBarAnnotation() override;
+
+    // 设置标注类型的颜色，颜色标记使用标记自身的颜色
+    void setColor(Kind kind, const QColor &color);
+    // 标注数据变更，重新计算全部区间
+    void invalidate();
+    // 文本块 [firstBlock, lastBlock] 的标注变更，仅重新计算对应的区间
+    void invalidateBlocks(int firstBlock, int lastBlock);
+    // 立即计算待更新的区间
+    void updateBuckets();
+
+    // 清空已修改行，保存或撤销到保存位置时调用
+    void clearModifiedBlocks();
+    // 已修改的文本块区间
+    inline const QVector<QPair<int, int>> &modifiedBlocks() const { return m_modifiedBlocks; }
+
+    int bucketCount() const;
+    bool hasAnnotation(int bucket, Kind kind) const;
+    // 文本块所在的区间
+    int bucketForBlock(int block) const;
+
+    // 文本块 [firstBlock, removedLast] 替换为 [firstBlock, addedLast] 时更新已修改的文本块区间
+    static void updateModifiedRanges(QVector<QPair<int, int>> &ranges, int firstBlock, int removedLast, int addedLast);
+
+    // 每个区间的高度(像素)
+    static const int s_bucketHeight = 3;
+    // 合并连续变更的延迟(ms)
+    static const int s_updateDelay = 50;
+
+public slots:
+    // 文档内容变更时更新已修改行并标记变更的区间
+    void onContentsChange(int from, int charsRemoved, int charsAdded);
+
+protected:
+    void paintEvent(QPaintEvent *e) override;
+    bool eventFilter(QObject *watched, QEvent *e) override;
+
+private:
+    // 按滚动条滑槽调整标注区域
+    void updateGeometryFromScrollBar();
+    void scheduleUpdate();
+    Bucket computeBucket(int bucket, const Sources &sources,
+                         const QVector<int> &rangeStarts, const QVector<int> &maxEndIndex) const;
+    // 文档总行数，包含换行及隐藏的文本块
+    int documentLineCount() const;
+
+private:
+    QPointer<QPlainTextEdit> m_edit;
+    SourceProvider m_provider;
+    QColor m_colors[KindCount];
+
+    QVector<Bucket> m_buckets;
+    bool m_fullUpdate = true;               ///< 是否需要重新计算全部区间
+    int m_dirtyFrom = -1;                   ///< 待更新的首个文本块，-1 表示无
+    int m_dirtyTo = -1;                     ///< 待更新的最后一个文本块
+    int m_lineCount = 0;                    ///< 上次计算时的文档行数
+    int m_blockCount = 0;                   ///< 上次计算时的文本块数量
+    QTimer *m_updateTimer = nullptr;
+
+    QVector<QPair<int, int>> m_modifiedBlocks;  ///< 升序排列、互不相邻的已修改文本块区间
+    int m_modifiedBlockCount = 0;               ///< 上次变更后的文本块数量
+};
+
+#endif  // SCROLLBARANNOTATION_H
@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "selectionoverlay.h"
+
+#include <algorithm>
+
+namespace {
+
+inline quint64 mixHash(quint64 hash, quint64 value)
+{
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+inline int selectionStart(const SelectionOverlay::OrderedSelection &item)
+{
+    return item.first.cursor.selectionStart();
+}
+
+inline int selectionEnd(const SelectionOverlay::OrderedSelection &item)
+{
+    return item.first.cursor.selectionEnd();
+}
+
+}  // namespace
+
+SelectionOverlay::SelectionOverlay()
+{
+}
+
+/**
+ * @brief 设置图层选区，按列表顺序绘制。列表修改时会分离隐式共享的数据，
+ *      因此和上次设置的列表仍共享数据时内容未变化，光标移动等频繁调用无需遍历全部选区
+ */
+bool SelectionOverlay::setLayer(Layer layer, const QList<QTextEdit::ExtraSelection> &selections)
+{
+    LayerData &data = m_layers[layer];
+    if (data.hasSource && data.source.isSharedWith(selections)) {
+        return false;
+    }
+
+    // 未指定时间戳时按列表顺序绘制
+    QList<OrderedSelection> orderedSelections;
+    orderedSelections.reserve(selections.size());
+    for (int i = 0; i < selections.size(); i++) {
+        orderedSelections.append(qMakePair(selections.at(i), static_cast<qint64>(i)));
+    }
+
+    const bool changed = setLayer(layer, orderedSelections);
+    data.source = selections;
+    data.hasSource = true;
+    return changed;
+}
+
+/**
+ * @brief 设置图层选区，图层内容(位置、格式、顺序)未变化时不重新排序。
+ *      由于 QTextCursor 会随文档编辑同步移动，编辑后已排序的选区依然保持有序，
+ *      因此仅比较当前位置的特征值即可判断图层是否变化。
+ */
+bool SelectionOverlay::setLayer(Layer layer, const QList<OrderedSelection> &selections)
+{
+    LayerData &data = m_layers[layer];
+    data.source.clear();
+    data.hasSource = false;
+    if (data.items.size() == selections.size()
+            && itemsSignature(data.items) == itemsSignature(selections)) {
+        return false;
+    }
+
+    data.items.clear();
+    data.items.reserve(selections.size());
+    for (const OrderedSelection &item : selections) {
+        data.items.append(item);
+    }
+    sortLayer(data);
+
+    return true;
+}
+
+void SelectionOverlay::clear()
+{
+    for (LayerData &data : m_layers) {
+        data.items.clear();
+        data.maxEndIndex.clear();
+        data.source.clear();
+        data.hasSource = false;
+    }
+}
+
+int SelectionOverlay::layerSize(Layer layer) const
+{
+    return m_layers[layer].items.size();
+}
+
+/**
+ * @brief 查询图层中和区间 [ \a from , \a to ] 相交的选区，二分查找起始位置不大于 \a to 的选区，
+ *      再通过前缀最大结束位置跳过结束位置小于 \a from 的选区，耗时仅和区间内的选区数量相关
+ */
+QList<QTextEdit::ExtraSelection> SelectionOverlay::layerSelectionsInRange(Layer layer, int from, int to) const
+{
+    QList<QTextEdit::ExtraSelection> result;
+    const LayerData &data = m_layers[layer];
+    if (data.items.isEmpty() || from > to) {
+        return result;
+    }
+
+    const QVector<OrderedSelection> &items = data.items;
+    auto upper = std::upper_bound(items.constBegin(), items.constEnd(), to, [](int pos, const OrderedSelection &item) {
+        return pos < selectionStart(item);
+    });
+    const int upperIndex = static_cast<int>(std::distance(items.constBegin(), upper));
+
+    auto lower = std::partition_point(data.maxEndIndex.constBegin(), data.maxEndIndex.constBegin() + upperIndex,
+    [&items, from](int index) {
+        return selectionEnd(items.at(index)) < from;
+    });
+    const int lowerIndex = static_cast<int>(std::distance(data.maxEndIndex.constBegin(), lower));
+
+    QVector<OrderedSelection> visibleItems;
+    for (int i = lowerIndex; i < upperIndex; i++) {
+        if (selectionEnd(items.at(i)) >= from) {
+            visibleItems.append(items.at(i));
+        }
+    }
+
+    // 仅对可视区域内的选区按绘制顺序排序
+    std::stable_sort(visibleItems.begin(), visibleItems.end(), [](const OrderedSelection &a, const OrderedSelection &b) {
+        return a.second < b.second;
+    });
+
+    result.reserve(visibleItems.size());
+    for (const OrderedSelection &item : visibleItems) {
+        result.append(item.first);
+    }
+
+    return result;
+}
+
+QList<QTextEdit::ExtraSelection> SelectionOverlay::selectionsInRange(int from, int to) const
+{
+    QList<QTextEdit::ExtraSelection> result;
+    for (int layer = CurrentLineLayer; layer < LayerCount; layer++) {
+        result.append(layerSelectionsInRange(static_cast<Layer>(layer), from, to));
+    }
+
+    return result;
+}
+
+quint64 SelectionOverlay::signature(const QList<QTextEdit::ExtraSelection> &selections)
+{
+    quint64 hash = static_cast<quint64>(selections.size());
+    for (int i = 0; i < selections.size(); i++) {
+        hash = mixHash(hash, selectionHash(selections.at(i), i));
+    }
+
+    return hash;
+}
+
+quint64 SelectionOverlay::itemsSignature(const QVector<OrderedSelection> &items)
+{
+    quint64 hash = 0;
+    for (const OrderedSelection &item : items) {
+        hash += selectionHash(item.first, item.second);
+    }
+
+    return hash;
+}
+
+quint64 SelectionOverlay::itemsSignature(const QList<OrderedSelection> &items)
+{
+    quint64 hash = 0;
+    for (const OrderedSelection &item : items) {
+        hash += selectionHash(item.first, item.second);
+    }
+
+    return hash;
+}
+
+quint64 SelectionOverlay::selectionHash(const QTextEdit::ExtraSelection &selection, qint64 order)
+{
+    quint64 hash = mixHash(0, static_cast<quint64>(selection.cursor.selectionStart()));
+    hash = mixHash(hash, static_cast<quint64>(selection.cursor.selectionEnd()));
+    hash = mixHash(hash, static_cast<quint64>(order));
+    hash = mixHash(hash, selection.format.background().color().rgba());
+    hash = mixHash(hash, selection.format.foreground().color().rgba());
+    hash = mixHash(hash, selection.format.property(QTextFormat::FullWidthSelection).toBool());
+
+    return hash;
+}
+
+void SelectionOverlay::sortLayer(LayerData &data)
+{
+    std::stable_sort(data.items.begin(), data.items.end(), [](const OrderedSelection &a, const OrderedSelection &b) {
+        return selectionStart(a) < selectionStart(b);
+    });
+
+    data.maxEndIndex.resize(data.items.size());
+    int maxIndex = 0;
+    for (int i = 0; i < data.items.size(); i++) {
+        if (selectionEnd(data.items.at(i)) > selectionEnd(data.items.at(maxIndex))) {
+            maxIndex = i;
+        }
+        data.maxEndIndex[i] = maxIndex;
+    }
+
+    m_sortCount++;
+}
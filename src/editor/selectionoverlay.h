@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SELECTIONOVERLAY_H
+#define SELECTIONOVERLAY_H
+
+#include <QTextEdit>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+/**
+ * @brief 分层的扩展选区(ExtraSelection)管理
+ *      每个图层按起始位置排序保存选区，仅在图层内容变化时重新排序，
+ *      只取出和可视区域相交的选区交由 QPlainTextEdit 渲染，
+ *      避免每次光标移动都将全文的颜色标记重新排序并设置到编辑器。
+ *      调用者传入未修改的同一列表(隐式共享数据相同)时直接判定为未变化，无需遍历选区。
+ */
+class SelectionOverlay
+{
+public:
+    // 图层，按绘制顺序排列，后绘制的图层覆盖先绘制的图层
+    enum Layer {
+        CurrentLineLayer = 0,   ///< 当前行高亮
+        ColorMarkLayer,         ///< 颜色标记，按时间戳顺序绘制
+        BracketLayer,           ///< 括号匹配
+        FoldHighlightLayer,     ///< 折叠代码段高亮
+        AltColumnLayer,         ///< Alt 列选区域
+        FindMatchLayer,         ///< 查找匹配项
+        FindHighlightLayer,     ///< 当前查找/替换项
+        LayerCount
+    };
+
+    // 选区及其绘制顺序(时间戳)
+    using OrderedSelection = QPair<QTextEdit::ExtraSelection, qint64>;
+
+    SelectionOverlay();
+
+    // 设置图层选区，按列表顺序绘制，返回图层内容是否变化，和上次传入的列表共享数据时耗时为 O(1)
+    bool setLayer(Layer layer, const QList<QTextEdit::ExtraSelection> &selections);
+    // 设置图层选区，按时间戳升序绘制，返回图层内容是否变化
+    bool setLayer(Layer layer, const QList<OrderedSelection> &selections);
+    void clear();
+
+    int layerSize(Layer layer) const;
+    // 查询图层中和区间 [from, to] 相交的选区，按绘制顺序排列
+    QList<QTextEdit::ExtraSelection> layerSelectionsInRange(Layer layer, int from, int to) const;
+    // 查询所有图层中和区间 [from, to] 相交的选区，按图层及绘制顺序排列
+    QList<QTextEdit::ExtraSelection> selectionsInRange(int from, int to) const;
+    // 图层累计重新排序次数
+    inline int sortCount() const { return m_sortCount; }
+
+    // 计算选区列表的特征值，和顺序相关，用于判断渲染内容是否变化
+    static quint64 signature(const QList<QTextEdit::ExtraSelection> &selections);
+
+private:
+    struct LayerData {
+        QVector<OrderedSelection> items;    ///< 按起始位置升序排列的选区
+        QVector<int> maxEndIndex;           ///< 前缀中结束位置最大的选区索引
+        QList<QTextEdit::ExtraSelection> source;    ///< 上次设置的列表，用于判断调用者是否修改了列表
+        bool hasSource = false;
+    };
+
+    // 计算选区集合的特征值，和顺序无关
+    static quint64 itemsSignature(const QVector<OrderedSelection> &items);
+    static quint64 itemsSignature(const QList<OrderedSelection> &items);
+    static quint64 selectionHash(const QTextEdit::ExtraSelection &selection, qint64 order);
+    // 按起始位置重新排序并构建前缀索引
+    void sortLayer(LayerData &data);
+
+private:
+    LayerData m_layers[LayerCount];
+    int m_sortCount = 0;
+};
+
+#endif  // SELECTIONOVERLAY_H
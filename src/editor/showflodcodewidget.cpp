@@ -3,22 +3,23 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "showflodcodewidget.h"
-#include <QFileInfo>
 #include <QDebug>
 #include <QPalette>
-#include <QVBoxLayout>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QtMath>
 #include <DWindowManagerHelper>
 #include <DGuiApplicationHelper>
 #include <QGraphicsDropShadowEffect>
-#include <QXmlStreamReader>
-
-namespace KSyntaxHighlighting {
-    class SyntaxHighlighter;
-}
 
 DGUI_USE_NAMESPACE
 DWIDGET_USE_NAMESPACE
 
+// 内容区域和边框的间距
+static const int s_contentMargin = 10;
+// 文本和内容区域的间距
+static const int s_textMargin = 5;
+
 ShowFlodCodeWidget::ShowFlodCodeWidget(DWidget *parent)
     : DFrame(parent)
 {
@@ -30,46 +31,30 @@ ShowFlodCodeWidget::ShowFlodCodeWidget(DWidget *parent)
     color.setAlphaF(0.2);
     effert->setColor(color);
     this->setGraphicsEffect(effert);
-    QVBoxLayout *pSubLayout = new QVBoxLayout();
-    m_pContentEdit = new DPlainTextEdit(this);
-    m_pContentEdit->setWordWrapMode(QTextOption::WrapAnywhere);
-    m_pContentEdit->setFrameStyle(0);
-    m_pContentEdit->setReadOnly(true);
-    m_pContentEdit->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_pContentEdit->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    pSubLayout->addWidget(m_pContentEdit);
-    this->setLayout(pSubLayout);
-    m_highlighter = new KSyntaxHighlighting::SyntaxHighlighter(m_pContentEdit->document());
-
-    // 更新单独添加的高亮格式文件
-    m_repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
+
+    m_font = font();
+    m_textColor = palette().color(QPalette::Text);
+    m_textOption.setWrapMode(QTextOption::WrapAnywhere);
 }
 
 ShowFlodCodeWidget::~ShowFlodCodeWidget()
 {
-    m_highlighter->deleteLater();
-    m_highlighter = nullptr;
 }
 
 void ShowFlodCodeWidget::clear()
 {
-    m_pContentEdit->document()->clear();
+    m_blocks.clear();
+    m_layouts.clear();
     m_nTextWidth = 0;
+    m_nTextHeight = 0;
     adjustSize();
 }
 
-void ShowFlodCodeWidget::initHighLight(QString filepath, bool bIsLight)
+void ShowFlodCodeWidget::setTextStyle(const QFont &font, const QTextOption &option, const QColor &textColor)
 {
-    if (m_highlighter != nullptr) {
-        if (!bIsLight) {
-            m_highlighter->setTheme(m_repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme));
-        } else {
-            m_highlighter->setTheme(m_repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
-        }
-    }
-   // m_highlighter->rehighlight();
-    const auto def = m_repository.definitionForFileName(QFileInfo(filepath).fileName());
-    m_highlighter->setDefinition(def);
+    m_font = font;
+    m_textOption = option;
+    m_textColor = textColor;
 }
 
 void ShowFlodCodeWidget::setStyle(bool bIsLineWrap)
@@ -79,65 +64,100 @@ void ShowFlodCodeWidget::setStyle(bool bIsLineWrap)
 
     if (DGuiApplicationHelper::instance()->themeType() == DGuiApplicationHelper::DarkType) {
         color.setAlphaF(0.8);
-        pa.setColor(QPalette::Base,color);
-        m_pContentEdit->setPalette(pa);
+        m_contentColor = color;
         pa.setColor(QPalette::Base,QColor(25,25,25));
         setPalette(pa);
     } else {
         color = QColor(247,247,247);
         color.setAlphaF(0.6);
-        pa.setColor(QPalette::Base,color);
-        m_pContentEdit->setPalette(pa);
+        m_contentColor = color;
         pa.setColor(QPalette::Base,QColor(247,247,247));
         setPalette(pa);
     }
 
-    if (bIsLineWrap) {
-        m_pContentEdit->setLineWrapMode(QPlainTextEdit::WidgetWidth);
-    } else {
-        m_pContentEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
-    }
+    m_bIsLineWrap = bIsLineWrap;
+}
+
+/**
+ * @brief 设置预览的文本块，使用文本块的内容及高亮格式创建临时布局，
+ *      仅处理预览框最大高度内的文本块
+ */
+void ShowFlodCodeWidget::setBlocks(const QVector<QTextBlock> &blocks, int maxWidth, int maxHeight)
+{
+    m_blocks = blocks;
+    layoutBlocks(maxWidth, maxHeight);
+
+    setFixedSize(m_nTextWidth + 2 * s_contentMargin, m_nTextHeight + 2 * s_contentMargin);
+    update();
 }
 
-void ShowFlodCodeWidget::hideFirstBlock()
+void ShowFlodCodeWidget::layoutBlocks(int maxWidth, int maxHeight)
 {
-    m_pContentEdit->document()->firstBlock().setVisible(false);
-    m_pContentEdit->document()->lastBlock().setVisible(false);
-    int editHight = 0;
+    m_layouts.clear();
+    m_nTextWidth = 0;
+    m_nTextHeight = 0;
 
-    for (auto block = m_pContentEdit->document()->firstBlock(); block.isValid(); block = block.next()) {
+    // 预览框宽度不超过窗口宽度
+    const int widthLimit = qMax(0, maxWidth - 50 - 2 * s_contentMargin);
+    const int textWidthLimit = qMax(1, widthLimit - 2 * s_textMargin);
+    const int heightLimit = qMax(0, maxHeight - 2 * s_contentMargin);
 
-        if (block == m_pContentEdit->document()->lastBlock()) {
+    QTextOption option = m_textOption;
+    option.setWrapMode(m_bIsLineWrap ? QTextOption::WrapAnywhere : QTextOption::NoWrap);
+
+    qreal height = 0;
+    qreal width = 0;
+    for (const QTextBlock &block : m_blocks) {
+        if (height >= heightLimit || !block.isValid()) {
             break;
         }
 
-        editHight += m_pContentEdit->document()->documentLayout()->blockBoundingRect(block).toRect().height();
+        std::unique_ptr<QTextLayout> layout(new QTextLayout(block.text(), m_font));
+        layout->setTextOption(option);
+        if (block.layout()) {
+            layout->setFormats(block.layout()->formats());
+        }
+
+        layout->beginLayout();
+        for (QTextLine line = layout->createLine(); line.isValid(); line = layout->createLine()) {
+            if (m_bIsLineWrap) {
+                line.setLineWidth(textWidthLimit);
+            }
+            line.setPosition(QPointF(0, height));
+            height += line.height();
+            width = qMax(width, line.naturalTextWidth());
+        }
+        layout->endLayout();
+
+        m_layouts.push_back(std::move(layout));
     }
 
-    m_pContentEdit->setFixedHeight(editHight + 10);
+    m_nTextWidth = qMin(qCeil(width) + 2 * s_textMargin, widthLimit);
+    m_nTextHeight = qMin(qCeil(height), heightLimit);
 }
 
-void ShowFlodCodeWidget::appendText(QString strText, int maxWidth)
+void ShowFlodCodeWidget::paintEvent(QPaintEvent *event)
 {
-    int textWidth = m_pContentEdit->fontMetrics().horizontalAdvance(strText) + 10;
-
-    if (m_nTextWidth < textWidth) {
-        m_nTextWidth = textWidth;
-        if (m_nTextWidth > maxWidth - 50) {
-            m_nTextWidth = maxWidth - 50;
+    DFrame::paintEvent(event);
+
+    QPainter painter(this);
+    const QRect contentRect(s_contentMargin, s_contentMargin, m_nTextWidth, m_nTextHeight);
+    painter.fillRect(contentRect, m_contentColor);
+    painter.setClipRect(contentRect);
+    painter.setPen(m_textColor);
+    painter.setFont(m_font);
+
+    const QPointF offset(contentRect.left() + s_textMargin, contentRect.top());
+    for (const auto &layout : m_layouts) {
+        // 跳过不在重绘区域内的文本块
+        const QRectF rect = layout->boundingRect().translated(offset);
+        if (rect.top() > event->rect().bottom()) {
+            break;
+        }
+        if (rect.bottom() < event->rect().top()) {
+            continue;
         }
-    }
-
-    m_pContentEdit->setFixedWidth(m_nTextWidth);
 
-    if (m_pContentEdit->document()->isEmpty()) {
-        m_pContentEdit->setPlainText(strText);
-    } else {
-        m_pContentEdit->appendPlainText(strText);
+        layout->draw(&painter, offset);
     }
-
-    QTextCursor cursor = m_pContentEdit->textCursor();
-    cursor.movePosition(QTextCursor::Start);
-    m_pContentEdit->setTextCursor(cursor);
 }
-
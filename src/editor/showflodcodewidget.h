@@ -5,15 +5,21 @@
 #ifndef SHOWFLODCODEWIDGET_H
 #define SHOWFLODCODEWIDGET_H
 #include <DFrame>
-#include <DPlainTextEdit>
 #include <DGuiApplicationHelper>
-#include <KSyntaxHighlighting/repository.h>
-#include <KSyntaxHighlighting/definition.h>
-#include <KSyntaxHighlighting/syntaxhighlighter.h>
-#include <KSyntaxHighlighting/theme.h>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QVector>
+
+#include <memory>
+#include <vector>
 
 DWIDGET_USE_NAMESPACE
 
+/**
+ * @brief 折叠代码预览框
+ *      直接使用编辑器文档中被折叠文本块的内容及已设置的高亮格式绘制，不再创建单独的文档及高亮器。
+ *      仅对预览框高度内可见的行进行布局。
+ */
 class ShowFlodCodeWidget: public DFrame
 {
     Q_OBJECT
@@ -22,21 +28,19 @@ public:
     ~ShowFlodCodeWidget();
 
     /**
-     * @author liumaochuan ut000616
-     * @brief appendText 添加文本
-     * @param strText 文本
+     * @brief setBlocks 设置预览的文本块
+     * @param blocks 编辑器文档中被折叠的文本块
      * @param maxWidth 当前窗口宽度
+     * @param maxHeight 预览框最大高度
      */
-    void appendText(QString strText, int maxWidth);
-
-    void clear();
+    void setBlocks(const QVector<QTextBlock> &blocks, int maxWidth, int maxHeight);
 
     /**
-     * @author liumaochuan ut000616
-     * @brief initHighLight 设置语法高亮
-     * @param filepath 当前文件路径
+     * @brief setTextStyle 设置和编辑器一致的字体、文本选项(制表符宽度等)及默认文本颜色
      */
-    void initHighLight(QString filepath, bool bIsLight);
+    void setTextStyle(const QFont &font, const QTextOption &option, const QColor &textColor);
+
+    void clear();
 
     /**
      * @author liumaochuan ut000616
@@ -45,17 +49,23 @@ public:
      */
     void setStyle(bool bIsLineWrap);
 
-    /**
-     * @author liumaochuan ut000616
-     * @brief hideFirstAndLastBlock 隐藏首末行
-     */
-    void hideFirstBlock();
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // 对文本块进行布局，超出最大高度后不再处理
+    void layoutBlocks(int maxWidth, int maxHeight);
 
 private:
-    DPlainTextEdit *m_pContentEdit;
+    QVector<QTextBlock> m_blocks;                       ///< 预览的文本块
+    std::vector<std::unique_ptr<QTextLayout>> m_layouts; ///< 可见文本块的布局
+    QFont m_font;
+    QTextOption m_textOption;
+    QColor m_textColor;
+    QColor m_contentColor;                              ///< 内容区域背景色
+    bool m_bIsLineWrap = false;
     int m_nTextWidth = 0;///< 代码预览框宽度
-    KSyntaxHighlighting::Repository m_repository;
-    KSyntaxHighlighting::SyntaxHighlighter *m_highlighter;
+    int m_nTextHeight = 0;///< 代码预览框内容高度
 };
 
 #endif // SHOWFLODCODEWIDGET_H
@@ -8,6 +8,7 @@
 #include "urlinfo.h"
 #include "editorapplication.h"
 #include "performancemonitor.h"
+#include "syntaxrepository.h"
 #include "eventlogutils.h"
 #include "common/utils.h"
 
@@ -85,6 +86,9 @@ int main(int argc, char *argv[])
         });
 #endif
 
+        // 在后台线程预先加载共享的高亮定义仓库，创建标签页时无需等待扫描高亮定义文件
+        SyntaxRepository::warmUp();
+
         StartManager *startManager = StartManager::instance();
         //埋点记录启动数据
         QJsonObject objStartEvent{
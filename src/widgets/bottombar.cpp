@@ -44,9 +44,16 @@ BottomBar::BottomBar(QWidget *parent)
     m_progressBar->setRange(0,100);
     m_progressBar->setTextVisible(false);
     m_progressBar->setMinimumWidth(80);
+    m_progressCancelBtn = new DIconButton(DStyle::SP_CloseButton);
+    m_progressCancelBtn->setIconSize(QSize(16, 16));
+    m_progressCancelBtn->setFixedSize(20, 20);
+    m_progressCancelBtn->setFlat(true);
+    m_progressCancelBtn->setToolTip(tr("Cancel"));
+    connect(m_progressCancelBtn, &DIconButton::clicked, this, &BottomBar::exportCancelRequested);
     QHBoxLayout* progressLayout = new QHBoxLayout;
     progressLayout->addWidget(m_progressLabel);
     progressLayout->addWidget(m_progressBar);
+    progressLayout->addWidget(m_progressCancelBtn);
    // progressLayout->addStretch();
 
     DFontSizeManager::instance()->bind(m_pPositionLabel, DFontSizeManager::T9);
@@ -69,6 +76,7 @@ BottomBar::BottomBar(QWidget *parent)
 
     m_progressBar->hide();
     m_progressLabel->hide();
+    m_progressCancelBtn->hide();
 
     m_pCursorStatus->setText(qApp->translate("EditWrapper", "INSERT"));
     m_pPositionLabel->setText(QString("%1 %2  %3 %4").arg(m_rowStr, "1",m_columnStr, "1"));
@@ -255,6 +263,8 @@ void BottomBar::setProgress(int progress)
     if(progress<0){
         return;
     }
+    m_progressLabel->setText(tr("Loading:"));
+    m_progressCancelBtn->hide();
     m_progressBar->show();
     m_progressLabel->show();
     m_progressBar->setValue(progress);
@@ -264,6 +274,21 @@ void BottomBar::setProgress(int progress)
     }
 }
 
+/**
+ * @brief 显示导出进度及取消按钮，导出结束(progress 小于0)时隐藏
+ */
+void BottomBar::setExportProgress(int progress)
+{
+    const bool visible = progress >= 0;
+    m_progressLabel->setText(tr("Exporting:"));
+    m_progressLabel->setVisible(visible);
+    m_progressBar->setVisible(visible);
+    m_progressCancelBtn->setVisible(visible);
+    if (visible) {
+        m_progressBar->setValue(qMin(progress, 100));
+    }
+}
+
 DDropdownMenu *BottomBar::getEncodeMenu()
 {
     return m_pEncodeMenu;
@@ -13,6 +13,7 @@
 #include <DFontSizeManager>
 #include <QPainterPath>
 #include <DProgressBar>
+#include <DIconButton>
 
 #define FormatActionType "format-action-type"
 
@@ -43,6 +44,8 @@ public:
     void setChildrenFocus(bool ok,QWidget* preOrderWidget = nullptr);
     void setScaleLabelText(qreal fontSize);
     void setProgress(int progress);
+    // 显示导出进度，progress 小于0时隐藏
+    void setExportProgress(int progress);
 
     DDropdownMenu* getEncodeMenu();
     DDropdownMenu* getHighlightMenu();
@@ -51,6 +54,10 @@ public:
     void setEndlineMenuText(EndlineFormat format);
     static int defaultHeight();
 
+signals:
+    // 点击取消导出
+    void exportCancelRequested();
+
 protected:
     void paintEvent(QPaintEvent *);
 
@@ -73,6 +80,7 @@ private:
     DLabel* m_scaleLabel = nullptr;
     DLabel* m_progressLabel = nullptr;
     DProgressBar* m_progressBar = nullptr;
+    DIconButton *m_progressCancelBtn = nullptr;
     DDropdownMenu *m_formatMenu = nullptr;
     EndlineFormat m_endlineFormat = EndlineFormat::Unix;
     QAction* m_unixAction = nullptr;
@@ -4,6 +4,7 @@
 
 #include "../common/utils.h"
 #include "../common/settings.h"
+#include "../common/syntaxrepository.h"
 #include "ddropdownmenu.h"
 #include <QHBoxLayout>
 #include <QMouseEvent>
@@ -31,9 +32,6 @@ DDropdownMenu::DDropdownMenu(QWidget *parent)
     , m_pToolButton(new DToolButton(this))
     , m_menu(new DMenu)
 {
-    // 更新单独添加的高亮格式文件
-    m_Repository.addCustomSearchPath(KF5_HIGHLIGHT_PATH);
-
     //设置toobutton属性
     m_pToolButton->setFocusPolicy(Qt::StrongFocus);
     m_pToolButton->setToolButtonStyle(Qt::ToolButtonIconOnly);
@@ -320,7 +318,7 @@ DDropdownMenu *DDropdownMenu::createHighLightMenu()
     QString currentGroup;
 
     bool intel = true;
-    for (KSyntaxHighlighting::Definition def : m_pHighLightMenu->m_Repository.definitions()) {
+    for (KSyntaxHighlighting::Definition def : SyntaxRepository::instance()->definitions()) {
 
         if(def.translatedName()=="Intel x86 (NASM)"&&intel)
         {
@@ -355,7 +353,7 @@ DDropdownMenu *DDropdownMenu::createHighLightMenu()
 
     connect(m_pActionGroup, &QActionGroup::triggered, m_pHighLightMenu, [m_pHighLightMenu] (QAction *action) {
         const auto defName = action->text();
-        const auto def = m_pHighLightMenu->m_Repository.definitionForName(defName);
+        const auto def = SyntaxRepository::instance()->definitionForName(defName);
         if (def.isValid() && m_pHighLightMenu->m_text != action->text()) {
             emit m_pHighLightMenu->currentActionChanged(action);
         }
@@ -80,7 +80,6 @@ private:
     QFont m_font;
     bool m_bPressed =false;
     bool isRequest = false;
-    KSyntaxHighlighting::Repository m_Repository;
 };
 
 #endif
@@ -4,6 +4,7 @@
 
 #include "window.h"
 #include "pathsettintwgt.h"
+#include "../common/printpagecache.h"
 #include <DTitlebar>
 #include <DAnchors>
 #include <DSettingsWidgetFactory>
@@ -27,8 +28,9 @@
 #include <DPrintPreviewDialog>
 #include <QGuiApplication>
 #include <QWindow>
+#include <QEventLoop>
+#include <QTimer>
 #include <DWidgetUtil>
-#include <QTextDocumentFragment>
 #include <dprintpreviewwidget.h>
 
 #ifdef DTKWIDGET_CLASS_DFileDialog
@@ -43,33 +45,6 @@
 #define PRINT_FORMAT_MARGIN 10
 #define FLOATTIP_MARGIN 95
 
-/**
- * @brief 根据传入的源文档 \a doc 创建新的文档
- * @param doc 源文档指针
- * @return 创建的新文档，用于拷贝数据
- */
-static QTextDocument *createNewDocument(QTextDocument *doc)
-{
-    QTextDocument *createDoc = new QTextDocument(doc);
-    // 不记录撤销信息
-    createDoc->setUndoRedoEnabled(false);
-    createDoc->setMetaInformation(QTextDocument::DocumentTitle,
-                                  doc->metaInformation(QTextDocument::DocumentTitle));
-    createDoc->setMetaInformation(QTextDocument::DocumentUrl,
-                                  doc->metaInformation(QTextDocument::DocumentUrl));
-    createDoc->setDefaultFont(doc->defaultFont());
-    createDoc->setDefaultStyleSheet(doc->defaultStyleSheet());
-    createDoc->setIndentWidth(doc->indentWidth());
-
-    // 设置固定为从左向右布局，降低后续高亮等操作导致更新计算布局方向
-    auto textOption = createDoc->defaultTextOption();
-    textOption.setTextDirection(Qt::LeftToRight);
-    textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-    createDoc->setDefaultTextOption(textOption);
-
-    return createDoc;
-}
-
 /*!
  * \~chinese \brief printPage 绘制每一页文本纸张到打印机
  * \~chinese \param index 纸张索引
@@ -103,97 +78,34 @@ void Window::printPage(int index, QPainter *painter, const QTextDocument *doc,
 }
 
 /**
- * @brief 使用多组文档打印，用于超大文档的情况
+ * @brief 使用分页引擎绘制页面，用于大文本打印
  * @param index         纸张索引
  * @param painter       打印指针
- * @param printInfo     多组文档信息
+ * @param snapshot      分页引擎取得的页面快照
  * @param body          范围大小
  * @param pageCountBox  绘制页码的范围
+ * @note 仅访问页面快照，可在工作线程调用
  */
-void Window::printPageWithMultiDoc(
-    int index, QPainter *painter, const QVector<Window::PrintInfo> &printInfo, const QRectF &body, const QRectF &pageCountBox)
+void Window::printPageWithPaginator(int index, QPainter *painter, const PrintPaginator::PageSnapshot &snapshot,
+                                    const QRectF &body, const QRectF &pageCountBox)
 {
     painter->save();
+    painter->translate(body.left(), body.top());
 
-    int docIndex = index;
-    for (auto info : printInfo) {
-        if (docIndex <= info.doc->pageCount()) {
-            // 调整绘制工具坐标到当前页面顶部
-            painter->translate(body.left(), body.top() - (docIndex - 1) * body.height());
-
-            // 绘制页码
-            painter->setFont(QFont(info.doc->defaultFont()));
-            const QRectF box = pageCountBox.translated(0, (docIndex - 1) * body.height());
-            const QString pageString = QString::number(index);
-            painter->drawText(box, Qt::AlignRight, pageString);
-
-            // 设置文档裁剪区域
-            const QRectF docView(0, (docIndex - 1) * body.height(), body.width(), body.height());
-            QAbstractTextDocumentLayout *layout = info.doc->documentLayout();
-
-            // 大文本的高亮单独处理
-            if (info.highlighter) {
-                // 提前两页拷贝数据，用于处理高亮计算时连续处理
-                qreal offsetHeight = qMax<qreal>(0, (qMin(2, docIndex - 1) * body.height()));
-                QPointF point = docView.topLeft() - QPointF(0, offsetHeight);
-                int pos = layout->hitTest(point, Qt::FuzzyHit);
-                QTextCursor cursor(info.doc);
-                cursor.setPosition(pos);
-                // 选取后续内容
-                int endPos = layout->hitTest(docView.bottomLeft(), Qt::FuzzyHit);
-                endPos = qMin(endPos + 1000, info.doc->characterCount() - 1);
-                cursor.setPosition(endPos, QTextCursor::KeepAnchor);
-                cursor.movePosition(QTextCursor::EndOfLine, QTextCursor::KeepAnchor);
-
-                // 创建临时文档
-                QTextDocument *tmpDoc = createNewDocument(info.doc);
-                QTextCursor insertCursor(tmpDoc);
-                insertCursor.beginEditBlock();
-                insertCursor.insertFragment(QTextDocumentFragment(cursor));
-                insertCursor.endEditBlock();
-
-                auto margin = info.doc->rootFrame()->frameFormat().margin();
-                auto fmt = tmpDoc->rootFrame()->frameFormat();
-                fmt.setMargin(margin);
-                tmpDoc->rootFrame()->setFrameFormat(fmt);
-
-                tmpDoc->setPageSize(body.size());
-                // 重新高亮文本
-                auto newHighlighter = new CSyntaxHighlighter(tmpDoc);
-                newHighlighter->setDefinition(info.highlighter->definition());
-                newHighlighter->setTheme(info.highlighter->theme());
-                rehighlightPrintDoc(tmpDoc, newHighlighter);
-
-                // 确保布局完成
-                tmpDoc->pageCount();
-
-                // 调整显示位置
-                painter->resetTransform();
-                painter->translate(body.left(), body.top() - offsetHeight);
-                QAbstractTextDocumentLayout::PaintContext ctx;
-                ctx.clip = QRectF(0, offsetHeight, body.width(), body.height());
-                ctx.palette.setColor(QPalette::Text, Qt::black);
-                tmpDoc->documentLayout()->setPaintDevice(painter->device());
-                tmpDoc->documentLayout()->draw(painter, ctx);
-
-                delete newHighlighter;
-                delete tmpDoc;
-            } else {
-                QAbstractTextDocumentLayout::PaintContext ctx;
-                ctx.clip = docView;
-                ctx.palette.setColor(QPalette::Text, Qt::black);
-                // 绘制文档
-                layout->draw(painter, ctx);
-            }
+    // 绘制页码
+    painter->setFont(snapshot.font);
+    painter->drawText(pageCountBox, Qt::AlignRight, QString::number(index));
 
-            break;
-        }
-        docIndex -= info.doc->pageCount();
-    }
+    // 文本区域和页码区域左侧对齐，上下边距和左右边距一致
+    const qreal margin = pageCountBox.left();
+    painter->translate(margin, margin);
+    painter->setClipRect(QRectF(0, 0, body.width() - 2 * margin, body.height() - 2 * margin));
+    PrintPaginator::drawSnapshot(painter, snapshot);
 
     painter->restore();
 }
 
+
 Window::Window(DMainWindow *parent)
     : DMainWindow(parent),
       m_centralWidget(new QWidget),
@@ -236,6 +148,7 @@ Window::Window(DMainWindow *parent)
     connect(m_settings, &Settings::sigSetLineNumberShow, this, &Window::slotSigSetLineNumberShow);
     connect(m_settings, &Settings::sigAdjustBookmark, this, &Window::slotSigAdjustBookmark);
     connect(m_settings, &Settings::sigShowBlankCharacter, this, &Window::slotSigShowBlankCharacter);
+    connect(m_settings, &Settings::sigShowMinimap, this, &Window::slotSigShowMinimap);
     connect(m_settings, &Settings::sigHightLightCurrentLine, this, &Window::slotSigHightLightCurrentLine);
     connect(m_settings, &Settings::sigShowCodeFlodFlag, this, &Window::slotSigShowCodeFlodFlag);
     /* 设置页面里窗口模式的设置是针对新创建窗口的设置，本窗口不需要实时响应，暂且屏蔽此信号的绑定 */
@@ -481,6 +394,7 @@ void Window::initTitlebar()
     QAction *saveAction(new QAction(tr("Save"), this));
     QAction *saveAsAction(new QAction(tr("Save as"), this));
     QAction *printAction(new QAction(tr("Print"), this));
+    QAction *exportPdfAction(new QAction(tr("Export to PDF"), this));
     QAction *switchThemeAction(new QAction(tr("Switch theme"), this));
     QAction *settingAction(new QAction(tr("Settings"), this));
     QAction *findAction(new QAction(QApplication::translate("TextEdit", "Find"), this));
@@ -495,6 +409,7 @@ void Window::initTitlebar()
     m_menu->addAction(saveAction);
     m_menu->addAction(saveAsAction);
     m_menu->addAction(printAction);
+    m_menu->addAction(exportPdfAction);
     //此接口不可删除，预留的编辑器内部主题选择接口
     //m_menu->addAction(switchThemeAction);
     m_menu->addSeparator();
@@ -556,6 +471,7 @@ void Window::initTitlebar()
     connect(saveAction, &QAction::triggered, this, &Window::saveFile);
     connect(saveAsAction, &QAction::triggered, this, &Window::saveAsFile);
     connect(printAction, &QAction::triggered, this, &Window::popupPrintDialog);
+    connect(exportPdfAction, &QAction::triggered, this, &Window::exportPdf);
     connect(settingAction, &QAction::triggered, this, &Window::popupSettingsDialog);
     connect(switchThemeAction, &QAction::triggered, this, &Window::popupThemePanel);
 }
@@ -907,6 +823,7 @@ void Window::restoreTab()
 
 EditWrapper *Window::createEditor()
 {
+    PerformanceMonitor::createEditorStart();
     EditWrapper *wrapper = new EditWrapper(this);
     connect(wrapper, &EditWrapper::sigClearDoubleCharaterEncode, this, &Window::slotClearDoubleCharaterEncode);
     connect(wrapper->textEditor(), &TextEdit::signal_readingPath, this, &Window::slot_saveReadingPath, Qt::QueuedConnection);
@@ -937,7 +854,10 @@ EditWrapper *Window::createEditor()
     wrapper->textEditor()->setBookmarkFlagVisable(m_settings->settings->option("base.font.showbookmark")->value().toBool(), true);
     wrapper->textEditor()->setCodeFlodFlagVisable(m_settings->settings->option("base.font.codeflod")->value().toBool(), true);
     wrapper->textEditor()->updateLeftAreaWidget();
+    // 已按当前设置初始化，显示时无需再次同步
+    wrapper->setDisplaySettingsGeneration(m_settings->displaySettingsGeneration());
 
+    PerformanceMonitor::createEditorFinish();
     return wrapper;
 }
 
@@ -997,6 +917,7 @@ void Window::removeWrapper(const QString &filePath, bool isDelete)
         m_editorWidget->removeWidget(wrapper);
         m_wrappers.remove(filePath);
         if (isDelete) {
+            wrapper->saveHighlightCache();
             disconnect(wrapper->textEditor(), nullptr);
             disconnect(wrapper, nullptr);
             wrapper->setQuitFlag();
@@ -1399,7 +1320,7 @@ void Window::decrementFontSize()
     m_fontSize = calcFontSizeFromScale(fontScale);
 
     qreal size = qMax<qreal>(m_fontSize, m_settings->m_iMinFontSize);
-    m_settings->settings->option("base.font.size")->setValue(size);
+    scheduleFontSize(size);
 }
 
 void Window::incrementFontSize()
@@ -1410,12 +1331,55 @@ void Window::incrementFontSize()
     m_fontSize = calcFontSizeFromScale(fontScale);
 
     qreal size = qMin<qreal>(m_fontSize, m_settings->m_iMaxFontSize);
-    m_settings->settings->option("base.font.size")->setValue(size);
+    scheduleFontSize(size);
 }
 
 void Window::resetFontSize()
 {
-    m_settings->settings->option("base.font.size")->setValue(m_settings->m_iDefaultFontSize);
+    scheduleFontSize(m_settings->m_iDefaultFontSize);
+}
+
+/**
+ * @brief 立即更新缩放比例显示，延迟保存字号，连续滚动滚轮或按下快捷键时仅重新布局一次
+ */
+void Window::scheduleFontSize(qreal fontSize)
+{
+    // 合并连续缩放的间隔(ms)
+    static const int s_fontSizeDelay = 40;
+
+    m_fontSize = fontSize;
+    if (EditWrapper *wrapper = currentWrapper()) {
+        wrapper->bottomBar()->setScaleLabelText(fontSize);
+    }
+    m_fontSizeTimer.start(s_fontSizeDelay, this);
+}
+
+/**
+ * @brief 仅在标签页显示时调用，显示设置版本未变化(已同步)的标签页不会重新布局
+ */
+void Window::syncDisplaySettings(EditWrapper *wrapper)
+{
+    if (!wrapper || wrapper->displaySettingsGeneration() == m_settings->displaySettingsGeneration()) {
+        return;
+    }
+    wrapper->setDisplaySettingsGeneration(m_settings->displaySettingsGeneration());
+
+    wrapper->textEditor()->setTabSpaceNumber(m_settings->settings->option("advance.editor.tabspacenumber")->value().toInt());
+    wrapper->textEditor()->setLineWrapMode(m_settings->settings->option("base.font.wordwrap")->value().toBool());
+    wrapper->setShowBlankCharacter(m_settings->settings->option("base.font.showblankcharacter")->value().toBool());
+
+    const qreal fontSize = m_fontSize > 0 ? m_fontSize : m_settings->settings->option("base.font.size")->value().toReal();
+    wrapper->textEditor()->applyFont(m_settings->settings->option("base.font.family")->value().toString(), fontSize);
+    wrapper->bottomBar()->setScaleLabelText(fontSize);
+    wrapper->OnUpdateHighlighter();
+}
+
+/**
+ * @brief 显示设置变更时由 Settings 递增版本，各窗口仅立即同步当前标签页，其它标签页在显示时同步
+ */
+void Window::markDisplaySettingsChanged()
+{
+    syncDisplaySettings(currentWrapper());
 }
 
 void Window::setFontSizeWithConfig(EditWrapper *wrapper)
@@ -1616,20 +1580,16 @@ void Window::clearPrintTextDocument()
         m_printDoc = nullptr;
     }
 
-    // 清空打印对象列表
-    if (!m_printDocList.isEmpty()) {
-        for (auto &info : m_printDocList) {
-            if (info.highlighter) {
-                delete info.highlighter;
-            }
-
-            if (info.doc) {
-                info.doc->clear();
-                delete info.doc;
-            }
-        }
+    // 释放缓存的打印页面
+    if (m_printPageCache != nullptr) {
+        m_printPageCache->deleteLater();
+        m_printPageCache = nullptr;
+    }
 
-        m_printDocList.clear();
+    // 释放大文本打印的分页引擎，可能在分页等待的事件循环中触发，延迟释放
+    if (m_printPaginator != nullptr) {
+        m_printPaginator->deleteLater();
+        m_printPaginator = nullptr;
     }
 }
 
@@ -1667,174 +1627,67 @@ QString Window::getCurrentOpenFilePath()
 }
 
 /**
- * @brief 克隆文本数据，不同于 QTextDocument::clone(), 主要用于大文本的拷贝，拷贝过程通过
- *      QApplication::processEvents() 执行其它事件
- * @param editWrapper 文本编辑处理，提供文本编辑器和高亮信息
- * @return 是否克隆数据成功
- *
- * @note Qt自带的布局算法在超长文本时存在计算越界的问题，计算长度将返回溢出值，导致显示异常，
-        调整为拆分的文档结构
+   @brief 接收布局模式变更信号 DGuiApplicationHelper::sizeModeChanged() ，更新界面布局
+        Window 接收布局模式变更，调整 findBar 和 replaceBar 的坐标位置。
+   @note 需要在 findBar / replaceBar / bottomBar 更新后触发更新
  */
-bool Window::cloneLargeDocument(EditWrapper *editWrapper)
+void Window::updateSizeMode()
 {
-    if (!editWrapper) {
-        return false;
+    if (m_findBar && m_findBar->isVisible()) {
+        currentWrapper()->bottomBar()->updateSize(m_findBar->height() + 8, true);
+        m_findBar->move(QPoint(4, height() - m_findBar->height() - 4));
     }
 
-    // 获取源文本
-    QTextDocument *srcDoc = editWrapper->textEditor()->document();
-    // 是否需要高亮
-    bool needHighlighter = editWrapper->getSyntaxHighlighter()
-                           && editWrapper->getSyntaxHighlighter()->definition().isValid();
-    // 创建新的打印信息
-    auto createPrintInfo = [ = ]()->PrintInfo {
-        PrintInfo info;
-        info.doc = createNewDocument(srcDoc);
-        if (needHighlighter)
-        {
-            // 构造高亮处理
-            info.highlighter = new CSyntaxHighlighter(info.doc);
-            info.highlighter->setDefinition(editWrapper->getSyntaxHighlighter()->definition());
-            info.highlighter->setTheme(editWrapper->getSyntaxHighlighter()->theme());
-        }
-        return info;
-    };
-
-    // 每次拷贝约100kb数据
-    static const int s_StepCopyCharCount = 1024 * 100;
-    // 单个文档字符不超过50MB, 防止布局失败
-    static const int s_MaxDocCharCount = 1024 * 1024 * 50;
-    // 单个文档文本块数不超过10万行
-    static const int s_MaxDocBlockCount = 100000;
-
-    // 创建首个拷贝文本对象
-    PrintInfo info = createPrintInfo();
-    QTextDocument *copyDoc = info.doc;
-    m_printDocList.append(info);
-
-    try {
-        // 此次拷贝到字符数统计
-        int currentCopyCharCount = 0;
-        // 此次拷贝勾选的文本块数
-        int currentSelectBlock = 0;
-        // 已读取的源文件偏移量
-        int srcOffset = 0;
-
-        // 标记开始处理
-        m_bPrintProcessing = true;
-        QPointer<QObject> checkPtr(this);
-
-        QTextCursor copyCursor(copyDoc);
-        QTextCursor srcCursor(srcDoc);
-
-        for (QTextBlock srcBlock = srcDoc->firstBlock(); srcBlock.isValid(); srcBlock = srcBlock.next()) {
-            currentSelectBlock++;
-            currentCopyCharCount += srcBlock.length();
-
-            if (currentCopyCharCount >= s_StepCopyCharCount) {
-                // 判断是否超过单个文档允许的最大范围
-                if ((copyDoc->characterCount() + currentCopyCharCount) > s_MaxDocCharCount ||
-                    (copyDoc->blockCount() + currentSelectBlock) > s_MaxDocBlockCount) {
-                    // 创建新的打印文档
-                    m_printDocList.append(createPrintInfo());
-                    copyDoc = m_printDocList.last().doc;
-                    // 创建新的插入光标
-                    copyCursor = QTextCursor(copyDoc);
-                }
-
-                srcCursor.setPosition(srcOffset);
-                srcCursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, currentSelectBlock);
-                copyCursor.insertFragment(QTextDocumentFragment(srcCursor));
-
-                srcOffset += currentCopyCharCount;
-                currentSelectBlock = 0;
-                currentCopyCharCount = 0;
-            }
-
-            // 处理其它事件
-            qApp->processEvents();
-            if (!checkPtr || !m_bPrintProcessing) {
-                qWarning() << "Abort print copy!";
-                clearPrintTextDocument();
-                return false;
-            }
-        }
-
-        // 补充保存最后的信息
-        srcCursor.setPosition(srcOffset);
-        srcCursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, currentSelectBlock);
-        // 保证拷贝到文档末尾
-        srcCursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor, 1);
-        copyCursor.insertFragment(QTextDocumentFragment(srcCursor));
-
-        m_bPrintProcessing = false;
-    } catch (const std::exception &e) {
-        qWarning() << "Print copy doc error!" << e.what();
-        // 清理数据
-        m_bPrintProcessing = false;
-        clearPrintTextDocument();
-        return false;
+    if (m_replaceBar && m_replaceBar->isVisible()) {
+        currentWrapper()->bottomBar()->updateSize(m_replaceBar->height() + 8, true);
+        m_replaceBar->move(QPoint(4, height() - m_replaceBar->height() - 4));
     }
-
-    return true;
 }
 
 /**
-   @brief 使用 \a highlighter 重新高亮传入的文本 \a doc ,此函数用于大文本打印时对临时文本的处理
+ * @brief 选择保存路径后在后台导出当前文档到 PDF 文件，进度及取消按钮显示在底部栏
  */
-void Window::rehighlightPrintDoc(QTextDocument *doc, CSyntaxHighlighter *highlighter)
+void Window::exportPdf()
 {
-    if (!doc || !highlighter) {
+    EditWrapper *wrapper = currentWrapper();
+    //大文本加载过程不允许导出操作
+    if (!wrapper || wrapper->getFileLoading()) {
         return;
     }
 
-    QColor background = m_printWrapper->textEditor()->palette().color(QPalette::Base);
-    bool backgroundIsDark = background.value() < 128;
-
-    highlighter->setEnableHighlight(true);
-    if (backgroundIsDark) {
-        for (QTextBlock block = doc->firstBlock(); block.isValid(); block = block.next()) {
-            highlighter->rehighlightBlock(block);
-
-            QVector<QTextLayout::FormatRange> formatList = block.layout()->formats();
-            // adjust syntax highlighting colors for better contrast
-            for (int i = formatList.count() - 1; i >= 0; --i) {
-                QTextCharFormat &format = formatList[i].format;
-                if (format.background().color() == background) {
-                    QBrush brush = format.foreground();
-                    QColor color = brush.color();
-                    int h, s, v, a;
-                    color.getHsv(&h, &s, &v, &a);
-                    color.setHsv(h, s, qMin(128, v), a);
-                    brush.setColor(color);
-                    format.setForeground(brush);
-                }
-                format.setBackground(Qt::white);
-            }
+    if (wrapper->isExportingPdf()) {
+        wrapper->showNotify(tr("The file is being exported"), true);
+        return;
+    }
 
-            block.layout()->setFormats(formatList);
-        }
-    } else {
-        highlighter->rehighlight();
+    // 草稿文件使用标签页名称，去除修改标记
+    QString fileName = m_tabbar->currentName().remove(QRegularExpression("^\\*"));
+    const QString truePath = wrapper->textEditor()->getTruePath();
+    if (!Utils::isDraftFile(truePath)) {
+        fileName = QFileInfo(truePath).completeBaseName();
     }
-    highlighter->setEnableHighlight(false);
-}
 
-/**
-   @brief 接收布局模式变更信号 DGuiApplicationHelper::sizeModeChanged() ，更新界面布局
-        Window 接收布局模式变更，调整 findBar 和 replaceBar 的坐标位置。
-   @note 需要在 findBar / replaceBar / bottomBar 更新后触发更新
- */
-void Window::updateSizeMode()
-{
-    if (m_findBar && m_findBar->isVisible()) {
-        currentWrapper()->bottomBar()->updateSize(m_findBar->height() + 8, true);
-        m_findBar->move(QPoint(4, height() - m_findBar->height() - 4));
+    DFileDialog dialog(this, tr("Export to PDF"));
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setNameFilter("*.pdf");
+    dialog.setDirectory(Utils::isDraftFile(truePath) ? QDir::homePath() : QFileInfo(truePath).absolutePath());
+    dialog.selectFile(fileName + ".pdf");
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
     }
 
-    if (m_replaceBar && m_replaceBar->isVisible()) {
-        currentWrapper()->bottomBar()->updateSize(m_replaceBar->height() + 8, true);
-        m_replaceBar->move(QPoint(4, height() - m_replaceBar->height() - 4));
+    QString pdfPath = dialog.selectedFiles().value(0);
+    if (pdfPath.isEmpty()) {
+        return;
+    }
+    if (!pdfPath.endsWith(".pdf", Qt::CaseInsensitive)) {
+        pdfPath += ".pdf";
+    }
+
+    // 对话框关闭期间标签页可能已关闭
+    if (m_wrappers.values().contains(wrapper)) {
+        wrapper->exportPdf(pdfPath);
     }
 }
 
@@ -1847,6 +1700,13 @@ void Window::popupPrintDialog()
     if (m_bPrintProcessing) {
         return;
     }
+    // 正在等待高亮完成，再次提示用户，高亮完成后自动弹出打印预览
+    if (m_printHighlightWatcher) {
+        if (EditWrapper *wrapper = currentWrapper()) {
+            wrapper->showNotify(tr("Preparing the document for printing, please wait"));
+        }
+        return;
+    }
 
     const QString &filePath = currentWrapper()->textEditor()->getFilePath();
     const QString &fileDir = QFileInfo(filePath).dir().absolutePath();
@@ -1862,7 +1722,6 @@ void Window::popupPrintDialog()
     m_bLargePrint = false;
     m_bPrintProcessing = false;
     m_printWrapper = currentWrapper();
-    m_multiDocPageCount = 0;
 
     if (doc != nullptr && !doc->isEmpty()) {
         static const int s_maxDirectReadLen = 1024 * 1024 * 10;
@@ -1880,22 +1739,23 @@ void Window::popupPrintDialog()
             // 无需高亮且数据量超过 10MB
             m_bLargePrint = true;
         } else {
-            currentWrapper()->updateHighlighterAll();
+            // 拷贝的文档需要完整的高亮格式，后台高亮完成后再继续
+            if (waitPrintHighlight(currentWrapper())) {
+                return;
+            }
             m_printDoc = doc->clone(doc);
         }
 
         // 大文件处理
         if (m_bLargePrint) {
-            qInfo() << qPrintable("Clone large print document");
-            // 克隆大文本数据
-            if (!cloneLargeDocument(currentWrapper())) {
-                return;
-            }
+            qInfo() << qPrintable("Create large print paginator");
+            // 不拷贝文档，打印时直接按源文档分页和绘制
+            m_printPaginator = new PrintPaginator(doc, this);
         }
     }
 
     if ((!m_bLargePrint && nullptr == m_printDoc)
-            || (m_bLargePrint && m_printDocList.isEmpty())) {
+            || (m_bLargePrint && nullptr == m_printPaginator)) {
         qWarning() << "The print document is not valid!";
         return;
     }
@@ -1938,6 +1798,10 @@ void Window::popupPrintDialog()
     m_pPreview->exec();
 
 #else
+    if (waitPrintHighlight(currentWrapper())) {
+        return;
+    }
+
     DPrintPreviewDialog preview(this);
 
     connect(&preview, QOverload<DPrinter *>::of(&DPrintPreviewDialog::paintRequested),
@@ -1950,12 +1814,38 @@ void Window::popupPrintDialog()
         currentWrapper()->textEditor()->print(printer);
     });
 
-    currentWrapper()->updateHighlighterAll();
-
     preview.exec();
 #endif
 }
 
+/**
+ * @brief 打印需要完整高亮时，通过 QFutureWatcher 等待后台高亮引擎完成，不阻塞 GUI 线程，
+ *      完成后若 \a wrapper 仍为当前标签页则重新进入打印流程
+ * @return 是否正在等待高亮完成
+ */
+bool Window::waitPrintHighlight(EditWrapper *wrapper)
+{
+    QFuture<void> future = wrapper->highlighterAllFuture();
+    if (future.isFinished()) {
+        return false;
+    }
+
+    qInfo() << qPrintable("Wait for highlight before print");
+    wrapper->showNotify(tr("Preparing the document for printing, please wait"));
+    m_printHighlightWatcher = new QFutureWatcher<void>(this);
+    connect(m_printHighlightWatcher, &QFutureWatcher<void>::finished, this, [this, wrapper]() {
+        m_printHighlightWatcher->deleteLater();
+        m_printHighlightWatcher = nullptr;
+
+        // 等待期间标签页可能已关闭或切换，高亮引擎析构时同样结束等待
+        if (m_wrappers.values().contains(wrapper) && wrapper == currentWrapper()) {
+            popupPrintDialog();
+        }
+    });
+    m_printHighlightWatcher->setFuture(future);
+    return true;
+}
+
 void Window::popupThemePanel()
 {
     updateThemePanelGeomerty();
@@ -2166,30 +2056,11 @@ void Window::doPrint(DPrinter *printer, const QVector<int> &pageRange)
         return;
     }
     QColor background = currentWrapper()->textEditor()->palette().color(QPalette::Base);
-    bool backgroundIsDark = background.value() < 128;
     //对文本进行分页处理
     for (QTextBlock srcBlock = currentWrapper()->textEditor()->document()->firstBlock(), dstBlock = m_printDoc->firstBlock();
             srcBlock.isValid() && dstBlock.isValid();
             srcBlock = srcBlock.next(), dstBlock = dstBlock.next()) {
-        QVector<QTextLayout::FormatRange> formatList = srcBlock.layout()->formats();
-        if (backgroundIsDark) {
-            // adjust syntax highlighting colors for better contrast
-            for (int i = formatList.count() - 1; i >= 0; --i) {
-                QTextCharFormat &format = formatList[i].format;
-                if (format.background().color() == background) {
-                    QBrush brush = format.foreground();
-                    QColor color = brush.color();
-                    int h, s, v, a;
-                    color.getHsv(&h, &s, &v, &a);
-                    color.setHsv(h, s, qMin(128, v), a);
-                    brush.setColor(color);
-                    format.setForeground(brush);
-                }
-                format.setBackground(Qt::white);
-            }
-        }
-
-        dstBlock.layout()->setFormats(formatList);
+        dstBlock.layout()->setFormats(PrintPaginator::printFormats(srcBlock.layout()->formats(), background));
     }
 
     QAbstractTextDocumentLayout *layout = m_printDoc->documentLayout();
@@ -2220,18 +2091,22 @@ void Window::doPrint(DPrinter *printer, const QVector<int> &pageRange)
     //输出总页码给到打印预览
     m_pPreview->setAsynPreview(m_printDoc->pageCount());
 
+    // 页面录制后缓存，翻页预览时直接回放，打印文档仅能在 GUI 线程访问
+    QPointer<QTextDocument> printDoc = m_printDoc;
+    printPageCache()->setSource(m_lastLayout, p.device(), [printDoc, body, titleBox](int page) -> PrintPageCache::PageJob {
+        return [printDoc, page, body, titleBox](QPainter *painter) {
+            if (printDoc) {
+                Window::printPage(page, painter, printDoc, body, titleBox);
+            }
+        };
+    }, m_printDoc->pageCount(), false);
+
     //渲染第一页文本
-    for (int i = 0; i < pageRange.count(); ++i) {
-        if (pageRange[i] > m_printDoc->pageCount())
-            continue;
-        Window::printPage(pageRange[i], &p, m_printDoc, body, titleBox);
-        if (i != pageRange.count() - 1)
-            printer->newPage();
-    }
+    printCachedPages(p, printer, pageRange);
 }
 
 /**
- * @brief 用于较大的文本文件进行打印计算和绘制，使用 processEvents 规避打印输入
+ * @brief 用于较大的文本文件进行打印计算和绘制，在后台线程分页，等待期间处理其它事件
  * @param printer       打印指针
  * @param pageRange     打印范围
  */
@@ -2241,7 +2116,7 @@ void Window::doPrintWithLargeDoc(DPrinter *printer, const QVector<int> &pageRang
         return;
     }
 
-    if (m_printDocList.isEmpty()) {
+    if (nullptr == m_printPaginator) {
         return;
     }
 
@@ -2266,7 +2141,7 @@ void Window::doPrintWithLargeDoc(DPrinter *printer, const QVector<int> &pageRang
     m_lastLayout = printer->pageLayout();
     m_isNewPrint = false;
 
-    if (currentWrapper() == nullptr) {
+    if (currentWrapper() == nullptr || m_printWrapper == nullptr) {
         return;
     }
 
@@ -2305,8 +2180,12 @@ void Window::doPrintWithLargeDoc(DPrinter *printer, const QVector<int> &pageRang
     QRectF pageRect(printer->pageRect(QPrinter::Point));
 #endif
     QRectF body = QRectF(0, 0, pageRect.width(), pageRect.height());
-    // 使用首个文档信息即可
-    QFontMetrics fontMetrics(m_printDocList.first().doc->defaultFont(), p.device());
+
+    TextEdit *textEdit = m_printWrapper->textEditor();
+    QTextDocument *srcDoc = textEdit->document();
+    // 打印字体按打印设备分辨率计算
+    QFont printFont(srcDoc->defaultFont(), p.device());
+    QFontMetrics fontMetrics(printFont);
     QRectF titleBox(margin,
                     body.bottom() - margin
                     + fontMetrics.height()
@@ -2314,42 +2193,53 @@ void Window::doPrintWithLargeDoc(DPrinter *printer, const QVector<int> &pageRang
                     body.width() - 2 * margin,
                     fontMetrics.height());
 
-    // Note:大文本打印的高亮处理被延迟到实际打印时计算
-    m_multiDocPageCount = 0;
-    for (auto &info : m_printDocList) {
-        QTextDocument *printDoc = info.doc;
-
-        QAbstractTextDocumentLayout *lay = info.doc->documentLayout();
-        lay->setPaintDevice(p.device());
-
-        auto fmt = printDoc->rootFrame()->frameFormat();
-        fmt.setMargin(margin);
-        printDoc->rootFrame()->setFrameFormat(fmt);
+    // 设置固定为从左向右布局，制表符宽度按打印设备分辨率缩放
+    QTextOption textOption = srcDoc->defaultTextOption();
+    textOption.setTextDirection(Qt::LeftToRight);
+    textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    textOption.setTabStopDistance(textOption.tabStopDistance() * p.device()->logicalDpiX() / textEdit->logicalDpiX());
+
+    m_printPaginator->setPageGeometry(printFont, textOption, QSizeF(body.width() - 2 * margin, body.height() - 2 * margin));
+    m_printPaginator->setBackground(textEdit->palette().color(QPalette::Base));
+    m_printPaginator->paginate();
+
+    // Note:大文本打印直接使用源文档的高亮格式，等待分页和后台高亮均完成
+    QPointer<HighlightEngine> engine = m_printWrapper->getHighlightEngine();
+    QEventLoop loop;
+    QTimer checkTimer;
+    connect(&checkTimer, &QTimer::timeout, &loop, [&]() {
+        // 判断当前窗口是否关闭，退出打印状态
+        if (!checkPtr || !m_bPrintProcessing || nullptr == m_printPaginator) {
+            loop.quit();
+        } else if (m_printPaginator->isFinished()
+                   && (!engine || !engine->isActive() || engine->isFinished())) {
+            loop.quit();
+        }
+    });
+    checkTimer.start(20);
+    loop.exec(QEventLoop::AllEvents | QEventLoop::DialogExec);
 
-        // 设置打印大小
-        printDoc->setPageSize(body.size());
+    if (!checkPtr) {
+        qWarning() << "Abort print layout!";
+        return;
+    }
 
-        for (QTextBlock block = printDoc->firstBlock(); block.isValid(); block = block.next()) {
-            // 通过对单个文本块进行布局，拆分布局总时间，防止布局时间过长
-            lay->blockBoundingRect(block);
-            // 处理其它事件
-            qApp->processEvents(QEventLoop::AllEvents | QEventLoop::DialogExec);
-            // 判断当前窗口是否关闭，退出打印状态
-            if (!checkPtr || !m_bPrintProcessing) {
-                qWarning() << "Abort print layout!";
+    if (!m_bPrintProcessing || nullptr == m_printPaginator) {
+        qWarning() << "Abort print layout!";
 
-                // 手动清理数据
-                QObject::disconnect(m_pPreview, nullptr, this, nullptr);
-                clearPrintTextDocument();
+        // 手动清理数据
+        m_bPrintProcessing = false;
+        QObject::disconnect(m_pPreview, nullptr, this, nullptr);
+        clearPrintTextDocument();
 
-                // 异常退出、中断打印时需要关闭窗口
-                QMetaObject::invokeMethod(m_pPreview, "reject", Qt::QueuedConnection);
-                return;
-            }
-        }
+        // 异常退出、中断打印时需要关闭窗口
+        QMetaObject::invokeMethod(m_pPreview, "reject", Qt::QueuedConnection);
+        return;
+    }
 
-        // 更新文件总打印页数
-        m_multiDocPageCount += printDoc->pageCount();
+    // 应用后台高亮的剩余结果
+    if (engine) {
+        engine->waitForFinished();
     }
 
     if (prieviewWidget) {
@@ -2362,18 +2252,23 @@ void Window::doPrintWithLargeDoc(DPrinter *printer, const QVector<int> &pageRang
     }
 
     //输出总页码给到打印预览
-    m_pPreview->setAsynPreview(m_multiDocPageCount);
+    m_pPreview->setAsynPreview(m_printPaginator->pageCount());
 
-    if (!m_printDocList.isEmpty()) {
-        //渲染第一页文本
-        for (int i = 0; i < pageRange.count(); ++i) {
-            if (pageRange[i] > m_multiDocPageCount)
-                continue;
-            printPageWithMultiDoc(pageRange[i], &p, m_printDocList, body, titleBox);
-            if (i != pageRange.count() - 1)
-                printer->newPage();
+    // 页面快照不访问文档，相邻页面在工作线程预先录制
+    QPointer<PrintPaginator> paginator = m_printPaginator;
+    printPageCache()->setSource(m_lastLayout, p.device(), [paginator, body, titleBox](int page) -> PrintPageCache::PageJob {
+        if (!paginator) {
+            return nullptr;
         }
-    }
+
+        const PrintPaginator::PageSnapshot snapshot = paginator->pageSnapshot(page);
+        return [snapshot, page, body, titleBox](QPainter *painter) {
+            Window::printPageWithPaginator(page, painter, snapshot, body, titleBox);
+        };
+    }, m_printPaginator->pageCount(), true);
+
+    //渲染第一页文本
+    printCachedPages(p, printer, pageRange);
 
     qInfo() << qPrintable("Calc print large doc finised!");
 }
@@ -2386,11 +2281,17 @@ void Window::doPrintWithLargeDoc(DPrinter *printer, const QVector<int> &pageRang
 void Window::asynPrint(QPainter &p, DPrinter *printer, const QVector<int> &pageRange)
 {
     if ((!m_bLargePrint && nullptr == m_printDoc)
-            || (m_bLargePrint && m_printDocList.isEmpty())) {
+            || (m_bLargePrint && nullptr == m_printPaginator)) {
         qWarning() << "The print document is not valid!";
         return;
     }
 
+    // 打印布局未变更，直接回放缓存的页面
+    if (m_printPageCache && m_printPageCache->hasSource()) {
+        printCachedPages(p, printer, pageRange);
+        return;
+    }
+
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
     QRectF pageRect(printer->pageRect());
 #else
@@ -2400,8 +2301,8 @@ void Window::asynPrint(QPainter &p, DPrinter *printer, const QVector<int> &pageR
     int margin = static_cast<int>((2 / 2.54) * dpiy); // 2 cm margins
     QRectF body = QRectF(0, 0, pageRect.width(), pageRect.height());
 
-    QTextDocument *curDoc = m_bLargePrint ? m_printDocList.first().doc : m_printDoc;
-    QFontMetrics fontMetrics(curDoc->defaultFont(), p.device());
+    QFontMetrics fontMetrics = m_bLargePrint ? QFontMetrics(m_printPaginator->font())
+                                             : QFontMetrics(m_printDoc->defaultFont(), p.device());
     QRectF titleBox(margin,
                     body.bottom() - margin
                     + fontMetrics.height()
@@ -2409,13 +2310,12 @@ void Window::asynPrint(QPainter &p, DPrinter *printer, const QVector<int> &pageR
                     body.width() - 2 * margin,
                     fontMetrics.height());
 
-    if (m_bLargePrint
-            && !m_printDocList.isEmpty()) {
+    if (m_bLargePrint) {
         // 大文本打印
         for (int i = 0; i < pageRange.count(); ++i) {
-            if (pageRange[i] > m_multiDocPageCount)
+            if (pageRange[i] > m_printPaginator->pageCount())
                 continue;
-            printPageWithMultiDoc(pageRange[i], &p, m_printDocList, body, titleBox);
+            printPageWithPaginator(pageRange[i], &p, m_printPaginator->pageSnapshot(pageRange[i]), body, titleBox);
             if (i != pageRange.count() - 1)
                 printer->newPage();
         }
@@ -2430,6 +2330,47 @@ void Window::asynPrint(QPainter &p, DPrinter *printer, const QVector<int> &pageR
     }
 }
 
+/**
+ * @brief 取得打印页面缓存，缓存上限取自配置项(MB)
+ */
+PrintPageCache *Window::printPageCache()
+{
+    if (nullptr == m_printPageCache) {
+        m_printPageCache = new PrintPageCache(this);
+
+        auto option = m_settings->settings->option("advance.editor.print_preview_cache_size");
+        if (option && option->value().toInt() > 0) {
+            m_printPageCache->setBudget(static_cast<qint64>(option->value().toInt()) * 1024 * 1024);
+        }
+    }
+
+    return m_printPageCache;
+}
+
+/**
+ * @brief 通过页面缓存绘制打印页面，并预先录制相邻的页面
+ * @param p             打印绘制
+ * @param printer       打印指针
+ * @param pageRange     打印范围
+ */
+void Window::printCachedPages(QPainter &p, DPrinter *printer, const QVector<int> &pageRange)
+{
+    if (pageRange.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < pageRange.count(); ++i) {
+        if (pageRange[i] > m_printPageCache->pageCount())
+            continue;
+        m_printPageCache->drawPage(&p, pageRange[i]);
+        if (i != pageRange.count() - 1)
+            printer->newPage();
+    }
+
+    auto range = std::minmax_element(pageRange.begin(), pageRange.end());
+    m_printPageCache->prefetch(*range.first, *range.second);
+}
+
 void Window::backupFile()
 {
     if (!QFileInfo(m_backupDir).exists()) {
@@ -2931,8 +2872,9 @@ void Window::loadTheme(const QString &path)
     const QString &tabbarEndColor = jsonMap["app-colors"].toMap()["tab-background-end-color"].toString();
 
 
+    // 仅立即更新显示的标签页，其它标签页在切换显示时更新
     for (EditWrapper *wrapper : m_wrappers.values()) {
-        wrapper->OnThemeChangeSlot(m_themePath);
+        wrapper->setPendingTheme(m_themePath);
     }
 
     m_themePanel->setBackground(backgroundColor);
@@ -3140,35 +3082,28 @@ void Window::slotSigThemeChanged(const QString &path)
 
 void Window::slotSigAdjustFont(QString fontName)
 {
-    for (EditWrapper *wrapper : m_wrappers.values()) {
-        wrapper->textEditor()->setFontFamily(fontName);
-    }
+    Q_UNUSED(fontName)
+    // 仅当前标签页立即重新布局，其它标签页在显示时更新
+    markDisplaySettingsChanged();
 }
 
 void Window::slotSigAdjustFontSize(qreal fontSize)
 {
-    for (EditWrapper *wrapper : m_wrappers.values()) {
-        wrapper->textEditor()->setFontSize(fontSize);
-        wrapper->bottomBar()->setScaleLabelText(fontSize);
-        wrapper->OnUpdateHighlighter();
-    }
-
+    m_fontSizeTimer.stop();
     m_fontSize = fontSize;
+    markDisplaySettingsChanged();
 }
 
 void Window::slotSigAdjustTabSpaceNumber(int number)
 {
-    for (EditWrapper *wrapper : m_wrappers.values()) {
-        wrapper->textEditor()->setTabSpaceNumber(number);
-    }
+    Q_UNUSED(number)
+    markDisplaySettingsChanged();
 }
 
 void Window::slotSigAdjustWordWrap(bool enable)
 {
-    for (EditWrapper *wrapper : m_wrappers.values()) {
-        TextEdit *textedit = wrapper->textEditor();
-        textedit->setLineWrapMode(enable);
-    }
+    Q_UNUSED(enable)
+    markDisplaySettingsChanged();
 }
 
 void Window::slotSigSetLineNumberShow(bool bIsShow)
@@ -3187,9 +3122,15 @@ void Window::slotSigAdjustBookmark(bool bIsShow)
 }
 
 void Window::slotSigShowBlankCharacter(bool bIsShow)
+{
+    Q_UNUSED(bIsShow)
+    markDisplaySettingsChanged();
+}
+
+void Window::slotSigShowMinimap(bool bIsShow)
 {
     for (EditWrapper *wrapper : m_wrappers.values()) {
-        wrapper->setShowBlankCharacter(bIsShow);
+        wrapper->setShowMinimap(bIsShow);
     }
 }
 
@@ -3352,6 +3293,7 @@ void Window::closeEvent(QCloseEvent *e)
             continue;
         }
         m_wrappers.remove(wrapper->filePath());
+        wrapper->saveHighlightCache();
         disconnect(wrapper->textEditor());
         wrapper->setQuitFlag();
         wrapper->deleteLater();
@@ -3535,6 +3477,13 @@ void Window::dropEvent(QDropEvent *event)
  */
 void Window::timerEvent(QTimerEvent *e)
 {
+    // 连续缩放结束后保存字号，通过设置变更通知所有窗口
+    if (e->timerId() == m_fontSizeTimer.timerId()) {
+        m_fontSizeTimer.stop();
+        m_settings->settings->option("base.font.size")->setValue(m_fontSize);
+        return;
+    }
+
     // 处理延迟关闭标签事件
     if (e->timerId() == m_delayCloseTabTimer.timerId()) {
         m_delayCloseTabTimer.stop();
@@ -3573,10 +3522,11 @@ QString Window::getKeywordForSearch()
 
 void Window::setPrintEnabled(bool enabled)
 {
+    // 打印和导出 PDF 同时启用或禁用
     for (int i = 0; i < m_menu->actions().count(); i++) {
-        if (!m_menu->actions().at(i)->text().compare(QString("Print"))) {
+        if (!m_menu->actions().at(i)->text().compare(QString("Print"))
+                || !m_menu->actions().at(i)->text().compare(tr("Export to PDF"))) {
             m_menu->actions().at(i)->setEnabled(enabled);
-            return;
         }
     }
 }
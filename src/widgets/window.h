@@ -20,24 +20,22 @@
 #include "../common/dbusinterface.h"
 #include "../common/iflytek_ai_assistant.h"
 #include "../common/CSyntaxHighlighter.h"
+#include "../common/printpaginator.h"
 #include <DMainWindow>
 #include <DStackedWidget>
 #include <qprintpreviewdialog.h>
 #include <dprintpreviewdialog.h>
+#include <QFutureWatcher>
 
 DWIDGET_USE_NAMESPACE
 
+class PrintPageCache;
+
 class Window : public DMainWindow
 {
     Q_OBJECT
 
 public:
-    // 打印文档信息，用于超大文档的打印
-    struct PrintInfo {
-        QTextDocument       *doc = nullptr;         // 打印的文本
-        CSyntaxHighlighter  *highlighter = nullptr; // 高亮处理
-    };
-
     explicit Window(DMainWindow *parent = nullptr);
     ~Window() override;
 
@@ -92,6 +90,8 @@ public:
     void incrementFontSize();
     void resetFontSize();
     void setFontSizeWithConfig(EditWrapper *editor);
+    // 同步显示设置(字体、字号、自动换行、制表符宽度、空白符显示)到标签页，已同步时直接返回
+    void syncDisplaySettings(EditWrapper *wrapper);
 
     void popupFindBar();
     void popupReplaceBar();
@@ -99,6 +99,8 @@ public:
     void updateJumpLineBar(TextEdit *editor);
     void popupSettingsDialog();
     void popupPrintDialog();
+    // 导出当前文档到 PDF 文件
+    void exportPdf();
     void popupThemePanel();
 
     void toggleFullscreen();
@@ -203,6 +205,7 @@ public Q_SLOTS:
     void slotSigSetLineNumberShow(bool bIsShow);
     void slotSigAdjustBookmark(bool bIsShow);
     void slotSigShowBlankCharacter(bool bIsShow);
+    void slotSigShowMinimap(bool bIsShow);
     void slotSigHightLightCurrentLine(bool bIsShow);
     void slotSigShowCodeFlodFlag(bool bIsShow);
     void slotSigChangeWindowSize(QString mode);
@@ -212,6 +215,8 @@ private:
     void updateThemePanelGeomerty();
     void checkTabbarForReload();
     void clearPrintTextDocument();
+    // 打印需要完整高亮时异步等待后台高亮完成，返回 true 表示等待中，完成后重新进入打印流程
+    bool waitPrintHighlight(EditWrapper *wrapper);
     void setWindowTitleInfo();
     // 取得当前文档打开路径（新建文档为"系统-文档"目录）
     QString getCurrentOpenFilePath();
@@ -220,13 +225,13 @@ private:
     // 从字体缩放比例推算字体大小
     qreal calcFontSizeFromScale(qreal fontScale);
 
-    // 克隆文本数据
-    bool cloneLargeDocument(EditWrapper *editWrapper);
-    // 打印多文本数据
-    void printPageWithMultiDoc(int index, QPainter *painter, const QVector<PrintInfo> &printInfo,
-                               const QRectF &body, const QRectF &pageCountBox);
-    // 重新更新文本
-    void rehighlightPrintDoc(QTextDocument *doc, CSyntaxHighlighter *highlighter);
+    // 使用分页引擎打印大文本数据
+    static void printPageWithPaginator(int index, QPainter *painter, const PrintPaginator::PageSnapshot &snapshot,
+                                       const QRectF &body, const QRectF &pageCountBox);
+    // 取得打印页面缓存
+    PrintPageCache *printPageCache();
+    // 通过页面缓存绘制打印页面
+    void printCachedPages(QPainter &p, DPrinter *printer, const QVector<int> &pageRange);
 
     // 接收布局模式变更信号，更新界面布局
     Q_SLOT void updateSizeMode();
@@ -242,6 +247,12 @@ protected:
     // 处理延迟处理等定时器事件
     void timerEvent(QTimerEvent *e) override;
 
+private:
+    // 显示设置变更(版本已由 Settings 递增)，立即应用到当前标签页，其它标签页在显示时同步
+    void markDisplaySettingsChanged();
+    // 更新字号，连续缩放时合并为一次重新布局
+    void scheduleFontSize(qreal fontSize);
+
 private:
     DBusDaemon::dbus *m_rootSaveDBus {nullptr};
 
@@ -293,13 +304,14 @@ private:
     bool m_bLargePrint = false;                     // 是否为大文件打印
     bool m_bPrintProcessing = false;                // 文件打印计算中
     EditWrapper *m_printWrapper = nullptr;          // 当前处理的编辑对象(关闭标签页时需要退出打印)
-    QTextDocument *printCopyDoc = nullptr;              // 用于大文本打印时的拷贝文档
-    CSyntaxHighlighter *printCopyHighlighter = nullptr; // 用于大文本打印时的高亮文档
-    QVector<PrintInfo> m_printDocList;              // 打印文档列表，用于超大文档打印
-    int m_multiDocPageCount = 0;                    // 用于超大文档打印时单独记录多文档的打印页数
+    PrintPaginator *m_printPaginator = nullptr;     // 打印分页引擎，用于超大文档打印
+    PrintPageCache *m_printPageCache = nullptr;     // 打印预览页面缓存
+    QFutureWatcher<void> *m_printHighlightWatcher = nullptr;   // 等待打印文档高亮完成
 
     QBasicTimer m_delayCloseTabTimer;               // 延迟关闭标签页定时器，防止异常情况多次触发关闭同一标签页的情况
     int m_requestCloseTabIndex = 0;                 // 请求关闭的标签页索引
+    QBasicTimer m_fontSizeTimer;                    // 延迟保存字号定时器，合并连续的缩放操作
+
 
     //语音助手服务是否被注册
     bool m_bIsRegistIflytekAiassistant {false};
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_highlightcache.h"
+#include "../../src/common/highlightcache.h"
+
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QFile>
+#include <QDir>
+
+UT_HighlightCache::UT_HighlightCache()
+{
+}
+
+// 为每个文本块设置和行号相关的格式
+static void setBlockFormats(QTextDocument *doc)
+{
+    for (QTextBlock block = doc->firstBlock(); block.isValid(); block = block.next()) {
+        QTextLayout::FormatRange range;
+        range.start = 0;
+        range.length = 3;
+        range.format.setForeground(QColor(block.blockNumber() % 256, 0, 0));
+        range.format.setFontWeight(0 == block.blockNumber() % 2 ? QFont::Bold : QFont::Normal);
+        block.layout()->setFormats({range});
+    }
+}
+
+static QString writeFile(const QString &path, int count)
+{
+    QString text;
+    for (int i = 0; i < count; i++) {
+        text += QString("line %1\n").arg(i);
+    }
+
+    QFile file(path);
+    file.open(QIODevice::WriteOnly);
+    file.write(text.toUtf8());
+    return text;
+}
+
+TEST_F(UT_HighlightCache, saveAndRestore)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    HighlightCache::setCacheDir(dir.filePath("cache"));
+
+    HighlightCache::Key key;
+    key.filePath = dir.filePath("test.cpp");
+    key.definitionName = "C++";
+    key.themeName = "Default";
+    const QString text = writeFile(key.filePath, 3000);
+
+    QTextDocument doc;
+    doc.setPlainText(text);
+    setBlockFormats(&doc);
+    // 仅保存已高亮的文本块
+    ASSERT_TRUE(HighlightCache::save(key, &doc, 1500, 1800));
+
+    QTextDocument restoreDoc;
+    restoreDoc.setPlainText(text);
+    ASSERT_EQ(HighlightCache::restore(key, &restoreDoc), 1800 - (1500 - HighlightCache::s_cacheRadius));
+    ASSERT_TRUE(restoreDoc.findBlockByNumber(1500 - HighlightCache::s_cacheRadius - 1).layout()->formats().isEmpty());
+    ASSERT_TRUE(restoreDoc.findBlockByNumber(1800).layout()->formats().isEmpty());
+    for (int i = 1500 - HighlightCache::s_cacheRadius; i < 1800; i++) {
+        ASSERT_EQ(restoreDoc.findBlockByNumber(i).layout()->formats(), doc.findBlockByNumber(i).layout()->formats());
+    }
+
+    // 不同的高亮定义不使用缓存
+    QTextDocument otherDoc;
+    otherDoc.setPlainText(text);
+    HighlightCache::Key otherKey = key;
+    otherKey.definitionName = "C";
+    ASSERT_EQ(HighlightCache::restore(otherKey, &otherDoc), 0);
+
+    // 文件变更后缓存失效
+    writeFile(key.filePath, 3001);
+    ASSERT_EQ(HighlightCache::restore(key, &otherDoc), 0);
+
+    HighlightCache::remove(key);
+    ASSERT_TRUE(QDir(HighlightCache::cacheDir()).entryList(QDir::Files).isEmpty());
+    HighlightCache::setCacheDir(QString());
+}
+
+TEST_F(UT_HighlightCache, checksum)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    HighlightCache::setCacheDir(dir.filePath("cache"));
+
+    HighlightCache::Key key;
+    key.filePath = dir.filePath("test.cpp");
+    key.definitionName = "C++";
+    const QString text = writeFile(key.filePath, 100);
+
+    QTextDocument doc;
+    doc.setPlainText(text);
+    setBlockFormats(&doc);
+    ASSERT_TRUE(HighlightCache::save(key, &doc, 0, doc.blockCount()));
+
+    // 内容不一致的文本块不应用缓存
+    QTextDocument restoreDoc;
+    restoreDoc.setPlainText(QString(text).replace("line 10\n", "line x\n"));
+    ASSERT_EQ(HighlightCache::restore(key, &restoreDoc), doc.blockCount() - 1);
+    ASSERT_TRUE(restoreDoc.findBlockByNumber(10).layout()->formats().isEmpty());
+    HighlightCache::setCacheDir(QString());
+}
@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_highlightengine.h"
+#include "../../src/common/highlightengine.h"
+#include "../../src/common/utils.h"
+
+#include <KSyntaxHighlighting/Repository>
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QCoreApplication>
+
+UT_HighlightEngine::UT_HighlightEngine()
+{
+}
+
+static QString cppSource(int count)
+{
+    QString text;
+    for (int i = 0; i < count; i++) {
+        text += QString("int func%1(int value)\n"
+                        "{\n"
+                        "    /* comment %1 */\n"
+                        "    return value + %1; // \"text\"\n"
+                        "}\n").arg(i);
+    }
+    return text;
+}
+
+// 使用新的引擎对相同内容完整高亮，比较所有文本块的格式
+static void checkWithFullHighlight(QTextDocument *doc, KSyntaxHighlighting::Repository &repository)
+{
+    QTextDocument fullDoc;
+    fullDoc.setPlainText(doc->toPlainText());
+    HighlightEngine engine(&fullDoc);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+
+    ASSERT_EQ(doc->blockCount(), fullDoc.blockCount());
+    for (QTextBlock block = doc->firstBlock(), fullBlock = fullDoc.firstBlock();
+            block.isValid(); block = block.next(), fullBlock = fullBlock.next()) {
+        ASSERT_EQ(block.layout()->formats(), fullBlock.layout()->formats()) << "block: " << block.blockNumber();
+    }
+}
+
+TEST_F(UT_HighlightEngine, inactive)
+{
+    QTextDocument doc;
+    doc.setPlainText(cppSource(10));
+    HighlightEngine engine(&doc);
+    ASSERT_FALSE(engine.isActive());
+    ASSERT_TRUE(engine.isFinished());
+
+    engine.waitForFinished();
+    ASSERT_TRUE(doc.firstBlock().layout()->formats().isEmpty());
+}
+
+TEST_F(UT_HighlightEngine, highlight)
+{
+    KSyntaxHighlighting::Repository repository;
+    QTextDocument doc;
+    doc.setPlainText(cppSource(2000));
+    HighlightEngine engine(&doc);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    ASSERT_TRUE(engine.isActive());
+    ASSERT_FALSE(engine.isFinished());
+
+    engine.waitForFinished();
+    ASSERT_TRUE(engine.isFinished());
+    ASSERT_FALSE(doc.firstBlock().layout()->formats().isEmpty());
+    ASSERT_FALSE(doc.lastBlock().previous().layout()->formats().isEmpty());
+    // 每隔固定数量的文本块记录检查点
+    ASSERT_GE(engine.checkpointCount(), doc.blockCount() / HighlightEngine::s_checkpointInterval);
+}
+
+TEST_F(UT_HighlightEngine, onContentsChange)
+{
+    KSyntaxHighlighting::Repository repository;
+    QTextDocument doc;
+    doc.setPlainText(cppSource(1000));
+    HighlightEngine engine(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &engine, &HighlightEngine::onContentsChange);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+    const int checkpointCount = engine.checkpointCount();
+
+    // 修改单行内容，检查点数量不变
+    QTextCursor cursor(doc.findBlockByNumber(2000));
+    cursor.insertText("int value = 0;");
+    ASSERT_FALSE(engine.isFinished());
+    engine.waitForFinished();
+    ASSERT_EQ(engine.checkpointCount(), checkpointCount);
+    checkWithFullHighlight(&doc, repository);
+
+    // 插入未闭合的注释，影响之后所有文本块
+    cursor.setPosition(doc.findBlockByNumber(100).position());
+    cursor.insertText("/* open\ncomment\n");
+    engine.waitForFinished();
+    checkWithFullHighlight(&doc, repository);
+
+    // 删除注释起始标记，恢复之后文本块的高亮
+    cursor.setPosition(doc.findBlockByNumber(100).position());
+    cursor.setPosition(doc.findBlockByNumber(102).position(), QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    engine.waitForFinished();
+    checkWithFullHighlight(&doc, repository);
+}
+
+TEST_F(UT_HighlightEngine, setDefinition)
+{
+    KSyntaxHighlighting::Repository repository;
+    QTextDocument doc;
+    doc.setPlainText(cppSource(10));
+    HighlightEngine engine(&doc);
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+    ASSERT_GT(engine.checkpointCount(), 0);
+
+    // 无效定义停止高亮并清除检查点
+    engine.setDefinition(KSyntaxHighlighting::Definition());
+    ASSERT_FALSE(engine.isActive());
+    ASSERT_TRUE(engine.isFinished());
+    ASSERT_EQ(engine.checkpointCount(), 0);
+}
+
+TEST_F(UT_HighlightEngine, frontier)
+{
+    KSyntaxHighlighting::Repository repository;
+    QTextDocument doc;
+    doc.setPlainText(cppSource(2000));
+    HighlightEngine engine(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &engine, &HighlightEngine::onContentsChange);
+    ASSERT_EQ(engine.frontier(), doc.blockCount());
+
+    engine.setDefinition(repository.definitionForName("C++"));
+    ASSERT_EQ(engine.frontier(), 0);
+
+    // 按时间片应用结果，边界逐步推进
+    engine.startJob();
+    int frontier = engine.frontier();
+    while (!engine.isFinished()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        ASSERT_GE(engine.frontier(), frontier);
+        frontier = engine.frontier();
+    }
+    ASSERT_EQ(engine.frontier(), doc.blockCount());
+
+    // 编辑后边界回退到变更位置之前
+    QTextCursor cursor(doc.findBlockByNumber(5000));
+    cursor.insertText("/* ");
+    ASSERT_LE(engine.frontier(), 5000);
+    engine.waitForFinished();
+    ASSERT_EQ(engine.frontier(), doc.blockCount());
+}
+
+TEST_F(UT_HighlightEngine, finishedFuture)
+{
+    KSyntaxHighlighting::Repository repository;
+    QTextDocument doc;
+    doc.setPlainText(cppSource(2000));
+    HighlightEngine engine(&doc);
+
+    // 未启用高亮时返回已完成的结果
+    ASSERT_TRUE(engine.finishedFuture().isFinished());
+
+    engine.setDefinition(repository.definitionForName("C++"));
+    QFuture<void> future = engine.finishedFuture();
+    ASSERT_FALSE(future.isFinished());
+
+    while (!future.isFinished()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    ASSERT_TRUE(engine.isFinished());
+    ASSERT_TRUE(engine.finishedFuture().isFinished());
+}
+
+TEST_F(UT_HighlightEngine, setTheme)
+{
+    KSyntaxHighlighting::Repository repository;
+    const KSyntaxHighlighting::Theme darkTheme = repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme);
+    QTextDocument doc;
+    doc.setPlainText(cppSource(1000));
+    HighlightEngine engine(&doc);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+
+    // 切换主题直接替换已有格式，不重新高亮
+    engine.setTheme(darkTheme);
+    ASSERT_TRUE(engine.isFinished());
+
+    QTextDocument fullDoc;
+    fullDoc.setPlainText(doc.toPlainText());
+    HighlightEngine fullEngine(&fullDoc);
+    fullEngine.setTheme(darkTheme);
+    fullEngine.setDefinition(repository.definitionForName("C++"));
+    fullEngine.waitForFinished();
+    for (QTextBlock block = doc.firstBlock(), fullBlock = fullDoc.firstBlock();
+            block.isValid(); block = block.next(), fullBlock = fullBlock.next()) {
+        ASSERT_EQ(block.layout()->formats(), fullBlock.layout()->formats()) << "block: " << block.blockNumber();
+    }
+}
+
+// 取得文本块中 position 处的高亮格式，无格式时返回默认格式
+static QTextCharFormat formatAt(const QTextBlock &block, int position)
+{
+    const auto formats = block.layout()->formats();
+    for (const QTextLayout::FormatRange &range : formats) {
+        if (range.start <= position && position < range.start + range.length) {
+            return range.format;
+        }
+    }
+    return QTextCharFormat();
+}
+
+TEST_F(UT_HighlightEngine, longLine)
+{
+    KSyntaxHighlighting::Repository repository;
+    // 字符串跨越多个分段位置，字符串在行尾结束，不能在字符串内切分
+    const QString content(LONG_LINE_SEGMENT * 3, 'x');
+    const QString line = "const char *s = \"" + content + "\"; int b = 1;";
+    ASSERT_GT(line.size(), LONG_LINE_THRESHOLD);
+
+    QTextDocument doc;
+    doc.setPlainText(line + "\nint c = 1;");
+    HighlightEngine engine(&doc);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+
+    const QTextBlock block = doc.firstBlock();
+    const int contentStart = line.indexOf('x');
+    const QTextCharFormat stringFormat = formatAt(block, contentStart);
+    ASSERT_NE(stringFormat, QTextCharFormat());
+    for (int position = contentStart; position < contentStart + content.size(); position += LONG_LINE_SEGMENT / 2) {
+        ASSERT_EQ(formatAt(block, position), stringFormat) << "position: " << position;
+    }
+    // 字符串之后的代码和短行的高亮一致
+    ASSERT_EQ(formatAt(block, line.lastIndexOf("int")), formatAt(doc.lastBlock(), 0));
+    ASSERT_NE(formatAt(doc.lastBlock(), 0), QTextCharFormat());
+}
+
+TEST_F(UT_HighlightEngine, longLineSegments)
+{
+    KSyntaxHighlighting::Repository repository;
+    // 超长行分为多段高亮，每段的格式和短行一致，行末未结束的多行注释延续到下一行
+    const QString statement = "int a = 1; /* c */ ";
+    QString line;
+    while (line.size() < LONG_LINE_SEGMENT * 8) {
+        line += statement;
+    }
+    line += "/* open";
+
+    QTextDocument doc;
+    doc.setPlainText(statement + "\n" + line + "\nclose */ int d;");
+    HighlightEngine engine(&doc);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+
+    const QTextBlock shortBlock = doc.firstBlock();
+    const QTextBlock longBlock = shortBlock.next();
+    const int commentOffset = statement.indexOf("/*");
+    const QTextCharFormat keywordFormat = formatAt(shortBlock, 0);
+    const QTextCharFormat commentFormat = formatAt(shortBlock, commentOffset);
+    ASSERT_NE(keywordFormat, QTextCharFormat());
+    ASSERT_NE(commentFormat, QTextCharFormat());
+    for (int position = 0; position + statement.size() <= line.size(); position += statement.size()) {
+        ASSERT_EQ(formatAt(longBlock, position), keywordFormat) << "position: " << position;
+        ASSERT_EQ(formatAt(longBlock, position + commentOffset), commentFormat) << "position: " << position;
+    }
+    ASSERT_EQ(formatAt(longBlock, line.size() - 1), commentFormat);
+    ASSERT_EQ(formatAt(doc.lastBlock(), 0), commentFormat);
+    ASSERT_EQ(formatAt(doc.lastBlock(), QString("close */ ").size()), keywordFormat);
+}
+
+TEST_F(UT_HighlightEngine, longLineLimit)
+{
+    KSyntaxHighlighting::Repository repository;
+    QTextDocument doc;
+    doc.setPlainText("int a = 1; // " + QString(LONG_LINE_HIGHLIGHT_LIMIT, 'x') + "\nint c = 1;");
+    HighlightEngine engine(&doc);
+    engine.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    engine.setDefinition(repository.definitionForName("C++"));
+    engine.waitForFinished();
+
+    // 单行注释在行尾结束，长度限制内找不到切分位置，该行不高亮，之后的行正常高亮
+    ASSERT_TRUE(engine.isFinished());
+    ASSERT_TRUE(doc.firstBlock().layout()->formats().isEmpty());
+    ASSERT_FALSE(doc.lastBlock().layout()->formats().isEmpty());
+}
@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_highlightformattable.h"
+#include "../../src/common/highlightformattable.h"
+#include "../../src/common/highlightengine.h"
+#include "../../src/common/CSyntaxHighlighter.h"
+
+#include <KSyntaxHighlighting/Repository>
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <memory>
+#include <vector>
+
+UT_HighlightFormatTable::UT_HighlightFormatTable()
+{
+}
+
+static QString cppSource(int count)
+{
+    QString text;
+    for (int i = 0; i < count; i++) {
+        text += QString("int func%1(int value)\n"
+                        "{\n"
+                        "    /* comment %1 */\n"
+                        "    return value + %1; // \"text\"\n"
+                        "}\n").arg(i);
+    }
+    return text;
+}
+
+TEST_F(UT_HighlightFormatTable, remap)
+{
+    KSyntaxHighlighting::Repository repository;
+    const KSyntaxHighlighting::Definition definition = repository.definitionForName("C++");
+    const KSyntaxHighlighting::Theme lightTheme = repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme);
+    const KSyntaxHighlighting::Theme darkTheme = repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme);
+
+    const HighlightFormatTable table(definition, darkTheme);
+    ASSERT_FALSE(table.isEmpty());
+
+    // 记录标识的格式替换为新主题的格式
+    const KSyntaxHighlighting::Format format = definition.formats().value(0);
+    QTextLayout::FormatRange range;
+    range.start = 1;
+    range.length = 2;
+    range.format = HighlightFormatTable::charFormat(format, lightTheme);
+    ASSERT_EQ(HighlightFormatTable::formatId(range.format), format.id());
+
+    bool changed = false;
+    const QVector<QTextLayout::FormatRange> ranges = table.remap({range}, &changed);
+    ASSERT_EQ(ranges.size(), 1);
+    ASSERT_EQ(ranges.first().start, 1);
+    ASSERT_EQ(ranges.first().length, 2);
+    ASSERT_EQ(ranges.first().format, HighlightFormatTable::charFormat(format, darkTheme));
+
+    // 未记录标识的格式(例如其它来源设置的格式)保持不变
+    QTextLayout::FormatRange plain;
+    plain.start = 0;
+    plain.length = 1;
+    plain.format.setForeground(Qt::red);
+    ASSERT_EQ(HighlightFormatTable::formatId(plain.format), -1);
+    const QVector<QTextLayout::FormatRange> plainRanges = table.remap({plain}, &changed);
+    ASSERT_FALSE(changed);
+    ASSERT_EQ(plainRanges.first().format, plain.format);
+}
+
+TEST_F(UT_HighlightFormatTable, applySyntaxHighlighter)
+{
+    KSyntaxHighlighting::Repository repository;
+    const KSyntaxHighlighting::Definition definition = repository.definitionForName("C++");
+    const KSyntaxHighlighting::Theme darkTheme = repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme);
+
+    QTextDocument doc;
+    doc.setPlainText(cppSource(20));
+    CSyntaxHighlighter highlighter(&doc);
+    highlighter.setEnableHighlight(true);
+    highlighter.setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
+    highlighter.setDefinition(definition);
+    highlighter.rehighlight();
+
+    // 替换后的格式和使用新主题重新高亮的结果一致
+    ASSERT_GT(HighlightFormatTable(definition, darkTheme).apply(&doc), 0);
+
+    QTextDocument fullDoc;
+    fullDoc.setPlainText(doc.toPlainText());
+    CSyntaxHighlighter fullHighlighter(&fullDoc);
+    fullHighlighter.setEnableHighlight(true);
+    fullHighlighter.setTheme(darkTheme);
+    fullHighlighter.setDefinition(definition);
+    fullHighlighter.rehighlight();
+    for (QTextBlock block = doc.firstBlock(), fullBlock = fullDoc.firstBlock();
+            block.isValid(); block = block.next(), fullBlock = fullBlock.next()) {
+        ASSERT_EQ(block.layout()->formats(), fullBlock.layout()->formats()) << "block: " << block.blockNumber();
+    }
+}
+
+// 多个大文本标签页切换主题，比较重新高亮和按格式标识替换的耗时
+TEST_F(UT_HighlightFormatTable, themeSwitchBenchmark)
+{
+    static const int s_tabCount = 30;
+    static const int s_functionCount = 4000;
+
+    KSyntaxHighlighting::Repository repository;
+    const KSyntaxHighlighting::Definition definition = repository.definitionForName("C++");
+    const KSyntaxHighlighting::Theme lightTheme = repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme);
+    const KSyntaxHighlighting::Theme darkTheme = repository.defaultTheme(KSyntaxHighlighting::Repository::DarkTheme);
+
+    const QString text = cppSource(s_functionCount);
+    std::vector<std::unique_ptr<QTextDocument>> docs;
+    std::vector<std::unique_ptr<HighlightEngine>> engines;
+    for (int i = 0; i < s_tabCount; i++) {
+        docs.emplace_back(new QTextDocument);
+        docs.back()->setPlainText(text);
+        engines.emplace_back(new HighlightEngine(docs.back().get()));
+        engines.back()->setTheme(lightTheme);
+        engines.back()->setDefinition(definition);
+        engines.back()->waitForFinished();
+    }
+
+    // 重新高亮全部文本块
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < s_tabCount; i++) {
+        engines[i]->restart(0);
+        engines[i]->waitForFinished();
+    }
+    const qint64 rehighlightElapsed = timer.elapsed();
+
+    // 按格式标识替换
+    timer.restart();
+    for (int i = 0; i < s_tabCount; i++) {
+        engines[i]->setTheme(darkTheme);
+    }
+    const qint64 remapElapsed = timer.elapsed();
+
+    // 仅处理显示的标签页，其它标签页延迟到显示时处理
+    timer.restart();
+    engines[0]->setTheme(lightTheme);
+    const qint64 visibleElapsed = timer.elapsed();
+
+    qInfo() << "[Benchmark] theme switch tabs:" << s_tabCount
+            << "blocks per tab:" << docs.front()->blockCount()
+            << "rehighlight(ms):" << rehighlightElapsed
+            << "remap(ms):" << remapElapsed
+            << "visible tab only(ms):" << visibleElapsed;
+    for (int i = 0; i < s_tabCount; i++) {
+        EXPECT_TRUE(engines[i]->isFinished());
+    }
+}
@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_HIGHLIGHTFORMATTABLE_H
+#define UT_HIGHLIGHTFORMATTABLE_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class UT_HighlightFormatTable : public QObject, public ::testing::Test
+{
+public:
+    UT_HighlightFormatTable();
+};
+
+#endif  // UT_HIGHLIGHTFORMATTABLE_H
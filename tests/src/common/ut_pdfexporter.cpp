@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_pdfexporter.h"
+#include "../../src/common/pdfexporter.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextLayout>
+#include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+// 读取 /proc/self/status 中的内存字段(KB)
+static qint64 procStatusKb(const QByteArray &field)
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        if (line.startsWith(field + ':')) {
+            return line.mid(field.size() + 1).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+    return -1;
+}
+
+UT_PdfExporter::UT_PdfExporter()
+{
+}
+
+TEST_F(UT_PdfExporter, exportPdf)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QTextDocument doc;
+    QStringList lines;
+    for (int i = 0; i < 2000; i++) {
+        lines.append(QString("line %1\tvalue").arg(i));
+    }
+    doc.setPlainText(lines.join('\n'));
+
+    // 设置高亮格式，导出时保留
+    QTextLayout::FormatRange range;
+    range.start = 0;
+    range.length = 4;
+    range.format.setForeground(Qt::red);
+    for (QTextBlock block = doc.begin(); block.isValid(); block = block.next()) {
+        block.layout()->setFormats({range});
+    }
+
+    PdfExporter exporter(&doc);
+    QSignalSpy progressSpy(&exporter, &PdfExporter::progressChanged);
+    QSignalSpy finishedSpy(&exporter, &PdfExporter::finished);
+
+    const QString filePath = dir.filePath("export.pdf");
+    ASSERT_TRUE(exporter.start(filePath));
+    ASSERT_TRUE(exporter.isRunning());
+    // 正在导出时不允许重复导出
+    ASSERT_FALSE(exporter.start(filePath));
+
+    ASSERT_TRUE(exporter.waitForFinished());
+    ASSERT_FALSE(exporter.isRunning());
+    ASSERT_EQ(finishedSpy.count(), 1);
+    ASSERT_TRUE(finishedSpy.first().first().toBool());
+
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    ASSERT_TRUE(file.read(4) == "%PDF");
+    ASSERT_GT(file.size(), 1024);
+
+    ASSERT_FALSE(progressSpy.isEmpty());
+    ASSERT_EQ(progressSpy.last().first().toInt(), 100);
+}
+
+TEST_F(UT_PdfExporter, cancel)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QTextDocument doc;
+    doc.setPlainText(QString("text\n").repeated(100000));
+
+    PdfExporter exporter(&doc);
+    const QString filePath = dir.filePath("cancel.pdf");
+    ASSERT_TRUE(exporter.start(filePath));
+    exporter.cancel();
+    ASSERT_FALSE(exporter.waitForFinished());
+
+    // 取消后删除未完成的文件
+    ASSERT_FALSE(QFile::exists(filePath));
+}
+
+TEST_F(UT_PdfExporter, contentsChange)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QTextDocument doc;
+    doc.setPlainText(QString("text\n").repeated(100000));
+
+    PdfExporter exporter(&doc);
+    const QString filePath = dir.filePath("change.pdf");
+    ASSERT_TRUE(exporter.start(filePath));
+
+    // 导出期间修改文档，中止导出
+    QTextCursor(&doc).insertText("a");
+    ASSERT_FALSE(exporter.waitForFinished());
+    ASSERT_FALSE(QFile::exists(filePath));
+}
+
+// 大文本导出耗时及峰值内存，默认 16MB ，可通过 EDITOR_BENCHMARK_PDF_MB 指定(例如 100)
+TEST_F(UT_PdfExporter, exportBenchmark)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const int sizeMb = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_PDF_MB")
+                       ? qMax(1, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_PDF_MB")) : 16;
+    const QString line = QString("int value = %1; // benchmark line for pdf export\n");
+    QString text;
+    text.reserve(sizeMb * 1024 * 1024);
+    for (int i = 0; text.size() < sizeMb * 1024 * 1024; i++) {
+        text += line.arg(i);
+    }
+
+    QTextDocument doc;
+    doc.setPlainText(text);
+    text.clear();
+    text.squeeze();
+
+    // 重置峰值内存统计，仅统计导出期间的增长
+    QFile clearRefs("/proc/self/clear_refs");
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+        clearRefs.close();
+    }
+    const qint64 baseRss = procStatusKb("VmRSS");
+
+    PdfExporter exporter(&doc);
+    QElapsedTimer timer;
+    timer.start();
+    ASSERT_TRUE(exporter.start(dir.filePath("benchmark.pdf")));
+    ASSERT_TRUE(exporter.waitForFinished());
+    const qint64 elapsed = timer.elapsed();
+
+    const qint64 peakRss = procStatusKb("VmHWM");
+    const qint64 growthMb = (baseRss >= 0 && peakRss >= 0) ? (peakRss - baseRss) / 1024 : -1;
+    qInfo() << "[Benchmark] export pdf(MB):" << sizeMb
+            << "blocks:" << doc.blockCount()
+            << "elapsed(ms):" << elapsed
+            << "peak memory growth(MB):" << growthMb
+            << "pdf size(KB):" << QFileInfo(dir.filePath("benchmark.pdf")).size() / 1024;
+
+    // 不拷贝文档，导出期间的内存增长和文档大小无关
+    if (growthMb >= 0) {
+        EXPECT_LT(growthMb, 256);
+    }
+}
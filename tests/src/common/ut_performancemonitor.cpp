@@ -74,3 +74,63 @@ TEST_F(test_performanceMonitor, openFileFinish)
     EXPECT_NE(p.openFileFinishMs,0);
     
 }
+
+//static void frameUpdateFinish(int foldedEvents);
+TEST_F(test_performanceMonitor, frameUpdateFinish)
+{
+    PerformanceMonitor::resetFrameUpdateStatistics();
+    PerformanceMonitor::frameUpdateFinish(1);
+    PerformanceMonitor::frameUpdateFinish(5);
+
+    EXPECT_EQ(PerformanceMonitor::frameUpdateCount, 2);
+    EXPECT_EQ(PerformanceMonitor::frameUpdateEventCount, 6);
+    EXPECT_EQ(PerformanceMonitor::frameUpdateMaxEvents, 5);
+
+    PerformanceMonitor::resetFrameUpdateStatistics();
+    EXPECT_EQ(PerformanceMonitor::frameUpdateCount, 0);
+}
+
+//static void recordLatency(LatencyMetric metric, qint64 nsecs);
+TEST_F(test_performanceMonitor, recordLatency)
+{
+    PerformanceMonitor::resetLatencyStatistics();
+    EXPECT_EQ(PerformanceMonitor::latencyPercentile(PerformanceMonitor::KeyToPaint, 50), 0);
+
+    // 1ms ~ 100ms 各记录一次，百分位数的相对误差不超过 25%
+    for (int ms = 1; ms <= 100; ms++) {
+        PerformanceMonitor::recordLatency(PerformanceMonitor::KeyToPaint, ms * 1000000LL);
+    }
+    EXPECT_EQ(PerformanceMonitor::latencyCount(PerformanceMonitor::KeyToPaint), 100);
+    const qint64 p50 = PerformanceMonitor::latencyPercentile(PerformanceMonitor::KeyToPaint, 50);
+    const qint64 p99 = PerformanceMonitor::latencyPercentile(PerformanceMonitor::KeyToPaint, 99);
+    EXPECT_GE(p50, 50000);
+    EXPECT_LE(p50, 50000 * 5 / 4);
+    EXPECT_GE(p99, 99000);
+    EXPECT_LE(p99, 99000 * 5 / 4);
+    EXPECT_LE(PerformanceMonitor::latencyPercentile(PerformanceMonitor::KeyToPaint, 100), 100000 * 5 / 4);
+
+    // 区间连续且单调递增
+    for (int bucket = 1; bucket < PerformanceMonitor::s_latencyBucketCount; bucket++) {
+        const qint64 lower = PerformanceMonitor::latencyBucketLowerBound(bucket);
+        EXPECT_GT(lower, PerformanceMonitor::latencyBucketLowerBound(bucket - 1));
+        EXPECT_EQ(PerformanceMonitor::latencyBucket(lower), bucket);
+        EXPECT_EQ(PerformanceMonitor::latencyBucket(lower - 1), bucket - 1);
+    }
+
+    {
+        PerformanceMonitor::LatencyScope latency(PerformanceMonitor::EditorPaint);
+    }
+    EXPECT_EQ(PerformanceMonitor::latencyCount(PerformanceMonitor::EditorPaint), 1);
+
+    PerformanceMonitor::resetLatencyStatistics();
+    EXPECT_EQ(PerformanceMonitor::latencyCount(PerformanceMonitor::KeyToPaint), 0);
+}
+
+//static void setLatencyOverlayEnabled(bool enabled);
+TEST_F(test_performanceMonitor, setLatencyOverlayEnabled)
+{
+    PerformanceMonitor::setLatencyOverlayEnabled(true);
+    EXPECT_TRUE(PerformanceMonitor::latencyOverlayEnabled());
+    PerformanceMonitor::setLatencyOverlayEnabled(false);
+    EXPECT_FALSE(PerformanceMonitor::latencyOverlayEnabled());
+}
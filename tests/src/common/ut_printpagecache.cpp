@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_printpagecache.h"
+#include "../../src/common/printpagecache.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QPageSize>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+
+UT_PrintPageCache::UT_PrintPageCache()
+{
+}
+
+// 绘制页码文本的页面任务，记录调用次数
+static PrintPageCache::JobFactory createFactory(QAtomicInt *recordCount)
+{
+    return [recordCount](int page) -> PrintPageCache::PageJob {
+        return [recordCount, page](QPainter *painter) {
+            recordCount->ref();
+            for (int line = 0; line < 50; line++) {
+                painter->drawText(QPointF(10, 20 + line * 20), QString("page %1 line %2").arg(page).arg(line));
+            }
+        };
+    };
+}
+
+TEST_F(UT_PrintPageCache, drawPage)
+{
+    QImage device(600, 1200, QImage::Format_ARGB32);
+    QAtomicInt recordCount;
+    PrintPageCache cache;
+    cache.setSource(QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()),
+                    &device, createFactory(&recordCount), 10, false);
+    ASSERT_TRUE(cache.hasSource());
+
+    QPainter painter(&device);
+    cache.drawPage(&painter, 1);
+    ASSERT_EQ(recordCount.loadAcquire(), 1);
+    ASSERT_TRUE(cache.contains(1));
+
+    // 已缓存的页面直接回放
+    cache.drawPage(&painter, 1);
+    ASSERT_EQ(recordCount.loadAcquire(), 1);
+
+    // 超出页数的页面不绘制
+    cache.drawPage(&painter, 11);
+    ASSERT_EQ(recordCount.loadAcquire(), 1);
+    painter.end();
+
+    // 不同布局使用不同的缓存键
+    cache.setSource(QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Landscape, QMarginsF()),
+                    &device, createFactory(&recordCount), 10, false);
+    ASSERT_FALSE(cache.contains(1));
+}
+
+TEST_F(UT_PrintPageCache, budget)
+{
+    QImage device(600, 1200, QImage::Format_ARGB32);
+    QAtomicInt recordCount;
+    PrintPageCache cache;
+    cache.setSource(QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()),
+                    &device, createFactory(&recordCount), 100, false);
+    cache.setBudget(256 * 1024);
+
+    QPainter painter(&device);
+    for (int page = 1; page <= 100; page++) {
+        cache.drawPage(&painter, page);
+    }
+    painter.end();
+
+    // 超出上限时淘汰最久未使用的页面
+    ASSERT_LE(cache.cost(), cache.budget());
+    ASSERT_LT(cache.count(), 100);
+    ASSERT_TRUE(cache.contains(100));
+    ASSERT_FALSE(cache.contains(1));
+}
+
+TEST_F(UT_PrintPageCache, prefetch)
+{
+    QImage device(600, 1200, QImage::Format_ARGB32);
+    QAtomicInt recordCount;
+    PrintPageCache cache;
+    cache.setSource(QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()),
+                    &device, createFactory(&recordCount), 10, true);
+
+    // 在工作线程预先录制相邻的页面
+    cache.prefetch(5, 5);
+    QElapsedTimer timer;
+    timer.start();
+    while (!(cache.contains(4) && cache.contains(6) && cache.contains(3) && cache.contains(7))
+            && timer.elapsed() < 5000) {
+        QCoreApplication::processEvents();
+    }
+
+    ASSERT_TRUE(cache.contains(3));
+    ASSERT_TRUE(cache.contains(4));
+    ASSERT_TRUE(cache.contains(6));
+    ASSERT_TRUE(cache.contains(7));
+    ASSERT_FALSE(cache.contains(5));
+    ASSERT_FALSE(cache.contains(8));
+
+    // 清空后丢弃缓存
+    cache.clear();
+    ASSERT_EQ(cache.count(), 0);
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_printpaginator.h"
+#include "../../src/common/printpaginator.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QFontMetricsF>
+
+UT_PrintPaginator::UT_PrintPaginator()
+{
+}
+
+TEST_F(UT_PrintPaginator, lineCount)
+{
+    QFont font;
+    QTextOption option;
+    option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+
+    // 空文本占用一行
+    ASSERT_EQ(PrintPaginator::lineCount(QString(), font, option, 100), 1);
+    ASSERT_EQ(PrintPaginator::lineCount("a", font, option, 100), 1);
+
+    // 超出宽度时换行
+    const qreal charWidth = QFontMetricsF(font).horizontalAdvance('a');
+    ASSERT_GT(PrintPaginator::lineCount(QString(100, 'a'), font, option, charWidth * 10), 5);
+}
+
+TEST_F(UT_PrintPaginator, paginate)
+{
+    QTextDocument doc;
+    QStringList lines;
+    for (int i = 0; i < 10000; i++) {
+        lines.append(QString::number(i));
+    }
+    doc.setPlainText(lines.join('\n'));
+
+    QFont font;
+    const qreal lineHeight = QFontMetricsF(font).lineSpacing();
+    PrintPaginator paginator(&doc);
+    // 每页 50 行
+    paginator.setPageGeometry(font, QTextOption(), QSizeF(1000, lineHeight * 50.5));
+    ASSERT_EQ(paginator.linesPerPage(), 50);
+
+    paginator.paginate();
+    paginator.waitForFinished();
+    ASSERT_TRUE(paginator.isFinished());
+    ASSERT_EQ(paginator.pageCount(), 200);
+    ASSERT_EQ(paginator.pageStart(2).block, 50);
+    ASSERT_EQ(paginator.pageStart(200).block, 9950);
+    ASSERT_EQ(paginator.pageStart(200).line, 0);
+}
+
+TEST_F(UT_PrintPaginator, paginateWrapLine)
+{
+    QTextDocument doc;
+    QFont font;
+    const qreal charWidth = QFontMetricsF(font).horizontalAdvance('a');
+    const qreal lineHeight = QFontMetricsF(font).lineSpacing();
+    doc.setPlainText(QString("a\n") + QString(1000, 'a'));
+
+    QTextOption option;
+    option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    PrintPaginator paginator(&doc);
+    paginator.setPageGeometry(font, option, QSizeF(charWidth * 100.5, lineHeight * 4.5));
+    paginator.paginate();
+    paginator.waitForFinished();
+
+    // 长行跨页时，页面从文本块内的行开始
+    const int wrapLines = PrintPaginator::lineCount(doc.lastBlock().text(), font, option, charWidth * 100.5);
+    ASSERT_EQ(paginator.pageCount(), (1 + wrapLines + 3) / 4);
+    ASSERT_EQ(paginator.pageStart(2).block, 1);
+    ASSERT_EQ(paginator.pageStart(2).line, 3);
+}
+
+TEST_F(UT_PrintPaginator, contentsChange)
+{
+    QTextDocument doc;
+    doc.setPlainText("a\nb");
+
+    QFont font;
+    PrintPaginator paginator(&doc);
+    paginator.setPageGeometry(font, QTextOption(), QSizeF(1000, QFontMetricsF(font).lineSpacing() * 2));
+    paginator.paginate();
+    paginator.waitForFinished();
+    ASSERT_EQ(paginator.pageCount(), 1);
+
+    // 文档变更后重新分页
+    QTextCursor cursor(&doc);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText("\nc");
+    ASSERT_FALSE(paginator.isFinished());
+    paginator.waitForFinished();
+    ASSERT_EQ(paginator.pageCount(), 2);
+}
+
+TEST_F(UT_PrintPaginator, printFormats)
+{
+    QTextLayout::FormatRange range;
+    range.start = 0;
+    range.length = 1;
+    range.format.setForeground(QColor(Qt::white));
+    range.format.setBackground(QColor(Qt::black));
+    const QVector<QTextLayout::FormatRange> formats {range};
+
+    // 浅色背景不调整
+    ASSERT_EQ(PrintPaginator::printFormats(formats, Qt::white).first().format, range.format);
+
+    // 深色背景降低前景色亮度并使用白色背景
+    const QTextCharFormat format = PrintPaginator::printFormats(formats, Qt::black).first().format;
+    ASSERT_LE(format.foreground().color().value(), 128);
+    ASSERT_EQ(format.background().color(), QColor(Qt::white));
+}
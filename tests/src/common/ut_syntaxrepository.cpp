@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_syntaxrepository.h"
+#include "../../src/common/syntaxrepository.h"
+#include "../../src/editor/editwrapper.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QElapsedTimer>
+#include <QDebug>
+
+UT_SyntaxRepository::UT_SyntaxRepository()
+{
+}
+
+TEST_F(UT_SyntaxRepository, instance)
+{
+    KSyntaxHighlighting::Repository *repository = SyntaxRepository::instance();
+    ASSERT_NE(repository, nullptr);
+    ASSERT_TRUE(SyntaxRepository::isLoaded());
+    ASSERT_EQ(SyntaxRepository::instance(), repository);
+    ASSERT_FALSE(repository->definitions().isEmpty());
+    ASSERT_TRUE(repository->definitionForFileName("main.cpp").isValid());
+}
+
+TEST_F(UT_SyntaxRepository, multiThread)
+{
+    // 多个线程同时访问时返回同一实例
+    QFuture<KSyntaxHighlighting::Repository *> future1 = QtConcurrent::run([]() {
+        return SyntaxRepository::instance();
+    });
+    QFuture<KSyntaxHighlighting::Repository *> future2 = QtConcurrent::run([]() {
+        return SyntaxRepository::instance();
+    });
+    SyntaxRepository::warmUp();
+
+    ASSERT_EQ(future1.result(), SyntaxRepository::instance());
+    ASSERT_EQ(future2.result(), SyntaxRepository::instance());
+}
+
+/**
+ * @brief 标签页构造耗时，对比共享仓库前每个标签页构造 4 个高亮定义仓库的开销。
+ *      本仓库未记录修改前后的实测数据，需要时设置 EDITOR_BENCHMARK_TABS(标签页数量)执行并查看输出。
+ */
+TEST_F(UT_SyntaxRepository, tabConstructionBenchmark)
+{
+    if (!qEnvironmentVariableIsSet("EDITOR_BENCHMARK_TABS")) {
+        return;
+    }
+    const int tabCount = qMax(1, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_TABS"));
+    // 共享前每个标签页中 TextEdit、EditWrapper、ShowFlodCodeWidget 及底栏各自构造一个仓库
+    static const int s_repositoriesPerTab = 4;
+
+    SyntaxRepository::instance();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < tabCount; i++) {
+        EditWrapper *wrapper = new EditWrapper;
+        delete wrapper;
+    }
+    const qint64 sharedElapsed = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < tabCount * s_repositoriesPerTab; i++) {
+        KSyntaxHighlighting::Repository repository;
+        ASSERT_FALSE(repository.definitions().isEmpty());
+    }
+    const qint64 repositoryElapsed = timer.nsecsElapsed();
+
+    qInfo() << "[Benchmark] tabs:" << tabCount
+            << "per tab with shared repository(us):" << sharedElapsed / 1000 / tabCount
+            << "extra repository loads per tab before sharing(us):" << repositoryElapsed / 1000 / tabCount;
+}
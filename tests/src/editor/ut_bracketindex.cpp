@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_bracketindex.h"
+#include "../../src/editor/bracketindex.h"
+#include "../../src/common/utils.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextBlock>
+
+UT_BracketIndex::UT_BracketIndex()
+{
+}
+
+// 逐字符扫描查找匹配括号，作为比较的基准
+static int scanMatchingBracket(QTextDocument *doc, int position, const QChar &openChar, const QChar &closeChar, bool forward)
+{
+    const QChar begin = forward ? openChar : closeChar;
+    const QChar end = forward ? closeChar : openChar;
+    int braceDepth = 1;
+    bool inCodeString = false;
+    QChar c;
+    while (!(c = doc->characterAt(position)).isNull()) {
+        if (inCodeString) {
+            if ('"' == c && '\\' != doc->characterAt(position - 1)) {
+                inCodeString = false;
+            }
+        } else {
+            if (c == begin) {
+                braceDepth++;
+            } else if (c == end) {
+                braceDepth--;
+                if (!braceDepth) {
+                    return position;
+                }
+            } else if ('"' == c) {
+                inCodeString = true;
+            }
+        }
+
+        forward ? position++ : position--;
+    }
+
+    return -1;
+}
+
+// 比较文档中所有位置的查找结果
+static void checkWithScan(QTextDocument *doc, BracketIndex &index)
+{
+    const QString pairs[] = {"()", "{}", "[]"};
+    for (const QString &pair : pairs) {
+        for (int pos = 0; pos < doc->characterCount(); pos++) {
+            for (bool forward : {true, false}) {
+                ASSERT_EQ(index.findMatchingBracket(pos, pair.at(0), pair.at(1), forward),
+                          scanMatchingBracket(doc, pos, pair.at(0), pair.at(1), forward))
+                        << "pos: " << pos << " pair: " << pair.toStdString() << " forward: " << forward;
+            }
+        }
+    }
+}
+
+TEST_F(UT_BracketIndex, bracketType)
+{
+    ASSERT_EQ(BracketIndex::bracketType('(', ')'), BracketIndex::RoundBracket);
+    ASSERT_EQ(BracketIndex::bracketType('{', '}'), BracketIndex::CurlyBracket);
+    ASSERT_EQ(BracketIndex::bracketType('[', ']'), BracketIndex::SquareBracket);
+    ASSERT_EQ(BracketIndex::bracketType('<', '>'), -1);
+}
+
+TEST_F(UT_BracketIndex, findMatchingBracket)
+{
+    QTextDocument doc;
+    doc.setPlainText("int main(int argc, char *argv[])\n"
+                     "{\n"
+                     "    if (argc > 1) {\n"
+                     "        printf(\"{ ( [\");\n"
+                     "        printf(\"\\\" ) \");\n"
+                     "    }\n"
+                     "\n"
+                     "    return 0;\n"
+                     "}\n");
+    BracketIndex index(&doc);
+
+    // 'main(' 之后查找 ')'
+    const int open = doc.toPlainText().indexOf('(');
+    const int close = doc.toPlainText().indexOf(')');
+    ASSERT_EQ(index.findMatchingBracket(open + 1, '(', ')', true), close);
+    ASSERT_EQ(index.findMatchingBracket(close - 1, '(', ')', false), open);
+
+    checkWithScan(&doc, index);
+}
+
+TEST_F(UT_BracketIndex, multiLineString)
+{
+    QTextDocument doc;
+    // 跨行的未闭合字符串
+    doc.setPlainText("{ \"abc\n"
+                     "} def\n"
+                     "ghi\" }\n"
+                     "[ ( ] )");
+    BracketIndex index(&doc);
+
+    checkWithScan(&doc, index);
+}
+
+TEST_F(UT_BracketIndex, onContentsChange)
+{
+    QTextDocument doc;
+    doc.setPlainText("{\n(\n[\n]\n)\n}");
+    BracketIndex index(&doc);
+    ASSERT_EQ(index.findMatchingBracket(1, '{', '}', true), doc.characterCount() - 2);
+
+    QTextCursor cursor(&doc);
+    cursor.setPosition(2);
+    cursor.insertText("}\n{\n");
+    checkWithScan(&doc, index);
+
+    cursor.setPosition(0);
+    cursor.setPosition(6, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    checkWithScan(&doc, index);
+
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText("\n\"(\"\n)");
+    checkWithScan(&doc, index);
+}
+
+TEST_F(UT_BracketIndex, timeBudget)
+{
+    QTextDocument doc;
+    doc.setPlainText(QString("(\n") + QString("abc\n").repeated(1000) + ")");
+    BracketIndex index(&doc);
+    ASSERT_EQ(index.findMatchingBracket(1, '(', ')', true), doc.characterCount() - 2);
+
+    // 超出耗时上限时返回未找到
+    index.clear();
+    index.setTimeBudget(-1);
+    ASSERT_EQ(index.findMatchingBracket(1, '(', ')', true), -1);
+}
+
+TEST_F(UT_BracketIndex, longLine)
+{
+    QTextDocument doc;
+    const QString padding(LONG_LINE_THRESHOLD, 'a');
+    // 超长行内相邻的括号及相隔超过分段长度的括号
+    doc.setPlainText("{\n(" + padding + "(b)" + padding + ")\n}");
+    BracketIndex index(&doc);
+    const QTextBlock longBlock = doc.findBlockByNumber(1);
+
+    const int open = longBlock.position() + padding.size() + 1;
+    ASSERT_EQ(index.findMatchingBracket(open + 1, '(', ')', true), open + 2);
+    ASSERT_EQ(index.findMatchingBracket(open + 1, '(', ')', false), open);
+
+    // 匹配括号不在分段内时不再查找
+    ASSERT_EQ(index.findMatchingBracket(longBlock.position() + 1, '(', ')', true), -1);
+    const int close = longBlock.position() + longBlock.length() - 2;
+    ASSERT_EQ(index.findMatchingBracket(close - 1, '(', ')', false), -1);
+
+    // 不跨越超长行查找
+    ASSERT_EQ(index.findMatchingBracket(1, '{', '}', true), -1);
+}
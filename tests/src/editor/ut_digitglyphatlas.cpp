@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_digitglyphatlas.h"
+#include "../../src/editor/digitglyphatlas.h"
+#include "../../src/editor/dtextedit.h"
+#include "../../src/editor/leftareaoftextedit.h"
+
+#include <QPainter>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QDebug>
+
+UT_DigitGlyphAtlas::UT_DigitGlyphAtlas()
+{
+}
+
+// 图像中是否存在非透明像素
+static bool hasPaintedPixel(const QImage &image)
+{
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            if (qAlpha(image.pixel(x, y)) > 0) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// 图像中非透明像素的外接矩形
+static QRect paintedRect(const QImage &image)
+{
+    QRect rect;
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            if (qAlpha(image.pixel(x, y)) > 0) {
+                rect |= QRect(x, y, 1, 1);
+            }
+        }
+    }
+
+    return rect;
+}
+
+// 是否设置了 EDITOR_BENCHMARK_GUTTER，行号绘制的耗时测试默认不执行
+static bool gutterBenchmarkEnabled()
+{
+    return qEnvironmentVariableIsSet("EDITOR_BENCHMARK_GUTTER");
+}
+
+TEST_F(UT_DigitGlyphAtlas, drawNumber)
+{
+    DigitGlyphAtlas atlas;
+    QImage image(120, 40, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    atlas.drawNumber(&painter, image.rect(), 1234567890, QFont(), Qt::black);
+    atlas.drawNumber(&painter, image.rect(), -1, QFont(), Qt::black);
+    painter.end();
+
+    EXPECT_TRUE(hasPaintedPixel(image));
+    EXPECT_EQ(atlas.atlasCount(), 1);
+}
+
+TEST_F(UT_DigitGlyphAtlas, atlasCache)
+{
+    DigitGlyphAtlas atlas;
+    QImage image(60, 20, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+
+    QFont font;
+    for (int i = 0; i < 100; i++) {
+        atlas.drawNumber(&painter, image.rect(), i, font, Qt::black);
+    }
+    EXPECT_EQ(atlas.atlasCount(), 1);
+
+    atlas.drawNumber(&painter, image.rect(), 1, font, Qt::red);
+    EXPECT_EQ(atlas.atlasCount(), 2);
+
+    font.setPointSize(font.pointSize() + 4);
+    atlas.drawNumber(&painter, image.rect(), 1, font, Qt::red);
+    EXPECT_EQ(atlas.atlasCount(), 3);
+
+    atlas.clear();
+    EXPECT_EQ(atlas.atlasCount(), 0);
+}
+
+// 图集绘制的行号和 drawText(AlignCenter) 绘制的位置及大小一致，允许 1 像素的取整误差
+TEST_F(UT_DigitGlyphAtlas, matchDrawText)
+{
+    QFont font;
+    font.setPointSize(10);
+    const QRect rect(0, 0, 80, 24);
+    const QList<int> numbers {0, 7, 42, 1234, 98765, 1000000};
+
+    DigitGlyphAtlas atlas;
+    for (int number : numbers) {
+        QImage textImage(rect.size(), QImage::Format_ARGB32_Premultiplied);
+        textImage.fill(Qt::transparent);
+        QPainter textPainter(&textImage);
+        textPainter.setRenderHint(QPainter::TextAntialiasing, true);
+        textPainter.setFont(font);
+        textPainter.setPen(Qt::black);
+        textPainter.drawText(rect, Qt::AlignVCenter | Qt::AlignHCenter, QString::number(number));
+        textPainter.end();
+
+        QImage atlasImage(rect.size(), QImage::Format_ARGB32_Premultiplied);
+        atlasImage.fill(Qt::transparent);
+        QPainter atlasPainter(&atlasImage);
+        atlas.drawNumber(&atlasPainter, rect, number, font, Qt::black);
+        atlasPainter.end();
+
+        const QRect textRect = paintedRect(textImage);
+        const QRect atlasRect = paintedRect(atlasImage);
+        ASSERT_FALSE(textRect.isEmpty()) << number;
+        ASSERT_FALSE(atlasRect.isEmpty()) << number;
+        EXPECT_LE(qAbs(textRect.left() - atlasRect.left()), 1) << number;
+        EXPECT_LE(qAbs(textRect.right() - atlasRect.right()), 1) << number;
+        EXPECT_LE(qAbs(textRect.top() - atlasRect.top()), 1) << number;
+        EXPECT_LE(qAbs(textRect.bottom() - atlasRect.bottom()), 1) << number;
+    }
+    EXPECT_EQ(atlas.atlasCount(), 1);
+}
+
+// 比较逐行排版绘制和图集拷贝绘制行号的耗时，仅在设置 EDITOR_BENCHMARK_GUTTER 时执行
+TEST_F(UT_DigitGlyphAtlas, paintBenchmark)
+{
+    if (!gutterBenchmarkEnabled()) {
+        return;
+    }
+
+    static const int s_lineCount = 150;
+    static const int s_repeatCount = 20;
+    static const int s_lineHeight = 12;
+
+    QFont font;
+    font.setPointSize(8);
+    QImage image(60, s_lineCount * s_lineHeight, QImage::Format_ARGB32_Premultiplied);
+    DigitGlyphAtlas atlas;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int repeat = 0; repeat < s_repeatCount; repeat++) {
+        QPainter painter(&image);
+        painter.setFont(font);
+        for (int line = 0; line < s_lineCount; line++) {
+            painter.drawText(0, line * s_lineHeight, image.width(), s_lineHeight,
+                             Qt::AlignVCenter | Qt::AlignHCenter, QString::number(100000 + line));
+        }
+    }
+    const qint64 textElapsed = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int repeat = 0; repeat < s_repeatCount; repeat++) {
+        QPainter painter(&image);
+        for (int line = 0; line < s_lineCount; line++) {
+            atlas.drawNumber(&painter, QRect(0, line * s_lineHeight, image.width(), s_lineHeight), 100000 + line, font, Qt::black);
+        }
+    }
+    const qint64 atlasElapsed = timer.nsecsElapsed();
+
+    qInfo() << "[Benchmark] line numbers per paint:" << s_lineCount
+            << "drawText(us):" << textElapsed / 1000 / s_repeatCount
+            << "atlas(us):" << atlasElapsed / 1000 / s_repeatCount;
+    EXPECT_EQ(atlas.atlasCount(), 1);
+}
+
+// 行号区域整体绘制耗时，仅在设置 EDITOR_BENCHMARK_GUTTER 时执行
+TEST_F(UT_DigitGlyphAtlas, gutterPaintBenchmark)
+{
+    if (!gutterBenchmarkEnabled()) {
+        return;
+    }
+
+    static const int s_repeatCount = 20;
+
+    TextEdit *textEdit = new TextEdit;
+    QString text;
+    for (int i = 0; i < 5000; i++) {
+        text += QString("line %1\n").arg(i);
+    }
+    textEdit->setPlainText(text);
+    textEdit->resize(800, 2000);
+
+    LineNumberArea *lineNumberArea = textEdit->getLeftAreaWidget()->m_pLineNumberArea;
+    lineNumberArea->resize(60, 2000);
+    QPixmap pixmap(lineNumberArea->size());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int repeat = 0; repeat < s_repeatCount; repeat++) {
+        // 模拟光标移动后的重绘，每帧重新计算几何信息
+        textEdit->getLeftAreaWidget()->invalidateBlockGeometry();
+        lineNumberArea->render(&pixmap);
+    }
+
+    qInfo() << "[Benchmark] line number gutter paint(us):" << timer.nsecsElapsed() / 1000 / s_repeatCount;
+    EXPECT_FALSE(textEdit->m_pLineNumberAtlas.isNull());
+    textEdit->deleteLater();
+}
@@ -1341,6 +1341,23 @@ TEST(UT_Editwrapper_OnThemeChangeSlot, UT_Editwrapper_OnThemeChangeSlot)
     doc->deleteLater();
 }
 
+TEST(UT_Editwrapper_setPendingTheme, UT_Editwrapper_setPendingTheme)
+{
+    EditWrapper *wra = new EditWrapper;
+    // 未显示时延迟到显示时应用
+    wra->setPendingTheme(DEEPIN_DARK_THEME);
+    EXPECT_TRUE(wra->hasPendingTheme());
+
+    wra->show();
+    EXPECT_FALSE(wra->hasPendingTheme());
+
+    // 显示时立即应用
+    wra->setPendingTheme(DEEPIN_THEME);
+    EXPECT_FALSE(wra->hasPendingTheme());
+
+    wra->deleteLater();
+}
+
 TEST(UT_Editwrapper_clearDoubleCharaterEncode, UT_Editwrapper_clearDoubleCharaterEncode_001)
 {
     EditWrapper* wra = new EditWrapper;
@@ -1418,13 +1435,11 @@ TEST(UT_Editwrapper_reloadFileHighlight, reloadFileHighlight_ChangeDefinition_Su
                                    "int main(int argc, char *argv[]) { }");
     const QString definitionName("C++");
     wra->reloadFileHighlight(definitionName);
-    EXPECT_FALSE(wra->m_bHighlighterAll);
     EXPECT_TRUE(wra->m_Definition.isValid());
     EXPECT_EQ(wra->m_Definition.name(), definitionName);
     EXPECT_NE(wra->m_pSyntaxHighlighter, nullptr);
 
     wra->reloadFileHighlight(QString("None"));
-    EXPECT_FALSE(wra->m_bHighlighterAll);
     EXPECT_FALSE(wra->m_Definition.isValid());
     EXPECT_EQ(wra->m_pSyntaxHighlighter, nullptr);
 
@@ -1432,6 +1447,18 @@ TEST(UT_Editwrapper_reloadFileHighlight, reloadFileHighlight_ChangeDefinition_Su
     window->deleteLater();
 }
 
+TEST(UT_Editwrapper_highlighterAllFuture, highlighterAllFuture_NoHighlight_Finished)
+{
+    Window* window = new Window();
+    EditWrapper* wra = new EditWrapper(window);
+    wra->m_pTextEdit->setPlainText("plain text");
+    // 未启用高亮时无需等待
+    EXPECT_TRUE(wra->highlighterAllFuture().isFinished());
+
+    wra->deleteLater();
+    window->deleteLater();
+}
+
 TEST(UT_Editwrapper_reloadFileHighlight, reloadFileHighlight_SingleLineText_Success)
 {
     Window* window = new Window();
@@ -0,0 +1,228 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_foldregionindex.h"
+#include "../../src/editor/foldregionindex.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextBlock>
+
+UT_FoldRegionIndex::UT_FoldRegionIndex()
+{
+}
+
+// 从文档开始逐字符扫描，取得每行最后一个左括号匹配的右括号所在行，作为比较的基准。
+// 字符串状态在每行开始时重置
+static QVector<int> scanFoldEnds(QTextDocument *doc)
+{
+    const QString text = doc->toPlainText();
+    QVector<int> lastOpen(doc->blockCount(), -1);
+    bool inString = false;
+    int line = 0;
+    for (int i = 0; i < text.size(); i++) {
+        const QChar c = text.at(i);
+        if ('\n' == c) {
+            line++;
+            inString = false;
+        } else if (inString) {
+            if ('"' == c && !(i > 0 && '\\' == text.at(i - 1))) {
+                inString = false;
+            }
+        } else if ('{' == c) {
+            lastOpen[line] = i;
+        } else if ('"' == c) {
+            inString = true;
+        }
+    }
+
+    QVector<int> ends(doc->blockCount(), FoldRegionIndex::NoFoldRegion);
+    for (int begin = 0; begin < lastOpen.size(); begin++) {
+        if (-1 == lastOpen.at(begin)) {
+            continue;
+        }
+
+        ends[begin] = FoldRegionIndex::UnmatchedFoldRegion;
+        int depth = 0;
+        int curLine = begin;
+        inString = false;
+        for (int i = lastOpen.at(begin); i < text.size(); i++) {
+            const QChar c = text.at(i);
+            if ('\n' == c) {
+                curLine++;
+                inString = false;
+            } else if (inString) {
+                if ('"' == c && !(i > 0 && '\\' == text.at(i - 1))) {
+                    inString = false;
+                }
+            } else if ('{' == c) {
+                depth++;
+            } else if ('}' == c) {
+                if (0 == --depth) {
+                    ends[begin] = curLine;
+                    break;
+                }
+            } else if ('"' == c) {
+                inString = true;
+            }
+        }
+    }
+
+    return ends;
+}
+
+static void checkWithScan(QTextDocument *doc, FoldRegionIndex &index)
+{
+    const QVector<int> ends = scanFoldEnds(doc);
+    for (int line = 0; line < doc->blockCount(); line++) {
+        ASSERT_EQ(index.foldEndLine(line), ends.at(line)) << "line: " << line;
+    }
+}
+
+TEST_F(UT_FoldRegionIndex, foldEndLine)
+{
+    QTextDocument doc;
+    doc.setPlainText("int main()\n"
+                     "{\n"
+                     "    if (a) {\n"
+                     "        b(\"{\");\n"
+                     "    } else { c(); }\n"
+                     "    d = {1, 2};\n"
+                     "}\n"
+                     "{ \"escaped \\\" {\" }\n"
+                     "{\n"
+                     "  {");
+    FoldRegionIndex index(&doc);
+
+    EXPECT_EQ(index.foldEndLine(0), FoldRegionIndex::NoFoldRegion);
+    EXPECT_EQ(index.foldEndLine(1), 6);
+    EXPECT_EQ(index.foldEndLine(2), 4);
+    EXPECT_EQ(index.foldEndLine(3), FoldRegionIndex::NoFoldRegion);
+    EXPECT_EQ(index.foldEndLine(4), 4);
+    EXPECT_EQ(index.foldEndLine(7), 7);
+    EXPECT_EQ(index.foldEndLine(8), FoldRegionIndex::UnmatchedFoldRegion);
+    EXPECT_EQ(index.foldEndLine(9), FoldRegionIndex::UnmatchedFoldRegion);
+    EXPECT_EQ(index.foldEndLine(-1), FoldRegionIndex::NoFoldRegion);
+    EXPECT_EQ(index.foldEndLine(100), FoldRegionIndex::NoFoldRegion);
+    checkWithScan(&doc, index);
+}
+
+TEST_F(UT_FoldRegionIndex, lineFlags)
+{
+    EXPECT_TRUE(FoldRegionIndex::computeFlags("if (a) {", "//", "/*") & FoldRegionIndex::HasBraceFlag);
+    EXPECT_FALSE(FoldRegionIndex::computeFlags("a = \"{\" + \"}\";", "//", "/*") & FoldRegionIndex::HasBraceFlag);
+    EXPECT_TRUE(FoldRegionIndex::computeFlags("{ a = \"{\";", "//", "/*") & FoldRegionIndex::HasBraceFlag);
+    EXPECT_TRUE(FoldRegionIndex::computeFlags("  // {", "//", "/*") & FoldRegionIndex::CommentFlag);
+    EXPECT_TRUE(FoldRegionIndex::computeFlags("  // {", "", "") & FoldRegionIndex::SlashCommentFlag);
+    EXPECT_FALSE(FoldRegionIndex::computeFlags("  // {", "", "") & FoldRegionIndex::CommentFlag);
+    EXPECT_TRUE(FoldRegionIndex::computeFlags("# {", "#", "") & FoldRegionIndex::CommentFlag);
+
+    EXPECT_TRUE(FoldRegionIndex::needFoldIcon("{"));
+    EXPECT_FALSE(FoldRegionIndex::needFoldIcon("{Hello world}"));
+    EXPECT_FALSE(FoldRegionIndex::needFoldIcon("} else {}"));
+
+    QTextDocument doc;
+    doc.setPlainText("{\n// {\n{}\n}");
+    FoldRegionIndex index(&doc);
+    index.setCommentMarks("//", "/*");
+    EXPECT_TRUE(index.isFoldIconLine(0));
+    EXPECT_FALSE(index.isFoldIconLine(1));
+    EXPECT_FALSE(index.isFoldIconLine(2));
+    EXPECT_FALSE(index.isFoldIconLine(3));
+    EXPECT_EQ(index.lineFlags(10), 0);
+}
+
+TEST_F(UT_FoldRegionIndex, onContentsChange)
+{
+    QTextDocument doc;
+    doc.setPlainText("void f()\n{\n    if (a) {\n        b();\n    }\n}\n");
+    FoldRegionIndex index(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &index, &FoldRegionIndex::onContentsChange);
+    checkWithScan(&doc, index);
+
+    // 插入多行
+    QTextCursor cursor(doc.findBlockByNumber(3));
+    cursor.insertText("        while (b) {\n            c();\n        }\n");
+    checkWithScan(&doc, index);
+    EXPECT_EQ(index.foldEndLine(1), 8);
+    EXPECT_EQ(index.foldEndLine(3), 5);
+
+    // 删除右括号，折叠区域延伸
+    cursor = QTextCursor(doc.findBlockByNumber(5));
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    checkWithScan(&doc, index);
+
+    // 插入引号，同一行之后的括号处于字符串内
+    cursor = QTextCursor(doc.findBlockByNumber(2));
+    cursor.insertText("\"");
+    checkWithScan(&doc, index);
+
+    // 删除多行
+    cursor = QTextCursor(doc.findBlockByNumber(1));
+    cursor.setPosition(doc.findBlockByNumber(4).position(), QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    checkWithScan(&doc, index);
+
+    cursor.select(QTextCursor::Document);
+    cursor.insertText("{\n}");
+    checkWithScan(&doc, index);
+    EXPECT_EQ(index.foldEndLine(0), 1);
+}
+
+TEST_F(UT_FoldRegionIndex, strayQuote)
+{
+    QTextDocument doc;
+    doc.setPlainText("char q = '\"';\n"
+                     "// say \"hi\n"
+                     "void f()\n"
+                     "{\n"
+                     "    if (a) {\n"
+                     "        b(\"{\");\n"
+                     "    }\n"
+                     "}\n");
+    FoldRegionIndex index(&doc);
+
+    // 未配对的引号仅影响所在行，之后的折叠区域不受影响
+    EXPECT_EQ(index.foldEndLine(0), FoldRegionIndex::NoFoldRegion);
+    EXPECT_EQ(index.foldEndLine(3), 7);
+    EXPECT_EQ(index.foldEndLine(4), 6);
+    EXPECT_EQ(index.foldEndLine(5), FoldRegionIndex::NoFoldRegion);
+    checkWithScan(&doc, index);
+}
+
+TEST_F(UT_FoldRegionIndex, rebuild)
+{
+    QTextDocument doc;
+    QString text;
+    for (int i = 0; i < 200; i++) {
+        text += QString("func%1() {\n    \"}\";\n    if (x) { y(); }\n}\n").arg(i);
+    }
+    doc.setPlainText(text);
+    FoldRegionIndex index(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &index, &FoldRegionIndex::onContentsChange);
+
+    // 后台构建完成前不等待结果，仅计算查询的折叠区域
+    index.rebuild();
+    EXPECT_TRUE(index.isBuilding());
+    EXPECT_EQ(index.foldEndLine(0), 3);
+    EXPECT_EQ(index.foldEndLine(2), 2);
+    EXPECT_EQ(index.foldEndLine(1), FoldRegionIndex::NoFoldRegion);
+    checkWithScan(&doc, index);
+    EXPECT_TRUE(index.isBuilding());
+    index.waitForFinished();
+    EXPECT_FALSE(index.isBuilding());
+    EXPECT_TRUE(index.isReady());
+    checkWithScan(&doc, index);
+
+    // 构建期间文档变更时丢弃结果，查询结果仍和文本一致
+    index.rebuild();
+    QTextCursor cursor(&doc);
+    cursor.insertText("{\n");
+    EXPECT_EQ(index.foldEndLine(0), FoldRegionIndex::UnmatchedFoldRegion);
+    checkWithScan(&doc, index);
+    index.waitForFinished();
+    checkWithScan(&doc, index);
+    EXPECT_EQ(index.foldEndLine(0), FoldRegionIndex::UnmatchedFoldRegion);
+}
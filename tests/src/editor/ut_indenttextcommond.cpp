@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_indenttextcommond.h"
+#include "../../src/editor/indenttextcommond.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QUndoStack>
+#include <QElapsedTimer>
+#include <QDebug>
+
+UT_IndentTextCommand::UT_IndentTextCommand()
+{
+}
+
+TEST_F(UT_IndentTextCommand, indent)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText("a\nb\nc\nd");
+    QTextCursor cursor = edit.textCursor();
+    cursor.setPosition(2);
+    cursor.setPosition(5, QTextCursor::KeepAnchor);
+    edit.setTextCursor(cursor);
+
+    int changes = 0;
+    QObject::connect(edit.document(), &QTextDocument::contentsChange, [&changes]() {
+        changes++;
+    });
+
+    QUndoStack stack;
+    stack.push(new IndentTextCommand(&edit, 1, 2));
+    ASSERT_EQ(edit.toPlainText(), QString("a\n\tb\n\tc\nd"));
+    ASSERT_EQ(changes, 1);
+    // 选区随文本移动
+    ASSERT_EQ(edit.textCursor().selectionStart(), 3);
+    ASSERT_EQ(edit.textCursor().selectionEnd(), 7);
+
+    stack.undo();
+    ASSERT_EQ(edit.toPlainText(), QString("a\nb\nc\nd"));
+    ASSERT_EQ(changes, 2);
+    ASSERT_EQ(edit.textCursor().selectionStart(), 2);
+    ASSERT_EQ(edit.textCursor().selectionEnd(), 5);
+
+    stack.redo();
+    ASSERT_EQ(edit.toPlainText(), QString("a\n\tb\n\tc\nd"));
+    ASSERT_EQ(edit.textCursor().selectionStart(), 3);
+    ASSERT_EQ(edit.textCursor().selectionEnd(), 7);
+}
+
+TEST_F(UT_IndentTextCommand, unindent)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText("\t\ta\n      b\n  c\nd\n\n");
+
+    int changes = 0;
+    QObject::connect(edit.document(), &QTextDocument::contentsChange, [&changes]() {
+        changes++;
+    });
+
+    QUndoStack stack;
+    auto command = new IndentTextCommand(&edit, 0, 5, true, 4);
+    ASSERT_TRUE(command->hasChange());
+    // 每行删除一个制表符或最多 4 个空格
+    stack.push(command);
+    ASSERT_EQ(edit.toPlainText(), QString("\ta\n  b\nc\nd\n\n"));
+    ASSERT_EQ(changes, 1);
+
+    stack.undo();
+    ASSERT_EQ(edit.toPlainText(), QString("\t\ta\n      b\n  c\nd\n\n"));
+    stack.redo();
+    ASSERT_EQ(edit.toPlainText(), QString("\ta\n  b\nc\nd\n\n"));
+
+    // 无缩进的行
+    IndentTextCommand empty(&edit, 2, 5, true, 4);
+    ASSERT_FALSE(empty.hasChange());
+}
+
+/**
+ * @brief 10 万行选区的缩进及取消缩进耗时，可通过 EDITOR_BENCHMARK_INDENT_LINES 调整行数
+ */
+TEST_F(UT_IndentTextCommand, indentBenchmark)
+{
+    const int lineCount = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_INDENT_LINES")
+                          ? qMax(1000, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_INDENT_LINES")) : 100000;
+    QStringList lines;
+    lines.reserve(lineCount);
+    for (int i = 0; i < lineCount; i++) {
+        lines.append(QString("    int value%1 = call(%1);").arg(i));
+    }
+    const QString text = lines.join('\n');
+
+    QPlainTextEdit edit;
+    edit.setPlainText(text);
+    QUndoStack stack;
+    int changes = 0;
+    QObject::connect(edit.document(), &QTextDocument::contentsChange, [&changes]() {
+        changes++;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    stack.push(new IndentTextCommand(&edit, 0, lineCount - 1));
+    const qint64 indentTime = timer.elapsed();
+
+    timer.start();
+    stack.push(new IndentTextCommand(&edit, 0, lineCount - 1, true, 4));
+    stack.push(new IndentTextCommand(&edit, 0, lineCount - 1, true, 4));
+    const qint64 unindentTime = timer.elapsed();
+    ASSERT_EQ(edit.document()->firstBlock().text(), QString("int value0 = call(0);"));
+
+    timer.start();
+    stack.undo();
+    stack.undo();
+    stack.undo();
+    const qint64 undoTime = timer.elapsed();
+
+    // 每次操作仅发送一次文档变更通知
+    ASSERT_EQ(changes, 6);
+    ASSERT_EQ(edit.toPlainText(), text);
+
+    qInfo() << "[Benchmark] indent lines:" << lineCount << "indent:" << indentTime << "ms"
+            << "unindent x2:" << unindentTime << "ms" << "undo x3:" << undoTime << "ms";
+}
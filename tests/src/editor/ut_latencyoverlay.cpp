@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_latencyoverlay.h"
+#include "../../src/editor/latencyoverlay.h"
+#include "../../src/common/performancemonitor.h"
+
+#include <QWidget>
+
+UT_LatencyOverlay::UT_LatencyOverlay()
+{
+}
+
+TEST_F(UT_LatencyOverlay, refresh)
+{
+    PerformanceMonitor::resetLatencyStatistics();
+    QWidget parent;
+    parent.resize(400, 300);
+    LatencyOverlay overlay(&parent);
+    ASSERT_TRUE(LatencyOverlay::statisticsLines().isEmpty());
+    overlay.refresh();
+    ASSERT_TRUE(overlay.geometry().isEmpty());
+
+    PerformanceMonitor::recordLatency(PerformanceMonitor::KeyToPaint, 2000000);
+    PerformanceMonitor::recordLatency(PerformanceMonitor::EditorPaint, 1000000);
+    const QStringList lines = LatencyOverlay::statisticsLines();
+    ASSERT_EQ(lines.size(), 2);
+    ASSERT_TRUE(lines.at(0).startsWith(PerformanceMonitor::latencyName(PerformanceMonitor::KeyToPaint)));
+
+    // 浮层按内容调整大小并放置在父控件右上角
+    overlay.refresh();
+    ASSERT_EQ(overlay.m_lines, lines);
+    ASSERT_FALSE(overlay.geometry().isEmpty());
+    ASSERT_EQ(overlay.geometry().right(), parent.width() - 1 - 6);
+    ASSERT_EQ(overlay.geometry().top(), 6);
+
+    parent.resize(600, 300);
+    overlay.refresh();
+    ASSERT_EQ(overlay.geometry().right(), 600 - 1 - 6);
+
+    PerformanceMonitor::resetLatencyStatistics();
+}
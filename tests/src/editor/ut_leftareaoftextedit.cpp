@@ -78,3 +78,31 @@ TEST_F(test_leftareaoftextedit, codeFlodAreaPaintEvent)
     leftArea->deleteLater();
     textEdit->deleteLater();
 }
+
+//const QVector<VisibleBlockGeometry> &visibleBlockGeometry();
+TEST_F(test_leftareaoftextedit, visibleBlockGeometry)
+{
+    TextEdit *textEdit = new TextEdit;
+    textEdit->setPlainText("a\nb\nc");
+    LeftAreaTextEdit *leftArea = textEdit->getLeftAreaWidget();
+
+    QVector<VisibleBlockGeometry> geometry = leftArea->visibleBlockGeometry();
+    ASSERT_FALSE(geometry.isEmpty());
+    EXPECT_EQ(geometry.first().blockNumber, 0);
+    EXPECT_TRUE(leftArea->m_geometryValid);
+    EXPECT_EQ(leftArea->blockGeometry(-1), nullptr);
+    EXPECT_EQ(leftArea->blockGeometry(100), nullptr);
+
+    // 同一帧内再次读取时使用缓存
+    leftArea->m_blockGeometry.first().y = -100;
+    EXPECT_EQ(leftArea->visibleBlockGeometry().first().y, -100);
+
+    // 文档变更后重新计算
+    QTextCursor cursor(textEdit->document());
+    cursor.insertText("d\n");
+    EXPECT_NE(leftArea->visibleBlockGeometry().first().y, -100);
+
+    leftArea->invalidateBlockGeometry();
+    EXPECT_FALSE(leftArea->m_geometryValid);
+    textEdit->deleteLater();
+}
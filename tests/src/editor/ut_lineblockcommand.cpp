@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_lineblockcommand.h"
+#include "../../src/editor/lineblockcommand.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QUndoStack>
+#include <QElapsedTimer>
+#include <QDebug>
+
+UT_LineBlockCommand::UT_LineBlockCommand()
+{
+}
+
+// 选中文本块 [first, last]，光标位于最后一个文本块中间
+static void selectBlocks(QPlainTextEdit &edit, int first, int last)
+{
+    QTextCursor cursor = edit.textCursor();
+    cursor.setPosition(edit.document()->findBlockByNumber(first).position());
+    const QTextBlock lastBlock = edit.document()->findBlockByNumber(last);
+    cursor.setPosition(lastBlock.position() + lastBlock.length() / 2, QTextCursor::KeepAnchor);
+    edit.setTextCursor(cursor);
+}
+
+TEST_F(UT_LineBlockCommand, moveLines)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText("a\nb\nc\nd\ne");
+    QUndoStack stack;
+
+    selectBlocks(edit, 3, 3);
+    stack.push(LineBlockCommand::moveLines(&edit, true));
+    // 长按快捷键时的连续移动合并为一个撤销项
+    stack.push(LineBlockCommand::moveLines(&edit, true, true));
+    stack.push(LineBlockCommand::moveLines(&edit, true, true));
+    ASSERT_EQ(edit.toPlainText(), QString("d\na\nb\nc\ne"));
+    ASSERT_EQ(stack.count(), 1);
+    ASSERT_EQ(edit.textCursor().blockNumber(), 0);
+    ASSERT_EQ(LineBlockCommand::moveLines(&edit, true), nullptr);
+
+    stack.undo();
+    ASSERT_EQ(edit.toPlainText(), QString("a\nb\nc\nd\ne"));
+    ASSERT_EQ(edit.textCursor().blockNumber(), 3);
+    stack.redo();
+    ASSERT_EQ(edit.toPlainText(), QString("d\na\nb\nc\ne"));
+
+    // 多行整体下移，未长按时不合并
+    selectBlocks(edit, 1, 2);
+    stack.push(LineBlockCommand::moveLines(&edit, false));
+    ASSERT_EQ(edit.toPlainText(), QString("d\nc\na\nb\ne"));
+    ASSERT_EQ(edit.textCursor().selectedText(), QString("a") + QChar::ParagraphSeparator + "b");
+    stack.push(LineBlockCommand::moveLines(&edit, false));
+    ASSERT_EQ(edit.toPlainText(), QString("d\nc\ne\na\nb"));
+    ASSERT_EQ(stack.count(), 3);
+    ASSERT_EQ(LineBlockCommand::moveLines(&edit, false), nullptr);
+
+    stack.undo();
+    stack.undo();
+    ASSERT_EQ(edit.toPlainText(), QString("d\na\nb\nc\ne"));
+}
+
+TEST_F(UT_LineBlockCommand, duplicateLines)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText("a\nb\nc\nd\ne");
+    QUndoStack stack;
+
+    // 选区结束于文本块开头时不包含该文本块
+    QTextCursor cursor = edit.textCursor();
+    cursor.setPosition(2);
+    cursor.setPosition(6, QTextCursor::KeepAnchor);
+    edit.setTextCursor(cursor);
+    stack.push(LineBlockCommand::duplicateLines(&edit));
+    ASSERT_EQ(edit.toPlainText(), QString("a\nb\nc\nb\nc\nd\ne"));
+    ASSERT_EQ(edit.textCursor().selectionStart(), 6);
+    ASSERT_EQ(edit.textCursor().selectionEnd(), 10);
+
+    stack.push(LineBlockCommand::duplicateLines(&edit, true));
+    ASSERT_EQ(edit.toPlainText(), QString("a\nb\nc\nb\nc\nb\nc\nd\ne"));
+    ASSERT_EQ(stack.count(), 1);
+
+    stack.undo();
+    ASSERT_EQ(edit.toPlainText(), QString("a\nb\nc\nd\ne"));
+    ASSERT_EQ(edit.textCursor().selectionStart(), 2);
+    ASSERT_EQ(edit.textCursor().selectionEnd(), 6);
+}
+
+TEST_F(UT_LineBlockCommand, joinLines)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText("a\nbb\nc\nd\ne");
+    QUndoStack stack;
+
+    selectBlocks(edit, 1, 3);
+    stack.push(LineBlockCommand::joinLines(&edit));
+    ASSERT_EQ(edit.toPlainText(), QString("a\nbbcd\ne"));
+    ASSERT_EQ(edit.textCursor().position(), 4);
+
+    // 未选中多行时和下一行合并
+    stack.push(LineBlockCommand::joinLines(&edit, true));
+    ASSERT_EQ(edit.toPlainText(), QString("a\nbbcde"));
+    ASSERT_EQ(stack.count(), 1);
+    ASSERT_EQ(LineBlockCommand::joinLines(&edit), nullptr);
+
+    stack.undo();
+    ASSERT_EQ(edit.toPlainText(), QString("a\nbb\nc\nd\ne"));
+}
+
+/**
+ * @brief 长按快捷键移动 5000 行选区的耗时，可通过 EDITOR_BENCHMARK_LINEBLOCK_LINES 调整文档行数
+ */
+TEST_F(UT_LineBlockCommand, moveBenchmark)
+{
+    const int lineCount = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_LINEBLOCK_LINES")
+                          ? qMax(20000, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_LINEBLOCK_LINES")) : 200000;
+    QStringList lines;
+    lines.reserve(lineCount);
+    for (int i = 0; i < lineCount; i++) {
+        lines.append(QString("    int value%1 = call(%1);").arg(i));
+    }
+    const QString text = lines.join('\n');
+
+    QPlainTextEdit edit;
+    edit.setPlainText(text);
+    QUndoStack stack;
+    const int first = lineCount / 2;
+    selectBlocks(edit, first, first + 4999);
+
+    const int steps = 100;
+    int changes = 0;
+    QObject::connect(edit.document(), &QTextDocument::contentsChange, [&changes]() {
+        changes++;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int step = 0; step < steps; step++) {
+        stack.push(LineBlockCommand::moveLines(&edit, true, step > 0));
+    }
+    const qint64 moveTime = timer.elapsed();
+
+    // 每次移动仅发送一次文档变更通知，连续移动合并为一个撤销项
+    ASSERT_EQ(changes, steps);
+    ASSERT_EQ(stack.count(), 1);
+    ASSERT_EQ(edit.document()->findBlockByNumber(first - steps).text(), lines.at(first));
+
+    timer.start();
+    stack.undo();
+    const qint64 undoTime = timer.elapsed();
+    ASSERT_EQ(edit.toPlainText(), text);
+
+    qInfo() << "[Benchmark] line block move lines:" << lineCount << "selected: 5000 steps:" << steps
+            << "move:" << moveTime << "ms" << "undo:" << undoTime << "ms";
+}
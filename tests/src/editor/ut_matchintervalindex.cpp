@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_matchintervalindex.h"
+#include "../../src/editor/matchintervalindex.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+
+UT_MatchIntervalIndex::UT_MatchIntervalIndex()
+{
+}
+
+// 和重新全文查找的结果比较，校验增量修正的正确性
+static bool checkWithFullScan(QTextDocument &doc, MatchIntervalIndex &index, const QString &keyword)
+{
+    QVector<int> expect = MatchIntervalIndex::findAll(doc.toPlainText(), keyword, Qt::CaseInsensitive);
+    QVector<int> actual = index.matchesInRange(keyword, 0, doc.characterCount());
+    return expect == actual;
+}
+
+TEST_F(UT_MatchIntervalIndex, findAll)
+{
+    QVector<int> result = MatchIntervalIndex::findAll("abcABCabc", "abc", Qt::CaseInsensitive);
+    ASSERT_EQ(result, QVector<int>({0, 3, 6}));
+
+    result = MatchIntervalIndex::findAll("abcABCabc", "abc", Qt::CaseSensitive, 10);
+    ASSERT_EQ(result, QVector<int>({10, 16}));
+
+    // 匹配项互不重叠，和逐个查找的结果一致
+    result = MatchIntervalIndex::findAll("aaaa", "aa", Qt::CaseSensitive);
+    ASSERT_EQ(result, QVector<int>({0, 2}));
+    result = MatchIntervalIndex::findAll("aaaaa", "aa", Qt::CaseSensitive);
+    ASSERT_EQ(result, QVector<int>({0, 2}));
+}
+
+TEST_F(UT_MatchIntervalIndex, normalizeText)
+{
+    QString text = QString("a") + QChar(QChar::ParagraphSeparator) + QString("b") + QChar(QChar::Nbsp);
+    ASSERT_EQ(MatchIntervalIndex::normalizeText(text), QString("a\nb "));
+}
+
+TEST_F(UT_MatchIntervalIndex, addKeyword)
+{
+    QTextDocument doc;
+    doc.setPlainText("int a;\nint b;\nfloat c;\nint d;");
+    MatchIntervalIndex index(&doc);
+
+    index.addKeyword("int");
+    ASSERT_TRUE(index.contains("int"));
+    ASSERT_TRUE(index.contains("INT"));
+    ASSERT_FALSE(index.contains("int", Qt::CaseSensitive));
+
+    index.waitForFinished();
+    ASSERT_TRUE(index.isReady("int"));
+    ASSERT_EQ(index.matchCount("int"), 3);
+    ASSERT_EQ(index.keys().size(), 1);
+    // 仅判断起始位置是否位于区间内
+    ASSERT_FALSE(index.hasMatchInRange("int", 1, 7));
+    ASSERT_TRUE(index.hasMatchInRange("int", 1, 8));
+
+    index.removeKeyword("int");
+    ASSERT_FALSE(index.contains("int"));
+    ASSERT_EQ(index.revision("int"), -1);
+}
+
+TEST_F(UT_MatchIntervalIndex, matchesInRange)
+{
+    QTextDocument doc;
+    doc.setPlainText("int a;\nint b;\nfloat c;\nint d;");
+    MatchIntervalIndex index(&doc);
+    index.addKeyword("int");
+    index.waitForFinished();
+
+    // 第二行 [7, 14)
+    ASSERT_EQ(index.matchesInRange("int", 7, 14), QVector<int>({7}));
+    // 和区间部分相交的匹配项同样返回
+    ASSERT_EQ(index.matchesInRange("int", 8, 9), QVector<int>({7}));
+    ASSERT_TRUE(index.matchesInRange("int", 14, 22).isEmpty());
+}
+
+TEST_F(UT_MatchIntervalIndex, onContentsChange)
+{
+    QTextDocument doc;
+    doc.setPlainText("int a;\nint b;\nfloat c;\nint d;");
+    MatchIntervalIndex index(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &index, &MatchIntervalIndex::onContentsChange);
+    index.addKeyword("int");
+    index.waitForFinished();
+    int revision = index.revision("int");
+
+    QTextCursor cursor(&doc);
+    // 插入新的匹配
+    cursor.setPosition(0);
+    cursor.insertText("print(1);\n");
+    ASSERT_TRUE(checkWithFullScan(doc, index, "int"));
+    ASSERT_GT(index.revision("int"), revision);
+
+    // 删除匹配内部的字符
+    cursor.setPosition(11);
+    cursor.deleteChar();
+    ASSERT_TRUE(checkWithFullScan(doc, index, "int"));
+
+    // 删除字符后拼接形成新的匹配
+    cursor.setPosition(0);
+    cursor.insertText("iXnt ");
+    cursor.setPosition(1);
+    cursor.deleteChar();
+    ASSERT_TRUE(checkWithFullScan(doc, index, "int"));
+
+    // 替换选中文本
+    cursor.setPosition(0);
+    cursor.setPosition(doc.characterCount() - 1, QTextCursor::KeepAnchor);
+    cursor.insertText("int int int");
+    ASSERT_TRUE(checkWithFullScan(doc, index, "int"));
+}
+
+TEST_F(UT_MatchIntervalIndex, overlappingKeyword)
+{
+    QTextDocument doc;
+    doc.setPlainText("aaaaaaaa b aaaaaaa");
+    MatchIntervalIndex index(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &index, &MatchIntervalIndex::onContentsChange);
+    index.addKeyword("aa");
+    index.waitForFinished();
+    ASSERT_TRUE(checkWithFullScan(doc, index, "aa"));
+
+    // 变更位置之后的匹配项随之错位，需继续向后修正
+    QTextCursor cursor(&doc);
+    cursor.setPosition(0);
+    cursor.insertText("a");
+    ASSERT_TRUE(checkWithFullScan(doc, index, "aa"));
+    cursor.setPosition(3);
+    cursor.deleteChar();
+    ASSERT_TRUE(checkWithFullScan(doc, index, "aa"));
+    cursor.setPosition(9);
+    cursor.insertText("a");
+    ASSERT_TRUE(checkWithFullScan(doc, index, "aa"));
+    cursor.setPosition(9);
+    cursor.deleteChar();
+    cursor.deleteChar();
+    ASSERT_TRUE(checkWithFullScan(doc, index, "aa"));
+}
+
+TEST_F(UT_MatchIntervalIndex, pendingDeltas)
+{
+    QTextDocument doc;
+    doc.setPlainText(QString("int a;\n").repeated(1000));
+    MatchIntervalIndex index(&doc);
+    QObject::connect(&doc, &QTextDocument::contentsChange, &index, &MatchIntervalIndex::onContentsChange);
+    index.addKeyword("int");
+
+    // 后台构建完成前的变更在构建完成后补充修正
+    QTextCursor cursor(&doc);
+    cursor.setPosition(0);
+    cursor.insertText("int ");
+    cursor.setPosition(100);
+    cursor.deleteChar();
+    index.waitForFinished();
+
+    ASSERT_TRUE(index.isReady("int"));
+    ASSERT_TRUE(checkWithFullScan(doc, index, "int"));
+}
+
+TEST_F(UT_MatchIntervalIndex, multiLineKeyword)
+{
+    QTextDocument doc;
+    doc.setPlainText("a;\nb;\na;\nb;");
+    MatchIntervalIndex index(&doc);
+    // 选中文本中的换行为段落分隔符
+    QString keyword = QString(";") + QChar(QChar::ParagraphSeparator) + QString("b");
+    index.addKeyword(keyword);
+    index.waitForFinished();
+
+    ASSERT_TRUE(index.contains(";\nb"));
+    ASSERT_EQ(index.matchCount(keyword), 2);
+}
@@ -0,0 +1,199 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_minimap.h"
+#include "../../src/editor/minimap.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextLayout>
+#include <QScrollBar>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+
+UT_Minimap::UT_Minimap()
+{
+}
+
+static QString numberedLines(int count)
+{
+    QStringList lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; i++) {
+        lines.append(QString("    int value%1 = call(%1); // line %1").arg(i));
+    }
+    return lines.join('\n');
+}
+
+// 等待已请求的图块全部绘制完成
+static bool waitForRendered(Minimap &minimap, int timeout = 10000)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while ((minimap.isRendering() || !minimap.m_pendingTiles.isEmpty()) && timer.elapsed() < timeout) {
+        QCoreApplication::processEvents();
+    }
+
+    return !minimap.isRendering() && minimap.m_pendingTiles.isEmpty();
+}
+
+TEST_F(UT_Minimap, invalidate)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText(numberedLines(2000));
+    Minimap minimap(&edit);
+
+    const int lastTile = Minimap::tileForBlock(edit.document()->blockCount() - 1);
+    minimap.requestTiles(0, lastTile);
+    ASSERT_TRUE(waitForRendered(minimap));
+    ASSERT_EQ(minimap.count(), lastTile + 1);
+
+    // 文本块数量不变时仅失效变更的文本块所在的图块
+    QTextCursor cursor(edit.document()->findBlockByNumber(300));
+    cursor.insertText("edited ");
+    ASSERT_FALSE(minimap.contains(Minimap::tileForBlock(300)));
+    for (int tile = 0; tile <= lastTile; tile++) {
+        if (tile != Minimap::tileForBlock(300)) {
+            ASSERT_TRUE(minimap.contains(tile)) << "tile: " << tile;
+        }
+    }
+
+    // 插入换行后失效之后的全部图块
+    minimap.requestTiles(0, lastTile);
+    ASSERT_TRUE(waitForRendered(minimap));
+    cursor = QTextCursor(edit.document()->findBlockByNumber(1000));
+    cursor.insertText("\n");
+    for (int tile = 0; tile <= lastTile; tile++) {
+        ASSERT_EQ(minimap.contains(tile), tile < Minimap::tileForBlock(1000)) << "tile: " << tile;
+    }
+
+    // 高亮格式变更时失效对应的图块
+    minimap.requestTiles(0, lastTile);
+    ASSERT_TRUE(waitForRendered(minimap));
+    minimap.invalidateBlocks(10, 20);
+    ASSERT_FALSE(minimap.contains(0));
+    ASSERT_TRUE(minimap.contains(1));
+
+    // 颜色变更时清空全部图块
+    minimap.setColors(Qt::black, Qt::white);
+    ASSERT_EQ(minimap.count(), 0);
+}
+
+TEST_F(UT_Minimap, renderTile)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText("keyword\n\tvalue");
+    Minimap minimap(&edit);
+    minimap.setColors(Qt::white, Qt::black);
+
+    QTextCharFormat format;
+    format.setForeground(Qt::red);
+    QTextLayout::FormatRange range;
+    range.start = 0;
+    range.length = 7;
+    range.format = format;
+    edit.document()->firstBlock().layout()->setFormats({range});
+
+    minimap.requestTiles(0, 0);
+    ASSERT_TRUE(waitForRendered(minimap));
+    const QImage *image = minimap.m_cache.object(0);
+    ASSERT_NE(image, nullptr);
+
+    // 使用已有的高亮颜色，空白及制表符不绘制
+    const QColor highlighted = image->pixelColor(Minimap::s_margin, 0);
+    ASSERT_GT(highlighted.red(), highlighted.blue());
+    const QColor tab = image->pixelColor(Minimap::s_margin, Minimap::s_lineHeight);
+    ASSERT_EQ(tab.rgb(), QColor(Qt::white).rgb());
+    const int tabSize = minimap.snapshotTile(0).tabSize;
+    const QColor text = image->pixelColor(Minimap::s_margin + tabSize, Minimap::s_lineHeight);
+    ASSERT_LT(text.red(), 255);
+}
+
+TEST_F(UT_Minimap, budget)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText(numberedLines(20000));
+    Minimap minimap(&edit);
+    minimap.setBudget(1024 * 1024);
+
+    const int lastTile = Minimap::tileForBlock(edit.document()->blockCount() - 1);
+    minimap.requestTiles(0, lastTile);
+    ASSERT_TRUE(waitForRendered(minimap, 30000));
+
+    // 超出上限时淘汰最久未使用的图块
+    ASSERT_LE(minimap.cost(), minimap.budget());
+    ASSERT_LT(minimap.count(), lastTile + 1);
+    ASSERT_TRUE(minimap.contains(lastTile));
+    ASSERT_FALSE(minimap.contains(0));
+}
+
+// 自动换行使文档前部占用大量可视行时，可视区域指示框仍和图块内容对齐
+TEST_F(UT_Minimap, indicatorWithWrap)
+{
+    QPlainTextEdit edit;
+    edit.setLineWrapMode(QPlainTextEdit::WidgetWidth);
+    edit.resize(400, 300);
+    QString text;
+    for (int i = 0; i < 200; i++) {
+        text += QString(2000, 'w') + "\n";
+    }
+    edit.setPlainText(text + numberedLines(2000));
+    Minimap minimap(&edit);
+    minimap.resize(minimap.width(), 300);
+    edit.show();
+    minimap.show();
+    QCoreApplication::processEvents();
+
+    QScrollBar *bar = edit.verticalScrollBar();
+    for (int value : {bar->maximum() / 4, bar->maximum() / 2, bar->maximum()}) {
+        bar->setValue(value);
+        int firstVisible = 0;
+        int lastVisible = 0;
+        minimap.visibleBlocks(firstVisible, lastVisible);
+        const int offset = minimap.scrollOffset();
+        EXPECT_GE(firstVisible * Minimap::s_lineHeight - offset, 0) << "value: " << value;
+        EXPECT_LE((lastVisible + 1) * Minimap::s_lineHeight - offset, minimap.height()) << "value: " << value;
+    }
+    EXPECT_EQ(minimap.scrollOffset(), edit.document()->blockCount() * Minimap::s_lineHeight - minimap.height());
+}
+
+/**
+ * @brief 100 万行文档滚动时的缩略图绘制耗时及缓存占用，可通过 EDITOR_BENCHMARK_MINIMAP_LINES 调整行数
+ */
+TEST_F(UT_Minimap, scrollBenchmark)
+{
+    const int lineCount = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_MINIMAP_LINES")
+                          ? qMax(1000, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_MINIMAP_LINES")) : 1000000;
+    QPlainTextEdit edit;
+    edit.resize(800, 600);
+    edit.setPlainText(numberedLines(lineCount));
+    Minimap minimap(&edit);
+    minimap.resize(minimap.width(), 600);
+
+    QScrollBar *bar = edit.verticalScrollBar();
+    qint64 paintTime = 0;
+    qint64 renderTime = 0;
+    const int steps = 20;
+    QElapsedTimer timer;
+    for (int step = 0; step <= steps; step++) {
+        bar->setValue(static_cast<int>(static_cast<qint64>(bar->maximum()) * step / steps));
+
+        // 绘制仅拼接已缓存的图块，未缓存的图块在工作线程绘制
+        timer.start();
+        minimap.grab();
+        paintTime += timer.elapsed();
+
+        timer.start();
+        ASSERT_TRUE(waitForRendered(minimap));
+        renderTime += timer.elapsed();
+        ASSERT_LE(minimap.cost(), minimap.budget());
+    }
+
+    qInfo() << "[Benchmark] minimap lines:" << edit.document()->blockCount()
+            << "paint:" << paintTime << "ms" << "render:" << renderTime << "ms"
+            << "tiles:" << minimap.count() << "cost:" << minimap.cost() / 1024 << "KB";
+}
@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_MINIMAP_H
+#define UT_MINIMAP_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class UT_Minimap : public QObject, public ::testing::Test
+{
+public:
+    UT_Minimap();
+};
+
+#endif  // UT_MINIMAP_H
@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_scrollbarannotation.h"
+#include "../../src/editor/scrollbarannotation.h"
+#include "../../src/editor/matchintervalindex.h"
+
+#include <QPlainTextEdit>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QElapsedTimer>
+#include <QDebug>
+
+UT_ScrollBarAnnotation::UT_ScrollBarAnnotation()
+{
+}
+
+using RangeList = QVector<QPair<int, int>>;
+
+static QString repeatedLines(int count, const QString &line)
+{
+    QStringList lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; i++) {
+        lines.append(line);
+    }
+    return lines.join('\n');
+}
+
+TEST_F(UT_ScrollBarAnnotation, updateModifiedRanges)
+{
+    RangeList ranges;
+    ScrollBarAnnotation::updateModifiedRanges(ranges, 5, 5, 5);
+    ASSERT_EQ(ranges, RangeList({{5, 5}}));
+
+    // 插入两行
+    ScrollBarAnnotation::updateModifiedRanges(ranges, 10, 10, 12);
+    ASSERT_EQ(ranges, RangeList({{5, 5}, {10, 12}}));
+
+    ScrollBarAnnotation::updateModifiedRanges(ranges, 3, 3, 3);
+    ASSERT_EQ(ranges, RangeList({{3, 3}, {5, 5}, {10, 12}}));
+
+    // 插入一行后之后的区间平移，相邻的区间合并
+    ScrollBarAnnotation::updateModifiedRanges(ranges, 4, 4, 5);
+    ASSERT_EQ(ranges, RangeList({{3, 6}, {11, 13}}));
+
+    // 删除两行
+    ScrollBarAnnotation::updateModifiedRanges(ranges, 11, 13, 11);
+    ASSERT_EQ(ranges, RangeList({{3, 6}, {11, 11}}));
+}
+
+TEST_F(UT_ScrollBarAnnotation, buckets)
+{
+    QPlainTextEdit edit;
+    edit.setPlainText(repeatedLines(10000, "int value = 0;"));
+    MatchIntervalIndex index(edit.document());
+    QObject::connect(edit.document(), &QTextDocument::contentsChange, &index, &MatchIntervalIndex::onContentsChange);
+
+    QTextCursor cursor(edit.document()->findBlockByNumber(7000));
+    cursor.insertText("needle ");
+    index.addKeyword("needle");
+    index.waitForFinished();
+
+    ScrollBarAnnotation annotation(&edit, [&index]() {
+        ScrollBarAnnotation::Sources sources;
+        sources.matchIndex = &index;
+        ScrollBarAnnotation::KeywordSource keyword;
+        keyword.keyword = "needle";
+        sources.keywords.append(keyword);
+        ScrollBarAnnotation::RangeSource range;
+        range.start = 0;
+        range.end = 5;
+        range.color = Qt::red;
+        sources.ranges.append(range);
+        sources.bookmarks.append(5000);
+        return sources;
+    });
+    annotation.resize(10, 300);
+    annotation.updateBuckets();
+    ASSERT_EQ(annotation.bucketCount(), 300 / ScrollBarAnnotation::s_bucketHeight);
+
+    ASSERT_TRUE(annotation.hasAnnotation(annotation.bucketForBlock(7000), ScrollBarAnnotation::FindMatch));
+    ASSERT_TRUE(annotation.hasAnnotation(annotation.bucketForBlock(5000), ScrollBarAnnotation::Bookmark));
+    ASSERT_TRUE(annotation.hasAnnotation(0, ScrollBarAnnotation::ColorMark));
+    ASSERT_EQ(annotation.m_buckets.at(0).markColor, QColor(Qt::red).rgba());
+    ASSERT_FALSE(annotation.hasAnnotation(0, ScrollBarAnnotation::FindMatch));
+    ASSERT_FALSE(annotation.hasAnnotation(annotation.bucketForBlock(5000), ScrollBarAnnotation::FindMatch));
+    for (int bucket = 0; bucket < annotation.bucketCount(); bucket++) {
+        ASSERT_FALSE(annotation.hasAnnotation(bucket, ScrollBarAnnotation::Modified));
+    }
+
+    // 文本块数量不变时仅更新变更行所在的区间
+    cursor = QTextCursor(edit.document()->findBlockByNumber(2000));
+    cursor.insertText("needle ");
+    ASSERT_EQ(annotation.m_dirtyFrom, 2000);
+    ASSERT_EQ(annotation.m_dirtyTo, 2000);
+    annotation.updateBuckets();
+    const int bucket = annotation.bucketForBlock(2000);
+    ASSERT_TRUE(annotation.hasAnnotation(bucket, ScrollBarAnnotation::Modified));
+    ASSERT_TRUE(annotation.hasAnnotation(bucket, ScrollBarAnnotation::FindMatch));
+    ASSERT_EQ(annotation.modifiedBlocks(), RangeList({{2000, 2000}}));
+
+    // 插入换行后之后的已修改行随之平移
+    cursor = QTextCursor(edit.document()->findBlockByNumber(100));
+    cursor.insertText("\n");
+    ASSERT_EQ(annotation.modifiedBlocks(), RangeList({{100, 101}, {2001, 2001}}));
+
+    // 保存后清空已修改行
+    annotation.clearModifiedBlocks();
+    annotation.updateBuckets();
+    for (int i = 0; i < annotation.bucketCount(); i++) {
+        ASSERT_FALSE(annotation.hasAnnotation(i, ScrollBarAnnotation::Modified));
+    }
+}
+
+/**
+ * @brief 大量匹配项时计算标注的耗时，耗时只和滑槽高度相关，可通过 EDITOR_BENCHMARK_ANNOTATION_LINES 调整行数
+ */
+TEST_F(UT_ScrollBarAnnotation, bucketBenchmark)
+{
+    const int lineCount = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_ANNOTATION_LINES")
+                          ? qMax(1000, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_ANNOTATION_LINES")) : 200000;
+    QPlainTextEdit edit;
+    edit.setPlainText(repeatedLines(lineCount, "x = x + x * x - x;"));
+    MatchIntervalIndex index(edit.document());
+    index.addKeyword("x");
+    index.waitForFinished();
+
+    ScrollBarAnnotation annotation(&edit, [&index]() {
+        ScrollBarAnnotation::Sources sources;
+        sources.matchIndex = &index;
+        ScrollBarAnnotation::KeywordSource keyword;
+        keyword.keyword = "x";
+        sources.keywords.append(keyword);
+        return sources;
+    });
+    annotation.resize(10, 900);
+
+    QElapsedTimer timer;
+    timer.start();
+    annotation.updateBuckets();
+    const qint64 elapsed = timer.elapsed();
+
+    for (int bucket = 0; bucket < annotation.bucketCount(); bucket++) {
+        ASSERT_TRUE(annotation.hasAnnotation(bucket, ScrollBarAnnotation::FindMatch));
+    }
+    qInfo() << "[Benchmark] scrollbar annotation matches:" << index.matchCount("x")
+            << "buckets:" << annotation.bucketCount() << "update:" << elapsed << "ms";
+}
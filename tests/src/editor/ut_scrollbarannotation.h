@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef UT_SCROLLBARANNOTATION_H
+#define UT_SCROLLBARANNOTATION_H
+
+#include "gtest/gtest.h"
+#include <QObject>
+
+class UT_ScrollBarAnnotation : public QObject, public ::testing::Test
+{
+public:
+    UT_ScrollBarAnnotation();
+};
+
+#endif  // UT_SCROLLBARANNOTATION_H
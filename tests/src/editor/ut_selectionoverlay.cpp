@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ut_selectionoverlay.h"
+#include "../../src/editor/selectionoverlay.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+
+UT_SelectionOverlay::UT_SelectionOverlay()
+{
+}
+
+static QTextEdit::ExtraSelection createSelection(QTextDocument *doc, int start, int end, const QColor &color)
+{
+    QTextEdit::ExtraSelection selection;
+    selection.cursor = QTextCursor(doc);
+    selection.cursor.setPosition(start);
+    selection.cursor.setPosition(end, QTextCursor::KeepAnchor);
+    selection.format.setBackground(color);
+    return selection;
+}
+
+TEST_F(UT_SelectionOverlay, setLayer)
+{
+    QTextDocument doc;
+    doc.setPlainText("0123456789\n0123456789\n0123456789");
+    SelectionOverlay overlay;
+
+    QList<QTextEdit::ExtraSelection> selections;
+    selections << createSelection(&doc, 20, 25, Qt::red) << createSelection(&doc, 0, 5, Qt::red);
+    ASSERT_TRUE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_EQ(overlay.layerSize(SelectionOverlay::FindMatchLayer), 2);
+    ASSERT_EQ(overlay.sortCount(), 1);
+
+    // 内容未变化时不重新排序
+    ASSERT_FALSE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_EQ(overlay.sortCount(), 1);
+
+    // 文档编辑后选区随之移动，依然视为未变化
+    QTextCursor cursor(&doc);
+    cursor.insertText("abc");
+    ASSERT_FALSE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_EQ(overlay.sortCount(), 1);
+
+    selections.removeLast();
+    ASSERT_TRUE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_EQ(overlay.sortCount(), 2);
+
+    overlay.clear();
+    ASSERT_EQ(overlay.layerSize(SelectionOverlay::FindMatchLayer), 0);
+}
+
+TEST_F(UT_SelectionOverlay, setLayerSharedList)
+{
+    QTextDocument doc;
+    doc.setPlainText("0123456789\n0123456789\n0123456789");
+    SelectionOverlay overlay;
+
+    QList<QTextEdit::ExtraSelection> selections;
+    selections << createSelection(&doc, 0, 5, Qt::red) << createSelection(&doc, 20, 25, Qt::red);
+    ASSERT_TRUE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_TRUE(overlay.m_layers[SelectionOverlay::FindMatchLayer].source.isSharedWith(selections));
+
+    // 未修改的列表直接判定为未变化
+    const QList<QTextEdit::ExtraSelection> copy = selections;
+    ASSERT_FALSE(overlay.setLayer(SelectionOverlay::FindMatchLayer, copy));
+    ASSERT_EQ(overlay.sortCount(), 1);
+
+    // 修改列表后分离共享数据，按内容比较
+    selections[0].format.setBackground(Qt::blue);
+    ASSERT_FALSE(overlay.m_layers[SelectionOverlay::FindMatchLayer].source.isSharedWith(selections));
+    ASSERT_TRUE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_EQ(overlay.sortCount(), 2);
+
+    // 使用时间戳设置后不再按共享数据判断
+    ASSERT_TRUE(overlay.setLayer(SelectionOverlay::FindMatchLayer, QList<SelectionOverlay::OrderedSelection>()));
+    ASSERT_FALSE(overlay.m_layers[SelectionOverlay::FindMatchLayer].hasSource);
+    ASSERT_TRUE(overlay.setLayer(SelectionOverlay::FindMatchLayer, selections));
+    ASSERT_EQ(overlay.layerSize(SelectionOverlay::FindMatchLayer), 2);
+}
+
+TEST_F(UT_SelectionOverlay, layerSelectionsInRange)
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(100, 'a'));
+    SelectionOverlay overlay;
+
+    QList<QTextEdit::ExtraSelection> selections;
+    // 跨越查询区间的长选区
+    selections << createSelection(&doc, 0, 90, Qt::red);
+    for (int i = 0; i < 10; i++) {
+        selections << createSelection(&doc, i * 10, i * 10 + 2, Qt::blue);
+    }
+    overlay.setLayer(SelectionOverlay::FindMatchLayer, selections);
+
+    QList<QTextEdit::ExtraSelection> result = overlay.layerSelectionsInRange(SelectionOverlay::FindMatchLayer, 35, 55);
+    ASSERT_EQ(result.size(), 3);
+    // 保持设置时的绘制顺序
+    ASSERT_EQ(result.at(0).cursor.selectionStart(), 0);
+    ASSERT_EQ(result.at(1).cursor.selectionStart(), 40);
+    ASSERT_EQ(result.at(2).cursor.selectionStart(), 50);
+
+    result = overlay.layerSelectionsInRange(SelectionOverlay::FindMatchLayer, 95, 99);
+    ASSERT_TRUE(result.isEmpty());
+
+    // 和区间边界相接的选区视为相交
+    result = overlay.layerSelectionsInRange(SelectionOverlay::FindMatchLayer, 92, 95);
+    ASSERT_EQ(result.size(), 1);
+    ASSERT_EQ(result.at(0).cursor.selectionStart(), 90);
+}
+
+TEST_F(UT_SelectionOverlay, timeStampOrder)
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(100, 'a'));
+    SelectionOverlay overlay;
+
+    QList<SelectionOverlay::OrderedSelection> selections;
+    selections << qMakePair(createSelection(&doc, 50, 60, Qt::red), qint64(300))
+               << qMakePair(createSelection(&doc, 10, 20, Qt::blue), qint64(200))
+               << qMakePair(createSelection(&doc, 30, 40, Qt::green), qint64(100));
+    overlay.setLayer(SelectionOverlay::ColorMarkLayer, selections);
+
+    QList<QTextEdit::ExtraSelection> result = overlay.layerSelectionsInRange(SelectionOverlay::ColorMarkLayer, 0, 100);
+    ASSERT_EQ(result.size(), 3);
+    ASSERT_EQ(result.at(0).cursor.selectionStart(), 30);
+    ASSERT_EQ(result.at(1).cursor.selectionStart(), 10);
+    ASSERT_EQ(result.at(2).cursor.selectionStart(), 50);
+}
+
+TEST_F(UT_SelectionOverlay, selectionsInRange)
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(100, 'a'));
+    SelectionOverlay overlay;
+
+    overlay.setLayer(SelectionOverlay::FindHighlightLayer, QList<QTextEdit::ExtraSelection>() << createSelection(&doc, 10, 12, Qt::red));
+    overlay.setLayer(SelectionOverlay::CurrentLineLayer, QList<QTextEdit::ExtraSelection>() << createSelection(&doc, 11, 11, Qt::gray));
+    overlay.setLayer(SelectionOverlay::BracketLayer, QList<QTextEdit::ExtraSelection>() << createSelection(&doc, 80, 81, Qt::blue));
+
+    // 按图层顺序排列
+    QList<QTextEdit::ExtraSelection> result = overlay.selectionsInRange(0, 50);
+    ASSERT_EQ(result.size(), 2);
+    ASSERT_EQ(result.at(0).format.background().color(), QColor(Qt::gray));
+    ASSERT_EQ(result.at(1).format.background().color(), QColor(Qt::red));
+
+    ASSERT_EQ(SelectionOverlay::signature(result), SelectionOverlay::signature(overlay.selectionsInRange(0, 50)));
+    ASSERT_NE(SelectionOverlay::signature(result), SelectionOverlay::signature(overlay.selectionsInRange(0, 100)));
+}
@@ -5,44 +5,73 @@
 #include "ut_showflodcodewidget.h"
 #include "../../src/editor/showflodcodewidget.h"
 
+#include <QTextDocument>
+
 test_showflodcodewidget::test_showflodcodewidget()
 {
 
 }
 
+static QVector<QTextBlock> documentBlocks(QTextDocument *doc)
+{
+    QVector<QTextBlock> blocks;
+    for (QTextBlock block = doc->firstBlock(); block.isValid(); block = block.next()) {
+        blocks.append(block);
+    }
+    return blocks;
+}
+
 TEST_F(test_showflodcodewidget, ShowFlodCodeWidget)
 {
     ShowFlodCodeWidget flodCodeWidget(nullptr);
-    ASSERT_TRUE(flodCodeWidget.m_pContentEdit != nullptr);
+    ASSERT_TRUE(flodCodeWidget.m_blocks.isEmpty());
 }
 
-//void appendText(QString strText, int maxWidth);
-TEST_F(test_showflodcodewidget, appendText)
+//void setBlocks(const QVector<QTextBlock> &blocks, int maxWidth, int maxHeight);
+TEST_F(test_showflodcodewidget, setBlocks)
 {
+    QTextDocument doc;
+    doc.setPlainText("int a = 0;\nint b = 1;\nint c = 2;");
+    // 预览使用文本块已有的格式
+    QTextLayout::FormatRange range;
+    range.start = 0;
+    range.length = 3;
+    range.format.setForeground(Qt::red);
+    doc.firstBlock().layout()->setFormats({range});
+
     ShowFlodCodeWidget *flodCodeWidget = new ShowFlodCodeWidget();
-    flodCodeWidget->appendText("aa",1);
-    ASSERT_TRUE(flodCodeWidget->m_pContentEdit->textCursor().position() == 0);
+    flodCodeWidget->setBlocks(documentBlocks(&doc), 1000, 1000);
+    ASSERT_EQ(flodCodeWidget->m_layouts.size(), static_cast<size_t>(3));
+    ASSERT_EQ(flodCodeWidget->m_layouts.front()->formats().size(), 1);
+    ASSERT_EQ(flodCodeWidget->m_layouts.front()->text(), QString("int a = 0;"));
+    ASSERT_GT(flodCodeWidget->m_nTextHeight, 0);
+    ASSERT_LE(flodCodeWidget->m_nTextWidth, 1000 - 50);
 
     flodCodeWidget->deleteLater();
 }
 
-//void clear();
-TEST_F(test_showflodcodewidget, clear)
+TEST_F(test_showflodcodewidget, setBlocksMaxHeight)
 {
+    QTextDocument doc;
+    doc.setPlainText(QString("line\n").repeated(1000));
+
+    // 超出最大高度的文本块不进行布局
     ShowFlodCodeWidget *flodCodeWidget = new ShowFlodCodeWidget();
-    flodCodeWidget->clear();
+    flodCodeWidget->setBlocks(documentBlocks(&doc), 1000, 200);
+    ASSERT_LT(flodCodeWidget->m_layouts.size(), static_cast<size_t>(doc.blockCount()));
+    ASSERT_LE(flodCodeWidget->m_nTextHeight, 200);
 
-    ASSERT_TRUE(flodCodeWidget->m_nTextWidth == 0);
     flodCodeWidget->deleteLater();
 }
 
-//void initHighLight(QString filepath, bool bIsLight);
-TEST_F(test_showflodcodewidget, initHighLight)
+//void clear();
+TEST_F(test_showflodcodewidget, clear)
 {
     ShowFlodCodeWidget *flodCodeWidget = new ShowFlodCodeWidget();
-    flodCodeWidget->initHighLight("aa",true);
+    flodCodeWidget->clear();
 
-    ASSERT_TRUE(flodCodeWidget->m_pContentEdit != nullptr);
+    ASSERT_TRUE(flodCodeWidget->m_nTextWidth == 0);
+    ASSERT_TRUE(flodCodeWidget->m_layouts.empty());
     flodCodeWidget->deleteLater();
 }
 
@@ -52,16 +81,6 @@ TEST_F(test_showflodcodewidget, setStyle)
     ShowFlodCodeWidget *flodCodeWidget = new ShowFlodCodeWidget();
     flodCodeWidget->setStyle(true);
 
-    ASSERT_TRUE(flodCodeWidget->m_pContentEdit->lineWrapMode() == QPlainTextEdit::WidgetWidth);
-    flodCodeWidget->deleteLater();
-}
-
-//void hideFirstBlock();
-TEST_F(test_showflodcodewidget, hideFirstBlock)
-{
-    ShowFlodCodeWidget *flodCodeWidget = new ShowFlodCodeWidget();
-    flodCodeWidget->hideFirstBlock();
-
-    ASSERT_TRUE(flodCodeWidget->m_pContentEdit->height() >= 10);
+    ASSERT_TRUE(flodCodeWidget->m_bIsLineWrap);
     flodCodeWidget->deleteLater();
 }
@@ -6,6 +6,8 @@
 #include "stub.h"
 #include "../../src/widgets/window.h"
 #include <QUndoStack>
+#include <QAbstractTextDocumentLayout>
+#include <algorithm>
 #include "QDBusReply"
 #include "QDBusConnection"
 
@@ -1765,6 +1767,111 @@ TEST(UT_test_textedit_updateFont, UT_test_textedit_updateFont_001)
     pWindow->deleteLater();
 }
 
+//void applyFont(const QString &fontName, qreal fontSize);
+TEST(UT_test_textedit_applyFont, UT_test_textedit_applyFont_001)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    TextEdit *edit = pWindow->currentWrapper()->textEditor();
+    QString strMsg;
+    for (int i = 0; i < 2000; i++) {
+        strMsg += QString("Holle world %1 ").arg(i).repeated(8) + "\n";
+    }
+    QTextCursor textCursor = edit->textCursor();
+    edit->insertTextEx(textCursor, strMsg);
+    edit->setLineWrapMode(true);
+
+    edit->applyFont(edit->m_fontName, edit->m_fontSize + 2);
+    EXPECT_EQ(edit->document()->defaultFont().pointSizeF(), edit->m_fontSize);
+    // 自动换行时按时间片重新计算行数
+    EXPECT_GE(edit->m_relayoutNext, 0);
+    while (edit->m_relayoutNext >= 0) {
+        edit->continueProgressiveRelayout();
+    }
+    EXPECT_FALSE(edit->m_relayoutTimer->isActive());
+
+    // 未变化时不重新布局
+    edit->applyFont(edit->m_fontName, edit->m_fontSize);
+    EXPECT_EQ(edit->m_relayoutNext, -1);
+    pWindow->deleteLater();
+}
+
+//bool detectLongLines();
+TEST(UT_test_textedit_detectLongLines, UT_test_textedit_detectLongLines_001)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    TextEdit *edit = pWindow->currentWrapper()->textEditor();
+    edit->setLineWrapMode(false);
+
+    edit->setPlainText(QString("Holle world\n") + QString(LONG_LINE_THRESHOLD + 1, 'a'));
+    EXPECT_TRUE(edit->detectLongLines());
+    EXPECT_TRUE(edit->isLongLineMode());
+    EXPECT_EQ(edit->lineWrapMode(), QPlainTextEdit::WidgetWidth);
+    // 超长行模式下保持自动换行
+    edit->setLineWrapMode(false);
+    EXPECT_EQ(edit->lineWrapMode(), QPlainTextEdit::WidgetWidth);
+
+    edit->setPlainText(QString("Holle world\nHolle world"));
+    EXPECT_FALSE(edit->detectLongLines());
+    EXPECT_FALSE(edit->isLongLineMode());
+    const bool wordWrap = Settings::instance()->settings->option("base.font.wordwrap")->value().toBool();
+    EXPECT_EQ(edit->lineWrapMode(), wordWrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+    pWindow->deleteLater();
+}
+
+// 打开单行的大文件，统计光标移动的耗时。默认使用 256KB 的单行，
+// 可通过 EDITOR_BENCHMARK_LONGLINE_MB 指定更大的文件(例如 20)
+TEST(UT_test_textedit_detectLongLines, UT_test_textedit_longLineBenchmark)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    TextEdit *edit = pWindow->currentWrapper()->textEditor();
+    edit->resize(800, 600);
+
+    const int sizeKb = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_LONGLINE_MB")
+                       ? qMax(1, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_LONGLINE_MB")) * 1024 : 256;
+    QString line;
+    line.reserve(sizeKb * 1024);
+    for (int i = 0; line.size() < sizeKb * 1024; i++) {
+        line += QString("{\"key%1\":[%1,\"value\"]},").arg(i);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    edit->setPlainText(line);
+    line.clear();
+    line.squeeze();
+    ASSERT_TRUE(edit->detectLongLines());
+    QAbstractTextDocumentLayout *layout = edit->document()->documentLayout();
+    layout->blockBoundingRect(edit->document()->firstBlock());
+    const qint64 loadElapsed = timer.elapsed();
+
+    // 逐次移动光标并执行界面更新(当前行、括号匹配)，记录单次耗时
+    const QTextCursor::MoveOperation operations[] = {QTextCursor::Right, QTextCursor::Down,
+                                                     QTextCursor::EndOfLine, QTextCursor::Left};
+    QVector<qint64> latencies;
+    for (int i = 0; i < 400; i++) {
+        timer.restart();
+        edit->moveCursor(operations[i % 4]);
+        edit->flushFrameUpdate();
+        latencies.append(timer.nsecsElapsed());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const qint64 p50 = latencies.at(latencies.size() / 2) / 1000;
+    const qint64 p99 = latencies.at(latencies.size() * 99 / 100) / 1000;
+    qInfo() << "[Benchmark] long line(KB):" << sizeKb
+            << "load and layout(ms):" << loadElapsed
+            << "visual lines:" << edit->document()->firstBlock().layout()->lineCount()
+            << "cursor move p50(us):" << p50
+            << "p99(us):" << p99;
+
+    EXPECT_EQ(edit->document()->blockCount(), 1);
+    EXPECT_EQ(edit->lineWrapMode(), QPlainTextEdit::WidgetWidth);
+    pWindow->deleteLater();
+}
+
 //replaceAll 001
 TEST(UT_test_textedit_replaceAll, UT_test_textedit_replaceAll_001)
 {
@@ -3632,6 +3739,59 @@ TEST(UT_test_textedit_flodOrUnflodAllLevel, UT_test_textedit_flodOrUnflodAllLeve
     pWindow->deleteLater();
 }
 
+// 折叠仅重新布局变更范围，统计大文件全部折叠及展开的耗时
+TEST(UT_test_textedit_flodOrUnflodAllLevel, UT_test_textedit_flodOrUnflodAllLevel_Benchmark)
+{
+    Window *pWindow = new Window();
+    pWindow->addBlankTab(QString());
+    TextEdit *edit = pWindow->currentWrapper()->textEditor();
+    const QPlainTextEdit::LineWrapMode wrapMode = edit->lineWrapMode();
+
+    const int lineCount = qEnvironmentVariableIsSet("EDITOR_BENCHMARK_FOLD_LINES")
+                          ? qMax(5, qEnvironmentVariableIntValue("EDITOR_BENCHMARK_FOLD_LINES")) : 100000;
+    QString text;
+    for (int i = 0; i < lineCount / 5; i++) {
+        text += QString("void func%1()\n{\n    int value = %1;\n    return;\n}\n").arg(i);
+    }
+    edit->setPlainText(text);
+    // 预先计算折叠区域索引，仅统计折叠耗时
+    edit->m_pFoldRegionIndex->foldEndLine(1);
+
+    // 隐藏的文本块行数为0，文档布局记录的行数和文本块一致
+    auto checkLineCount = [edit]() {
+        int visibleBlocks = 0;
+        int lines = 0;
+        int mismatched = 0;
+        for (QTextBlock block = edit->document()->firstBlock(); block.isValid(); block = block.next()) {
+            visibleBlocks += block.isVisible() ? 1 : 0;
+            lines += block.lineCount();
+            mismatched += (block.isVisible() != (block.lineCount() > 0)) ? 1 : 0;
+        }
+        EXPECT_EQ(mismatched, 0);
+        EXPECT_EQ(static_cast<int>(edit->document()->documentLayout()->documentSize().height()), lines);
+        return visibleBlocks;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    edit->flodOrUnflodAllLevel(true);
+    const qint64 foldElapsed = timer.elapsed();
+    EXPECT_EQ(checkLineCount(), lineCount / 5 * 2 + 1);
+
+    timer.restart();
+    edit->flodOrUnflodAllLevel(false);
+    const qint64 unfoldElapsed = timer.elapsed();
+    EXPECT_EQ(checkLineCount(), edit->document()->blockCount());
+
+    qInfo() << "[Benchmark] fold all lines:" << edit->document()->blockCount()
+            << "fold(ms):" << foldElapsed
+            << "unfold(ms):" << unfoldElapsed;
+
+    // 不再通过切换换行模式重新布局
+    EXPECT_EQ(edit->lineWrapMode(), wrapMode);
+    pWindow->deleteLater();
+}
+
 //void flodOrUnflodCurrentLevel(bool isFlod);
 TEST(UT_test_textedit_flodOrUnflodCurrentLevel, UT_test_textedit_flodOrUnflodCurrentLevel_001)
 {
@@ -3657,9 +3817,8 @@ TEST(UT_test_textedit_getHideRowContent, UT_test_textedit_getHideRowContent_001)
     pWindow->currentWrapper()->textEditor()->insertTextEx(textCursor, strMsg);
 
     pWindow->currentWrapper()->textEditor()->getHideRowContent(0);
-    QString strRet(pWindow->currentWrapper()->textEditor()->m_foldCodeShow->m_pContentEdit->toPlainText());
-
-    ASSERT_TRUE(strRet.compare(QString("{\nHello world\n{\nHello world\n}\n}")));
+    // 预览折叠隐藏的文本块
+    ASSERT_FALSE(pWindow->currentWrapper()->textEditor()->m_foldCodeShow->m_blocks.isEmpty());
     pWindow->deleteLater();
 }
 
@@ -5377,6 +5536,33 @@ TEST_F(test_textedit, cursorPositionChanged)
     p->deleteLater();
 }
 
+// 连续的光标移动合并到同一帧更新
+TEST_F(test_textedit, cursorPositionChanged_coalesced)
+{
+    TextEdit *edit = new TextEdit();
+    EditWrapper *wrapper = new EditWrapper();
+    edit->setWrapper(wrapper);
+    edit->setPlainText("(abc)\n[def]\n{ghi}");
+    edit->flushFrameUpdate();
+
+    QTextCursor cursor = edit->textCursor();
+    // 位置未变化时不会触发光标移动信号，从 1 开始
+    for (int i = 1; i <= 3; i++) {
+        cursor.setPosition(i);
+        edit->setTextCursor(cursor);
+    }
+    EXPECT_EQ(edit->m_frameFoldedEvents, 3);
+    EXPECT_EQ(edit->m_frameUpdateFlags, TextEdit::FrameUpdateAll);
+    EXPECT_TRUE(edit->m_frameUpdateTimer->isActive());
+
+    edit->flushFrameUpdate();
+    EXPECT_EQ(edit->m_frameFoldedEvents, 0);
+    EXPECT_EQ(edit->m_frameUpdateFlags, TextEdit::FrameUpdateNone);
+
+    wrapper->deleteLater();
+    edit->deleteLater();
+}
+
 // void cut();
 TEST_F(test_textedit, cut_normal_passed)
 {
@@ -7,6 +7,7 @@
 #include "ddialog.h"
 #include "qfileinfo.h"
 #include "qfile.h"
+#include "../../src/common/printpaginator.h"
 
 int exec_ret = 1;
 int QDialog_exec_stub()
@@ -745,6 +746,23 @@ TEST(UT_Window_popupPrintDialog, UT_Window_popupPrintDialog)
 //    window = nullptr;
 
 
+}
+
+// 等待高亮完成期间再次打印时提示用户，不重复进入打印流程
+TEST(UT_Window_popupPrintDialog, UT_Window_popupPrintDialog_WaitHighlight)
+{
+    Window *window = new Window();
+    window->addBlankTab();
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(window);
+    window->m_printHighlightWatcher = watcher;
+
+    window->popupPrintDialog();
+    EXPECT_EQ(window->m_printHighlightWatcher, watcher);
+    EXPECT_FALSE(window->m_bPrintProcessing);
+    EXPECT_EQ(window->m_printDoc, nullptr);
+
+    window->m_printHighlightWatcher = nullptr;
+    window->deleteLater();
 }
 TEST(UT_Window_popupThemePanel, UT_Window_popupThemePanel)
 {
@@ -1268,6 +1286,102 @@ TEST(UT_Window_incrementFontSize, UT_Window_incrementFontSize)
     a->deleteLater();
 
 }
+// 连续缩放合并为一次保存
+TEST(UT_Window_incrementFontSize, UT_Window_incrementFontSize_Collapse)
+{
+    Window *window = new Window();
+    window->m_settings = Settings::instance();
+    window->addBlankTab();
+    qreal oldFontSize = window->m_fontSize;
+    window->incrementFontSize();
+    window->incrementFontSize();
+    EXPECT_EQ(window->m_fontSize, oldFontSize + 2);
+    EXPECT_TRUE(window->m_fontSizeTimer.isActive());
+
+    QTimerEvent event(window->m_fontSizeTimer.timerId());
+    window->timerEvent(&event);
+    EXPECT_FALSE(window->m_fontSizeTimer.isActive());
+    EXPECT_EQ(window->currentWrapper()->textEditor()->m_fontSize, oldFontSize + 2);
+
+    window->deleteLater();
+}
+
+// 隐藏的标签页在显示时同步显示设置
+TEST(UT_Window_syncDisplaySettings, UT_Window_syncDisplaySettings)
+{
+    Window *window = new Window();
+    window->m_settings = Settings::instance();
+    window->addBlankTab();
+    EditWrapper *hidden = window->currentWrapper();
+    window->addBlankTab();
+    EditWrapper *current = window->currentWrapper();
+    ASSERT_NE(hidden, current);
+
+    Settings *settings = Settings::instance();
+    const quint64 generation = settings->displaySettingsGeneration();
+    settings->slotsigAdjustFontSize(QVariant(window->m_fontSize + 1));
+    EXPECT_EQ(settings->displaySettingsGeneration(), generation + 1);
+    EXPECT_EQ(current->displaySettingsGeneration(), settings->displaySettingsGeneration());
+    EXPECT_NE(hidden->displaySettingsGeneration(), settings->displaySettingsGeneration());
+
+    window->syncDisplaySettings(hidden);
+    EXPECT_EQ(hidden->displaySettingsGeneration(), settings->displaySettingsGeneration());
+    EXPECT_EQ(hidden->textEditor()->m_fontSize, window->m_fontSize);
+
+    window->deleteLater();
+}
+
+// 多个窗口时每次设置变更显示设置版本仅递增一次，各窗口的当前标签页均完成同步
+TEST(UT_Window_syncDisplaySettings, UT_Window_syncDisplaySettings_MultiWindow)
+{
+    Window *first = new Window();
+    first->m_settings = Settings::instance();
+    first->addBlankTab();
+    Window *second = new Window();
+    second->m_settings = Settings::instance();
+    second->addBlankTab();
+
+    Settings *settings = Settings::instance();
+    const quint64 generation = settings->displaySettingsGeneration();
+    settings->slotsigAdjustTabSpaceNumber(QVariant(8));
+    EXPECT_EQ(settings->displaySettingsGeneration(), generation + 1);
+    EXPECT_EQ(first->currentWrapper()->displaySettingsGeneration(), generation + 1);
+    EXPECT_EQ(second->currentWrapper()->displaySettingsGeneration(), generation + 1);
+
+    // 直接调用窗口的槽函数不会递增版本
+    first->slotSigAdjustTabSpaceNumber(8);
+    EXPECT_EQ(settings->displaySettingsGeneration(), generation + 1);
+
+    first->deleteLater();
+    second->deleteLater();
+}
+
+// 自动换行、制表符宽度及空白符显示仅立即应用到当前标签页
+TEST(UT_Window_syncDisplaySettings, UT_Window_syncDisplaySettings_WordWrap)
+{
+    Window *window = new Window();
+    window->m_settings = Settings::instance();
+    window->addBlankTab();
+    EditWrapper *hidden = window->currentWrapper();
+    window->addBlankTab();
+    EditWrapper *current = window->currentWrapper();
+    ASSERT_NE(hidden, current);
+
+    auto wordWrap = window->m_settings->settings->option("base.font.wordwrap");
+    const bool oldWordWrap = wordWrap->value().toBool();
+    const QPlainTextEdit::LineWrapMode hiddenMode = hidden->textEditor()->lineWrapMode();
+    // 修改配置项时由 Settings 递增显示设置版本并通知窗口
+    wordWrap->setValue(!oldWordWrap);
+    EXPECT_EQ(current->textEditor()->lineWrapMode(), oldWordWrap ? QPlainTextEdit::NoWrap : QPlainTextEdit::WidgetWidth);
+    EXPECT_EQ(hidden->textEditor()->lineWrapMode(), hiddenMode);
+
+    window->syncDisplaySettings(hidden);
+    EXPECT_EQ(hidden->textEditor()->lineWrapMode(), current->textEditor()->lineWrapMode());
+
+    wordWrap->setValue(oldWordWrap);
+    window->deleteLater();
+}
+
 //void resetFontSize();
 TEST(UT_Window_resetFontSize, UT_Window_resetFontSize)
 {
@@ -2025,9 +2139,7 @@ TEST(UT_Window_doprint, UT_Window_doPrintWithLargeDoc)
     Window* w = new Window();
     DPrinter* p = new DPrinter;
     w->m_pPreview = new DPrintPreviewDialog;
-    Window::PrintInfo info;
-    info.doc = new QTextDocument;
-    w->m_printDocList.append(info);
+    w->m_printPaginator = new PrintPaginator(new QTextDocument(w), w);
 
     editwrapper_texteditor = new TextEdit;
     Stub s1;s1.set(ADDR(EditWrapper,textEditor),EditWrapper_textEditor_stub);
@@ -2048,33 +2160,20 @@ TEST(UT_Window_doprint, UT_Window_doPrintWithLargeDoc)
     p = nullptr;
 }
 
-void stubProcessEvents(QEventLoop::ProcessEventsFlags flags = QEventLoop::AllEvents)
-{
-    Q_UNUSED(flags);
-}
-
-TEST(UT_Window_doprint, UT_Window_cloneLargeDocument)
+TEST(UT_Window_doprint, UT_Window_clearPrintTextDocument)
 {
     Window* w = new Window();
     EditWrapper* wra = new EditWrapper(w);
     QString text = "123";
     wra->textEditor()->document()->setPlainText(text);
 
-    // 不在ut中使用Eventloop
-    typedef void (*Func)(QEventLoop::ProcessEventsFlags);
-    Stub s1;
-    s1.set((Func)ADDR(QCoreApplication, processEvents), stubProcessEvents);
-
-    // 拷贝数据
-    w->cloneLargeDocument(wra);
-    EXPECT_FALSE(w->m_printDocList.isEmpty());
-    if (!w->m_printDocList.isEmpty()) {
-        EXPECT_NE(w->m_printDocList.first().doc, nullptr);
-    }
+    // 大文本打印不拷贝文档，仅创建分页引擎
+    w->m_printPaginator = new PrintPaginator(wra->textEditor()->document(), w);
+    EXPECT_NE(w->m_printPaginator, nullptr);
 
     // 清空数据
     w->clearPrintTextDocument();
-    EXPECT_TRUE(w->m_printDocList.isEmpty());
+    EXPECT_EQ(w->m_printPaginator, nullptr);
 
     wra->deleteLater();
     w->deleteLater();
@@ -2177,22 +2276,40 @@ TEST(UT_Window_slot_setTitleFocus, UT_Window_slot_setTitleFocus_002)
     w->deleteLater();
 }
 
-TEST(UT_Window_rehighlightPrintDoc, rehighlightPrintDoc_HighlightCpp_pass)
+TEST(UT_Window_printPageWithPaginator, printPageWithPaginator_HighlightCpp_pass)
 {
     Window* w = new Window;
-    w->addBlankTab();
-    w->m_printWrapper = w->currentWrapper();
     QTextDocument *doc = new QTextDocument;
     doc->setPlainText("#include <iostream>;\n"
                       "int main(int argc, char *argv[]) { }");
 
+    // 使用源文档已有的高亮格式绘制
     CSyntaxHighlighter *highlighter = new CSyntaxHighlighter(doc);
     KSyntaxHighlighting::Repository repository;
     highlighter->setDefinition(repository.definitionForName("C++"));
     highlighter->setTheme(repository.defaultTheme(KSyntaxHighlighting::Repository::LightTheme));
-
-    w->rehighlightPrintDoc(doc, highlighter);
-    EXPECT_FALSE(doc->firstBlock().textFormats().isEmpty());
+    highlighter->rehighlight();
+
+    PrintPaginator paginator(doc);
+    paginator.setPageGeometry(doc->defaultFont(), QTextOption(), QSizeF(400, 400));
+    paginator.paginate();
+    paginator.waitForFinished();
+    EXPECT_EQ(paginator.pageCount(), 1);
+
+    QImage image(500, 500, QImage::Format_ARGB32);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    Window::printPageWithPaginator(1, &painter, paginator.pageSnapshot(1), QRectF(0, 0, 500, 500), QRectF(50, 450, 400, 20));
+    painter.end();
+
+    // 文本区域(页边距内)已绘制文本
+    bool hasText = false;
+    for (int y = 50; y < 100 && !hasText; y++) {
+        for (int x = 50; x < 450 && !hasText; x++) {
+            hasText = image.pixel(x, y) != qRgb(255, 255, 255);
+        }
+    }
+    EXPECT_TRUE(hasText);
 
     doc->deleteLater();
     w->deleteLater();